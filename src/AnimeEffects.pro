@@ -11,6 +11,14 @@ SUBDIRS     = util thr cmnd gl img core ctrl gui
 
 CONFIG += ordered
 
+# accuracy checks, "make check" fails if one of them fails
+SUBDIRS     += check
+
+# benchmarks, enabled by "qmake CONFIG+=bench"
+bench {
+SUBDIRS     += bench
+}
+
 TRANSLATIONS = ../data/locale/translation_ja.ts
 
 # copy directory
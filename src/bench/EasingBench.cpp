@@ -0,0 +1,175 @@
+#include <cmath>
+#include <algorithm>
+#include <QVector>
+#include <QElapsedTimer>
+#include "XC.h"
+#include "util/Easing.h"
+#include "util/EasingTable.h"
+#include "bench/EasingBench.h"
+
+namespace
+{
+
+const char* rangeName(util::Easing::Range aRange)
+{
+    switch (aRange)
+    {
+    case util::Easing::Range_In: return "in";
+    case util::Easing::Range_Out: return "out";
+    case util::Easing::Range_InOut: return "inout";
+    default: return "unknown";
+    }
+}
+
+// the rates of the channels, the ends and the sample points of the tables
+// are included
+QVector<float> createRates(int aCount)
+{
+    QVector<float> rates(aCount);
+    uint32 seed = 123456789;
+
+    for (int i = 0; i < aCount; ++i)
+    {
+        seed ^= seed << 13;
+        seed ^= seed >> 17;
+        seed ^= seed << 5;
+        rates[i] = (float)(seed >> 8) / (float)(1 << 24);
+    }
+    for (int i = 0; i <= util::EasingTable::kSampleCount && i < aCount / 2; ++i)
+    {
+        rates[i * 2] = (float)i / util::EasingTable::kSampleCount;
+    }
+    rates[aCount - 1] = 1.0f;
+    return rates;
+}
+
+double nsecPerRate(const QElapsedTimer& aTimer, int aRepeatCount, int aCount)
+{
+    return (double)aTimer.nsecsElapsed() / ((double)aRepeatCount * aCount);
+}
+
+} // namespace
+
+namespace bench
+{
+
+EasingBench::EasingBench(int aRepeatCount)
+    : mRepeatCount(aRepeatCount)
+{
+}
+
+void EasingBench::run(Report& aReport)
+{
+    static const int kChannelCount = 1 << 16;
+    const util::EasingTable& table = util::EasingTable::instance();
+    const QVector<float> rates = createRates(kChannelCount);
+    QVector<float> expected(kChannelCount);
+    QVector<float> scalar(kChannelCount);
+    QVector<float> batch(kChannelCount);
+
+    aReport.beginTable("easing", QStringList()
+                       << "type" << "range" << "weight" << "simd" << "max_error" << "passed"
+                       << "calculate_ns" << "rate_ns" << "batch_ns" << "speedup");
+
+    for (int t = util::Easing::Type_Linear; t < util::Easing::Type_TERM; ++t)
+    {
+        for (int r = 0; r < util::Easing::Range_TERM; ++r)
+        {
+            util::Easing::Param param;
+            param.type = (util::Easing::Type)t;
+            param.range = (util::Easing::Range)r;
+            param.weight = 0.75f;
+
+            QElapsedTimer timer;
+            timer.start();
+            for (int i = 0; i < mRepeatCount; ++i)
+            {
+                for (int k = 0; k < kChannelCount; ++k)
+                {
+                    expected[k] = util::Easing::calculate(param, rates[k], 0.0f, 1.0f, 1.0f);
+                }
+            }
+            const double calculateNSec = nsecPerRate(timer, mRepeatCount, kChannelCount);
+
+            timer.start();
+            for (int i = 0; i < mRepeatCount; ++i)
+            {
+                for (int k = 0; k < kChannelCount; ++k)
+                {
+                    scalar[k] = table.rate(param, rates[k]);
+                }
+            }
+            const double rateNSec = nsecPerRate(timer, mRepeatCount, kChannelCount);
+
+            timer.start();
+            for (int i = 0; i < mRepeatCount; ++i)
+            {
+                table.rates(param, rates.constData(), batch.data(), kChannelCount);
+            }
+            const double batchNSec = nsecPerRate(timer, mRepeatCount, kChannelCount);
+
+            // the batch has to return the same rates as the scalar one
+            bool sameRates = true;
+            float maxError = 0.0f;
+            for (int k = 0; k < kChannelCount; ++k)
+            {
+                sameRates = sameRates && scalar[k] == batch[k];
+                maxError = std::max(maxError, std::fabs(batch[k] - expected[k]));
+            }
+            const bool passed = sameRates && maxError < util::EasingTable::kMaxError;
+            XC_ASSERT(passed);
+
+            aReport.row(QVariantList()
+                        << util::Easing::getTypeName(param.type) << rangeName(param.range)
+                        << param.weight << util::EasingTable::usesSimd() << maxError << passed
+                        << calculateNSec << rateNSec << batchNSec
+                        << (batchNSec > 0.0 ? calculateNSec / batchNSec : 0.0));
+        }
+    }
+
+    // channels of mixed easings, which are evaluated in runs of the same one
+    {
+        QVector<util::Easing::Param> params(kChannelCount);
+        for (int k = 0; k < kChannelCount; ++k)
+        {
+            params[k].type = (util::Easing::Type)(1 + (k / 64) % (util::Easing::Type_TERM - 1));
+            params[k].range = (util::Easing::Range)((k / 256) % util::Easing::Range_TERM);
+            params[k].weight = 1.0f;
+        }
+
+        QElapsedTimer timer;
+        timer.start();
+        for (int i = 0; i < mRepeatCount; ++i)
+        {
+            for (int k = 0; k < kChannelCount; ++k)
+            {
+                expected[k] = util::Easing::calculate(params[k], rates[k], 0.0f, 1.0f, 1.0f);
+            }
+        }
+        const double calculateNSec = nsecPerRate(timer, mRepeatCount, kChannelCount);
+
+        timer.start();
+        for (int i = 0; i < mRepeatCount; ++i)
+        {
+            table.rates(params.constData(), rates.constData(), batch.data(), kChannelCount);
+        }
+        const double batchNSec = nsecPerRate(timer, mRepeatCount, kChannelCount);
+
+        float maxError = 0.0f;
+        for (int k = 0; k < kChannelCount; ++k)
+        {
+            maxError = std::max(maxError, std::fabs(batch[k] - expected[k]));
+        }
+        const bool passed = maxError < util::EasingTable::kMaxError;
+        XC_ASSERT(passed);
+
+        aReport.beginTable("easing_channels", QStringList()
+                           << "channels" << "run" << "max_error" << "passed"
+                           << "calculate_ns" << "batch_ns" << "speedup");
+        aReport.row(QVariantList()
+                    << kChannelCount << 64 << maxError << passed << calculateNSec << batchNSec
+                    << (batchNSec > 0.0 ? calculateNSec / batchNSec : 0.0));
+    }
+}
+
+} // namespace bench
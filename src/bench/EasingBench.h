@@ -0,0 +1,24 @@
+#ifndef BENCH_EASINGBENCH_H
+#define BENCH_EASINGBENCH_H
+
+#include "bench/Report.h"
+
+namespace bench
+{
+
+// Checks util::EasingTable against util::Easing for each easing type and
+// range, and measures Easing::calculate, the scalar rate of the table and
+// the batch rates over many channels.
+class EasingBench
+{
+public:
+    EasingBench(int aRepeatCount);
+    void run(Report& aReport);
+
+private:
+    int mRepeatCount;
+};
+
+} // namespace bench
+
+#endif // BENCH_EASINGBENCH_H
@@ -0,0 +1,355 @@
+#include <cstring>
+#include <cmath>
+#include <QTemporaryDir>
+#include <QElapsedTimer>
+#include <QCoreApplication>
+#include <QMouseEvent>
+#include <QVector>
+#include <QVector2D>
+#include "XC.h"
+#include "gl/Global.h"
+#include "core/ObjectNode.h"
+#include "core/ImageKey.h"
+#include "core/TimeLine.h"
+#include "core/TimeKeyBlender.h"
+#include "core/MeshTransformerResource.h"
+#include "core/CameraInfo.h"
+#include "core/AbstractCursor.h"
+#include "ctrl/FFDParam.h"
+#include "ctrl/ffd/ffd_Task.h"
+#include "ctrl/ffd/ffd_Target.h"
+#include "ctrl/ffd/ffd_BrushMode.h"
+#include "ctrl/ffd/ffd_TaskResource.h"
+#include "bench/SyntheticProject.h"
+#include "bench/FFDBench.h"
+
+namespace
+{
+
+static const int kStrokeSteps = 64;
+static const int kBrushRadius = 32;
+static const int kBrushFrames = 32;
+static const int kTabletSamplesPerFrame = 4; // about 240Hz
+static const qint64 kFrameNSec = 16000000; // the display frame of the brush mode
+
+typedef bench::SyntheticProject::Spec Spec;
+
+QVector<Spec> specs()
+{
+    // one large layer in several mesh densities
+    QVector<Spec> result;
+    result << Spec("coarse", 1, 0, 1, 16)
+           << Spec("base",   1, 0, 1,  8)
+           << Spec("dense",  1, 0, 1,  4);
+    for (auto& spec : result)
+    {
+        spec.layerSize = QSize(1024, 1024);
+    }
+    return result;
+}
+
+struct StrokeResult
+{
+    StrokeResult() : stepMSec(), vertexCount() {}
+    double stepMSec;
+    double vertexCount; // evaluated in a step
+};
+
+// a horizontal stroke through the middle of the layer. the results are
+// applied to the positions as the brush mode does.
+StrokeResult stroke(ctrl::ffd::Task& aTask, const core::TimeKeyExpans& aExpans,
+                    const core::LayerMesh& aMesh, const QRect& aRect,
+                    int aRadius, int aRepeatCount)
+{
+    const int vtxCount = aMesh.vertexCount();
+    QVector<gl::Vector3> positions(vtxCount);
+
+    ctrl::FFDParam param;
+    param.radius = aRadius;
+    param.pressure = 1.0f;
+
+    const QVector2D move((float)aRect.width() / kStrokeSteps, 0.0f);
+    qint64 evaluated = 0;
+
+    aTask.setType(ctrl::ffd::Task::Type_Deformer);
+
+    QElapsedTimer timer;
+    timer.start();
+    for (int i = 0; i < aRepeatCount; ++i)
+    {
+        memcpy(positions.data(), aMesh.positions(), sizeof(gl::Vector3) * vtxCount);
+        QVector2D center(aRect.left(), aRect.center().y());
+        aTask.resetRegion();
+
+        for (int step = 0; step < kStrokeSteps; ++step)
+        {
+            aTask.writeSrc(aExpans, positions.data(), aMesh, param);
+            aTask.setBrush(center, move);
+            aTask.request();
+            aTask.finish();
+
+            for (auto range : aTask.dstRanges())
+            {
+                const int count = range.diff() + 1;
+                memcpy(positions.data() + range.min(), aTask.dstMesh() + range.min(),
+                       sizeof(gl::Vector3) * count);
+                evaluated += count;
+            }
+            center += move;
+        }
+    }
+
+    const int stepCount = std::max(aRepeatCount, 1) * kStrokeSteps;
+    StrokeResult result;
+    result.stepMSec = (double)timer.nsecsElapsed() / (1000000.0 * stepCount);
+    result.vertexCount = (double)evaluated / stepCount;
+    return result;
+}
+
+struct BrushResult
+{
+    BrushResult() : dispatchPerFrame(), inFlightMean(), inFlightMax(), stallFrameMSec() {}
+    double dispatchPerFrame;
+    double inFlightMean; // readbacks in flight after a dispatch
+    int inFlightMax;
+    double stallFrameMSec;
+};
+
+// a horizontal stroke through the middle of the layer by the brush mode.
+// the samples come at the tablet rate in real time, the timers of the mode
+// run between them, and the posted events are flushed once per display
+// frame as the display does.
+BrushResult brushStroke(core::Project& aProject, ctrl::ffd::Targets& aTargets,
+                        const QRect& aRect, bool aAsync, int aSampleBudget,
+                        int aRepeatCount)
+{
+    ctrl::FFDParam param;
+    param.type = ctrl::FFDParam::Type_Pencil;
+    param.radius = kBrushRadius;
+    param.asyncReadback = aAsync;
+    param.sampleBudget = aSampleBudget;
+
+    ctrl::ffd::BrushMode mode(aProject, aTargets);
+    mode.updateParam(param);
+
+    // the screen coordinates are the same as the world ones
+    const QSize imageSize = aProject.attribute().imageSize();
+    core::CameraInfo camera;
+    camera.reset(imageSize, 1.0, imageSize, QPoint(0, 0));
+    core::AbstractCursor cursor;
+
+    const int sampleCount = kBrushFrames * kTabletSamplesPerFrame;
+    const qint64 sampleNSec = kFrameNSec / kTabletSamplesPerFrame;
+    const int y = aRect.center().y();
+    auto samplePos = [&](int aIndex)
+    {
+        return QPointF(aRect.left() + (double)aRect.width() * aIndex / sampleCount, y);
+    };
+
+    int dispatchCount = 0;
+    int inFlightSum = 0;
+    int inFlightMax = 0;
+    qint64 stallNSec = 0;
+
+    for (int i = 0; i < aRepeatCount; ++i)
+    {
+        QElapsedTimer clock;
+        clock.start();
+
+        QMouseEvent press(QEvent::MouseButtonPress, samplePos(0),
+                          Qt::LeftButton, Qt::LeftButton, Qt::NoModifier);
+        cursor.setMousePress(&press, camera);
+        mode.updateCursor(camera, cursor);
+
+        for (int sample = 1; sample <= sampleCount; ++sample)
+        {
+            // wait for the next sample
+            while (clock.nsecsElapsed() < sample * sampleNSec)
+            {
+                QCoreApplication::processEvents();
+            }
+
+            QMouseEvent move(QEvent::MouseMove, samplePos(sample),
+                             Qt::NoButton, Qt::LeftButton, Qt::NoModifier);
+            cursor.setMouseMove(&move, camera);
+            mode.updateCursor(camera, cursor);
+
+            if (sample % kTabletSamplesPerFrame == 0)
+            {
+                aProject.flushTimeLineEvents();
+            }
+        }
+
+        QMouseEvent release(QEvent::MouseButtonRelease, samplePos(sampleCount),
+                            Qt::LeftButton, Qt::NoButton, Qt::NoModifier);
+        cursor.setMouseRelease(&release, camera);
+        mode.updateCursor(camera, cursor);
+        aProject.flushTimeLineEvents();
+
+        const auto& stats = mode.strokeStats();
+        dispatchCount += stats.dispatchCount;
+        inFlightSum += stats.inFlightSum;
+        inFlightMax = std::max(inFlightMax, stats.inFlightMax);
+        stallNSec += stats.stallNSec;
+    }
+
+    const int frameCount = std::max(aRepeatCount, 1) * kBrushFrames;
+    BrushResult result;
+    result.dispatchPerFrame = (double)dispatchCount / frameCount;
+    result.inFlightMean = (double)inFlightSum / std::max(dispatchCount, 1);
+    result.inFlightMax = inFlightMax;
+    result.stallFrameMSec = (double)stallNSec / (1000000.0 * frameCount);
+    return result;
+}
+
+} // namespace
+
+namespace bench
+{
+
+FFDBench::FFDBench(int aRepeatCount, const gl::DeviceInfo& aDeviceInfo)
+    : mRepeatCount(aRepeatCount)
+    , mDeviceInfo(aDeviceInfo)
+{
+}
+
+void FFDBench::run(Report& aReport)
+{
+    QTemporaryDir workDir;
+    if (!workDir.isValid())
+    {
+        aReport.comment("ffd: failed to create a work directory");
+        return;
+    }
+
+    // the same shaders as the ffd editor
+    core::MeshTransformerResource meshResource;
+    meshResource.setup("./data/shader/MeshTransformVert.glsl");
+    ctrl::ffd::TaskResource taskResource;
+    taskResource.setup(
+                "./data/shader/FreeFormDeformVert.glsl",
+                "./data/shader/FFDEraseVert.glsl",
+                "./data/shader/FFDFocusVertexVert.glsl",
+                "./data/shader/FFDBlurVert.glsl");
+
+    aReport.beginTable("ffd", QStringList()
+                       << "spec" << "cell" << "vertices" << "radius"
+                       << "full_step_ms" << "region_step_ms"
+                       << "full_vertices" << "region_vertices");
+
+    // the brush table follows the step table
+    QVector<QVariantList> brushRows;
+
+    for (auto& spec : specs())
+    {
+        const QString psdPath = workDir.path() + "/" + spec.name + ".psd";
+        if (!SyntheticProject::writePSD(spec, psdPath))
+        {
+            aReport.comment("ffd: failed to write " + psdPath);
+            continue;
+        }
+
+        SyntheticProject synthetic(spec);
+        if (!synthetic.load(psdPath, mDeviceInfo))
+        {
+            aReport.comment("ffd: failed to import " + psdPath);
+            continue;
+        }
+        synthetic.resetGridMeshes();
+        core::Project& project = synthetic.project();
+
+        core::ObjectNode* layer = nullptr;
+        for (core::ObjectNode::Iterator itr(project.objectTree().topNode()); itr.hasNext();)
+        {
+            core::ObjectNode* node = itr.next();
+            if (node->type() == core::ObjectType_Layer)
+            {
+                layer = node;
+                break;
+            }
+        }
+        auto key = layer ?
+                    (core::ImageKey*)layer->timeLine()->defaultKey(core::TimeKeyType_Image) :
+                    nullptr;
+        if (!key || key->data().gridMesh().vertexCount() <= 0)
+        {
+            aReport.comment("ffd: no layer mesh in " + spec.name);
+            continue;
+        }
+
+        core::TimeKeyBlender blender(project.objectTree());
+        blender.updateCurrents(project.objectTree().topNode(), project.currentTimeInfo());
+
+        const core::LayerMesh& mesh = key->data().gridMesh();
+        const core::TimeKeyExpans& expans = layer->timeLine()->current();
+        const QRect rect = spec.layerRect(0);
+        const int coverRadius = (int)std::ceil(std::hypot(rect.width(), rect.height()));
+
+        gl::Global::makeCurrent();
+        ctrl::ffd::Task task(taskResource, meshResource);
+        task.resetDst(mesh.vertexCount());
+
+        // the first stroke allocates the buffers
+        stroke(task, expans, mesh, rect, kBrushRadius, 1);
+        const StrokeResult full = stroke(task, expans, mesh, rect, coverRadius, mRepeatCount);
+        const StrokeResult region = stroke(task, expans, mesh, rect, kBrushRadius, mRepeatCount);
+
+        aReport.row(QVariantList()
+                    << spec.name << spec.cellSize << mesh.vertexCount() << kBrushRadius
+                    << full.stepMSec << region.stepMSec
+                    << full.vertexCount << region.vertexCount);
+
+        // the targets as the ffd editor makes them
+        core::TimeLine& line = *layer->timeLine();
+        const core::LayerMesh* areaMesh = line.current().ffdMesh();
+        if (!areaMesh || areaMesh->vertexCount() <= 0)
+        {
+            aReport.comment("ffd: no deformable mesh in " + spec.name);
+            continue;
+        }
+        ctrl::ffd::Targets targets;
+        targets.push_back(new ctrl::ffd::Target(layer));
+        targets.back()->task.reset(new ctrl::ffd::Task(taskResource, meshResource));
+        targets.back()->task->resetDst(areaMesh->vertexCount());
+        targets.back()->keyOwner.createKey(
+                    line, *areaMesh, line.current().ffdMeshParent(),
+                    project.animator().currentFrame().get());
+
+        // the subscriber resets the blending as the driver does
+        auto slot = project.onTimeLineModified.connect([&](core::TimeLineEvent& aEvent, bool)
+        {
+            blender.clearCaches(aEvent);
+            blender.updateCurrents(project.objectTree().topNode(), project.currentTimeInfo());
+        });
+
+        // the synchronous path, and the asynchronous one with a dispatch
+        // per two samples or per display frame
+        const int budgets[] = { 1, 2, 8 };
+        for (int budget : budgets)
+        {
+            const bool async = budget > 1;
+            const BrushResult brush = brushStroke(
+                        project, targets, rect, async, budget, mRepeatCount);
+            brushRows.push_back(QVariantList()
+                                << spec.name << mesh.vertexCount()
+                                << QString(async ? "async" : "sync") << budget
+                                << kTabletSamplesPerFrame << brush.dispatchPerFrame
+                                << brush.inFlightMean << brush.inFlightMax
+                                << brush.stallFrameMSec);
+        }
+
+        project.onTimeLineModified.disconnect(slot);
+        qDeleteAll(targets);
+    }
+
+    aReport.beginTable("ffd_brush", QStringList()
+                       << "spec" << "vertices" << "mode" << "sample_budget"
+                       << "samples_per_frame" << "dispatch_per_frame"
+                       << "inflight_mean" << "inflight_max" << "stall_frame_ms");
+    for (auto& row : brushRows)
+    {
+        aReport.row(row);
+    }
+}
+
+} // namespace bench
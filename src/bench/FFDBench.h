@@ -0,0 +1,30 @@
+#ifndef BENCH_FFDBENCH_H
+#define BENCH_FFDBENCH_H
+
+#include "gl/DeviceInfo.h"
+#include "bench/Report.h"
+
+namespace bench
+{
+
+// Measures the synchronous steps of the ffd deformer on the grid mesh of a
+// synthetic layer, for a brush which limits the evaluation to the vertices
+// around it and for a brush which covers the layer. The latter evaluates
+// all vertices by the same code path.
+// The brush table strokes by the brush mode at the tablet rate, and
+// compares the asynchronous readbacks against the synchronous path.
+// The opengl context has to be current.
+class FFDBench
+{
+public:
+    FFDBench(int aRepeatCount, const gl::DeviceInfo& aDeviceInfo);
+    void run(Report& aReport);
+
+private:
+    int mRepeatCount;
+    const gl::DeviceInfo& mDeviceInfo;
+};
+
+} // namespace bench
+
+#endif // BENCH_FFDBENCH_H
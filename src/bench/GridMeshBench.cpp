@@ -0,0 +1,199 @@
+#include <algorithm>
+#include <QVector>
+#include <QElapsedTimer>
+#include "XC.h"
+#include "thr/ParallelFor.h"
+#include "img/GridMeshCreator.h"
+#include "bench/GridMeshBench.h"
+
+namespace
+{
+
+enum Pattern
+{
+    Pattern_Opaque,
+    Pattern_Transparent,
+    Pattern_Circle,
+    Pattern_Stripes,
+    Pattern_Noise,
+    Pattern_TERM
+};
+
+const char* patternName(Pattern aPattern)
+{
+    switch (aPattern)
+    {
+    case Pattern_Opaque: return "opaque";
+    case Pattern_Transparent: return "transparent";
+    case Pattern_Circle: return "circle";
+    case Pattern_Stripes: return "stripes";
+    case Pattern_Noise: return "noise";
+    default: return "unknown";
+    }
+}
+
+QVector<uint8> createImage(Pattern aPattern, const QSize& aSize)
+{
+    const int w = aSize.width();
+    const int h = aSize.height();
+    QVector<uint8> image(w * h * 4, 0);
+    uint32 seed = 123456789;
+
+    for (int y = 0; y < h; ++y)
+    {
+        for (int x = 0; x < w; ++x)
+        {
+            bool opaque = false;
+            switch (aPattern)
+            {
+            case Pattern_Opaque:
+                opaque = true;
+                break;
+            case Pattern_Circle:
+            {
+                const int dx = x - w / 2;
+                const int dy = y - h / 2;
+                const int r = std::min(w, h) / 2;
+                opaque = (dx * dx + dy * dy) <= r * r;
+                break;
+            }
+            case Pattern_Stripes:
+                opaque = ((x / 24) % 2) == 0;
+                break;
+            case Pattern_Noise:
+                // xorshift, sparse blobs of 8x8 pixels
+                if (x % 8 == 0)
+                {
+                    seed ^= seed << 13;
+                    seed ^= seed >> 17;
+                    seed ^= seed << 5;
+                }
+                opaque = ((seed + (y / 8) * 2654435761u) >> 29) == 0;
+                break;
+            default:
+                break;
+            }
+
+            uint8* pixel = image.data() + (x + y * w) * 4;
+            pixel[0] = pixel[1] = pixel[2] = 128;
+            pixel[3] = opaque ? 255 : 0;
+        }
+    }
+    return image;
+}
+
+// returns elapsed milliseconds
+double measure(const QVector<uint8>& aImage, const QSize& aSize, int aCellPx,
+               bool aParallel, bool aAdaptive, int aRepeatCount, int& aVertexCount)
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    for (int i = 0; i < aRepeatCount; ++i)
+    {
+        img::GridMeshCreator creator(aImage.data(), aSize, aCellPx, aParallel, aAdaptive);
+        QVector<img::GridMeshCreator::HexaConnection> connections(creator.vertexCount());
+        creator.writeConnections(connections.data());
+        aVertexCount = creator.vertexCount();
+    }
+    return (double)timer.nsecsElapsed() / (1000000.0 * aRepeatCount);
+}
+
+// many layers at once, as loading a psd
+double measureLayers(const QVector<QVector<uint8>>& aImages, const QSize& aSize,
+                     int aCellPx, int aRepeatCount)
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    for (int i = 0; i < aRepeatCount; ++i)
+    {
+        thr::ParallelFor::run(aImages.size(), 1, [&](int aBegin, int aEnd)
+        {
+            for (int k = aBegin; k < aEnd; ++k)
+            {
+                img::GridMeshCreator creator(aImages[k].data(), aSize, aCellPx, true);
+                Q_UNUSED(creator);
+            }
+        });
+    }
+    return (double)timer.nsecsElapsed() / (1000000.0 * aRepeatCount);
+}
+
+} // namespace
+
+namespace bench
+{
+
+GridMeshBench::GridMeshBench(int aRepeatCount)
+    : mRepeatCount(aRepeatCount)
+{
+}
+
+void GridMeshBench::run(Report& aReport)
+{
+    static const int kCellPx = 16;
+    const QSize sizes[] = { QSize(256, 256), QSize(1024, 1024), QSize(4096, 2048) };
+
+    aReport.beginTable("gridmesh", QStringList()
+                       << "pattern" << "width" << "height" << "vertices"
+                       << "serial_ms" << "parallel_ms" << "speedup"
+                       << "adaptive_vertices" << "adaptive_ms");
+
+    for (auto size : sizes)
+    {
+        for (int p = 0; p < Pattern_TERM; ++p)
+        {
+            auto pattern = (Pattern)p;
+            auto image = createImage(pattern, size);
+
+            int vtxSerial = 0;
+            int vtxParallel = 0;
+            int vtxAdaptive = 0;
+            const double serial = measure(image, size, kCellPx, false, false, mRepeatCount, vtxSerial);
+            const double parallel = measure(image, size, kCellPx, true, false, mRepeatCount, vtxParallel);
+            const double adaptive = measure(image, size, kCellPx, true, true, mRepeatCount, vtxAdaptive);
+            XC_ASSERT(vtxSerial == vtxParallel);
+
+            aReport.row(QVariantList()
+                        << patternName(pattern) << size.width() << size.height()
+                        << vtxSerial << serial << parallel
+                        << (parallel > 0.0 ? serial / parallel : 0.0)
+                        << vtxAdaptive << adaptive);
+        }
+    }
+
+    // layers
+    {
+        static const int kLayerCount = 32;
+        const QSize size(512, 512);
+        QVector<QVector<uint8>> images;
+        for (int i = 0; i < kLayerCount; ++i)
+        {
+            images.push_back(createImage((Pattern)(i % Pattern_TERM), size));
+        }
+
+        QElapsedTimer timer;
+        timer.start();
+        for (int r = 0; r < mRepeatCount; ++r)
+        {
+            for (auto& image : images)
+            {
+                img::GridMeshCreator creator(image.data(), size, kCellPx, false);
+                Q_UNUSED(creator);
+            }
+        }
+        const double serial = (double)timer.nsecsElapsed() / (1000000.0 * mRepeatCount);
+        const double parallel = measureLayers(images, size, kCellPx, mRepeatCount);
+
+        aReport.beginTable("gridmesh_layers", QStringList()
+                           << "count" << "width" << "height"
+                           << "serial_ms" << "parallel_ms" << "speedup");
+        aReport.row(QVariantList()
+                    << kLayerCount << size.width() << size.height()
+                    << serial << parallel
+                    << (parallel > 0.0 ? serial / parallel : 0.0));
+    }
+}
+
+} // namespace bench
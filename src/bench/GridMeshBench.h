@@ -0,0 +1,23 @@
+#ifndef BENCH_GRIDMESHBENCH_H
+#define BENCH_GRIDMESHBENCH_H
+
+#include "bench/Report.h"
+
+namespace bench
+{
+
+// Measures img::GridMeshCreator in the serial, parallel and adaptive mode
+// over some synthetic alpha patterns and image sizes.
+class GridMeshBench
+{
+public:
+    GridMeshBench(int aRepeatCount);
+    void run(Report& aReport);
+
+private:
+    int mRepeatCount;
+};
+
+} // namespace bench
+
+#endif // BENCH_GRIDMESHBENCH_H
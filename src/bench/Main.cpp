@@ -0,0 +1,111 @@
+#include <algorithm>
+#include <QGuiApplication>
+#include <QStringList>
+#include <QTextStream>
+#include <QThread>
+#include "XC.h"
+#include "bench/Report.h"
+#include "bench/EasingBench.h"
+#include "bench/FFDBench.h"
+#include "bench/GridMeshBench.h"
+#include "bench/PackBitsBench.h"
+#include "bench/ProjectBench.h"
+#include "gl/OffscreenContext.h"
+
+XCAssertHandler* gXCAssertHandler = nullptr;
+
+// usage: AnimeEffectsBench [--json] [--suite gridmesh|packbits|easing|ffd|project]... [repeat count]
+// results are written to stdout as tab separated values, or as a json
+// object per line with --json. all the suites run if no suite is given.
+// the ffd and project suites need an opengl 3.3 context, "-platform offscreen"
+// can be given on a machine without a display.
+int main(int argc, char *argv[])
+{
+    QGuiApplication app(argc, argv);
+    // the settings of the application are not used
+    app.setApplicationName("AnimeEffectsBench");
+
+    int repeatCount = 3;
+    bench::Report::Format format = bench::Report::Format_TSV;
+    QStringList suites;
+
+    const QStringList arguments = app.arguments();
+    for (int i = 1; i < arguments.size(); ++i)
+    {
+        const QString& arg = arguments.at(i);
+        if (arg == "--json")
+        {
+            format = bench::Report::Format_JSON;
+        }
+        else if (arg == "--suite" && i + 1 < arguments.size())
+        {
+            suites.push_back(arguments.at(++i));
+        }
+        else
+        {
+            repeatCount = std::max(1, arg.toInt());
+        }
+    }
+    auto runs = [&](const char* aSuite)
+    {
+        return suites.isEmpty() || suites.contains(aSuite);
+    };
+
+    QTextStream out(stdout);
+    bench::Report report(out, format);
+
+    gl::OffscreenContext context;
+
+    report.beginTable("environment", QStringList()
+                      << "qt" << "threads" << "repeat" << "gl_renderer" << "gl_version");
+    report.row(QVariantList()
+               << qVersion() << QThread::idealThreadCount() << repeatCount
+               << QString::fromStdString(context.deviceInfo().renderer)
+               << QString::fromStdString(context.deviceInfo().version));
+
+    if (runs("gridmesh"))
+    {
+        bench::GridMeshBench gridMesh(repeatCount);
+        gridMesh.run(report);
+    }
+
+    if (runs("packbits"))
+    {
+        bench::PackBitsBench packBits(repeatCount);
+        packBits.run(report);
+    }
+
+    if (runs("easing"))
+    {
+        bench::EasingBench easing(repeatCount);
+        easing.run(report);
+    }
+
+    if (runs("ffd"))
+    {
+        if (context.isValid())
+        {
+            bench::FFDBench ffd(repeatCount, context.deviceInfo());
+            ffd.run(report);
+        }
+        else
+        {
+            report.comment("ffd: opengl context is not available");
+        }
+    }
+
+    if (runs("project"))
+    {
+        if (context.isValid())
+        {
+            bench::ProjectBench project(repeatCount, context.deviceInfo());
+            project.run(report);
+        }
+        else
+        {
+            report.comment("project: opengl context is not available");
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,224 @@
+#include <cstring>
+#include <QVector>
+#include <QSize>
+#include <QElapsedTimer>
+#include "XC.h"
+#include "util/PackBits.h"
+#include "img/PSDUtil.h"
+#include "bench/PackBitsBench.h"
+
+namespace
+{
+
+enum Content
+{
+    Content_Flat,
+    Content_Sprite,
+    Content_Gradient,
+    Content_Noise,
+    Content_TERM
+};
+
+const char* contentName(Content aContent)
+{
+    switch (aContent)
+    {
+    case Content_Flat: return "flat";
+    case Content_Sprite: return "sprite";
+    case Content_Gradient: return "gradient";
+    case Content_Noise: return "noise";
+    default: return "unknown";
+    }
+}
+
+QVector<uint8> createImage(Content aContent, const QSize& aSize)
+{
+    const int w = aSize.width();
+    const int h = aSize.height();
+    QVector<uint8> image(w * h * 4, 0);
+    uint32 seed = 123456789;
+
+    for (int y = 0; y < h; ++y)
+    {
+        for (int x = 0; x < w; ++x)
+        {
+            uint8* pixel = image.data() + (x + y * w) * 4;
+            switch (aContent)
+            {
+            case Content_Flat:
+                pixel[0] = 200; pixel[1] = 120; pixel[2] = 40; pixel[3] = 255;
+                break;
+            case Content_Sprite:
+            {
+                // flat filled circles, as a typical layer of an illustration
+                const int dx = (x % 256) - 128;
+                const int dy = (y % 256) - 128;
+                if (dx * dx + dy * dy <= 100 * 100)
+                {
+                    pixel[0] = (uint8)(x / 256 * 40); pixel[1] = 180; pixel[2] = 90; pixel[3] = 255;
+                }
+                break;
+            }
+            case Content_Gradient:
+                pixel[0] = (uint8)x; pixel[1] = (uint8)y; pixel[2] = (uint8)(x + y); pixel[3] = 255;
+                break;
+            case Content_Noise:
+                seed ^= seed << 13;
+                seed ^= seed >> 17;
+                seed ^= seed << 5;
+                std::memcpy(pixel, &seed, 4);
+                break;
+            default:
+                break;
+            }
+        }
+    }
+    return image;
+}
+
+// encodes each channel of each line as core::Serializer does.
+// returns the encoded bytes, aLines receives the length of each line.
+QVector<uint8> encode(const QVector<uint8>& aImage, const QSize& aSize, QVector<int>& aLines)
+{
+    const int w = aSize.width();
+    const int h = aSize.height();
+    const size_t wrkSize = (size_t)w;
+    QVector<uint8> wrk(w);
+    QVector<uint8> dst(h * 4 * (int)util::PackBits::worstEncodedSize(wrkSize));
+    const XCMemBlock wrkBlock(wrk.data(), wrkSize);
+
+    util::PackBits encoder;
+    aLines.resize(h * 4);
+    const uint8* src = aImage.constData();
+    uint8* dp = dst.data();
+
+    for (int y = 0; y < h; ++y)
+    {
+        for (int i = 0; i < 4; ++i)
+        {
+            const uint8* sp = src + i;
+            for (int x = 0; x < w; ++x, sp += 4) wrk[x] = *sp;
+
+            const size_t size = encoder.encode(wrkBlock, dp);
+            aLines[y * 4 + i] = (int)size;
+            dp += size;
+        }
+        src += w * 4;
+    }
+    dst.resize((int)(dp - dst.data()));
+    return dst;
+}
+
+bool decode(const QVector<uint8>& aEncoded, const QVector<int>& aLines,
+            const QSize& aSize, QVector<uint8>& aImage)
+{
+    const int w = aSize.width();
+    const int h = aSize.height();
+    QVector<uint8> wrk(w);
+    XCMemBlock wrkBlock(wrk.data(), (size_t)w);
+
+    util::PackBits decoder;
+    aImage.resize(w * h * 4);
+    const uint8* sp = aEncoded.constData();
+    uint8* dst = aImage.data();
+
+    for (int y = 0; y < h; ++y)
+    {
+        for (int i = 0; i < 4; ++i)
+        {
+            const size_t length = (size_t)aLines[y * 4 + i];
+            if (!decoder.decode(XCMemBlock(const_cast<uint8*>(sp), length), wrkBlock))
+            {
+                return false;
+            }
+            sp += length;
+
+            uint8* dp = dst + i;
+            for (int x = 0; x < w; ++x, dp += 4) *dp = wrk[x];
+        }
+        dst += w * 4;
+    }
+    return true;
+}
+
+double msecSince(const QElapsedTimer& aTimer, int aRepeatCount)
+{
+    return (double)aTimer.nsecsElapsed() / (1000000.0 * aRepeatCount);
+}
+
+double megaBytesPerSec(size_t aBytes, double aMSec)
+{
+    return aMSec > 0.0 ? (aBytes / (1024.0 * 1024.0)) / (aMSec * 0.001) : 0.0;
+}
+
+} // namespace
+
+namespace bench
+{
+
+PackBitsBench::PackBitsBench(int aRepeatCount)
+    : mRepeatCount(aRepeatCount)
+{
+}
+
+void PackBitsBench::run(Report& aReport)
+{
+    const QSize size(2048, 1024);
+    const size_t rawBytes = (size_t)size.width() * size.height() * 4;
+
+    aReport.beginTable("packbits", QStringList()
+                       << "content" << "width" << "height" << "ratio"
+                       << "encode_ms" << "encode_mbps" << "decode_ms" << "decode_mbps"
+                       << "psd_encode_ms");
+
+    for (int c = 0; c < Content_TERM; ++c)
+    {
+        auto content = (Content)c;
+        auto image = createImage(content, size);
+
+        QVector<int> lines;
+        QVector<uint8> encoded;
+        QElapsedTimer timer;
+
+        timer.start();
+        for (int i = 0; i < mRepeatCount; ++i)
+        {
+            encoded = encode(image, size, lines);
+        }
+        const double encodeMSec = msecSince(timer, mRepeatCount);
+
+        QVector<uint8> decoded;
+        bool success = true;
+        timer.start();
+        for (int i = 0; i < mRepeatCount; ++i)
+        {
+            success = decode(encoded, lines, size, decoded) && success;
+        }
+        const double decodeMSec = msecSince(timer, mRepeatCount);
+        XC_ASSERT(success && decoded == image);
+        (void)success;
+
+        // planes of a psd channel
+        timer.start();
+        for (int i = 0; i < mRepeatCount; ++i)
+        {
+            for (int k = 0; k < 4; ++k)
+            {
+                XCMemBlock block = img::PSDUtil::encodePlanePackBits(
+                            image.constData() + k, rawBytes - k,
+                            size.width(), size.height(), 4);
+                delete [] block.data;
+            }
+        }
+        const double psdMSec = msecSince(timer, mRepeatCount);
+
+        aReport.row(QVariantList()
+                    << contentName(content) << size.width() << size.height()
+                    << (double)encoded.size() / rawBytes
+                    << encodeMSec << megaBytesPerSec(rawBytes, encodeMSec)
+                    << decodeMSec << megaBytesPerSec(rawBytes, decodeMSec)
+                    << psdMSec);
+    }
+}
+
+} // namespace bench
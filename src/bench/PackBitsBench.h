@@ -0,0 +1,24 @@
+#ifndef BENCH_PACKBITSBENCH_H
+#define BENCH_PACKBITSBENCH_H
+
+#include "bench/Report.h"
+
+namespace bench
+{
+
+// Measures util::PackBits over the channel lines of synthetic rgba images,
+// in the same way as the image serialization of projects, and the plane
+// encoding of psd files.
+class PackBitsBench
+{
+public:
+    PackBitsBench(int aRepeatCount);
+    void run(Report& aReport);
+
+private:
+    int mRepeatCount;
+};
+
+} // namespace bench
+
+#endif // BENCH_PACKBITSBENCH_H
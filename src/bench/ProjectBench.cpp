@@ -0,0 +1,370 @@
+#include <algorithm>
+#include <QTemporaryDir>
+#include <QFileInfo>
+#include <QElapsedTimer>
+#include <QScopedPointer>
+#include "XC.h"
+#include "core/ObjectNode.h"
+#include "core/TimeKeyBlender.h"
+#include "ctrl/ProjectSaver.h"
+#include "ctrl/ProjectLoader.h"
+#include "ctrl/Exporter.h"
+#include "bench/SyntheticProject.h"
+#include "bench/ProjectBench.h"
+
+namespace
+{
+
+static const int kExportFrameCount = 16;
+static const int kDragFrameCount = 32;
+static const int kDragSamplesPerFrame = 8;
+
+typedef bench::SyntheticProject::Spec Spec;
+
+QVector<Spec> specs()
+{
+    // varies one parameter of the base spec at a time
+    return QVector<Spec>()
+            << Spec("base",   16,  8,  16, 16)
+            << Spec("layers", 64,  8,  16, 16)
+            << Spec("bones",  16, 32,  16, 16)
+            << Spec("keys",   16,  8, 128, 16)
+            << Spec("dense",  16,  8,  16,  4)
+            << Spec("coarse", 16,  8,  16, 32);
+}
+
+double msecSince(const QElapsedTimer& aTimer, int aCount)
+{
+    return (double)aTimer.nsecsElapsed() / (1000000.0 * std::max(aCount, 1));
+}
+
+// returns false if the export failed. the export size is scaled from
+// the project size, by the downscale chain or by rendering at the size.
+bool exportFrames(core::Project& aProject, const QString& aDir, int aFrameCount,
+                  double aScale = 1.0, bool aRendersAtSize = false, int aSupersampling = 1)
+{
+    ctrl::Exporter exporter(aProject);
+    exporter.setOverwriteConfirmer([](const QString&) { return true; });
+
+    ctrl::Exporter::CommonParam common;
+    common.path = aDir;
+    common.size = aProject.attribute().imageSize() * aScale;
+    common.renderAtExportSize = aRendersAtSize;
+    common.supersampling = aSupersampling;
+    common.frame = util::Range(0, aFrameCount - 1);
+    common.fps = aProject.attribute().fps();
+
+    // bmp keeps the encoding cost small beside the rendering
+    ctrl::Exporter::ImageParam image;
+    image.name = "frame";
+    image.suffix = "bmp";
+
+    return (bool)exporter.execute(common, image);
+}
+
+// the project size and the half size image sequences from one rendering
+bool exportSinks(core::Project& aProject, const QString& aDir, int aFrameCount)
+{
+    ctrl::Exporter exporter(aProject);
+    exporter.setOverwriteConfirmer([](const QString&) { return true; });
+
+    ctrl::Exporter::CommonParam common;
+    common.frame = util::Range(0, aFrameCount - 1);
+    common.fps = aProject.attribute().fps();
+
+    QVector<ctrl::Exporter::SinkParam> sinks(2);
+    for (int i = 0; i < sinks.size(); ++i)
+    {
+        sinks[i].type = ctrl::Exporter::SinkType_Image;
+        sinks[i].path = aDir;
+        sinks[i].size = aProject.attribute().imageSize() / (i + 1);
+        sinks[i].image.name = QString("sink%1_").arg(i);
+        sinks[i].image.suffix = "bmp";
+    }
+    return (bool)exporter.execute(common, sinks);
+}
+
+// drags the move key of the first layer by several samples per frame, and
+// returns the dispatch time per frame. the subscriber resets the blending
+// as the driver does.
+double dragKeys(core::Project& aProject, bool aCoalesces)
+{
+    core::ObjectNode* target = nullptr;
+    for (core::ObjectNode::Iterator itr(aProject.objectTree().topNode()); itr.hasNext();)
+    {
+        core::ObjectNode* node = itr.next();
+        if (node->type() == core::ObjectType_Layer &&
+                node->timeLine()->hasTimeKey(core::TimeKeyType_Move, 0))
+        {
+            target = node;
+            break;
+        }
+    }
+    if (!target) return 0.0;
+
+    core::TimeKeyBlender blender(aProject.objectTree());
+    auto slot = aProject.onTimeLineModified.connect([&](core::TimeLineEvent& aEvent, bool)
+    {
+        blender.clearCaches(aEvent);
+        blender.updateCurrents(aProject.objectTree().topNode(), aProject.currentTimeInfo());
+    });
+
+    aProject.setCoalescesTimeLineEvents(aCoalesces);
+    aProject.resetDispatchStats();
+    for (int frame = 0; frame < kDragFrameCount; ++frame)
+    {
+        for (int i = 0; i < kDragSamplesPerFrame; ++i)
+        {
+            core::TimeLineEvent event;
+            event.setType(core::TimeLineEvent::Type_ChangeKeyValue);
+            event.pushTarget(*target, core::TimeKeyType_Move, 0);
+            aProject.postTimeLineModified(event);
+        }
+        aProject.flushTimeLineEvents();
+    }
+    const double msec = aProject.dispatchStats().dispatchNSec / (1000000.0 * kDragFrameCount);
+
+    aProject.onTimeLineModified.disconnect(slot);
+    aProject.setCoalescesTimeLineEvents(true);
+    return msec;
+}
+
+} // namespace
+
+namespace bench
+{
+
+ProjectBench::ProjectBench(int aRepeatCount, const gl::DeviceInfo& aDeviceInfo)
+    : mRepeatCount(aRepeatCount)
+    , mDeviceInfo(aDeviceInfo)
+{
+}
+
+void ProjectBench::run(Report& aReport)
+{
+    QTemporaryDir workDir;
+    if (!workDir.isValid())
+    {
+        aReport.comment("project: failed to create a work directory");
+        return;
+    }
+
+    aReport.beginTable("project", QStringList()
+                       << "spec" << "layers" << "bones" << "keys" << "cell"
+                       << "width" << "height" << "vertices"
+                       << "import_ms" << "mesh_ms" << "blend_frame_ms"
+                       << "bake_ms" << "baked_blend_frame_ms" << "influence_ms"
+                       << "save_ms" << "load_ms" << "file_kb" << "export_frame_ms"
+                       << "half_chain_ms" << "half_native_ms" << "half_ss2_ms"
+                       << "two_exports_ms" << "two_sinks_ms"
+                       << "drag_dispatch_ms" << "drag_coalesced_ms");
+
+    for (auto& spec : specs())
+    {
+        const QString psdPath = workDir.path() + "/" + spec.name + ".psd";
+        const QString projectPath = workDir.path() + "/" + spec.name + ".anie";
+        const QString exportDir = workDir.path();
+
+        if (!SyntheticProject::writePSD(spec, psdPath))
+        {
+            aReport.comment("project: failed to write " + psdPath);
+            continue;
+        }
+
+        SyntheticProject synthetic(spec);
+        QElapsedTimer timer;
+
+        // psd import, the first one compiles the shaders and the last one
+        // is used by the following measurements
+        bool loaded = synthetic.load(psdPath, mDeviceInfo);
+        timer.start();
+        for (int i = 0; i < mRepeatCount && loaded; ++i)
+        {
+            loaded = synthetic.load(psdPath, mDeviceInfo);
+        }
+        const double importMSec = msecSince(timer, mRepeatCount);
+        if (!loaded)
+        {
+            aReport.comment("project: failed to import " + psdPath);
+            continue;
+        }
+
+        // grid meshes in the density of the spec
+        int vertexCount = 0;
+        timer.start();
+        for (int i = 0; i < mRepeatCount; ++i)
+        {
+            vertexCount = synthetic.resetGridMeshes();
+        }
+        const double meshMSec = msecSince(timer, mRepeatCount);
+
+        synthetic.pushLayerKeys();
+        synthetic.pushBones();
+        core::Project& project = synthetic.project();
+
+        // key blending of all frames
+        const int frameCount = project.attribute().maxFrame() + 1;
+        double blendMSec = 0.0;
+        {
+            core::TimeKeyBlender blender(project.objectTree());
+            core::TimeInfo time = project.currentTimeInfo();
+
+            timer.start();
+            for (int i = 0; i < mRepeatCount; ++i)
+            {
+                for (int frame = 0; frame < frameCount; ++frame)
+                {
+                    time.frame = core::Frame(frame);
+                    blender.updateCurrents(project.objectTree().topNode(), time);
+                }
+            }
+            blendMSec = msecSince(timer, mRepeatCount * frameCount);
+        }
+
+        // the same blending from the baked tracks
+        double bakeMSec = 0.0;
+        double bakedBlendMSec = 0.0;
+        {
+            core::TimeKeyBlender blender(project.objectTree());
+            core::TimeInfo time = project.currentTimeInfo();
+
+            timer.start();
+            project.objectTree().updateBake(time);
+            bakeMSec = msecSince(timer, 1);
+
+            blender.setBake(&project.objectTree().bake());
+            timer.start();
+            for (int i = 0; i < mRepeatCount; ++i)
+            {
+                for (int frame = 0; frame < frameCount; ++frame)
+                {
+                    time.frame = core::Frame(frame);
+                    blender.updateCurrents(project.objectTree().topNode(), time);
+                }
+            }
+            bakedBlendMSec = msecSince(timer, mRepeatCount * frameCount);
+        }
+
+        // bone influence maps
+        double influenceMSec = 0.0;
+        if (synthetic.boneKey())
+        {
+            timer.start();
+            for (int i = 0; i < mRepeatCount; ++i)
+            {
+                synthetic.updateInfluenceMaps();
+            }
+            influenceMSec = msecSince(timer, mRepeatCount);
+        }
+
+        // save and load
+        bool saved = true;
+        timer.start();
+        for (int i = 0; i < mRepeatCount && saved; ++i)
+        {
+            ctrl::ProjectSaver saver;
+            saved = saver.save(projectPath, project);
+        }
+        const double saveMSec = msecSince(timer, mRepeatCount);
+
+        double loadMSec = 0.0;
+        if (saved)
+        {
+            NullReporter reporter;
+            timer.start();
+            for (int i = 0; i < mRepeatCount; ++i)
+            {
+                QScopedPointer<core::Project> loading(
+                            new core::Project(projectPath, synthetic.animator(), nullptr));
+                ctrl::ProjectLoader loader;
+                if (!loader.load(projectPath, *loading, mDeviceInfo, reporter))
+                {
+                    aReport.comment("project: failed to load " + projectPath);
+                    break;
+                }
+            }
+            loadMSec = msecSince(timer, mRepeatCount);
+        }
+        else
+        {
+            aReport.comment("project: failed to save " + projectPath);
+        }
+
+        // image sequence export, the first one compiles the shaders
+        const int exportCount = std::min(frameCount, kExportFrameCount);
+        double exportMSec = 0.0;
+        if (exportFrames(project, exportDir, 1))
+        {
+            timer.start();
+            for (int i = 0; i < mRepeatCount; ++i)
+            {
+                exportFrames(project, exportDir, exportCount);
+            }
+            exportMSec = msecSince(timer, mRepeatCount * exportCount);
+        }
+        else
+        {
+            aReport.comment("project: failed to export " + spec.name);
+        }
+
+        // half size export, the downscale chain against the rendering at
+        // the export size with and without supersampling
+        auto measureHalf = [&](bool aRendersAtSize, int aSupersampling)
+        {
+            if (!exportFrames(project, exportDir, 1, 0.5, aRendersAtSize, aSupersampling))
+            {
+                return 0.0;
+            }
+            timer.start();
+            for (int i = 0; i < mRepeatCount; ++i)
+            {
+                exportFrames(project, exportDir, exportCount, 0.5, aRendersAtSize, aSupersampling);
+            }
+            return msecSince(timer, mRepeatCount * exportCount);
+        };
+        const double halfChainMSec = measureHalf(false, 1);
+        const double halfNativeMSec = measureHalf(true, 1);
+        const double halfSS2MSec = measureHalf(true, 2);
+
+        // the project size and the half size outputs, by two exports
+        // against two sinks of one export
+        double twoExportsMSec = 0.0;
+        double twoSinksMSec = 0.0;
+        if (exportSinks(project, exportDir, 1))
+        {
+            timer.start();
+            for (int i = 0; i < mRepeatCount; ++i)
+            {
+                exportFrames(project, exportDir, exportCount);
+                exportFrames(project, exportDir, exportCount, 0.5);
+            }
+            twoExportsMSec = msecSince(timer, mRepeatCount * exportCount);
+
+            timer.start();
+            for (int i = 0; i < mRepeatCount; ++i)
+            {
+                exportSinks(project, exportDir, exportCount);
+            }
+            twoSinksMSec = msecSince(timer, mRepeatCount * exportCount);
+        }
+
+        // the dispatches of the key dragging per display refresh, for each
+        // sample against the coalesced ones
+        const double dragDispatchMSec = dragKeys(project, false);
+        const double dragCoalescedMSec = dragKeys(project, true);
+
+        aReport.row(QVariantList()
+                    << spec.name << spec.layerCount << spec.boneCount
+                    << spec.keyCount << spec.cellSize
+                    << spec.canvasSize().width() << spec.canvasSize().height()
+                    << vertexCount << importMSec << meshMSec << blendMSec
+                    << bakeMSec << bakedBlendMSec << influenceMSec
+                    << saveMSec << loadMSec
+                    << (int)(QFileInfo(projectPath).size() / 1024)
+                    << exportMSec << halfChainMSec << halfNativeMSec << halfSS2MSec
+                    << twoExportsMSec << twoSinksMSec
+                    << dragDispatchMSec << dragCoalescedMSec);
+    }
+}
+
+} // namespace bench
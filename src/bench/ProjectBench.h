@@ -0,0 +1,31 @@
+#ifndef BENCH_PROJECTBENCH_H
+#define BENCH_PROJECTBENCH_H
+
+#include "gl/DeviceInfo.h"
+#include "bench/Report.h"
+
+namespace bench
+{
+
+// Measures the operations on whole projects which are generated by
+// SyntheticProject: psd import, grid mesh generation, key blending with
+// and without the baked tracks, bone influence maps, saving, loading,
+// image sequence export at the project size and at the half size by
+// separate exports and by the sinks of one export, and the dispatch of
+// the timeline events while dragging a key, for each sample and coalesced
+// per refresh.
+// The opengl context has to be current.
+class ProjectBench
+{
+public:
+    ProjectBench(int aRepeatCount, const gl::DeviceInfo& aDeviceInfo);
+    void run(Report& aReport);
+
+private:
+    int mRepeatCount;
+    const gl::DeviceInfo& mDeviceInfo;
+};
+
+} // namespace bench
+
+#endif // BENCH_PROJECTBENCH_H
@@ -0,0 +1,88 @@
+#include "XC.h"
+#include "bench/Report.h"
+
+namespace bench
+{
+
+Report::Report(QTextStream& aOut, Format aFormat)
+    : mOut(aOut)
+    , mFormat(aFormat)
+    , mName()
+    , mColumns()
+{
+}
+
+void Report::beginTable(const QString& aName, const QStringList& aColumns)
+{
+    mName = aName;
+    mColumns = aColumns;
+
+    if (mFormat == Format_TSV)
+    {
+        mOut << "# " << mName << "\t" << mColumns.join("\t") << "\n";
+    }
+}
+
+void Report::row(const QVariantList& aValues)
+{
+    XC_ASSERT(aValues.size() == mColumns.size());
+
+    if (mFormat == Format_TSV)
+    {
+        mOut << mName;
+        for (auto& value : aValues)
+        {
+            mOut << "\t" << value.toString();
+        }
+        mOut << "\n";
+    }
+    else
+    {
+        mOut << "{\"bench\":\"" << mName << "\"";
+        for (int i = 0; i < aValues.size() && i < mColumns.size(); ++i)
+        {
+            mOut << ",\"" << mColumns[i] << "\":" << toJson(aValues[i]);
+        }
+        mOut << "}\n";
+    }
+    mOut.flush();
+}
+
+void Report::comment(const QString& aText)
+{
+    if (mFormat == Format_TSV)
+    {
+        mOut << "# " << aText << "\n";
+        mOut.flush();
+    }
+}
+
+QString Report::toJson(const QVariant& aValue) const
+{
+    switch ((QMetaType::Type)aValue.type())
+    {
+    case QMetaType::Int:
+    case QMetaType::UInt:
+    case QMetaType::LongLong:
+    case QMetaType::ULongLong:
+        return aValue.toString();
+    case QMetaType::Double:
+    case QMetaType::Float:
+        return QString::number(aValue.toDouble(), 'g', 8);
+    case QMetaType::Bool:
+        return aValue.toBool() ? "true" : "false";
+    default:
+        break;
+    }
+
+    QString text;
+    for (auto c : aValue.toString())
+    {
+        if (c == '"' || c == '\\') { text += '\\'; text += c; }
+        else if (c.unicode() < 0x20) { text += QString("\\u%1").arg(c.unicode(), 4, 16, QChar('0')); }
+        else { text += c; }
+    }
+    return "\"" + text + "\"";
+}
+
+} // namespace bench
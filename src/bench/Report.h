@@ -0,0 +1,43 @@
+#ifndef BENCH_REPORT_H
+#define BENCH_REPORT_H
+
+#include <QTextStream>
+#include <QStringList>
+#include <QVariantList>
+
+namespace bench
+{
+
+// Writes the results as tables of named columns.
+// The tab separated format has a "# name\tcolumn..." line before the rows
+// of each table. The json format writes a json object per row, which has
+// the table name as "bench" and the values keyed by the column names.
+class Report
+{
+public:
+    enum Format
+    {
+        Format_TSV,
+        Format_JSON
+    };
+
+    Report(QTextStream& aOut, Format aFormat);
+
+    void beginTable(const QString& aName, const QStringList& aColumns);
+    // the values have to be in the order of the columns
+    void row(const QVariantList& aValues);
+    // a line which is not a result, ignored by the json format
+    void comment(const QString& aText);
+
+private:
+    QString toJson(const QVariant& aValue) const;
+
+    QTextStream& mOut;
+    Format mFormat;
+    QString mName;
+    QStringList mColumns;
+};
+
+} // namespace bench
+
+#endif // BENCH_REPORT_H
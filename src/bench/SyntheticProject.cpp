@@ -0,0 +1,353 @@
+#include <cmath>
+#include <algorithm>
+#include <fstream>
+#include <QFileInfo>
+#include <QVector>
+#include "XC.h"
+#include "img/PSDFormat.h"
+#include "img/PSDWriter.h"
+#include "img/PSDUtil.h"
+#include "cmnd/ScopedMacro.h"
+#include "cmnd/BasicCommands.h"
+#include "core/ObjectNode.h"
+#include "core/ImageKey.h"
+#include "core/PoseKey.h"
+#include "ctrl/ImageFileLoader.h"
+#include "ctrl/TimeLineUtil.h"
+#include "ctrl/bone/bone_GeoBuilder.h"
+#include "bench/SyntheticProject.h"
+
+namespace
+{
+
+static const int kBoneChainLength = 4;
+
+img::PSDFormat::ChannelPtr createChannel(sint16 aId)
+{
+    img::PSDFormat::ChannelPtr channel(new img::PSDFormat::Channel());
+    channel->id = aId;
+    channel->compressionId = 1; // packbits
+    channel->dataLength = 0;
+    return channel;
+}
+
+void pushChannels(img::PSDFormat::ChannelList& aChannels)
+{
+    aChannels.push_back(createChannel(0));
+    aChannels.push_back(createChannel(1));
+    aChannels.push_back(createChannel(2));
+    aChannels.push_back(createChannel(-1));
+}
+
+// a blob with a notch, which makes a grid mesh of an irregular outline
+QVector<uint8> createLayerImage(int aIndex, const QSize& aSize)
+{
+    const int w = aSize.width();
+    const int h = aSize.height();
+    const float rx = w * 0.45f;
+    const float ry = h * 0.45f;
+    QVector<uint8> image(w * h * 4, 0);
+
+    for (int y = 0; y < h; ++y)
+    {
+        for (int x = 0; x < w; ++x)
+        {
+            const float dx = (x - w * 0.5f) / rx;
+            const float dy = (y - h * 0.5f) / ry;
+            const bool inside = dx * dx + dy * dy <= 1.0f;
+            const bool notch = dx > 0.3f && std::fabs(dy) < 0.2f;
+            if (!inside || notch) continue;
+
+            uint8* pixel = image.data() + (x + y * w) * 4;
+            pixel[0] = (uint8)(aIndex * 37);
+            pixel[1] = (uint8)(aIndex * 91 + y);
+            pixel[2] = (uint8)(160 + aIndex * 13);
+            pixel[3] = 255;
+        }
+    }
+    return image;
+}
+
+} // namespace
+
+namespace bench
+{
+
+//-------------------------------------------------------------------------------------------------
+SyntheticProject::Spec::Spec(const QString& aName, int aLayerCount, int aBoneCount,
+                             int aKeyCount, int aCellSize)
+    : name(aName)
+    , layerCount(aLayerCount)
+    , boneCount(aBoneCount)
+    , keyCount(aKeyCount)
+    , cellSize(aCellSize)
+    , layerSize(256, 256)
+{
+}
+
+QSize SyntheticProject::Spec::canvasSize() const
+{
+    // the layers are in a grid, and overlap each other by a quarter
+    const int columns = (int)std::ceil(std::sqrt((double)std::max(layerCount, 1)));
+    const int rows = (std::max(layerCount, 1) + columns - 1) / columns;
+    const int stepX = layerSize.width() * 3 / 4;
+    const int stepY = layerSize.height() * 3 / 4;
+    return QSize((columns - 1) * stepX + layerSize.width(),
+                 (rows - 1) * stepY + layerSize.height());
+}
+
+QRect SyntheticProject::Spec::layerRect(int aIndex) const
+{
+    const int columns = (int)std::ceil(std::sqrt((double)std::max(layerCount, 1)));
+    const QPoint pos((aIndex % columns) * layerSize.width() * 3 / 4,
+                     (aIndex / columns) * layerSize.height() * 3 / 4);
+    return QRect(pos, layerSize);
+}
+
+int SyntheticProject::Spec::maxFrame() const
+{
+    return std::max(keyCount - 1, 1) * kKeyInterval;
+}
+
+//-------------------------------------------------------------------------------------------------
+bool SyntheticProject::writePSD(const Spec& aSpec, const QString& aPath)
+{
+    using img::PSDFormat;
+    using img::PSDUtil;
+
+    const QSize canvasSize = aSpec.canvasSize();
+
+    PSDFormat format;
+    PSDFormat::Header& header = format.header();
+    header.version = 1;
+    header.channels = 4;
+    header.width = (uint32)canvasSize.width();
+    header.height = (uint32)canvasSize.height();
+    header.depth = 8;
+    header.mode = PSDFormat::ColorMode_RGB;
+
+    for (int i = 0; i < aSpec.layerCount; ++i)
+    {
+        const QRect rect = aSpec.layerRect(i);
+
+        PSDFormat::LayerPtr layer(new PSDFormat::Layer());
+        layer->rect.edge[0] = rect.top();
+        layer->rect.edge[1] = rect.left();
+        layer->rect.edge[2] = rect.top() + rect.height();
+        layer->rect.edge[3] = rect.left() + rect.width();
+        layer->blendMode = "norm";
+        layer->opacity = 255;
+        layer->clipping = 0;
+        layer->flags = 0;
+        layer->name = QString("layer%1").arg(i).toStdString();
+        pushChannels(layer->channels);
+
+        auto image = createLayerImage(i, rect.size());
+        const XCMemBlock block(image.data(), (size_t)image.size());
+        if (!PSDUtil::makeChanneledImage(*layer, header, block, PSDUtil::ColorFormat_RGBA8))
+        {
+            return false;
+        }
+        format.layerAndMaskInfo().layers.push_back(std::move(layer));
+    }
+
+    // the merged image is not read by the loader
+    {
+        PSDFormat::ImageData& imageData = format.imageData();
+        imageData.compressionId = 1;
+        imageData.hasTransparency = 1;
+        pushChannels(imageData.channels);
+
+        QVector<uint8> image(canvasSize.width() * canvasSize.height() * 4, 0);
+        const XCMemBlock block(image.data(), (size_t)image.size());
+        if (!PSDUtil::makeChanneledImage(imageData, header, block, PSDUtil::ColorFormat_RGBA8))
+        {
+            return false;
+        }
+    }
+
+    std::ofstream file(aPath.toLocal8Bit().constData(), std::ios::binary);
+    img::PSDWriter writer(file, format);
+    return writer.resultCode() == img::PSDWriter::ResultCode_Success;
+}
+
+//-------------------------------------------------------------------------------------------------
+SyntheticProject::SyntheticProject(const Spec& aSpec)
+    : mSpec(aSpec)
+    , mAnimator()
+    , mProject()
+    , mBoneKey()
+{
+}
+
+SyntheticProject::~SyntheticProject()
+{
+    mProject.reset();
+}
+
+bool SyntheticProject::load(const QString& aPsdPath, const gl::DeviceInfo& aDeviceInfo)
+{
+    mBoneKey = nullptr;
+    mProject.reset(new core::Project(QString(), mAnimator, nullptr));
+    mProject->resourceHolder().setRootPath(QFileInfo(aPsdPath).path());
+
+    NullReporter reporter;
+    ctrl::ImageFileLoader loader(aDeviceInfo);
+    if (!loader.load(aPsdPath, *mProject, reporter))
+    {
+        mProject.reset();
+        return false;
+    }
+    mProject->attribute().setMaxFrame(mSpec.maxFrame());
+    return true;
+}
+
+int SyntheticProject::resetGridMeshes()
+{
+    XC_ASSERT(mProject);
+
+    QVector<core::ImageKey*> keys;
+    for (core::ObjectNode::Iterator itr(mProject->objectTree().topNode()); itr.hasNext();)
+    {
+        core::ObjectNode* node = itr.next();
+        if (node->type() != core::ObjectType_Layer) continue;
+
+        auto key = (core::ImageKey*)node->timeLine()->defaultKey(core::TimeKeyType_Image);
+        if (key) keys.push_back(key);
+    }
+    core::ImageKey::resetGridMeshes(keys, QVector<int>(keys.size(), mSpec.cellSize));
+
+    int vertexCount = 0;
+    for (auto key : keys)
+    {
+        vertexCount += key->data().gridMesh().vertexCount();
+    }
+    return vertexCount;
+}
+
+void SyntheticProject::pushLayerKeys()
+{
+    XC_ASSERT(mProject);
+    core::Project& project = *mProject;
+
+    int index = 0;
+    for (core::ObjectNode::Iterator itr(project.objectTree().topNode()); itr.hasNext();)
+    {
+        core::ObjectNode* node = itr.next();
+        if (node->type() != core::ObjectType_Layer) continue;
+
+        auto defaultMove = (core::MoveKey*)node->timeLine()->defaultKey(core::TimeKeyType_Move);
+        XC_PTR_ASSERT(defaultMove);
+
+        for (int k = 0; k < mSpec.keyCount; ++k)
+        {
+            const int frame = k * kKeyInterval;
+            const float phase = 0.7f * k + 0.3f * index;
+
+            auto moveKey = new core::MoveKey();
+            moveKey->data() = defaultMove->data();
+            moveKey->data().addPos(QVector2D(16.0f * std::sin(phase), 16.0f * std::cos(phase)));
+            ctrl::TimeLineUtil::pushNewMoveKey(project, *node, frame, moveKey);
+
+            auto rotateKey = new core::RotateKey();
+            rotateKey->setRotate(0.2f * std::sin(phase));
+            ctrl::TimeLineUtil::pushNewRotateKey(project, *node, frame, rotateKey);
+
+            auto scaleKey = new core::ScaleKey();
+            scaleKey->setScale(QVector2D(1.0f + 0.1f * std::sin(phase), 1.0f + 0.1f * std::cos(phase)));
+            ctrl::TimeLineUtil::pushNewScaleKey(project, *node, frame, scaleKey);
+
+            auto opaKey = new core::OpaKey();
+            opaKey->setOpacity(0.75f + 0.25f * std::sin(phase));
+            ctrl::TimeLineUtil::pushNewOpaKey(project, *node, frame, opaKey);
+        }
+        ++index;
+    }
+}
+
+void SyntheticProject::pushBones()
+{
+    XC_ASSERT(mProject);
+    if (mSpec.boneCount <= 0) return;
+
+    core::Project& project = *mProject;
+    core::ObjectNode& topNode = *project.objectTree().topNode();
+    const QSize canvasSize = mSpec.canvasSize();
+    const float radius = mSpec.layerSize.width() * 0.5f;
+    const int chainCount = (mSpec.boneCount + kBoneChainLength - 1) / kBoneChainLength;
+
+    // vertical chains of bones over the canvas
+    auto boneKey = new core::BoneKey();
+    for (int c = 0, b = 0; c < chainCount; ++c)
+    {
+        const float x = canvasSize.width() * (c + 0.5f) / chainCount;
+        core::Bone2* parent = nullptr;
+
+        for (int i = 0; i < kBoneChainLength && b < mSpec.boneCount; ++i, ++b)
+        {
+            const float y = canvasSize.height() * (i + 0.5f) / kBoneChainLength;
+            auto bone = new core::Bone2();
+            bone->setWorldPos(QVector2D(x, y), parent);
+            bone->setRange(0, QVector2D(radius, radius));
+            bone->setRange(1, QVector2D(radius, radius));
+
+            if (parent) parent->children().pushBack(bone);
+            else boneKey->data().topBones().push_back(bone);
+            bone->updateWorldTransform();
+            parent = bone;
+        }
+    }
+    ctrl::bone::GeoBuilder::build(boneKey->data().topBones());
+
+    // push the bone key
+    {
+        cmnd::ScopedMacro macro(project.commandStack(), "Add new bone key");
+
+        auto notifier = new ctrl::TimeLineUtil::Notifier(project);
+        notifier->event().setType(core::TimeLineEvent::Type_PushKey);
+        notifier->event().pushTarget(topNode, core::TimeKeyType_Bone, 0);
+        macro.grabListener(notifier);
+
+        project.commandStack().push(new cmnd::GrabNewObject<core::BoneKey>(boneKey));
+        project.commandStack().push(
+                    topNode.timeLine()->createPusher(core::TimeKeyType_Bone, 0, boneKey));
+    }
+    mBoneKey = boneKey;
+    updateInfluenceMaps();
+
+    // pose keys bend the chains
+    for (int k = 0; k < mSpec.keyCount; ++k)
+    {
+        const int frame = k * kKeyInterval;
+
+        auto poseKey = new core::PoseKey();
+        poseKey->data().createBonesBy(*boneKey);
+
+        int index = 0;
+        for (auto topBone : poseKey->data().topBones())
+        {
+            for (core::Bone2::Iterator itr(topBone); itr.hasNext(); ++index)
+            {
+                itr.next()->setRotate(0.3f * std::sin(0.7f * k + 0.5f * index));
+            }
+            topBone->updateWorldTransform();
+        }
+        ctrl::TimeLineUtil::pushNewPoseKey(project, topNode, frame, poseKey, boneKey);
+    }
+}
+
+void SyntheticProject::updateInfluenceMaps()
+{
+    XC_ASSERT(mProject);
+    if (!mBoneKey) return;
+
+    mBoneKey->resetCaches(*mProject, *mProject->objectTree().topNode());
+
+    // wait for the tasks of the scheduler
+    for (auto cache : mBoneKey->caches())
+    {
+        cache->influence().accessor();
+    }
+}
+
+} // namespace bench
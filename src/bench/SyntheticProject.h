@@ -0,0 +1,92 @@
+#ifndef BENCH_SYNTHETICPROJECT_H
+#define BENCH_SYNTHETICPROJECT_H
+
+#include <QString>
+#include <QSize>
+#include <QRect>
+#include <QScopedPointer>
+#include "util/IProgressReporter.h"
+#include "gl/DeviceInfo.h"
+#include "core/Project.h"
+#include "core/Animator.h"
+#include "core/BoneKey.h"
+
+namespace bench
+{
+
+//-------------------------------------------------------------------------------------------------
+class NullReporter : public util::IProgressReporter
+{
+public:
+    virtual void setSection(const QString&) {}
+    virtual void setMaximum(int) {}
+    virtual void setProgress(int) {}
+    virtual bool wasCanceled() const { return false; }
+};
+
+//-------------------------------------------------------------------------------------------------
+// A project which is generated from a spec. The layers are imported from a
+// generated psd file, so the same spec always makes the same project.
+// The keys and bones are pushed through the command stack as the editors do.
+class SyntheticProject
+{
+public:
+    struct Spec
+    {
+        Spec(const QString& aName, int aLayerCount, int aBoneCount,
+             int aKeyCount, int aCellSize);
+        QSize canvasSize() const;
+        QRect layerRect(int aIndex) const;
+        int maxFrame() const;
+
+        QString name;
+        int layerCount;
+        int boneCount;
+        int keyCount; // of each key type on each layer
+        int cellSize; // of the grid meshes
+        QSize layerSize;
+    };
+
+    enum { kKeyInterval = 4 };
+
+    static bool writePSD(const Spec& aSpec, const QString& aPath);
+
+    SyntheticProject(const Spec& aSpec);
+    ~SyntheticProject();
+
+    const Spec& spec() const { return mSpec; }
+    core::Animator& animator() { return mAnimator; }
+    core::Project& project() { return *mProject; }
+    core::BoneKey* boneKey() const { return mBoneKey; }
+
+    // imports the psd file as a new project
+    bool load(const QString& aPsdPath, const gl::DeviceInfo& aDeviceInfo);
+    // returns the vertex count of all layers
+    int resetGridMeshes();
+    // srt and opacity keys on each layer
+    void pushLayerKeys();
+    // a bone key and pose keys on the top node
+    void pushBones();
+    // rewrites the influence maps of the bone key and waits for them
+    void updateInfluenceMaps();
+
+private:
+    class Animator : public core::Animator
+    {
+    public:
+        virtual core::Frame currentFrame() const { return core::Frame(0); }
+        virtual void stop() {}
+        virtual void suspend() {}
+        virtual void resume() {}
+        virtual bool isSuspended() const { return false; }
+    };
+
+    Spec mSpec;
+    Animator mAnimator;
+    QScopedPointer<core::Project> mProject;
+    core::BoneKey* mBoneKey;
+};
+
+} // namespace bench
+
+#endif // BENCH_SYNTHETICPROJECT_H
@@ -0,0 +1,74 @@
+include(../common.pri)
+
+TARGET      = AnimeEffectsBench
+TEMPLATE    = app
+DESTDIR     = ..
+
+CONFIG      += console
+CONFIG      -= app_bundle
+INCLUDES    += $$PWD
+
+OBJECTS_DIR = .obj
+MOC_DIR     = .moc
+RCC_DIR     = .rcc
+
+msvc:LIBS            += ../util/util.lib ../thr/thr.lib ../cmnd/cmnd.lib ../gl/gl.lib ../img/img.lib ../core/core.lib ../ctrl/ctrl.lib
+msvc:PRE_TARGETDEPS  += ../util/util.lib ../thr/thr.lib ../cmnd/cmnd.lib ../gl/gl.lib ../img/img.lib ../core/core.lib ../ctrl/ctrl.lib
+
+mingw:LIBS            += \
+    -L"$$OUT_PWD/../ctrl/" -lctrl \
+    -L"$$OUT_PWD/../core/" -lcore \
+    -L"$$OUT_PWD/../img/"  -limg \
+    -L"$$OUT_PWD/../gl/"   -lgl \
+    -L"$$OUT_PWD/../cmnd/" -lcmnd \
+    -L"$$OUT_PWD/../thr/"  -lthr \
+    -L"$$OUT_PWD/../util/" -lutil
+
+mingw:PRE_TARGETDEPS  += \
+    ../ctrl/libctrl.a \
+    ../core/libcore.a \
+    ../img/libimg.a \
+    ../gl/libgl.a \
+    ../cmnd/libcmnd.a \
+    ../thr/libthr.a \
+    ../util/libutil.a
+
+gcc:LIBS            += \
+    -L"$$OUT_PWD/../ctrl/" -lctrl \
+    -L"$$OUT_PWD/../core/" -lcore \
+    -L"$$OUT_PWD/../img/"  -limg \
+    -L"$$OUT_PWD/../gl/"   -lgl \
+    -L"$$OUT_PWD/../cmnd/" -lcmnd \
+    -L"$$OUT_PWD/../thr/"  -lthr \
+    -L"$$OUT_PWD/../util/" -lutil
+
+gcc:PRE_TARGETDEPS  += \
+    ../ctrl/libctrl.a \
+    ../core/libcore.a \
+    ../img/libimg.a \
+    ../gl/libgl.a \
+    ../cmnd/libcmnd.a \
+    ../thr/libthr.a \
+    ../util/libutil.a
+
+INCLUDEPATH += ..
+DEPENDPATH  += ..
+
+SOURCES += \
+    Main.cpp \
+    EasingBench.cpp \
+    FFDBench.cpp \
+    GridMeshBench.cpp \
+    PackBitsBench.cpp \
+    ProjectBench.cpp \
+    Report.cpp \
+    SyntheticProject.cpp
+
+HEADERS += \
+    EasingBench.h \
+    FFDBench.h \
+    GridMeshBench.h \
+    PackBitsBench.h \
+    ProjectBench.h \
+    Report.h \
+    SyntheticProject.h
@@ -0,0 +1,121 @@
+#include <cmath>
+#include <algorithm>
+#include <QVector>
+#include <QTextStream>
+#include "XC.h"
+#include "util/Easing.h"
+#include "util/EasingTable.h"
+
+XCAssertHandler* gXCAssertHandler = nullptr;
+
+namespace
+{
+
+static const int kRateCount = 1 << 16;
+
+// the ends, the sample points of the tables and the points between them
+QVector<float> createRates()
+{
+    QVector<float> rates;
+    rates.reserve(kRateCount);
+    for (int i = 0; i <= util::EasingTable::kSampleCount; ++i)
+    {
+        rates.push_back((float)i / util::EasingTable::kSampleCount);
+        rates.push_back((i + 0.5f) / util::EasingTable::kSampleCount);
+    }
+    uint32 seed = 123456789;
+    while (rates.size() < kRateCount)
+    {
+        seed ^= seed << 13;
+        seed ^= seed >> 17;
+        seed ^= seed << 5;
+        rates.push_back((float)(seed >> 8) / (float)(1 << 24));
+    }
+    return rates;
+}
+
+float maxError(const QVector<float>& aValues, const QVector<float>& aExpected)
+{
+    float error = 0.0f;
+    for (int i = 0; i < aValues.size(); ++i)
+    {
+        error = std::max(error, std::fabs(aValues[i] - aExpected[i]));
+    }
+    return error;
+}
+
+} // namespace
+
+// checks util::EasingTable against util::Easing::calculate. the scalar and
+// the batch evaluation have to be within EasingTable::kMaxError, and the
+// batch has to return the same rates as the scalar one.
+// returns non-zero if any of them fails, "make check" runs this.
+int main()
+{
+    QTextStream out(stdout);
+    const util::EasingTable& table = util::EasingTable::instance();
+    const QVector<float> rates = createRates();
+    QVector<float> expected(rates.size());
+    QVector<float> scalar(rates.size());
+    QVector<float> batch(rates.size());
+    int failureCount = 0;
+
+    static const float kWeights[] = { 0.0f, 0.5f, 1.0f };
+
+    for (int t = util::Easing::Type_Linear; t < util::Easing::Type_TERM; ++t)
+    {
+        for (int r = 0; r < util::Easing::Range_TERM; ++r)
+        {
+            for (float weight : kWeights)
+            {
+                util::Easing::Param param;
+                param.type = (util::Easing::Type)t;
+                param.range = (util::Easing::Range)r;
+                param.weight = weight;
+
+                for (int i = 0; i < rates.size(); ++i)
+                {
+                    expected[i] = util::Easing::calculate(param, rates[i], 0.0f, 1.0f, 1.0f);
+                    scalar[i] = table.rate(param, rates[i]);
+                }
+                table.rates(param, rates.constData(), batch.data(), rates.size());
+
+                const float error = maxError(scalar, expected);
+                const bool sameRates = (scalar == batch);
+                if (error >= util::EasingTable::kMaxError || !sameRates)
+                {
+                    out << "FAIL easing " << util::Easing::getTypeName(param.type)
+                        << " range " << r << " weight " << weight
+                        << ": max error " << error
+                        << (sameRates ? "" : ", the batch differs from the scalar") << "\n";
+                    ++failureCount;
+                }
+            }
+        }
+    }
+
+    // channels of mixed easings
+    {
+        QVector<util::Easing::Param> params(rates.size());
+        for (int i = 0; i < rates.size(); ++i)
+        {
+            params[i].type = (util::Easing::Type)(1 + (i / 64) % (util::Easing::Type_TERM - 1));
+            params[i].range = (util::Easing::Range)((i / 256) % util::Easing::Range_TERM);
+            params[i].weight = 1.0f;
+            expected[i] = util::Easing::calculate(params[i], rates[i], 0.0f, 1.0f, 1.0f);
+        }
+        table.rates(params.constData(), rates.constData(), batch.data(), rates.size());
+
+        const float error = maxError(batch, expected);
+        if (error >= util::EasingTable::kMaxError)
+        {
+            out << "FAIL easing channels: max error " << error << "\n";
+            ++failureCount;
+        }
+    }
+
+    out << (failureCount ? "FAILED" : "PASSED") << " easing table, simd "
+        << (util::EasingTable::usesSimd() ? "on" : "off") << "\n";
+    out.flush();
+    return failureCount ? 1 : 0;
+}
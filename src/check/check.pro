@@ -0,0 +1,29 @@
+include(../common.pri)
+
+TARGET      = AnimeEffectsCheck
+TEMPLATE    = app
+DESTDIR     = .
+
+# "make check" runs the executable, and fails if it returns non-zero
+CONFIG      += console testcase no_testcase_installs
+CONFIG      -= app_bundle
+INCLUDES    += $$PWD
+
+OBJECTS_DIR = .obj
+MOC_DIR     = .moc
+RCC_DIR     = .rcc
+
+msvc:LIBS            += ../util/util.lib
+msvc:PRE_TARGETDEPS  += ../util/util.lib
+
+mingw:LIBS            += -L"$$OUT_PWD/../util/" -lutil
+mingw:PRE_TARGETDEPS  += ../util/libutil.a
+
+gcc:LIBS            += -L"$$OUT_PWD/../util/" -lutil
+gcc:PRE_TARGETDEPS  += ../util/libutil.a
+
+INCLUDEPATH += ..
+DEPENDPATH  += ..
+
+SOURCES += \
+    Main.cpp
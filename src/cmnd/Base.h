@@ -6,6 +6,8 @@
 namespace cmnd
 {
 
+class SpillFile;
+
 class Base
 {
 public:
@@ -17,6 +19,13 @@ public:
     virtual bool tryRedo() { return true; }
     virtual bool tryUndo() { return true; }
 
+    // approximate heap bytes held for undoing and redoing
+    virtual size_t byteSize() const { return 0; }
+    // called when the command will never be modified again
+    virtual void compact() {}
+    // move the held data into aFile, returns the released heap bytes
+    virtual size_t spill(SpillFile& aFile) { (void)aFile; return 0; }
+
 private:
     Base(const Base&);
     Base& operator=(const Base&);
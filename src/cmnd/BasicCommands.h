@@ -10,6 +10,7 @@
 #include "XC.h"
 #include "cmnd/Stable.h"
 #include "cmnd/SleepableObject.h"
+#include "cmnd/MemoryDelta.h"
 
 namespace cmnd
 {
@@ -413,10 +414,27 @@ class AssignMemory : public Stable
     std::unique_ptr<uint8[]> mCopyBlock;
     size_t mCopySize;
     bool mDone;
+    MemoryDelta mDelta;
+    bool mCompacted;
+    uint64 mTargetSum;
 
     bool copiesOneTime() const { return mCopySize == mSize; }
     uint8* assignData() { return mAssign.get(); }
 
+    // a position weighted sum of the target bytes. it is kept for the writes
+    // of this command, so that compact() can tell whether anything else has
+    // written the target since.
+    static uint64 weightedSum(const void* aBytes, size_t aOffset, size_t aSize)
+    {
+        const uint8* bytes = (const uint8*)aBytes;
+        uint64 sum = 0;
+        for (size_t i = 0; i < aSize; ++i)
+        {
+            sum += (uint64)bytes[i] * (aOffset + i + 1);
+        }
+        return sum;
+    }
+
     void exchange(uint8* aBuffer0, uint8* aBuffer1)
     {
         const uint8* block = mCopyBlock.get();
@@ -444,6 +462,9 @@ public:
         , mCopyBlock()
         , mCopySize(aCopySize > 0 ? aCopySize : aSize)
         , mDone(false)
+        , mDelta()
+        , mCompacted(false)
+        , mTargetSum(0)
     {
         XC_ASSERT(aSize > 0);
 
@@ -468,6 +489,9 @@ public:
         , mCopyBlock()
         , mCopySize(aCopySize > 0 ? aCopySize : aSize)
         , mDone(false)
+        , mDelta()
+        , mCompacted(false)
+        , mTargetSum(0)
     {
         XC_ASSERT(aSize > 0);
         XC_ASSERT(aCopySize > 0);
@@ -488,6 +512,7 @@ public:
 
     void modifyValue(const void* aNewAssign)
     {
+        XC_ASSERT(!mCompacted);
         if (copiesOneTime() || !mDone)
         {
             memcpy(assignData(), aNewAssign, mSize);
@@ -495,6 +520,25 @@ public:
         if (mDone)
         {
             memcpy(mTarget, aNewAssign, mSize);
+            mTargetSum = weightedSum(mTarget, 0, mSize);
+        }
+    }
+
+    // modify a part of the value, aNewAssign points the new data of the part
+    void modifyValue(const void* aNewAssign, size_t aOffset, size_t aSize)
+    {
+        XC_ASSERT(!mCompacted);
+        XC_ASSERT(aOffset + aSize <= mSize);
+        if (copiesOneTime() || !mDone)
+        {
+            memcpy(assignData() + aOffset, aNewAssign, aSize);
+        }
+        if (mDone)
+        {
+            uint8* target = (uint8*)mTarget + aOffset;
+            mTargetSum -= weightedSum(target, aOffset, aSize);
+            memcpy(target, aNewAssign, aSize);
+            mTargetSum += weightedSum(target, aOffset, aSize);
         }
     }
 
@@ -507,9 +551,45 @@ public:
         redo();
     }
 
+    virtual size_t byteSize() const
+    {
+        if (mCompacted) return mDelta.byteSize();
+        return (mAssign ? mSize : 0) + (mCopyBlock ? mCopySize : 0);
+    }
+
+    // keep only the changed bytes once the command is finished
+    virtual void compact()
+    {
+        if (mCompacted || !mDone) return;
+
+        // the delta is only valid while the target has the assigned state
+        const bool intact = (weightedSum(mTarget, 0, mSize) == mTargetSum);
+        XC_MSG_ASSERT(intact, "the target of AssignMemory was written by another one");
+        if (!intact) return;
+
+        // the target holds the assigned state, the other buffer the previous one
+        const uint8* other = (copiesOneTime() ? mCopyBlock : mAssign).get();
+        mDelta.make(mTarget, other, mSize);
+        mAssign.reset();
+        mCopyBlock.reset();
+        mCompacted = true;
+    }
+
+    virtual size_t spill(SpillFile& aFile)
+    {
+        return mCompacted ? mDelta.spill(aFile) : 0;
+    }
+
     virtual void undo()
     {
-        if (copiesOneTime())
+        if (mCompacted)
+        {
+            if (!mDelta.apply(mTarget))
+            {
+                XC_FATAL_ERROR("Undo Error", "Failed to read the undo history.", "");
+            }
+        }
+        else if (copiesOneTime())
         {
             memcpy(mTarget, mCopyBlock.get(), mSize);
         }
@@ -523,7 +603,14 @@ public:
 
     virtual void redo()
     {
-        if (copiesOneTime())
+        if (mCompacted)
+        {
+            if (!mDelta.apply(mTarget))
+            {
+                XC_FATAL_ERROR("Undo Error", "Failed to read the undo history.", "");
+            }
+        }
+        else if (copiesOneTime())
         {
             memcpy(mTarget, assignData(), mSize);
         }
@@ -532,6 +619,10 @@ public:
             exchange((uint8*)mTarget, assignData());
         }
 
+        if (!mCompacted)
+        {
+            mTargetSum = weightedSum(mTarget, 0, mSize);
+        }
         mDone = true;
     }
 };
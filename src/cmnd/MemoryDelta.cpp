@@ -0,0 +1,134 @@
+#include <string.h>
+#include "cmnd/SpillFile.h"
+#include "cmnd/MemoryDelta.h"
+
+namespace cmnd
+{
+
+MemoryDelta::MemoryDelta()
+    : mRuns()
+    , mBytes()
+    , mFile()
+    , mFileOffset(-1)
+    , mRunCount(0)
+    , mByteCount(0)
+{
+}
+
+MemoryDelta::~MemoryDelta()
+{
+    clear();
+}
+
+void MemoryDelta::make(const void* aCurrent, const void* aOther, size_t aSize)
+{
+    clear();
+
+    const uint8* current = (const uint8*)aCurrent;
+    const uint8* other = (const uint8*)aOther;
+
+    // an equal gap shorter than a run header is cheaper inside the run
+    const size_t kMinGap = sizeof(Run);
+
+    size_t i = 0;
+    while (i < aSize)
+    {
+        // skip equal bytes
+        while (i < aSize && current[i] == other[i]) ++i;
+        if (i >= aSize) break;
+
+        size_t end = i + 1;
+        for (size_t k = end; k < aSize && k - end < kMinGap; ++k)
+        {
+            if (current[k] != other[k]) end = k + 1;
+        }
+
+        Run run = { i, end - i };
+        mRuns.push_back(run);
+        for (size_t k = i; k < end; ++k)
+        {
+            mBytes.push_back(current[k] ^ other[k]);
+        }
+        i = end;
+    }
+
+    mRuns.shrink_to_fit();
+    mBytes.shrink_to_fit();
+    mRunCount = mRuns.size();
+    mByteCount = mBytes.size();
+}
+
+void MemoryDelta::clear()
+{
+    if (mFile)
+    {
+        mFile->release(mRunCount * sizeof(Run) + mByteCount);
+        mFile = nullptr;
+        mFileOffset = -1;
+    }
+    std::vector<Run>().swap(mRuns);
+    std::vector<uint8>().swap(mBytes);
+    mRunCount = 0;
+    mByteCount = 0;
+}
+
+bool MemoryDelta::apply(void* aTarget) const
+{
+    if (!mFile)
+    {
+        applyRuns(mRuns.data(), mRunCount, mBytes.data(), (uint8*)aTarget);
+        return true;
+    }
+
+    std::vector<Run> runs(mRunCount);
+    std::vector<uint8> bytes(mByteCount);
+    const size_t runBytes = mRunCount * sizeof(Run);
+    if (!mFile->read(mFileOffset, runs.data(), runBytes) ||
+            !mFile->read(mFileOffset + (qint64)runBytes, bytes.data(), mByteCount))
+    {
+        return false;
+    }
+    applyRuns(runs.data(), mRunCount, bytes.data(), (uint8*)aTarget);
+    return true;
+}
+
+size_t MemoryDelta::byteSize() const
+{
+    return mRuns.capacity() * sizeof(Run) + mBytes.capacity();
+}
+
+size_t MemoryDelta::spill(SpillFile& aFile)
+{
+    if (mFile || mRunCount == 0) return 0;
+
+    const size_t runBytes = mRunCount * sizeof(Run);
+    std::vector<uint8> block(runBytes + mByteCount);
+    memcpy(block.data(), mRuns.data(), runBytes);
+    memcpy(block.data() + runBytes, mBytes.data(), mByteCount);
+
+    const qint64 offset = aFile.write(block.data(), block.size());
+    if (offset < 0) return 0;
+
+    const size_t released = byteSize();
+    mFile = &aFile;
+    mFileOffset = offset;
+    std::vector<Run>().swap(mRuns);
+    std::vector<uint8>().swap(mBytes);
+    return released;
+}
+
+void MemoryDelta::applyRuns(const Run* aRuns, size_t aRunCount,
+                            const uint8* aBytes, uint8* aTarget)
+{
+    for (size_t i = 0; i < aRunCount; ++i)
+    {
+        uint8* target = aTarget + aRuns[i].offset;
+        for (size_t k = 0; k < aRuns[i].size; ++k)
+        {
+            target[k] ^= aBytes[k];
+        }
+        aBytes += aRuns[i].size;
+    }
+}
+
+} // namespace cmnd
@@ -0,0 +1,53 @@
+#ifndef CMND_MEMORYDELTA_H
+#define CMND_MEMORYDELTA_H
+
+#include <vector>
+#include "XC.h"
+#include "util/NonCopyable.h"
+
+namespace cmnd
+{
+
+class SpillFile;
+
+// xor difference of two memory blocks, stored as runs of the changed bytes.
+// applying the delta toggles a block between the two states.
+class MemoryDelta : private util::NonCopyable
+{
+public:
+    MemoryDelta();
+    ~MemoryDelta();
+
+    void make(const void* aCurrent, const void* aOther, size_t aSize);
+    void clear();
+
+    // returns false if the spilled data could not be read.
+    bool apply(void* aTarget) const;
+
+    // bytes on the heap
+    size_t byteSize() const;
+    bool isSpilled() const { return mFile; }
+
+    // move the runs into aFile, returns the released heap bytes.
+    size_t spill(SpillFile& aFile);
+
+private:
+    struct Run
+    {
+        size_t offset;
+        size_t size;
+    };
+    static void applyRuns(const Run* aRuns, size_t aRunCount,
+                          const uint8* aBytes, uint8* aTarget);
+
+    std::vector<Run> mRuns;
+    std::vector<uint8> mBytes;
+    SpillFile* mFile;
+    qint64 mFileOffset;
+    size_t mRunCount;
+    size_t mByteCount;
+};
+
+} // namespace cmnd
+
+#endif // CMND_MEMORYDELTA_H
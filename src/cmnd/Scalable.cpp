@@ -105,5 +105,32 @@ bool Scalable::tryUndo()
     return succeed;
 }
 
+size_t Scalable::byteSize() const
+{
+    size_t size = 0;
+    for (auto command : mCommands)
+    {
+        size += command->byteSize();
+    }
+    return size;
+}
+
+void Scalable::compact()
+{
+    for (auto command : mCommands)
+    {
+        command->compact();
+    }
+}
+
+size_t Scalable::spill(SpillFile& aFile)
+{
+    size_t released = 0;
+    for (auto command : mCommands)
+    {
+        released += command->spill(aFile);
+    }
+    return released;
+}
 
 } // namespace cmnd
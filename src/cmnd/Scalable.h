@@ -27,6 +27,9 @@ private:
     virtual bool tryExec();
     virtual bool tryRedo();
     virtual bool tryUndo();
+    virtual size_t byteSize() const;
+    virtual void compact();
+    virtual size_t spill(SpillFile& aFile);
 
     Vector mCommands;
     QVector<cmnd::Listener*> mListeners;
@@ -0,0 +1,67 @@
+#include <QDir>
+#include "XC.h"
+#include "cmnd/SpillFile.h"
+
+namespace cmnd
+{
+
+SpillFile::SpillFile()
+    : mFile(QDir::tempPath() + "/AnimeEffects_undo_XXXXXX")
+    , mOpened(false)
+    , mFailed(false)
+    , mFileSize(0)
+    , mLiveSize(0)
+{
+}
+
+qint64 SpillFile::write(const void* aData, size_t aSize)
+{
+    if (mFailed) return -1;
+
+    if (!mOpened)
+    {
+        // open lazily, most of the sessions never spill
+        if (!mFile.open())
+        {
+            mFailed = true;
+            return -1;
+        }
+        mOpened = true;
+    }
+
+    const qint64 offset = mFileSize;
+    if (!mFile.seek(offset) ||
+            mFile.write((const char*)aData, (qint64)aSize) != (qint64)aSize)
+    {
+        // a partial write leaves garbage only after the last valid offset
+        mFailed = true;
+        return -1;
+    }
+
+    mFileSize += (qint64)aSize;
+    mLiveSize += (qint64)aSize;
+    return offset;
+}
+
+bool SpillFile::read(qint64 aOffset, void* aDest, size_t aSize)
+{
+    XC_ASSERT(mOpened);
+    XC_ASSERT(aOffset + (qint64)aSize <= mFileSize);
+    if (!mOpened || !mFile.seek(aOffset)) return false;
+    return mFile.read((char*)aDest, (qint64)aSize) == (qint64)aSize;
+}
+
+void SpillFile::release(size_t aSize)
+{
+    mLiveSize -= (qint64)aSize;
+    XC_ASSERT(mLiveSize >= 0);
+
+    if (mLiveSize <= 0 && mOpened)
+    {
+        mLiveSize = 0;
+        mFileSize = 0;
+        mFile.resize(0);
+    }
+}
+
+} // namespace cmnd
@@ -0,0 +1,35 @@
+#ifndef CMND_SPILLFILE_H
+#define CMND_SPILLFILE_H
+
+#include <QTemporaryFile>
+#include "util/NonCopyable.h"
+
+namespace cmnd
+{
+
+// append only temporary file which keeps the old data of commands.
+// the file is truncated when no spilled data is alive.
+class SpillFile : private util::NonCopyable
+{
+public:
+    SpillFile();
+
+    // returns the offset of the written data, or -1 on failure.
+    qint64 write(const void* aData, size_t aSize);
+    bool read(qint64 aOffset, void* aDest, size_t aSize);
+    void release(size_t aSize);
+
+    qint64 fileSize() const { return mFileSize; }
+    qint64 liveSize() const { return mLiveSize; }
+
+private:
+    QTemporaryFile mFile;
+    bool mOpened;
+    bool mFailed;
+    qint64 mFileSize;
+    qint64 mLiveSize;
+};
+
+} // namespace cmnd
+
+#endif // CMND_SPILLFILE_H
@@ -1,16 +1,28 @@
+#include <algorithm>
 #include "XC.h"
 #include "cmnd/Stack.h"
 
+namespace
+{
+static const size_t kDefaultByteBudget = 512 * 1024 * 1024;
+// small commands report no bytes, keep the list itself bounded
+static const int kMaxCommandCount = 1024;
+}
+
 namespace cmnd
 {
 
 Stack::Stack()
-    : mLimit(32)
+    : mByteBudget(kDefaultByteBudget)
+    , mSpillBudget(0)
+    , mSpillFile()
+    , mMemoryUsage(0)
     , mCommands()
     , mCurrent(mCommands.end())
     , mMacro()
     , mSuspendCount(0)
     , mModifiable()
+    , mLastPushed()
     , mEditingOrigin(0)
     , mIsEdited()
     , mOnEditStatusChanged()
@@ -80,20 +92,17 @@ void Stack::pushImpl(Base* aCommand)
     XC_PTR_ASSERT(aCommand);
     if (!aCommand) return;
 
+    // the previous command can not be modified any more
+    compactLastPushed();
+
     // delete invalid branch
     while (mCurrent != mCommands.end())
     {
+        releaseUsage((*mCurrent)->byteSize());
         delete *mCurrent;
         mCurrent = mCommands.erase(mCurrent);
     }
 
-    // make sure limit
-    while (mCommands.count() >= mLimit)
-    {
-        delete mCommands.front();
-        mCommands.pop_front();
-    }
-
     mCommands.push_back(aCommand);
 
     // invoke
@@ -105,12 +114,71 @@ void Stack::pushImpl(Base* aCommand)
         --mEditingOrigin; // update editing origin
     }
 
+    mLastPushed = aCommand;
+
+    // make sure budget
+    keepBudget();
+
     // update current
     mCurrent = mCommands.end();
 
     updateEditStatus();
 }
 
+void Stack::compactLastPushed()
+{
+    if (mLastPushed)
+    {
+        mLastPushed->compact();
+        // the size is fixed from now on
+        mMemoryUsage += mLastPushed->byteSize();
+        mLastPushed = NULL;
+    }
+}
+
+void Stack::releaseUsage(size_t aBytes)
+{
+    mMemoryUsage -= std::min(mMemoryUsage, aBytes);
+}
+
+void Stack::keepBudget()
+{
+    // the last command is never evicted
+    while (mCommands.count() > kMaxCommandCount)
+    {
+        releaseUsage(mCommands.front()->byteSize());
+        delete mCommands.front();
+        mCommands.pop_front();
+    }
+
+    if (memoryUsage() <= mByteBudget) return;
+
+    // move the oldest data to the disk firstly
+    if (mSpillBudget > 0)
+    {
+        if (!mSpillFile)
+        {
+            mSpillFile.reset(new SpillFile());
+        }
+
+        for (auto command : mCommands)
+        {
+            if (memoryUsage() <= mByteBudget) break;
+            if (command == mLastPushed) break;
+            if (mSpillFile->fileSize() >= mSpillBudget) break;
+            releaseUsage(command->spill(*mSpillFile));
+        }
+    }
+
+    while (memoryUsage() > mByteBudget && mCommands.count() > 1)
+    {
+        Base* command = mCommands.front();
+        releaseUsage(command->byteSize());
+        delete command;
+        mCommands.pop_front();
+    }
+}
+
 QString Stack::undo(bool* undone)
 {
     if (undone) *undone = false;
@@ -118,6 +186,7 @@ QString Stack::undo(bool* undone)
     if (!isSuspended())
     {
         mModifiable = NULL;
+        compactLastPushed();
         while (mCurrent != mCommands.begin())
         {
             --mCurrent;
@@ -125,7 +194,11 @@ QString Stack::undo(bool* undone)
             bool success = false;
             if (!(*mCurrent)->isUseless())
             {
+                // the held data can be swapped with a different sized one
+                const size_t size = (*mCurrent)->byteSize();
                 success = (*mCurrent)->tryUndo();
+                releaseUsage(size);
+                mMemoryUsage += (*mCurrent)->byteSize();
             }
             ++mEditingOrigin; // update editing origin
 
@@ -149,6 +222,7 @@ QString Stack::redo(bool* redone)
     if (!isSuspended())
     {
         mModifiable = NULL;
+        compactLastPushed();
         while (mCurrent != mCommands.end())
         {
             bool success = false;
@@ -156,7 +230,10 @@ QString Stack::redo(bool* redone)
 
             if (!(*mCurrent)->isUseless())
             {
+                const size_t size = (*mCurrent)->byteSize();
                 success = (*mCurrent)->tryRedo();
+                releaseUsage(size);
+                mMemoryUsage += (*mCurrent)->byteSize();
                 name = (*mCurrent)->name();
             }
             ++mCurrent; // update current
@@ -180,7 +257,9 @@ void Stack::clear()
     qDeleteAll(mCommands.begin(), mCommands.end());
     mCommands.clear();
     mCurrent = mCommands.end();
+    mMemoryUsage = 0;
     mModifiable = NULL;
+    mLastPushed = NULL;
 }
 
 bool Stack::isModifiable(const Base* aBase) const
@@ -189,6 +268,27 @@ bool Stack::isModifiable(const Base* aBase) const
     return mModifiable == aBase;
 }
 
+void Stack::setByteBudget(size_t aBytes)
+{
+    mByteBudget = aBytes;
+}
+
+void Stack::setSpillBudget(qint64 aBytes)
+{
+    mSpillBudget = aBytes;
+}
+
+size_t Stack::memoryUsage() const
+{
+    // the last pushed command can still grow or be compacted
+    return mMemoryUsage + (mLastPushed ? mLastPushed->byteSize() : 0);
+}
+
+qint64 Stack::diskUsage() const
+{
+    return mSpillFile ? mSpillFile->liveSize() : 0;
+}
+
 void Stack::resetEditingOrigin()
 {
     mEditingOrigin = 0;
@@ -363,4 +463,32 @@ bool Stack::Macro::isUseless() const
     return true;
 }
 
+size_t Stack::Macro::byteSize() const
+{
+    size_t size = 0;
+    for (Base* command : mCommands)
+    {
+        size += command->byteSize();
+    }
+    return size;
+}
+
+void Stack::Macro::compact()
+{
+    for (Base* command : mCommands)
+    {
+        command->compact();
+    }
+}
+
+size_t Stack::Macro::spill(SpillFile& aFile)
+{
+    size_t released = 0;
+    for (Base* command : mCommands)
+    {
+        released += command->spill(aFile);
+    }
+    return released;
+}
+
 } // namespace cmnd
@@ -7,9 +7,11 @@
 #include <QList>
 #include <QMutableListIterator>
 #include <QListIterator>
+#include <QScopedPointer>
 #include "util/LifeLink.h"
 #include "cmnd/Base.h"
 #include "cmnd/Listener.h"
+#include "cmnd/SpillFile.h"
 
 namespace cmnd
 {
@@ -32,6 +34,15 @@ public:
 
     bool isModifiable(const Base* aBase) const;
 
+    // the oldest commands are spilled to a temporary file, or deleted,
+    // while the history holds more bytes than the budget.
+    void setByteBudget(size_t aBytes);
+    void setSpillBudget(qint64 aBytes); // zero disables spilling
+    size_t byteBudget() const { return mByteBudget; }
+    int count() const { return mCommands.count(); }
+    size_t memoryUsage() const;
+    qint64 diskUsage() const;
+
     void resetEditingOrigin();
     bool isEdited() const;
     void setOnEditStatusChanged(const std::function<void(bool)>&);
@@ -50,6 +61,9 @@ private:
         virtual bool tryRedo();
         virtual bool tryUndo();
         virtual bool isUseless() const;
+        virtual size_t byteSize() const;
+        virtual void compact();
+        virtual size_t spill(SpillFile& aFile);
     private:
         void killListeners();
         QList<Base*> mCommands;
@@ -70,14 +84,21 @@ private:
     void resumeUndo() { --mSuspendCount; }
 
     void pushImpl(Base* aCommand);
+    void compactLastPushed();
+    void releaseUsage(size_t aBytes);
+    void keepBudget();
     void updateEditStatus();
 
-    const int mLimit;
+    size_t mByteBudget;
+    qint64 mSpillBudget;
+    QScopedPointer<SpillFile> mSpillFile;
+    size_t mMemoryUsage; // the bytes of the commands except the last pushed one
     QList<Base*> mCommands;
     QList<Base*>::Iterator mCurrent;
     Macro* mMacro;
     int mSuspendCount;
     Base* mModifiable;
+    Base* mLastPushed;
     int mEditingOrigin;
     bool mIsEdited;
     std::function<void(bool)> mOnEditStatusChanged;
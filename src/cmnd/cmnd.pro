@@ -25,7 +25,9 @@ DEPENDPATH  += ..
 
 SOURCES += \
     Stack.cpp \
-    Scalable.cpp
+    Scalable.cpp \
+    MemoryDelta.cpp \
+    SpillFile.cpp
 
 HEADERS += \
     Base.h \
@@ -40,4 +42,6 @@ HEADERS += \
     UndoneDeleter.h \
     DoneDeleter.h \
     Stable.h \
-    Vector.h
+    Vector.h \
+    MemoryDelta.h \
+    SpillFile.h
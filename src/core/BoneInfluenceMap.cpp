@@ -126,7 +126,7 @@ void BoneInfluenceMap::writeAsync(
 #else
     // create task
     mBuildTask.reset(new BuildTask(aProject, *this));
-    aProject.paralleler().push(*mBuildTask);
+    aProject.taskGroup().push(*mBuildTask);
 #endif
 }
 
@@ -408,7 +408,7 @@ void BoneInfluenceMap::BuildTask::run()
 
 void BoneInfluenceMap::BuildTask::cancel()
 {
-    mProject.paralleler().cancel(*this);
+    mProject.taskGroup().cancel(*this);
 }
 
 //-------------------------------------------------------------------------------------------------
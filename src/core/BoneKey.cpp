@@ -156,11 +156,6 @@ void BoneKey::updateCaches(Project& aProject, const QList<Cache*>& aTargets)
             // request writing
             map.writeAsync(aProject, mData.topBones(), mapMtx, *mesh);
         }
-
-#ifndef UNUSE_PARALLEL
-        // wake all worker threads
-        aProject.paralleler().wakeAll();
-#endif
     }
 
 
@@ -1,5 +1,7 @@
 #include "gl/Global.h"
 #include "gl/Util.h"
+#include "gl/GPUProfiler.h"
+#include "util/Profiler.h"
 #include "core/DestinationTexturizer.h"
 
 namespace
@@ -66,6 +68,8 @@ void DestinationTexturizer::update(
         LayerMesh& aMesh, gl::BufferObject& aPositions)
 {
     XC_ASSERT(mTexture->size().isValid());
+    util::ProfileZone zone("destination texturize");
+    gl::GPUProfileZone gpuZone("destination texturize");
 
     auto& ggl = gl::Global::functions();
 
@@ -72,6 +72,16 @@ public:
         redo();
     }
 
+    virtual size_t byteSize() const
+    {
+        size_t size = 0;
+        for (auto& target : mTargets)
+        {
+            size += sizeof(gl::Vector3) * target.pos.size();
+        }
+        return size;
+    }
+
     virtual void redo()
     {
         for (auto& target : mTargets)
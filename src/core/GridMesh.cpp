@@ -1,4 +1,7 @@
 #include <float.h>
+#include <cmath>
+#include <array>
+#include <algorithm>
 #include <QVector3D>
 #include <QMatrix4x4>
 #include <QPoint>
@@ -8,11 +11,18 @@
 #include "util/CollDetect.h"
 #include "util/MathUtil.h"
 #include "util/BinarySpacePartition2D.h"
+#include "thr/ParallelFor.h"
 #include "img/PixelPos.h"
 #include "img/Quad.h"
 #include "core/GridMesh.h"
 #include "core/HeightMap.h"
 #include "core/TimeLine.h"
+#include "core/Constant.h"
+
+namespace
+{
+static const int kTransitionGrain = 256;
+}
 
 namespace core
 {
@@ -161,7 +171,66 @@ void GridMesh::initializeVertexBuffers(int aVertexCount)
     }
 }
 
+bool GridMesh::isEmptyImage(const void* aImagePtr, const QSize& aSize)
+{
+    return !aImagePtr || aSize.isEmpty() ||
+            (aSize == QSize(1, 1) && *((uint32*)aImagePtr) == 0);
+}
+
+bool GridMesh::needsGridMesh(const QSize& aSize, int aCellPx)
+{
+    return aCellPx < aSize.width() - 2 || aCellPx < aSize.height() - 2;
+}
+
+img::GridMeshCreator* GridMesh::prepareGridMesh(
+        const void* aImagePtr, const QSize& aSize, int aCellPx, bool aParallel,
+        const MeshingParam& aParam)
+{
+    static const int kBudgetRetryMax = 4;
+    XC_ASSERT(aCellPx > 0);
+
+    int cellPx = aCellPx;
+    for (int i = 0; ; ++i)
+    {
+        if (isEmptyImage(aImagePtr, aSize) || !needsGridMesh(aSize, cellPx))
+        {
+            return nullptr;
+        }
+
+        QScopedPointer<img::GridMeshCreator> creator(
+                    new img::GridMeshCreator(
+                        (const uint8*)aImagePtr, aSize, cellPx, aParallel, aParam.adaptive));
+
+        const int count = creator->vertexCount();
+        const int budget = aParam.vertexBudget;
+        if (budget <= 0 || count <= budget ||
+                i >= kBudgetRetryMax || cellPx >= Constant::imageCellSizeMax())
+        {
+            return creator.take();
+        }
+
+        // the vertex count is roughly inverse proportional to the cell area
+        const float scale = std::sqrt((float)count / budget);
+        cellPx = std::min(std::max(cellPx + 1, (int)std::ceil(cellPx * scale)),
+                          Constant::imageCellSizeMax());
+    }
+}
+
+size_t GridMesh::byteSize() const
+{
+    return sizeof(GLuint) * mIndices.count() +
+            sizeof(gl::Vector3) * (mPositions.count() + mOffsets.count() + mNormals.count()) +
+            sizeof(gl::Vector2) * mTexCoords.count() +
+            sizeof(HexaConnection) * mHexaConnections.count();
+}
+
 void GridMesh::createFromImage(const void* aImagePtr, const QSize& aSize, int aCellPx)
+{
+    createFromImage(aImagePtr, aSize, aCellPx, nullptr);
+}
+
+void GridMesh::createFromImage(const void* aImagePtr, const QSize& aSize, int aCellPx,
+                               img::GridMeshCreator* aPrepared)
 {
     XC_ASSERT(aCellPx > 0);
 
@@ -171,15 +240,25 @@ void GridMesh::createFromImage(const void* aImagePtr, const QSize& aSize, int aC
     mSize = aSize;
     mCellPx = aCellPx;
 
-    if (!aImagePtr || aSize.isEmpty() || (aSize == QSize(1, 1) && *((uint32*)aImagePtr) == 0))
+    if (isEmptyImage(aImagePtr, aSize))
     {
         mVertexRect = QRect(QPoint(), QSize());
         mVertexCount = 0;
         mIndexCount = 0;
     }
-    else if (aCellPx < aSize.width() - 2 || aCellPx < aSize.height() - 2)
+    else if (needsGridMesh(aSize, aCellPx))
     {
-        createGridMesh(aImagePtr);
+        if (aPrepared)
+        {
+            // the cell size may be enlarged by the vertex budget of a new mesh
+            mCellPx = aPrepared->cellPx();
+            createGridMesh(*aPrepared);
+        }
+        else
+        {
+            img::GridMeshCreator creator((const uint8*)aImagePtr, mSize, mCellPx);
+            createGridMesh(creator);
+        }
     }
     else
     {
@@ -187,9 +266,9 @@ void GridMesh::createFromImage(const void* aImagePtr, const QSize& aSize, int aC
     }
 }
 
-void GridMesh::createGridMesh(const void* aImagePtr)
+void GridMesh::createGridMesh(img::GridMeshCreator& aCreator)
 {
-    img::GridMeshCreator creator((const uint8*)aImagePtr, mSize, mCellPx);
+    img::GridMeshCreator& creator = aCreator;
 
     mVertexRect = creator.vertexRect();
     mVertexCount = creator.vertexCount();
@@ -686,6 +765,7 @@ GridMesh::Transitions GridMesh::TransitionCreater::create(
 
     const QRectF space(mRect);
     util::BinarySpacePartition2D<TriId> bsp(space);
+    bsp.reserve(mIndexCount / 3);
 
     for (int i = 0; i < mIndexCount; i += 3)
     {
@@ -703,6 +783,7 @@ GridMesh::Transitions GridMesh::TransitionCreater::create(
             XC_ASSERT(result);
         }
     }
+    bsp.build();
 
     const QVector2D offset(aTopLeft - mTopLeft);
     auto positions = aNext;
@@ -712,20 +793,36 @@ GridMesh::Transitions GridMesh::TransitionCreater::create(
     result.data.resize(count);
     result.offset = -offset;
 
-    for (int i = 0; i < count; ++i)
+    // each chunk writes its own range of the result only
+    Transition* transData = result.data.data();
+    thr::ParallelFor::run(count, kTransitionGrain, [=, &bsp](int aBegin, int aEnd)
     {
-        auto glpos = positions[i];
-        auto pos = glpos.pos2D() + offset;
-        auto obj = bsp.findOne(pos.toPointF());
+        typedef util::BinarySpacePartition2D<TriId>::Object ObjType;
+        std::array<QPointF, kTransitionGrain> points;
+        std::array<const ObjType*, kTransitionGrain> objs;
 
-        if (obj)
+        for (int head = aBegin; head < aEnd; head += kTransitionGrain)
         {
-            Transition trans;
-            trans.id = obj->data;
-            trans.pos = util::Triangle2DPos::make(obj->tri, pos);
-            result.data[i] = trans;
+            const int batch = std::min((int)kTransitionGrain, aEnd - head);
+            for (int k = 0; k < batch; ++k)
+            {
+                points[k] = (positions[head + k].pos2D() + offset).toPointF();
+            }
+            bsp.findEach(points.data(), batch, objs.data());
+
+            for (int k = 0; k < batch; ++k)
+            {
+                auto obj = objs[k];
+                if (obj)
+                {
+                    Transition trans;
+                    trans.id = obj->data;
+                    trans.pos = util::Triangle2DPos::make(obj->tri, QVector2D(points[k]));
+                    transData[head + k] = trans;
+                }
+            }
         }
-    }
+    });
 
     return result;
 }
@@ -33,6 +33,19 @@ public:
         util::Triangle2DPos pos;
     };
 
+    // the meshing options of the general settings which the application
+    // passes in. a positive vertex budget enlarges the cell size until the
+    // mesh fits in, so it is given only where no cell size was chosen.
+    struct MeshingParam
+    {
+        MeshingParam() : adaptive(false), vertexBudget(0) {}
+        MeshingParam(bool aAdaptive, int aVertexBudget)
+            : adaptive(aAdaptive), vertexBudget(aVertexBudget) {}
+        MeshingParam withoutBudget() const { return MeshingParam(adaptive, 0); }
+        bool adaptive;
+        int vertexBudget; // 0 means unlimited
+    };
+
     struct Transitions
     {
         QVector<Transition> data;
@@ -63,7 +76,15 @@ public:
 
     void swap(GridMesh& aRhs);
     void setOriginOffset(const QVector2D& aOffset) { mOriginOffset = aOffset; }
+    // the heavy part of createFromImage which does not touch any gl object.
+    // it is thread safe and returns null if the image needs no grid.
+    static img::GridMeshCreator* prepareGridMesh(
+            const void* aImagePtr, const QSize& aSize, int aCellPx, bool aParallel,
+            const MeshingParam& aParam = MeshingParam());
+
     void createFromImage(const void* aImagePtr, const QSize& aSize, int aCellPx);
+    void createFromImage(const void* aImagePtr, const QSize& aSize, int aCellPx,
+                         img::GridMeshCreator* aPrepared);
     void writeHeightMap(const HeightMap& aMap, const QVector2D& aMinPos);
     util::ArrayBlock<gl::Vector3> createFFD(
             util::ArrayBlock<const gl::Vector3> aPrevFFD,
@@ -90,6 +111,8 @@ public:
     const QSize& size() const { return mSize; }
     int cellSize() const { return mCellPx; }
     const QRect& vertexRect() const { return mVertexRect; }
+    // approximate heap bytes of the vertex and index arrays
+    size_t byteSize() const;
 
     bool serialize(Serializer& aOut) const;
     bool deserialize(Deserializer& aIn);
@@ -98,7 +121,9 @@ private:
     typedef img::GridMeshCreator::HexaConnection HexaConnection;
     enum { kMaxConnectionCount = 6, kHexaConnectionCount = 6 };
 
-    void createGridMesh(const void* aImagePtr);
+    static bool needsGridMesh(const QSize& aSize, int aCellPx);
+    static bool isEmptyImage(const void* aImagePtr, const QSize& aSize);
+    void createGridMesh(img::GridMeshCreator& aCreator);
     void createQuadMesh();
 
     void allocIndices(int aIndexCount);
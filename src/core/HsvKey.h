@@ -32,6 +32,9 @@ public:
         void updateHSV() {mHSV.clear(); mHSV = {mHue, mSaturation, mValue};}
 
         const QList<int>& hsv() const { return mHSV; }
+        int hue() const { return mHue; }
+        int saturation() const { return mSaturation; }
+        int value() const { return mValue; }
 
         bool isZero() const;
     };
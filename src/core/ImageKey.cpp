@@ -1,3 +1,6 @@
+#include <memory>
+#include <vector>
+#include "thr/ParallelFor.h"
 #include "img/ResourceNode.h"
 #include "img/BlendMode.h"
 #include "core/ImageKey.h"
@@ -94,21 +97,72 @@ void ImageKey::setImageOffsetByCenter()
     }
 }
 
-void ImageKey::resetGridMesh(int aCellSize)
+int ImageKey::getValidCellSize(int aCellSize) const
+{
+    auto size = mData.resource()->image().pixelSize();
+
+    //const int cellPx = std::max(std::min(8, pixelSize.width() / 4), 2);
+    auto cell = std::max(aCellSize, Constant::imageCellSizeMin());
+    while (img::GridMeshCreator::getCellTableCount(size, cell) > Constant::imageCellCountMax())
+    {
+        ++cell;
+    }
+    return std::min(cell, Constant::imageCellSizeMax());
+}
+
+void ImageKey::resetGridMesh(int aCellSize, const GridMesh::MeshingParam& aParam)
 {
     if (mData.resource()->hasImage())
     {
         auto data = mData.resource()->image().data();
         auto size = mData.resource()->image().pixelSize();
+        auto cell = getValidCellSize(aCellSize);
+
+        QScopedPointer<img::GridMeshCreator> creator(
+                    GridMesh::prepareGridMesh(data, size, cell, false, aParam));
+        mData.gridMesh().createFromImage(data, size, cell, creator.data());
+    }
+}
+
+void ImageKey::resetGridMeshes(const QVector<ImageKey*>& aKeys,
+                               const QVector<int>& aCellSizes,
+                               const GridMesh::MeshingParam& aParam)
+{
+    XC_ASSERT(aKeys.size() == aCellSizes.size());
+    const int count = aKeys.size();
+
+    QVector<int> cells(count, 0);
+    std::vector<std::unique_ptr<img::GridMeshCreator>> creators(count);
+
+    for (int i = 0; i < count; ++i)
+    {
+        XC_PTR_ASSERT(aKeys[i]);
+        if (aKeys[i]->mData.resource()->hasImage())
+        {
+            cells[i] = aKeys[i]->getValidCellSize(aCellSizes[i]);
+        }
+    }
 
-        //const int cellPx = std::max(std::min(8, pixelSize.width() / 4), 2);
-        auto cell = std::max(aCellSize, Constant::imageCellSizeMin());
-        while (img::GridMeshCreator::getCellTableCount(size, cell) > Constant::imageCellCountMax())
+    // generate grids concurrently, one layer per task.
+    // large images are also split into row bands inside the creator.
+    thr::ParallelFor::run(count, 1, [&](int aBegin, int aEnd)
+    {
+        for (int i = aBegin; i < aEnd; ++i)
         {
-            ++cell;
+            if (cells[i] <= 0) continue;
+            auto& image = aKeys[i]->mData.resource()->image();
+            creators[i].reset(GridMesh::prepareGridMesh(
+                                  image.data(), image.pixelSize(), cells[i], true, aParam));
         }
-        cell = std::min(cell, Constant::imageCellSizeMax());
-        mData.gridMesh().createFromImage(data, size, cell);
+    });
+
+    // gl buffers have to be made on the current thread
+    for (int i = 0; i < count; ++i)
+    {
+        if (cells[i] <= 0) continue;
+        auto& image = aKeys[i]->mData.resource()->image();
+        aKeys[i]->mData.gridMesh().createFromImage(
+                    image.data(), image.pixelSize(), cells[i], creators[i].get());
     }
 }
 
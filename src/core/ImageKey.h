@@ -61,7 +61,14 @@ public:
     void setImageOffset(const QVector2D& aOffset);
     void setImageOffsetByCenter();
     bool hasImage() const { return mData.resource() && mData.resource()->hasImage(); }
-    void resetGridMesh(int CellSize = kDefaultMeshCellSize);
+    void resetGridMesh(int CellSize = kDefaultMeshCellSize,
+                       const GridMesh::MeshingParam& aParam = GridMesh::MeshingParam());
+
+    // reset grid meshes of many keys at once. the meshes are generated
+    // concurrently and gl objects are created on the calling thread.
+    static void resetGridMeshes(const QVector<ImageKey*>& aKeys,
+                                const QVector<int>& aCellSizes,
+                                const GridMesh::MeshingParam& aParam = GridMesh::MeshingParam());
 
     virtual TimeKeyType type() const { return TimeKeyType_Image; }
     virtual bool canHoldChild() const { return true; }
@@ -74,6 +81,7 @@ public:
 
 private:
     void resetTextureCache();
+    int getValidCellSize(int aCellSize) const;
 
     Data mData;
     Cache mCache;
@@ -1,3 +1,5 @@
+#include <memory>
+#include <vector>
 #include "core/ImageKeyUpdater.h"
 #include "core/ImageKey.h"
 
@@ -9,10 +11,12 @@ class ImageResourceUpdaterBase : public cmnd::Stable
 {
 public:
     ImageResourceUpdaterBase(const ResourceUpdatingWorkspacePtr& aWorkspace,
-                             bool aCreateTransitions)
+                             bool aCreateTransitions,
+                             const GridMesh::MeshingParam& aMeshing)
         : mTargets()
         , mWorkspace(aWorkspace)
         , mCreateTransitions(aCreateTransitions)
+        , mMeshing(aMeshing.withoutBudget())
     {
     }
 
@@ -22,16 +26,24 @@ public:
 
     virtual void exec()
     {
-        for (auto& target : mTargets)
+        const int count = mTargets.size();
+        std::vector<std::unique_ptr<GridMesh::TransitionCreater>> transers(count);
+        QVector<ImageKey*> keys(count, nullptr);
+        QVector<int> cellSizes(count, 0);
+        QVector<QVector2D> imageOffsets(count);
+
+        for (int i = 0; i < count; ++i)
         {
+            auto& target = mTargets[i];
             auto key = target.key;
-            GridMesh::TransitionCreater transer(
-                        key->data().gridMesh(),
-                        key->data().resource()->pos());
+            transers[i].reset(new GridMesh::TransitionCreater(
+                                  key->data().gridMesh(),
+                                  key->data().resource()->pos()));
 
-            auto cellSize = target.nextCellSize > 0 ?
+            keys[i] = key;
+            cellSizes[i] = target.nextCellSize > 0 ?
                         target.nextCellSize : key->data().gridMesh().cellSize();
-            auto imageOffset = key->data().imageOffset();
+            imageOffsets[i] = key->data().imageOffset();
 
             // swap grid mesh
             target.anotherMesh = std::make_shared<GridMesh>();
@@ -39,13 +51,19 @@ public:
 
             // update image
             key->setImage(target.nextImage);
+        }
 
-            // reset grid mesh
-            key->resetGridMesh(cellSize);
+        // reset grid meshes at once
+        ImageKey::resetGridMeshes(keys, cellSizes, mMeshing);
+
+        for (int i = 0; i < count; ++i)
+        {
+            auto& target = mTargets[i];
+            auto key = target.key;
 
             // update image offset
             const QVector2D move(target.nextImage->pos() - target.prevImage->pos());
-            target.prevOffset = imageOffset;
+            target.prevOffset = imageOffsets[i];
             target.nextOffset = target.prevOffset + move;
             key->data().setImageOffset(target.nextOffset);
 
@@ -53,7 +71,7 @@ public:
             if (mCreateTransitions)
             {
                 auto& trans = mWorkspace->makeSureTransitions(key, key->data().gridMesh());
-                trans = transer.create(
+                trans = transers[i]->create(
                             key->data().gridMesh().positions(),
                             key->data().gridMesh().vertexCount(),
                             key->data().resource()->pos());
@@ -62,6 +80,17 @@ public:
         mWorkspace.reset(); // finish using
     }
 
+    virtual size_t byteSize() const
+    {
+        // the meshes which are not on the keys
+        size_t size = 0;
+        for (auto& target : mTargets)
+        {
+            if (target.anotherMesh) size += target.anotherMesh->byteSize();
+        }
+        return size;
+    }
+
     virtual void redo()
     {
         for (auto& target : mTargets)
@@ -111,7 +140,7 @@ private:
     QList<Target> mTargets;
     ResourceUpdatingWorkspacePtr mWorkspace;
     bool mCreateTransitions;
-
+    GridMesh::MeshingParam mMeshing;
 };
 
 //-------------------------------------------------------------------------------------------------
@@ -136,8 +165,9 @@ class ImageReloader : public ImageResourceUpdaterBase
 
 public:
     ImageReloader(TimeLine& aTimeLine, const ResourceEvent& aEvent,
-                  const ResourceUpdatingWorkspacePtr& aWorkspace, bool aCreateTransitions)
-        : ImageResourceUpdaterBase(aWorkspace, aCreateTransitions)
+                  const ResourceUpdatingWorkspacePtr& aWorkspace, bool aCreateTransitions,
+                  const GridMesh::MeshingParam& aMeshing)
+        : ImageResourceUpdaterBase(aWorkspace, aCreateTransitions, aMeshing)
         , mTimeLine(aTimeLine)
         , mEvent(aEvent)
     {
@@ -167,8 +197,9 @@ class ImageChanger : public ImageResourceUpdaterBase
 {
 public:
     ImageChanger(ImageKey& aKey, img::ResourceNode& aNewResource,
-                 const ResourceUpdatingWorkspacePtr& aWorkspace, bool aCreateTransitions)
-        : ImageResourceUpdaterBase(aWorkspace, aCreateTransitions)
+                 const ResourceUpdatingWorkspacePtr& aWorkspace, bool aCreateTransitions,
+                 const GridMesh::MeshingParam& aMeshing)
+        : ImageResourceUpdaterBase(aWorkspace, aCreateTransitions, aMeshing)
     {
         this->targets().push_back(Target(&aKey));
         this->targets().back().prevImage = aKey.data().resource();
@@ -182,8 +213,9 @@ class GridMeshUpdater : public ImageResourceUpdaterBase
 public:
     GridMeshUpdater(ImageKey& aKey, int aNewCellSize,
                     const ResourceUpdatingWorkspacePtr& aWorkspace,
-                    bool aCreateTransitions)
-        : ImageResourceUpdaterBase(aWorkspace, aCreateTransitions)
+                    bool aCreateTransitions,
+                    const GridMesh::MeshingParam& aMeshing)
+        : ImageResourceUpdaterBase(aWorkspace, aCreateTransitions, aMeshing)
     {
         this->targets().push_back(Target(&aKey));
         this->targets().back().prevImage = aKey.data().resource();
@@ -195,24 +227,28 @@ public:
 //-------------------------------------------------------------------------------------------------
 cmnd::Stable* ImageKeyUpdater::createResourceUpdater(
         ObjectNode& aNode, const ResourceEvent& aEvent,
-        const ResourceUpdatingWorkspacePtr& aWorkspace, bool aCreateTransitions)
+        const ResourceUpdatingWorkspacePtr& aWorkspace, bool aCreateTransitions,
+        const GridMesh::MeshingParam& aMeshing)
 {
     if (!aNode.timeLine()) return nullptr;
-    return new ImageReloader(*aNode.timeLine(), aEvent, aWorkspace, aCreateTransitions);
+    return new ImageReloader(*aNode.timeLine(), aEvent, aWorkspace,
+                             aCreateTransitions, aMeshing);
 }
 
 cmnd::Stable* ImageKeyUpdater::createResourceUpdater(
         ImageKey& aKey, img::ResourceNode& aNewResource,
-        const ResourceUpdatingWorkspacePtr& aWorkspace, bool aCreateTransitions)
+        const ResourceUpdatingWorkspacePtr& aWorkspace, bool aCreateTransitions,
+        const GridMesh::MeshingParam& aMeshing)
 {
-    return new ImageChanger(aKey, aNewResource, aWorkspace, aCreateTransitions);
+    return new ImageChanger(aKey, aNewResource, aWorkspace, aCreateTransitions, aMeshing);
 }
 
 cmnd::Stable* ImageKeyUpdater::createGridMeshUpdater(
         ImageKey& aKey, int aNewCellSize,
-        const ResourceUpdatingWorkspacePtr& aWorkspace, bool aCreateTransitions)
+        const ResourceUpdatingWorkspacePtr& aWorkspace, bool aCreateTransitions,
+        const GridMesh::MeshingParam& aMeshing)
 {
-    return new GridMeshUpdater(aKey, aNewCellSize, aWorkspace, aCreateTransitions);
+    return new GridMeshUpdater(aKey, aNewCellSize, aWorkspace, aCreateTransitions, aMeshing);
 }
 
 //-------------------------------------------------------------------------------------------------
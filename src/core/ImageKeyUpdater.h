@@ -5,25 +5,31 @@
 #include "core/ObjectNode.h"
 #include "core/ResourceEvent.h"
 #include "core/ResourceUpdatingWorkspace.h"
+#include "core/GridMesh.h"
 namespace core { class ImageKey; }
 
 namespace core
 {
 
+// the updaters keep the cell sizes of the keys, so the vertex budget of
+// aMeshing is not applied.
 class ImageKeyUpdater
 {
 public:
     static cmnd::Stable* createResourceUpdater(
             ObjectNode& aNode, const ResourceEvent& aEvent,
-            const ResourceUpdatingWorkspacePtr& aWorkspace, bool aCreateTransitions);
+            const ResourceUpdatingWorkspacePtr& aWorkspace, bool aCreateTransitions,
+            const GridMesh::MeshingParam& aMeshing);
 
     static cmnd::Stable* createResourceUpdater(
             ImageKey& aKey, img::ResourceNode& aNewResource,
-            const ResourceUpdatingWorkspacePtr& aWorkspace, bool aCreateTransitions);
+            const ResourceUpdatingWorkspacePtr& aWorkspace, bool aCreateTransitions,
+            const GridMesh::MeshingParam& aMeshing);
 
     static cmnd::Stable* createGridMeshUpdater(
             ImageKey& aKey, int aNewCellSize,
-            const ResourceUpdatingWorkspacePtr& aWorkspace, bool aCreateTransitions);
+            const ResourceUpdatingWorkspacePtr& aWorkspace, bool aCreateTransitions,
+            const GridMesh::MeshingParam& aMeshing);
 
     static cmnd::Base* createResourceSleeperForDelete(ObjectNode& aNode);
 };
@@ -16,6 +16,7 @@
 #include "core/ResourceUpdatingWorkspace.h"
 #include "core/FFDKeyUpdater.h"
 #include "core/ImageKeyUpdater.h"
+#include "core/Project.h"
 #include "core/ClippingFrame.h"
 #include "core/DestinationTexturizer.h"
 
@@ -36,12 +37,14 @@ LayerNode::LayerNode(const QString& aName, ShaderHolder& aShaderHolder)
 {
 }
 
-void LayerNode::setDefaultImage(const img::ResourceHandle& aHandle)
+void LayerNode::setDefaultImage(const img::ResourceHandle& aHandle, bool aResetGridMesh,
+                                const GridMesh::MeshingParam& aMeshing)
 {
-    setDefaultImage(aHandle, aHandle->blendMode());
+    setDefaultImage(aHandle, aHandle->blendMode(), aResetGridMesh, aMeshing);
 }
 
-void LayerNode::setDefaultImage(const img::ResourceHandle& aHandle, img::BlendMode aBlendMode)
+void LayerNode::setDefaultImage(const img::ResourceHandle& aHandle, img::BlendMode aBlendMode,
+                                bool aResetGridMesh, const GridMesh::MeshingParam& aMeshing)
 {
     XC_ASSERT(aHandle);
     XC_PTR_ASSERT(aHandle->image().data());
@@ -51,7 +54,7 @@ void LayerNode::setDefaultImage(const img::ResourceHandle& aHandle, img::BlendMo
     auto key = new ImageKey();
     mTimeLine.grabDefaultKey(TimeKeyType_Image, key);
     key->setImage(aHandle, aBlendMode);
-    key->resetGridMesh();
+    if (aResetGridMesh) key->resetGridMesh(ImageKey::kDefaultMeshCellSize, aMeshing);
     key->setImageOffsetByCenter();
 
     mShaderHolder.reserveShaders(aBlendMode);
@@ -582,7 +585,9 @@ cmnd::Vector LayerNode::createResourceUpdater(const ResourceEvent& aEvent)
     const bool createTransitions = !mTimeLine.isEmpty(TimeKeyType_FFD);
 
     // image key
-    result.push(ImageKeyUpdater::createResourceUpdater(*this, aEvent, workspace, createTransitions));
+    result.push(ImageKeyUpdater::createResourceUpdater(
+                    *this, aEvent, workspace, createTransitions,
+                    aEvent.project().meshingParam()));
 
     // ffd key should be called finally
     if (createTransitions)
@@ -29,8 +29,12 @@ public:
     util::LifeLink::Pointee<LayerNode> pointee() { return lifeLink().pointee<LayerNode>(this); }
 
     // default image
-    void setDefaultImage(const img::ResourceHandle& aHandle);
-    void setDefaultImage(const img::ResourceHandle& aHandle, img::BlendMode aBlendMode);
+    // set aResetGridMesh false to reset the grid mesh later (e.g. ImageKey::resetGridMeshes)
+    void setDefaultImage(const img::ResourceHandle& aHandle, bool aResetGridMesh = true,
+                         const GridMesh::MeshingParam& aMeshing = GridMesh::MeshingParam());
+    void setDefaultImage(const img::ResourceHandle& aHandle, img::BlendMode aBlendMode,
+                         bool aResetGridMesh = true,
+                         const GridMesh::MeshingParam& aMeshing = GridMesh::MeshingParam());
     // default posture
     void setDefaultPosture(const QVector2D& aPos);
     // default depth
@@ -425,6 +425,7 @@ MeshKey::Data::Data()
     , mVertices()
     , mEdges()
     , mFaces()
+    , mSpatialIndex()
     , mPositions()
     , mTexCoords()
     , mIndices()
@@ -439,6 +440,7 @@ MeshKey::Data::Data(const Data& aRhs)
     , mVertices()
     , mEdges()
     , mFaces()
+    , mSpatialIndex()
     , mPositions(aRhs.mPositions)
     , mTexCoords(aRhs.mTexCoords)
     , mIndices(aRhs.mIndices)
@@ -512,6 +514,15 @@ void MeshKey::Data::copyVerticesEdgesAndFaces(const Data& aRhs)
                 *edgeMap[prevFace->edge(2)]);
         mFaces.push_back(nextFace);
     }
+    resetSpatialIndex();
+}
+
+void MeshKey::Data::resetSpatialIndex()
+{
+    mSpatialIndex.clear();
+    for (auto vtx : mVertices) mSpatialIndex.insert(*vtx);
+    for (auto edge : mEdges) mSpatialIndex.insert(*edge);
+    for (auto face : mFaces) mSpatialIndex.insert(*face);
 }
 
 void MeshKey::Data::destroy()
@@ -524,6 +535,7 @@ void MeshKey::Data::destroy()
     mFaces.clear();
     mEdges.clear();
     mVertices.clear();
+    mSpatialIndex.clear();
 }
 
 gl::BufferObject& MeshKey::Data::getIndexBuffer()
@@ -778,6 +790,9 @@ bool MeshKey::Data::deserialize(Deserializer& aIn)
     if (aIn.failure())
         return aIn.errored("stream error");
 
+    // update spatial index
+    resetSpatialIndex();
+
     // update gl attribute
     updateGLAttribute();
 
@@ -865,7 +880,7 @@ MeshFace* MeshKey::createTriangle(
     // create vertices
     if (!vtx[0])
     {
-        auto command = new MeshKeyUtil::CreateVtx(*this, mData.mVertices, aPos[0]);
+        auto command = new MeshKeyUtil::CreateVtx(*this, mData.mVertices, mData.mSpatialIndex, aPos[0]);
         command->exec();
         aCommands.push(command);
         vtx[0] = command->newVtx();
@@ -884,7 +899,7 @@ MeshFace* MeshKey::createTriangle(
 
     if (!vtx[1])
     {
-        auto command = new MeshKeyUtil::CreateVtx(*this, mData.mVertices, aPos[1]);
+        auto command = new MeshKeyUtil::CreateVtx(*this, mData.mVertices, mData.mSpatialIndex, aPos[1]);
         command->exec();
         aCommands.push(command);
         vtx[1] = command->newVtx();
@@ -899,7 +914,7 @@ MeshFace* MeshKey::createTriangle(
 
     if (!vtx[2])
     {
-        auto command = new MeshKeyUtil::CreateVtx(*this, mData.mVertices, aPos[2]);
+        auto command = new MeshKeyUtil::CreateVtx(*this, mData.mVertices, mData.mSpatialIndex, aPos[2]);
         command->exec();
         aCommands.push(command);
         vtx[2] = command->newVtx();
@@ -910,7 +925,7 @@ MeshFace* MeshKey::createTriangle(
     // create edges
     if (!edge[0])
     {
-        auto command = new MeshKeyUtil::CreateEdge(mData.mEdges, *vtx[0], *vtx[1]);
+        auto command = new MeshKeyUtil::CreateEdge(mData.mEdges, mData.mSpatialIndex, *vtx[0], *vtx[1]);
         command->exec();
         aCommands.push(command);
         edge[0] = command->newEdge();
@@ -918,7 +933,7 @@ MeshFace* MeshKey::createTriangle(
     }
     if (!edge[1])
     {
-        auto command = new MeshKeyUtil::CreateEdge(mData.mEdges, *vtx[1], *vtx[2]);
+        auto command = new MeshKeyUtil::CreateEdge(mData.mEdges, mData.mSpatialIndex, *vtx[1], *vtx[2]);
         command->exec();
         aCommands.push(command);
         edge[1] = command->newEdge();
@@ -926,7 +941,7 @@ MeshFace* MeshKey::createTriangle(
     }
     if (!edge[2])
     {
-        auto command = new MeshKeyUtil::CreateEdge(mData.mEdges, *vtx[2], *vtx[0]);
+        auto command = new MeshKeyUtil::CreateEdge(mData.mEdges, mData.mSpatialIndex, *vtx[2], *vtx[0]);
         command->exec();
         aCommands.push(command);
         edge[2] = command->newEdge();
@@ -943,7 +958,7 @@ MeshFace* MeshKey::createTriangle(
     if (!face)
     {
         auto command = new MeshKeyUtil::CreateFace(
-                           mData.mFaces, *edge[0], *edge[1], *edge[2]);
+                           mData.mFaces, mData.mSpatialIndex, *edge[0], *edge[1], *edge[2]);
         command->exec();
         aCommands.push(command);
         face = command->newFace();
@@ -980,7 +995,7 @@ void MeshKey::listNeedToRemove(MeshVtx& aStartingVtx, cmnd::Vector& aCommands)
             if (!killFaces.contains(face))
             {
                 killFaces.push_back(face);
-                aCommands.push(new MeshKeyUtil::RemoveFace(mData.mFaces, *face));
+                aCommands.push(new MeshKeyUtil::RemoveFace(mData.mFaces, mData.mSpatialIndex, *face));
             }
         }
     }
@@ -997,7 +1012,7 @@ void MeshKey::listNeedToRemove(MeshVtx& aStartingVtx, cmnd::Vector& aCommands)
                 if (!killEdges.contains(edge))
                 {
                     killEdges.push_back(edge);
-                    aCommands.push(new MeshKeyUtil::RemoveEdge(mData.mEdges, *edge));
+                    aCommands.push(new MeshKeyUtil::RemoveEdge(mData.mEdges, mData.mSpatialIndex, *edge));
                 }
             }
         }
@@ -1008,7 +1023,7 @@ void MeshKey::listNeedToRemove(MeshVtx& aStartingVtx, cmnd::Vector& aCommands)
     {
         killVertices.push_back(&aStartingVtx);
         aCommands.push(new MeshKeyUtil::RemoveVtx(
-                           *this, mData.mVertices, aStartingVtx));
+                           *this, mData.mVertices, mData.mSpatialIndex, aStartingVtx));
     }
     for (auto edge : killEdges)
     {
@@ -1021,7 +1036,7 @@ void MeshKey::listNeedToRemove(MeshVtx& aStartingVtx, cmnd::Vector& aCommands)
                 {
                     killVertices.push_back(vtx);
                     aCommands.push(new MeshKeyUtil::RemoveVtx(
-                                       *this, mData.mVertices, *vtx));
+                                       *this, mData.mVertices, mData.mSpatialIndex, *vtx));
                 }
             }
 
@@ -1049,7 +1064,7 @@ void MeshKey::listNeedToRemove(MeshFace& aStartingFace, cmnd::Vector& aCommands)
     QVector<MeshFace*> killFaces;
     {
         killFaces.push_back(&aStartingFace);
-        aCommands.push(new MeshKeyUtil::RemoveFace(mData.mFaces, aStartingFace));
+        aCommands.push(new MeshKeyUtil::RemoveFace(mData.mFaces, mData.mSpatialIndex, aStartingFace));
     }
 
     // find edges to kill
@@ -1062,7 +1077,7 @@ void MeshKey::listNeedToRemove(MeshFace& aStartingFace, cmnd::Vector& aCommands)
             if (!killEdges.contains(edge))
             {
                 killEdges.push_back(edge);
-                aCommands.push(new MeshKeyUtil::RemoveEdge(mData.mEdges, *edge));
+                aCommands.push(new MeshKeyUtil::RemoveEdge(mData.mEdges, mData.mSpatialIndex, *edge));
             }
         }
 
@@ -1081,7 +1096,7 @@ void MeshKey::listNeedToRemove(MeshFace& aStartingFace, cmnd::Vector& aCommands)
                 {
                     killVertices.push_back(vtx);
                     aCommands.push(new MeshKeyUtil::RemoveVtx(
-                                       *this, mData.mVertices, *vtx));
+                                       *this, mData.mVertices, mData.mSpatialIndex, *vtx));
                 }
             }
         }
@@ -1188,7 +1203,7 @@ MeshVtx* MeshKey::splitTriangle(
         }
         for (auto face : killFaces)
         {
-            auto command = new MeshKeyUtil::RemoveFace(mData.mFaces, *face);
+            auto command = new MeshKeyUtil::RemoveFace(mData.mFaces, mData.mSpatialIndex, *face);
             command->exec();
             aCommands.push(command);
         }
@@ -1202,7 +1217,7 @@ MeshVtx* MeshKey::splitTriangle(
 
     // remove edge need to split
     {
-        auto command = new MeshKeyUtil::RemoveEdge(mData.mEdges, aEdgeSide);
+        auto command = new MeshKeyUtil::RemoveEdge(mData.mEdges, mData.mSpatialIndex, aEdgeSide);
         command->exec();
         aCommands.push(command);
     }
@@ -1210,7 +1225,7 @@ MeshVtx* MeshKey::splitTriangle(
     // create center vertex
     MeshVtx* centerVtx = nullptr;
     {
-        auto command = new MeshKeyUtil::CreateVtx(*this, mData.mVertices, aPosOnEdge);
+        auto command = new MeshKeyUtil::CreateVtx(*this, mData.mVertices, mData.mSpatialIndex, aPosOnEdge);
         command->exec();
         centerVtx = command->newVtx();
         aCommands.push(command);
@@ -1219,7 +1234,7 @@ MeshVtx* MeshKey::splitTriangle(
     // create flank edge
     MeshEdge* flankEdge0 = nullptr;
     {
-        auto command = new MeshKeyUtil::CreateEdge(mData.mEdges, *centerVtx, *flankVtx0);
+        auto command = new MeshKeyUtil::CreateEdge(mData.mEdges, mData.mSpatialIndex, *centerVtx, *flankVtx0);
         command->exec();
         flankEdge0 = command->newEdge();
         aCommands.push(command);
@@ -1228,7 +1243,7 @@ MeshVtx* MeshKey::splitTriangle(
     // create flank edge
     MeshEdge* flankEdge1 = nullptr;
     {
-        auto command = new MeshKeyUtil::CreateEdge(mData.mEdges, *centerVtx, *flankVtx1);
+        auto command = new MeshKeyUtil::CreateEdge(mData.mEdges, mData.mSpatialIndex, *centerVtx, *flankVtx1);
         command->exec();
         flankEdge1 = command->newEdge();
         aCommands.push(command);
@@ -1240,7 +1255,7 @@ MeshVtx* MeshKey::splitTriangle(
         XC_PTR_ASSERT(oppoVtx);
 
         // split edge
-        auto edgeCommand = new MeshKeyUtil::CreateEdge(mData.mEdges, *centerVtx, *oppoVtx);
+        auto edgeCommand = new MeshKeyUtil::CreateEdge(mData.mEdges, mData.mSpatialIndex, *centerVtx, *oppoVtx);
         edgeCommand->exec();
         auto centerEdge = edgeCommand->newEdge();
         aCommands.push(edgeCommand);
@@ -1250,7 +1265,7 @@ MeshVtx* MeshKey::splitTriangle(
         auto cornerEdge0 = MeshKeyUtil::findEdge(flankVtx0, oppoVtx);
         XC_PTR_ASSERT(cornerEdge0);
         auto faceCommand0 = new MeshKeyUtil::CreateFace(
-                                mData.mFaces, *centerEdge, *cornerEdge0, *flankEdge0);
+                                mData.mFaces, mData.mSpatialIndex, *centerEdge, *cornerEdge0, *flankEdge0);
         faceCommand0->exec();
         aCommands.push(faceCommand0);
 
@@ -1258,7 +1273,7 @@ MeshVtx* MeshKey::splitTriangle(
         auto cornerEdge1 = MeshKeyUtil::findEdge(flankVtx1, oppoVtx);
         XC_PTR_ASSERT(cornerEdge1);
         auto faceCommand1 = new MeshKeyUtil::CreateFace(
-                                mData.mFaces, *centerEdge, *cornerEdge1, *flankEdge1);
+                                mData.mFaces, mData.mSpatialIndex, *centerEdge, *cornerEdge1, *flankEdge1);
         faceCommand1->exec();
         aCommands.push(faceCommand1);
     }
@@ -1307,7 +1322,7 @@ MeshVtx* MeshKey::splitTriangle(
         killFaces.push_back(&aFace);
         for (auto face : killFaces)
         {
-            auto command = new MeshKeyUtil::RemoveFace(mData.mFaces, *face);
+            auto command = new MeshKeyUtil::RemoveFace(mData.mFaces, mData.mSpatialIndex, *face);
             command->exec();
             aCommands.push(command);
         }
@@ -1325,7 +1340,7 @@ MeshVtx* MeshKey::splitTriangle(
     // remove edge need to split
     for (int i = 0; i < 2; ++i)
     {
-        auto command = new MeshKeyUtil::RemoveEdge(mData.mEdges, *edges[i]);
+        auto command = new MeshKeyUtil::RemoveEdge(mData.mEdges, mData.mSpatialIndex, *edges[i]);
         command->exec();
         aCommands.push(command);
     }
@@ -1337,7 +1352,7 @@ MeshVtx* MeshKey::splitTriangle(
     {
         // create center vertex
         {
-            auto command = new MeshKeyUtil::CreateVtx(*this, mData.mVertices, poses[i]);
+            auto command = new MeshKeyUtil::CreateVtx(*this, mData.mVertices, mData.mSpatialIndex, poses[i]);
             command->exec();
             centerVtx[i] = command->newVtx();
             aCommands.push(command);
@@ -1346,7 +1361,7 @@ MeshVtx* MeshKey::splitTriangle(
         // create flank edge
         {
             auto command = new MeshKeyUtil::CreateEdge(
-                               mData.mEdges, *centerVtx[i], *flankVtx[i]);
+                               mData.mEdges, mData.mSpatialIndex, *centerVtx[i], *flankVtx[i]);
             command->exec();
             flankEdgeA[i] = command->newEdge();
             aCommands.push(command);
@@ -1355,7 +1370,7 @@ MeshVtx* MeshKey::splitTriangle(
         // create flank edge
         {
             auto command = new MeshKeyUtil::CreateEdge(
-                               mData.mEdges, *centerVtx[i], *commonVtx);
+                               mData.mEdges, mData.mSpatialIndex, *centerVtx[i], *commonVtx);
             command->exec();
             flankEdgeB[i] = command->newEdge();
             aCommands.push(command);
@@ -1371,7 +1386,7 @@ MeshVtx* MeshKey::splitTriangle(
 
             // split edge
             auto edgeCommand = new MeshKeyUtil::CreateEdge(
-                                   mData.mEdges, *centerVtx[i], *oppoVtx);
+                                   mData.mEdges, mData.mSpatialIndex, *centerVtx[i], *oppoVtx);
             edgeCommand->exec();
             auto centerEdge = edgeCommand->newEdge();
             aCommands.push(edgeCommand);
@@ -1381,7 +1396,7 @@ MeshVtx* MeshKey::splitTriangle(
             auto cornerEdge0 = MeshKeyUtil::findEdge(flankVtx[i], oppoVtx);
             XC_PTR_ASSERT(cornerEdge0);
             auto faceCommand0 = new MeshKeyUtil::CreateFace(
-                                    mData.mFaces, *centerEdge, *cornerEdge0, *flankEdgeA[i]);
+                                    mData.mFaces, mData.mSpatialIndex, *centerEdge, *cornerEdge0, *flankEdgeA[i]);
             faceCommand0->exec();
             aCommands.push(faceCommand0);
 
@@ -1389,7 +1404,7 @@ MeshVtx* MeshKey::splitTriangle(
             auto cornerEdge1 = MeshKeyUtil::findEdge(commonVtx, oppoVtx);
             XC_PTR_ASSERT(cornerEdge1);
             auto faceCommand1 = new MeshKeyUtil::CreateFace(
-                                    mData.mFaces, *centerEdge, *cornerEdge1, *flankEdgeB[i]);
+                                    mData.mFaces, mData.mSpatialIndex, *centerEdge, *cornerEdge1, *flankEdgeB[i]);
             faceCommand1->exec();
             aCommands.push(faceCommand1);
         }
@@ -1401,7 +1416,7 @@ MeshVtx* MeshKey::splitTriangle(
         MeshEdge* centerEdge = nullptr;
         {
             auto command = new MeshKeyUtil::CreateEdge(
-                               mData.mEdges, *centerVtx[0], *centerVtx[1]);
+                               mData.mEdges, mData.mSpatialIndex, *centerVtx[0], *centerVtx[1]);
             command->exec();
             centerEdge = command->newEdge();
             aCommands.push(command);
@@ -1410,7 +1425,7 @@ MeshVtx* MeshKey::splitTriangle(
         MeshEdge* appendEdge = nullptr;
         {
             auto command = new MeshKeyUtil::CreateEdge(
-                               mData.mEdges, *centerVtx[0], *flankVtx[1]);
+                               mData.mEdges, mData.mSpatialIndex, *centerVtx[0], *flankVtx[1]);
             command->exec();
             appendEdge = command->newEdge();
             aCommands.push(command);
@@ -1418,7 +1433,7 @@ MeshVtx* MeshKey::splitTriangle(
         // create face A
         {
             auto command = new MeshKeyUtil::CreateFace(
-                               mData.mFaces, *flankEdgeB[0],
+                               mData.mFaces, mData.mSpatialIndex, *flankEdgeB[0],
                                *flankEdgeB[1], *centerEdge);
             command->exec();
             aCommands.push(command);
@@ -1426,7 +1441,7 @@ MeshVtx* MeshKey::splitTriangle(
         // create face B
         {
             auto command = new MeshKeyUtil::CreateFace(
-                               mData.mFaces, *centerEdge,
+                               mData.mFaces, mData.mSpatialIndex, *centerEdge,
                                *flankEdgeA[1], *appendEdge);
             command->exec();
             aCommands.push(command);
@@ -1434,7 +1449,7 @@ MeshVtx* MeshKey::splitTriangle(
         // create face C
         {
             auto command = new MeshKeyUtil::CreateFace(
-                               mData.mFaces, *flankEdgeA[0],
+                               mData.mFaces, mData.mSpatialIndex, *flankEdgeA[0],
                                *appendEdge, *anotherEdge);
             command->exec();
             aCommands.push(command);
@@ -1447,6 +1462,7 @@ MeshVtx* MeshKey::splitTriangle(
 void MeshKey::moveVtx(MeshVtx& aVtx, const QVector2D& aPos)
 {
     aVtx.set(aPos);
+    mData.mSpatialIndex.update(aVtx);
     auto index = aVtx.index();
     XC_ASSERT(index >= 0);
     mData.mPositions[index].set(aPos.toVector3D());
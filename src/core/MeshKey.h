@@ -11,6 +11,7 @@
 #include "cmnd/Vector.h"
 #include "core/TimeKey.h"
 #include "core/LayerMesh.h"
+#include "core/MeshSpatialIndex.h"
 
 namespace core
 {
@@ -157,6 +158,7 @@ public:
         const VtxList& vertices() const { return mVertices; }
         const EdgeList& edges() const { return mEdges; }
         const FaceList& faces() const { return mFaces; }
+        const MeshSpatialIndex& spatialIndex() const { return mSpatialIndex; }
 
         void setOriginOffset(const QVector2D& aOffset) { mOriginOffset = aOffset; }
 
@@ -184,6 +186,7 @@ public:
         void updateVtxIndices();
         void updateGLAttribute();
         void resetIndexBuffer();
+        void resetSpatialIndex();
         bool serialize(Serializer& aOut) const;
         bool deserialize(Deserializer& aIn);
 
@@ -191,6 +194,7 @@ public:
         VtxList mVertices;
         EdgeList mEdges;
         FaceList mFaces;
+        MeshSpatialIndex mSpatialIndex;
         QVector<gl::Vector3> mPositions;
         QVector<gl::Vector2> mTexCoords;
         QVector<GLuint> mIndices;
@@ -6,8 +6,10 @@ namespace core
 
 //-------------------------------------------------------------------------------------------------
 MeshKeyUtil::CreateFace::CreateFace(
-        QList<MeshFace*>& aFaceList, MeshEdge& aEdge0, MeshEdge& aEdge1, MeshEdge& aEdge2)
+        QList<MeshFace*>& aFaceList, MeshSpatialIndex& aIndex,
+        MeshEdge& aEdge0, MeshEdge& aEdge1, MeshEdge& aEdge2)
     : mFaceList(aFaceList)
+    , mSpatialIndex(aIndex)
     , mNewFace()
     , mEdges()
 {
@@ -27,6 +29,7 @@ void MeshKeyUtil::CreateFace::redo()
 {
     mNewFace->set(*mEdges[0], *mEdges[1], *mEdges[2]);
     mFaceList.push_back(mNewFace.get());
+    mSpatialIndex.insert(*mNewFace);
     mNewFace.done();
 }
 
@@ -35,14 +38,16 @@ void MeshKeyUtil::CreateFace::undo()
     XC_ASSERT(!mFaceList.empty());
     XC_ASSERT(mFaceList.back() == mNewFace.get());
     mFaceList.pop_back();
+    mSpatialIndex.remove(*mNewFace);
     mNewFace->clear();
     mNewFace.undone();
 }
 
 //-------------------------------------------------------------------------------------------------
 MeshKeyUtil::CreateEdge::CreateEdge(
-        QList<MeshEdge*>& aEdgeList, MeshVtx& aVtx0, MeshVtx& aVtx1)
+        QList<MeshEdge*>& aEdgeList, MeshSpatialIndex& aIndex, MeshVtx& aVtx0, MeshVtx& aVtx1)
     : mEdgeList(aEdgeList)
+    , mSpatialIndex(aIndex)
     , mNewEdge()
     , mVtxs()
 {
@@ -61,6 +66,7 @@ void MeshKeyUtil::CreateEdge::redo()
 {
     mNewEdge->set(*mVtxs[0], *mVtxs[1]);
     mEdgeList.push_back(mNewEdge.get());
+    mSpatialIndex.insert(*mNewEdge);
     mNewEdge.done();
 }
 
@@ -69,14 +75,16 @@ void MeshKeyUtil::CreateEdge::undo()
     XC_ASSERT(!mEdgeList.empty());
     XC_ASSERT(mEdgeList.back() == mNewEdge.get());
     mEdgeList.pop_back();
+    mSpatialIndex.remove(*mNewEdge);
     mNewEdge->clear();
     mNewEdge.undone();
 }
 
 //-------------------------------------------------------------------------------------------------
 MeshKeyUtil::CreateVtx::CreateVtx(
-        MeshKey& aKey, QList<MeshVtx*>& aVtxList, const QVector2D& aPos)
-    : mKey(aKey), mVtxList(aVtxList), mNewVtx(), mPos(aPos)
+        MeshKey& aKey, QList<MeshVtx*>& aVtxList,
+        MeshSpatialIndex& aIndex, const QVector2D& aPos)
+    : mKey(aKey), mVtxList(aVtxList), mSpatialIndex(aIndex), mNewVtx(), mPos(aPos)
 {
 }
 
@@ -91,6 +99,7 @@ void MeshKeyUtil::CreateVtx::redo()
 {
     mNewVtx->setIndex(mVtxList.count());
     mVtxList.push_back(mNewVtx.get());
+    mSpatialIndex.insert(*mNewVtx);
 
     auto pos = gl::Vector3::make(mPos.x(), mPos.y(), 0.0f);
     for (auto child : mKey.children())
@@ -106,6 +115,7 @@ void MeshKeyUtil::CreateVtx::undo()
     XC_ASSERT(!mVtxList.empty());
     XC_ASSERT(mVtxList.back() == mNewVtx.get());
     mVtxList.pop_back();
+    mSpatialIndex.remove(*mNewVtx);
 
     for (auto child : mKey.children())
     {
@@ -116,8 +126,10 @@ void MeshKeyUtil::CreateVtx::undo()
 }
 
 //-------------------------------------------------------------------------------------------------
-MeshKeyUtil::RemoveFace::RemoveFace(QList<MeshFace*>& aFaceList, MeshFace& aDelFace)
+MeshKeyUtil::RemoveFace::RemoveFace(
+        QList<MeshFace*>& aFaceList, MeshSpatialIndex& aIndex, MeshFace& aDelFace)
     : mFaceList(aFaceList)
+    , mSpatialIndex(aIndex)
     , mDelFace(&aDelFace)
     , mPrevEdges()
     , mIndex()
@@ -138,6 +150,7 @@ void MeshKeyUtil::RemoveFace::exec()
 void MeshKeyUtil::RemoveFace::redo()
 {
     mFaceList.removeAt(mIndex);
+    mSpatialIndex.remove(*mDelFace);
     mDelFace->clear();
     mDelFace.done();
 }
@@ -146,12 +159,15 @@ void MeshKeyUtil::RemoveFace::undo()
 {
     mDelFace->set(*mPrevEdges[0], *mPrevEdges[1], *mPrevEdges[2]);
     mFaceList.insert(mIndex, mDelFace.get());
+    mSpatialIndex.insert(*mDelFace);
     mDelFace.undone();
 }
 
 //-------------------------------------------------------------------------------------------------
-MeshKeyUtil::RemoveEdge::RemoveEdge(QList<MeshEdge*>& aEdgeList, MeshEdge& aDelEdge)
+MeshKeyUtil::RemoveEdge::RemoveEdge(
+        QList<MeshEdge*>& aEdgeList, MeshSpatialIndex& aIndex, MeshEdge& aDelEdge)
     : mEdgeList(aEdgeList)
+    , mSpatialIndex(aIndex)
     , mDelEdge(&aDelEdge)
     , mPrevVtxs()
     , mIndex()
@@ -172,6 +188,7 @@ void MeshKeyUtil::RemoveEdge::exec()
 void MeshKeyUtil::RemoveEdge::redo()
 {
     mEdgeList.removeAt(mIndex);
+    mSpatialIndex.remove(*mDelEdge);
     mDelEdge->clear();
     mDelEdge.done();
 }
@@ -180,13 +197,16 @@ void MeshKeyUtil::RemoveEdge::undo()
 {
     mDelEdge->set(*mPrevVtxs[0], *mPrevVtxs[1]);
     mEdgeList.insert(mIndex, mDelEdge.get());
+    mSpatialIndex.insert(*mDelEdge);
     mDelEdge.undone();
 }
 
 //-------------------------------------------------------------------------------------------------
-MeshKeyUtil::RemoveVtx::RemoveVtx(MeshKey& aKey, QList<MeshVtx*>& aVtxList, MeshVtx& aDelVtx)
+MeshKeyUtil::RemoveVtx::RemoveVtx(
+        MeshKey& aKey, QList<MeshVtx*>& aVtxList, MeshSpatialIndex& aIndex, MeshVtx& aDelVtx)
     : mKey(aKey)
     , mVtxList(aVtxList)
+    , mSpatialIndex(aIndex)
     , mDelVtx(&aDelVtx)
     , mPrevFFDs()
     , mIndex()
@@ -203,6 +223,7 @@ void MeshKeyUtil::RemoveVtx::exec()
 void MeshKeyUtil::RemoveVtx::redo()
 {
     mVtxList.removeAt(mIndex);
+    mSpatialIndex.remove(*mDelVtx);
     mKey.updateVtxIndices();
 
     mPrevFFDs.clear();
@@ -217,6 +238,7 @@ void MeshKeyUtil::RemoveVtx::redo()
 void MeshKeyUtil::RemoveVtx::undo()
 {
     mVtxList.insert(mIndex, mDelVtx.get());
+    mSpatialIndex.insert(*mDelVtx);
     mKey.updateVtxIndices();
 
     int i = 0;
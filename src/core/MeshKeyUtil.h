@@ -18,11 +18,13 @@ public:
     class CreateFace : public cmnd::Stable
     {
         QList<MeshFace*>& mFaceList;
+        MeshSpatialIndex& mSpatialIndex;
         cmnd::UndoneDeleter<MeshFace> mNewFace;
         std::array<MeshEdge*, 3> mEdges;
 
     public:
         CreateFace(QList<MeshFace*>& aFaceList,
+                    MeshSpatialIndex& aIndex,
                     MeshEdge& aEdge0,
                     MeshEdge& aEdge1,
                     MeshEdge& aEdge2);
@@ -38,11 +40,12 @@ public:
     class CreateEdge : public cmnd::Stable
     {
         QList<MeshEdge*>& mEdgeList;
+        MeshSpatialIndex& mSpatialIndex;
         cmnd::UndoneDeleter<MeshEdge> mNewEdge;
         std::array<MeshVtx*, 2> mVtxs;
 
     public:
-        CreateEdge(QList<MeshEdge*>& aEdgeList,
+        CreateEdge(QList<MeshEdge*>& aEdgeList, MeshSpatialIndex& aIndex,
                     MeshVtx& aVtx0, MeshVtx& aVtx1);
 
         MeshEdge* newEdge() { return mNewEdge.get(); }
@@ -57,11 +60,13 @@ public:
     {
         MeshKey& mKey; // for ffd key
         QList<MeshVtx*>& mVtxList;
+        MeshSpatialIndex& mSpatialIndex;
         cmnd::UndoneDeleter<MeshVtx> mNewVtx;
         QVector2D mPos;
 
     public:
-        CreateVtx(MeshKey& aKey, QList<MeshVtx*>& aVtxList, const QVector2D& aPos);
+        CreateVtx(MeshKey& aKey, QList<MeshVtx*>& aVtxList,
+                  MeshSpatialIndex& aIndex, const QVector2D& aPos);
 
         MeshVtx* newVtx() { return mNewVtx.get(); }
 
@@ -75,12 +80,13 @@ public:
     class RemoveFace : public cmnd::Stable
     {
         QList<MeshFace*>& mFaceList;
+        MeshSpatialIndex& mSpatialIndex;
         cmnd::DoneDeleter<MeshFace> mDelFace;
         std::array<MeshEdge*, 3> mPrevEdges;
         int mIndex;
 
     public:
-        RemoveFace(QList<MeshFace*>& aFaceList, MeshFace& aDelFace);
+        RemoveFace(QList<MeshFace*>& aFaceList, MeshSpatialIndex& aIndex, MeshFace& aDelFace);
 
         virtual void exec();
         virtual void redo();
@@ -91,12 +97,13 @@ public:
     class RemoveEdge : public cmnd::Stable
     {
         QList<MeshEdge*>& mEdgeList;
+        MeshSpatialIndex& mSpatialIndex;
         cmnd::DoneDeleter<MeshEdge> mDelEdge;
         std::array<MeshVtx*, 2> mPrevVtxs;
         int mIndex;
 
     public:
-        RemoveEdge(QList<MeshEdge*>& aEdgeList, MeshEdge& aDelEdge);
+        RemoveEdge(QList<MeshEdge*>& aEdgeList, MeshSpatialIndex& aIndex, MeshEdge& aDelEdge);
 
         virtual void exec();
         virtual void redo();
@@ -108,12 +115,14 @@ public:
     {
         MeshKey& mKey; // for ffd key, for update vertex indices
         QList<MeshVtx*>& mVtxList;
+        MeshSpatialIndex& mSpatialIndex;
         cmnd::DoneDeleter<MeshVtx> mDelVtx;
         QVector<gl::Vector3> mPrevFFDs;
         int mIndex;
 
     public:
-        RemoveVtx(MeshKey& aKey, QList<MeshVtx*>& aVtxList, MeshVtx& aDelVtx);
+        RemoveVtx(MeshKey& aKey, QList<MeshVtx*>& aVtxList,
+                  MeshSpatialIndex& aIndex, MeshVtx& aDelVtx);
 
         virtual void exec();
         virtual void redo();
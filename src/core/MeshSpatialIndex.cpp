@@ -0,0 +1,217 @@
+#include <cmath>
+#include <algorithm>
+#include "XC.h"
+#include "core/MeshSpatialIndex.h"
+#include "core/MeshKey.h"
+
+namespace
+{
+
+QRectF getBoundingRect(const QVector2D& aV0, const QVector2D& aV1)
+{
+    const float l = std::min(aV0.x(), aV1.x());
+    const float t = std::min(aV0.y(), aV1.y());
+    const float r = std::max(aV0.x(), aV1.x());
+    const float b = std::max(aV0.y(), aV1.y());
+    return QRectF(QPointF(l, t), QPointF(r, b));
+}
+
+}
+
+namespace core
+{
+
+//-------------------------------------------------------------------------------------------------
+template <typename tPrim>
+void MeshSpatialIndex::Layer<tPrim>::clear()
+{
+    mCells.clear();
+    mRanges.clear();
+}
+
+template <typename tPrim>
+void MeshSpatialIndex::Layer<tPrim>::insert(tPrim* aPrim, const QRect& aCells)
+{
+    remove(aPrim);
+
+    for (int y = aCells.top(); y <= aCells.bottom(); ++y)
+    {
+        for (int x = aCells.left(); x <= aCells.right(); ++x)
+        {
+            mCells[cellKey(x, y)].push_back(aPrim);
+        }
+    }
+    mRanges.insert(aPrim, aCells);
+}
+
+template <typename tPrim>
+void MeshSpatialIndex::Layer<tPrim>::remove(const tPrim* aPrim)
+{
+    auto rangeItr = mRanges.find(aPrim);
+    if (rangeItr == mRanges.end()) return;
+
+    const QRect cells = rangeItr.value();
+    mRanges.erase(rangeItr);
+
+    for (int y = cells.top(); y <= cells.bottom(); ++y)
+    {
+        for (int x = cells.left(); x <= cells.right(); ++x)
+        {
+            auto cellItr = mCells.find(cellKey(x, y));
+            if (cellItr == mCells.end()) continue;
+
+            QVector<tPrim*>& prims = cellItr.value();
+            const int index = prims.indexOf(const_cast<tPrim*>(aPrim));
+            if (index >= 0)
+            {
+                // the order in a cell is meaningless
+                prims[index] = prims.back();
+                prims.pop_back();
+            }
+            if (prims.isEmpty())
+            {
+                mCells.erase(cellItr);
+            }
+        }
+    }
+}
+
+template <typename tPrim>
+QVector<tPrim*> MeshSpatialIndex::Layer<tPrim>::find(const QRect& aCells) const
+{
+    QVector<tPrim*> result;
+    const qint64 cellCount = (qint64)aCells.width() * aCells.height();
+
+    if (cellCount > mCells.size())
+    {
+        // a wide range, walking the existing cells is cheaper
+        for (auto cellItr = mCells.begin(); cellItr != mCells.end(); ++cellItr)
+        {
+            const int x = (int)(quint32)(cellItr.key() >> 32);
+            const int y = (int)(quint32)(cellItr.key() & 0xffffffff);
+            if (aCells.contains(x, y)) result += cellItr.value();
+        }
+    }
+    else
+    {
+        for (int y = aCells.top(); y <= aCells.bottom(); ++y)
+        {
+            for (int x = aCells.left(); x <= aCells.right(); ++x)
+            {
+                auto cellItr = mCells.find(cellKey(x, y));
+                if (cellItr == mCells.end()) continue;
+                result += cellItr.value();
+            }
+        }
+    }
+
+    // a primitive which overlaps some cells appears repeatedly
+    if (cellCount > 1)
+    {
+        std::sort(result.begin(), result.end());
+        result.erase(std::unique(result.begin(), result.end()), result.end());
+    }
+    return result;
+}
+
+//-------------------------------------------------------------------------------------------------
+MeshSpatialIndex::MeshSpatialIndex(float aCellSize)
+    : mCellSize(aCellSize)
+    , mVertices()
+    , mEdges()
+    , mFaces()
+{
+    XC_ASSERT(mCellSize > 0.0f);
+}
+
+void MeshSpatialIndex::clear()
+{
+    mVertices.clear();
+    mEdges.clear();
+    mFaces.clear();
+}
+
+void MeshSpatialIndex::insert(MeshVtx& aVtx)
+{
+    const QVector2D pos = aVtx.vec();
+    mVertices.insert(&aVtx, cellRange(getBoundingRect(pos, pos)));
+}
+
+void MeshSpatialIndex::insert(MeshEdge& aEdge)
+{
+    if (!aEdge.vtx(0) || !aEdge.vtx(1)) return;
+    mEdges.insert(&aEdge, cellRange(getBoundingRect(aEdge.start(), aEdge.end())));
+}
+
+void MeshSpatialIndex::insert(MeshFace& aFace)
+{
+    if (!aFace.edge(0) || !aFace.edge(1) || !aFace.edge(2)) return;
+    auto vtx = aFace.vertices();
+    const QRectF rect =
+            getBoundingRect(vtx[0]->vec(), vtx[1]->vec()).united(
+                getBoundingRect(vtx[1]->vec(), vtx[2]->vec()));
+    mFaces.insert(&aFace, cellRange(rect));
+}
+
+void MeshSpatialIndex::remove(const MeshVtx& aVtx)
+{
+    mVertices.remove(&aVtx);
+}
+
+void MeshSpatialIndex::remove(const MeshEdge& aEdge)
+{
+    mEdges.remove(&aEdge);
+}
+
+void MeshSpatialIndex::remove(const MeshFace& aFace)
+{
+    mFaces.remove(&aFace);
+}
+
+void MeshSpatialIndex::update(MeshVtx& aVtx)
+{
+    insert(aVtx);
+
+    for (auto edgeNode = aVtx.edges(); edgeNode; edgeNode = edgeNode->next)
+    {
+        MeshEdge* edge = edgeNode->parent;
+        insert(*edge);
+
+        for (auto faceNode = edge->faces(); faceNode; faceNode = faceNode->next)
+        {
+            insert(*faceNode->parent);
+        }
+    }
+}
+
+QVector<MeshVtx*> MeshSpatialIndex::findVertices(const QRectF& aRect) const
+{
+    return mVertices.find(cellRange(aRect));
+}
+
+QVector<MeshEdge*> MeshSpatialIndex::findEdges(const QRectF& aRect) const
+{
+    return mEdges.find(cellRange(aRect));
+}
+
+QVector<MeshFace*> MeshSpatialIndex::findFaces(const QRectF& aRect) const
+{
+    return mFaces.find(cellRange(aRect));
+}
+
+quint64 MeshSpatialIndex::cellKey(int aX, int aY)
+{
+    return ((quint64)(quint32)aX << 32) | (quint64)(quint32)aY;
+}
+
+QRect MeshSpatialIndex::cellRange(const QRectF& aRect) const
+{
+    const QRectF rect = aRect.normalized();
+    const int l = (int)std::floor(rect.left() / mCellSize);
+    const int t = (int)std::floor(rect.top() / mCellSize);
+    const int r = (int)std::floor(rect.right() / mCellSize);
+    const int b = (int)std::floor(rect.bottom() / mCellSize);
+    return QRect(QPoint(l, t), QPoint(r, b));
+}
+
+} // namespace core
@@ -0,0 +1,67 @@
+#ifndef CORE_MESHSPATIALINDEX_H
+#define CORE_MESHSPATIALINDEX_H
+
+#include <QHash>
+#include <QRect>
+#include <QRectF>
+#include <QVector>
+#include "util/NonCopyable.h"
+
+namespace core
+{
+
+class MeshVtx;
+class MeshEdge;
+class MeshFace;
+
+//-------------------------------------------------------------------------------------------------
+// uniform grid over the model space of a mesh key.
+// each primitive is registered in every cell its bounding box overlaps.
+class MeshSpatialIndex : private util::NonCopyable
+{
+public:
+    MeshSpatialIndex(float aCellSize = 32.0f);
+
+    void clear();
+
+    void insert(MeshVtx& aVtx);
+    void insert(MeshEdge& aEdge);
+    void insert(MeshFace& aFace);
+    void remove(const MeshVtx& aVtx);
+    void remove(const MeshEdge& aEdge);
+    void remove(const MeshFace& aFace);
+
+    // refresh a moved vertex and all edges and faces which connect to it
+    void update(MeshVtx& aVtx);
+
+    // candidates whose bounding boxes overlap the model space rect
+    QVector<MeshVtx*> findVertices(const QRectF& aRect) const;
+    QVector<MeshEdge*> findEdges(const QRectF& aRect) const;
+    QVector<MeshFace*> findFaces(const QRectF& aRect) const;
+
+private:
+    template <typename tPrim>
+    class Layer
+    {
+    public:
+        void clear();
+        void insert(tPrim* aPrim, const QRect& aCells);
+        void remove(const tPrim* aPrim);
+        QVector<tPrim*> find(const QRect& aCells) const;
+    private:
+        QHash<quint64, QVector<tPrim*>> mCells;
+        QHash<const tPrim*, QRect> mRanges;
+    };
+
+    static quint64 cellKey(int aX, int aY);
+    QRect cellRange(const QRectF& aRect) const;
+
+    float mCellSize;
+    Layer<MeshVtx> mVertices;
+    Layer<MeshEdge> mEdges;
+    Layer<MeshFace> mFaces;
+};
+
+} // namespace core
+
+#endif // CORE_MESHSPATIALINDEX_H
@@ -1,5 +1,7 @@
 #include "gl/Global.h"
 #include "gl/Util.h"
+#include "gl/GPUProfiler.h"
+#include "util/Profiler.h"
 #include "core/MeshTransformer.h"
 #include "core/MeshTransformerResource.h"
 #include "core/ObjectNodeUtil.h"
@@ -43,6 +45,8 @@ void MeshTransformer::callGL(
         bool aNonPosed, bool aUseInfluence)
 {
     XC_ASSERT(aPositions);
+    util::ProfileZone zone("mesh transform");
+    gl::GPUProfileZone gpuZone("mesh transform");
 
     auto& buffer = aMeshBuffer;
     const int outCount = buffer.vtxCount;
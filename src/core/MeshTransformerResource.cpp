@@ -1,6 +1,7 @@
 #include <QFile>
 #include "gl/Global.h"
 #include "gl/ExtendShader.h"
+#include "gl/ProgramRegistry.h"
 #include "core/MeshTransformerResource.h"
 
 namespace core
@@ -8,29 +9,27 @@ namespace core
 
 //-------------------------------------------------------------------------------------------------
 MeshTransformerResource::MeshTransformerResource()
+    : mProgram()
 {
 }
 
 void MeshTransformerResource::setup(const QString& aShaderPath)
 {
-    QString code;
-    loadFile(aShaderPath, code);
-
-    buildShader(mProgram[0], code, false, false);
-    buildShader(mProgram[1], code, true, false);
-    buildShader(mProgram[2], code, true, true);
+    mProgram[0] = &acquireShader(aShaderPath, false, false);
+    mProgram[1] = &acquireShader(aShaderPath, true, false);
+    mProgram[2] = &acquireShader(aShaderPath, true, true);
 }
 
 gl::EasyShaderProgram& MeshTransformerResource::program(bool aUseSkinning, bool aUseDualQuaternion)
 {
-    return !aUseSkinning ? mProgram[0] :
-        (!aUseDualQuaternion ? mProgram[1] : mProgram[2]);
+    return *(!aUseSkinning ? mProgram[0] :
+        (!aUseDualQuaternion ? mProgram[1] : mProgram[2]));
 }
 
 const gl::EasyShaderProgram& MeshTransformerResource::program(bool aUseSkinning, bool aUseDualQuaternion) const
 {
-    return !aUseSkinning ? mProgram[0] :
-        (!aUseDualQuaternion ? mProgram[1] : mProgram[2]);
+    return *(!aUseSkinning ? mProgram[0] :
+        (!aUseDualQuaternion ? mProgram[1] : mProgram[2]));
 }
 
 
@@ -46,51 +45,50 @@ void MeshTransformerResource::loadFile(const QString& aPath, QString& aDstCode)
     aDstCode = in.readAll();
 }
 
-void MeshTransformerResource::buildShader(
-        gl::EasyShaderProgram& aProgram, const QString& aCode,
-        bool aUseSkinning, bool aUseDualQuaternion)
+gl::EasyShaderProgram& MeshTransformerResource::acquireShader(
+        const QString& aPath, bool aUseSkinning, bool aUseDualQuaternion)
 {
-    gl::Global::Functions& ggl = gl::Global::functions();
-
-    gl::ExtendShader source;
-
-    // parse shader source
-    source.openFromTextVert(aCode);
-
-    // set variation
-    source.setVariationValue("USE_SKINNING", QString::number(aUseSkinning ? 1 : 0));
-    source.setVariationValue("USE_DUAL_QUATERNION", QString::number(aUseDualQuaternion ? 1 : 0));
-
-    // resolve variation
-    if (!source.resolveVariation())
+    const QString useSkinning = QString::number(aUseSkinning ? 1 : 0);
+    const QString useDualQuaternion = QString::number(aUseDualQuaternion ? 1 : 0);
+    const QString id = "MeshTransform:" + aPath +
+            ":USE_SKINNING=" + useSkinning +
+            ",USE_DUAL_QUATERNION=" + useDualQuaternion +
+            ",feedback=outPosition/outXArrow/outYArrow";
+
+    auto sourceFunc = [=](gl::ExtendShader& aSource)
     {
-        XC_FATAL_ERROR("OpenGL Error", "Failed to resolve shader variation.",
-                       source.log());
-    }
-
-    // set shader source
-    if (!aProgram.setVertexSource(source))
-    {
-        XC_FATAL_ERROR("OpenGL Error", "Failed to compile vertex shader.",
-                       aProgram.log());
-    }
-
-    // feedback
+        // parse shader source
+        QString code;
+        loadFile(aPath, code);
+        aSource.openFromTextVert(code);
+
+        // set variation
+        aSource.setVariationValue("USE_SKINNING", useSkinning);
+        aSource.setVariationValue("USE_DUAL_QUATERNION", useDualQuaternion);
+
+        // resolve variation
+        if (!aSource.resolveVariation())
+        {
+            XC_FATAL_ERROR("OpenGL Error", "Failed to resolve shader variation.",
+                           aSource.log());
+        }
+    };
+
+    auto preLinkFunc = [](gl::EasyShaderProgram& aProgram)
     {
+        // feedback
         static const GLchar* kVaryings[] = {
             "outPosition", "outXArrow", "outYArrow"
         };
-        ggl.glTransformFeedbackVaryings(aProgram.id(), 3, kVaryings, GL_SEPARATE_ATTRIBS);
-    }
+        gl::Global::functions().glTransformFeedbackVaryings(
+                    aProgram.id(), 3, kVaryings, GL_SEPARATE_ATTRIBS);
+    };
 
-    // link shader
-    if (!aProgram.link())
-    {
-        XC_FATAL_ERROR("OpenGL Error", "Failed to link shader.",
-                       aProgram.log());
-    }
+    gl::EasyShaderProgram& program =
+            gl::ProgramRegistry::acquire(id, sourceFunc, preLinkFunc);
 
-    XC_ASSERT(ggl.glGetError() == GL_NO_ERROR);
+    XC_ASSERT(gl::Global::functions().glGetError() == GL_NO_ERROR);
+    return program;
 }
 
 } // namespace core
@@ -16,11 +16,11 @@ public:
 
 private:
     void loadFile(const QString& aPath, QString& aDstCode);
-    void buildShader(
-            gl::EasyShaderProgram& aProgram, const QString& aCode,
-            bool aUseSkinning, bool aUseDualQuaternion);
+    gl::EasyShaderProgram& acquireShader(
+            const QString& aPath, bool aUseSkinning, bool aUseDualQuaternion);
 
-    gl::EasyShaderProgram mProgram[3];
+    // shared programs of gl::ProgramRegistry
+    gl::EasyShaderProgram* mProgram[3];
 };
 
 } // namespace core
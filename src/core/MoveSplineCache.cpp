@@ -0,0 +1,107 @@
+#include "XC.h"
+#include <QMutexLocker>
+#include "core/MoveSplineCache.h"
+#include "core/MoveKey.h"
+
+namespace core
+{
+
+//-------------------------------------------------------------------------------------------------
+MoveSplineCache::Segment::Segment()
+    : frame1(-1)
+    , pos0()
+    , pos1()
+    , vel0()
+    , vel1()
+    , spline()
+{
+}
+
+bool MoveSplineCache::Segment::isBuiltOf(
+        int aFrame1, const QVector2D& aPos0, const QVector2D& aPos1,
+        const QVector2D& aVel0, const QVector2D& aVel1) const
+{
+    return frame1 == aFrame1 && pos0 == aPos0 && pos1 == aPos1 &&
+            vel0 == aVel0 && vel1 == aVel1;
+}
+
+//-------------------------------------------------------------------------------------------------
+MoveSplineCache::MoveSplineCache()
+    : mMutex()
+    , mSegments()
+    , mBuildCount(0)
+{
+}
+
+QVector2D MoveSplineCache::getPos(
+        const TimeLine::MapType& aMap,
+        const MoveKey* aPrev, const MoveKey* aKey0, int aFrame0,
+        const MoveKey* aKey1, int aFrame1, const MoveKey* aNext,
+        float aRate)
+{
+    XC_ASSERT(aKey0 && aKey1);
+
+    // the velocities depend on the neighbours and the spline types
+    auto vels = MoveKey::getCatmullRomVels(aPrev, aKey0, aKey1, aNext);
+    const QVector2D pos0 = aKey0->pos();
+    const QVector2D pos1 = aKey1->pos();
+
+    QMutexLocker locker(&mMutex);
+
+    auto itr = mSegments.find(aFrame0);
+    if (itr == mSegments.end())
+    {
+        // a segment for each key at most
+        if (mSegments.size() >= aMap.size()) prune(aMap);
+        itr = mSegments.insert(aFrame0, Segment());
+    }
+
+    Segment& segment = itr.value();
+    if (!segment.isBuiltOf(aFrame1, pos0, pos1, vels[0], vels[1]))
+    {
+        segment.frame1 = aFrame1;
+        segment.pos0 = pos0;
+        segment.pos1 = pos1;
+        segment.vel0 = vels[0];
+        segment.vel1 = vels[1];
+        segment.spline.set(pos0, pos1, vels[0], vels[1]);
+        ++mBuildCount;
+    }
+    return segment.spline.getByLinear(aRate).toVector2D();
+}
+
+void MoveSplineCache::clear()
+{
+    QMutexLocker locker(&mMutex);
+    mSegments.clear();
+}
+
+int MoveSplineCache::segmentCount() const
+{
+    QMutexLocker locker(&mMutex);
+    return mSegments.size();
+}
+
+int MoveSplineCache::buildCount() const
+{
+    QMutexLocker locker(&mMutex);
+    return mBuildCount;
+}
+
+void MoveSplineCache::prune(const TimeLine::MapType& aMap)
+{
+    auto itr = mSegments.begin();
+    while (itr != mSegments.end())
+    {
+        if (aMap.contains(itr.key()))
+        {
+            ++itr;
+        }
+        else
+        {
+            itr = mSegments.erase(itr);
+        }
+    }
+}
+
+} // namespace core
@@ -0,0 +1,64 @@
+#ifndef CORE_MOVESPLINECACHE_H
+#define CORE_MOVESPLINECACHE_H
+
+#include <QMap>
+#include <QMutex>
+#include <QVector2D>
+#include <QVector3D>
+#include "util/NonCopyable.h"
+#include "util/FergusonCoonsSpline.h"
+#include "core/TimeLine.h"
+namespace core { class MoveKey; }
+
+namespace core
+{
+
+// Keeps the linearized splines of the segments between the move keys of a
+// timeline, for the current and the working blending and for any frame.
+// A segment is keyed by the frame of its first key, and is built again only
+// if its keys or their neighbours have changed since it was built.
+// The blending of the render-ahead thread shares the cache.
+class MoveSplineCache : private util::NonCopyable
+{
+public:
+    typedef util::FergusonCoonsSpline<QVector3D> SplineType;
+
+    MoveSplineCache();
+
+    // returns the position at the rate of the segment from aKey0 to aKey1.
+    // aPrev and aNext are the keys around the segment, or null.
+    QVector2D getPos(const TimeLine::MapType& aMap,
+                     const MoveKey* aPrev, const MoveKey* aKey0, int aFrame0,
+                     const MoveKey* aKey1, int aFrame1, const MoveKey* aNext,
+                     float aRate);
+    void clear();
+
+    int segmentCount() const;
+    // the count of the segments which have been built
+    int buildCount() const;
+
+private:
+    struct Segment
+    {
+        Segment();
+        bool isBuiltOf(int aFrame1, const QVector2D& aPos0, const QVector2D& aPos1,
+                       const QVector2D& aVel0, const QVector2D& aVel1) const;
+        int frame1;
+        QVector2D pos0;
+        QVector2D pos1;
+        QVector2D vel0;
+        QVector2D vel1;
+        SplineType spline;
+    };
+
+    // removes the segments whose first key doesn't exist
+    void prune(const TimeLine::MapType& aMap);
+
+    mutable QMutex mMutex;
+    QMap<int, Segment> mSegments;
+    int mBuildCount;
+};
+
+} // namespace core
+
+#endif // CORE_MOVESPLINECACHE_H
@@ -28,6 +28,7 @@ void fPushRenderClippeeRecursive(
 {
     core::Renderer::SortUnit unit;
     unit.renderer = aNode.renderer();
+    unit.node = &aNode;
     unit.depth = aAccessor.get(aNode).worldDepth();
     aDest.push_back(unit);
 
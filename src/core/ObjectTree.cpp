@@ -2,6 +2,9 @@
 #include <functional>
 #include "util/LinkPointer.h"
 #include "util/TreeUtil.h"
+#include "util/Profiler.h"
+#include "util/HashUtil.h"
+#include "gl/GPUProfiler.h"
 #include "cmnd/Stable.h"
 #include "cmnd/Vector.h"
 #include "cmnd/BasicCommands.h"
@@ -37,6 +40,7 @@ class SortAndRenderCall
                 {
                     Renderer::SortUnit unit;
                     unit.renderer = renderer;
+                    unit.node = aNode;
                     unit.depth = mAccessor->get(*aNode).worldDepth();
                     mArray.push_back(unit);
                 }
@@ -70,9 +74,11 @@ public:
                 const TimeCacheAccessor& aAccessor)
     {
         mAccessor = &aAccessor;
+        util::ProfileZone zone("render tree");
 
         // prerender
         {
+            util::ProfileZone prerenderZone("prerender");
             ObjectNode::Iterator itr(aTopNode);
             while (itr.hasNext())
             {
@@ -92,6 +98,8 @@ public:
         // render
         for (auto data : mArray)
         {
+            util::ProfileZone nodeZone("node", data.node->name());
+            gl::GPUProfileZone gpuNodeZone("node", data.node->name());
             data.renderer->render(aInfo, aAccessor);
         }
     }
@@ -109,6 +117,7 @@ ObjectTree::ObjectTree()
     , mCaller(new SortAndRenderCall())
     , mShaderHolder()
     , mTimeCacheLock()
+    , mBake()
 {
 }
 
@@ -116,16 +125,55 @@ ObjectTree::~ObjectTree()
 {
 }
 
+int ObjectTree::updateBake(const TimeInfo& aTime)
+{
+    if (!mTopNode.data()) return 0;
+
+    // the render-ahead thread reads the bake in the working caches
+    QWriteLocker locker(&mTimeCacheLock.working);
+    return mBake.update(*mTopNode.data(), aTime);
+}
+
 void ObjectTree::render(const RenderInfo& aInfo, bool aUseWorkingCache)
 {
     if (mTopNode.data())
     {
+        QMutexLocker locker(&mTimeCacheLock.rendering);
         TimeCacheAccessor accessor(
-                    *mTopNode.data(), mTimeCacheLock, aInfo.time, aUseWorkingCache);
+                    *mTopNode.data(), mTimeCacheLock, aInfo.time, aUseWorkingCache, &mBake);
         mCaller->invoke(mTopNode.data(), aInfo, accessor);
     }
 }
 
+uint64 ObjectTree::fingerprint(const TimeInfo& aTime, bool aUseWorkingCache)
+{
+    uint64 hash = 0;
+    if (mTopNode.data())
+    {
+        QMutexLocker locker(&mTimeCacheLock.rendering);
+        TimeCacheAccessor accessor(
+                    *mTopNode.data(), mTimeCacheLock, aTime, aUseWorkingCache, &mBake);
+
+        auto hashNode = [&](const ObjectNode& aNode)
+        {
+            hash = util::HashUtil::combine(hash, aNode.isVisible() ? 1 : 0);
+            if (aNode.timeLine())
+            {
+                hash = util::HashUtil::combine(hash, accessor.get(aNode).fingerprint());
+            }
+        };
+
+        // the iterator doesn't contain the top node
+        hashNode(*mTopNode);
+        ObjectNode::ConstIterator itr(mTopNode.data());
+        while (itr.hasNext())
+        {
+            hashNode(*itr.next());
+        }
+    }
+    return hash;
+}
+
 cmnd::Vector ObjectTree::createNodeDeleter(ObjectNode& aNode)
 {
     cmnd::Vector commands;
@@ -346,16 +394,29 @@ cmnd::Vector ObjectTree::createResourceUpdater(const ResourceEvent& aEvent)
 
 void ObjectTree::onTimeLineModified(TimeLineEvent& aEvent, bool)
 {
+    {
+        QWriteLocker locker(&mTimeCacheLock.working);
+        mBake.invalidate(aEvent);
+    }
     BoneKeyUpdater::onTimeLineModified(aEvent);
 }
 
 void ObjectTree::onTreeRestructured(ObjectTreeEvent& aEvent, bool)
 {
+    {
+        QWriteLocker locker(&mTimeCacheLock.working);
+        mBake.invalidateAll();
+    }
     BoneKeyUpdater::onTreeRestructured(aEvent);
 }
 
 void ObjectTree::onResourceModified(ResourceEvent& aEvent, bool)
 {
+    // the updated resources can add the nodes
+    {
+        QWriteLocker locker(&mTimeCacheLock.working);
+        mBake.invalidateAll();
+    }
     BoneKeyUpdater::onResourceModified(aEvent);
 }
 
@@ -17,6 +17,7 @@
 #include "core/ProjectEvent.h"
 #include "core/ShaderHolder.h"
 #include "core/TimeCacheLock.h"
+#include "core/TimeLineBake.h"
 namespace core { class SortAndRenderCall; }
 
 namespace core
@@ -32,7 +33,7 @@ public:
     util::LifeLink::Pointee<ObjectTree> pointee() { return mLifeLink.pointee<ObjectTree>(this); }
     util::LifeLink::Pointee<const ObjectTree> constPointee() { return mLifeLink.pointee<const ObjectTree>(this); }
 
-    void grabTopNode(ObjectNode* aNode) { mTopNode.reset(aNode); }
+    void grabTopNode(ObjectNode* aNode) { mTopNode.reset(aNode); mBake.invalidateAll(); }
     ObjectNode* topNode() { return mTopNode.data(); }
     const ObjectNode* topNode() const { return mTopNode.data(); }
 
@@ -42,7 +43,16 @@ public:
     TimeCacheLock& timeCacheLock() { return mTimeCacheLock; }
     const TimeCacheLock& timeCacheLock() const { return mTimeCacheLock; }
 
+    // the baked tracks which the blending of the tree reads
+    const TimeLineBake& bake() const { return mBake; }
+    // bakes the tracks which were edited since the last one, under the
+    // lock of the working caches. returns the count of the baked tracks.
+    int updateBake(const TimeInfo& aTime);
+
     void render(const RenderInfo& aRenderInfo, bool aUseWorkingCache);
+    // hash of the blended states of all nodes at the time. same values
+    // render the same image unless the project is edited in between.
+    uint64 fingerprint(const TimeInfo& aTime, bool aUseWorkingCache);
 
     cmnd::Vector createNodeDeleter(ObjectNode& aNode);
     //cmnd::Vector createNodeMover(const util::TreePos& aFrom, const util::TreePos& aTo);
@@ -70,6 +80,7 @@ private:
     QScopedPointer<SortAndRenderCall> mCaller;
     ShaderHolder mShaderHolder;
     TimeCacheLock mTimeCacheLock;
+    TimeLineBake mBake;
 };
 
 } // namespace core
@@ -1,11 +1,12 @@
 #include <QFileInfo>
+#include <QElapsedTimer>
 #include <QUndoCommand>
 #include "XC.h"
+#include "util/Profiler.h"
 #include "core/Project.h"
 
 namespace
 {
-static const int kParaThreadCount = 4;
 static const int kStandardFps = 60;
 static const int kDefaultMaxFrame = 60 * 10;
 }
@@ -26,36 +27,44 @@ Project::Project(QString aFileName, Animator& aAnimator, Hook* aHookGrabbed)
     : mLifeLink()
     , mFileName(aFileName)
     , mAttribute()
-    , mParalleler(new thr::Paralleler(kParaThreadCount))
+    , mTaskGroup()
     , mResourceHolder()
     , mCommandStack()
     , mObjectTree()
     , mAnimator(aAnimator)
     , mHook(aHookGrabbed)
+    , mMeshingParam()
+    , mCoalescesTimeLineEvents(true)
+    , mPendingTimeLineEvents()
+    , mDispatchStats()
 {
     if (!aFileName.isEmpty())
     {
         setFileName(aFileName);
     }
 
+    // the pending events precede any other emission
     onTimeLineModified.connect([=](TimeLineEvent& aEvent, bool)
     {
+        flushTimeLineEvents();
         aEvent.setProject(*this);
     });
+    onNodeAttributeModified.connect([=](ObjectNode&, bool) { flushTimeLineEvents(); });
+    onResourceModified.connect([=](ResourceEvent&, bool) { flushTimeLineEvents(); });
+    onTreeRestructured.connect([=](ObjectTreeEvent&, bool) { flushTimeLineEvents(); });
+    onProjectAttributeModified.connect([=](ProjectEvent&, bool) { flushTimeLineEvents(); });
 
     onTimeLineModified.connect(&mObjectTree, &ObjectTree::onTimeLineModified);
     onTreeRestructured.connect(&mObjectTree, &ObjectTree::onTreeRestructured);
     onResourceModified.connect(&mObjectTree, &ObjectTree::onResourceModified);
     onProjectAttributeModified.connect(&mObjectTree, &ObjectTree::onProjectAttributeModified);
-
-#ifdef UNUSE_PARALLEL
-#else
-    mParalleler->start();
-#endif
 }
 
 Project::~Project()
 {
+    // the pending events refer to the nodes which the commands hold
+    mPendingTimeLineEvents.clear();
+
     // clear all command firstly
     mCommandStack.clear();
 }
@@ -66,6 +75,72 @@ void Project::setFileName(const QString& aFileName)
     mResourceHolder.setRootPath(QFileInfo(aFileName).path());
 }
 
+void Project::setCoalescesTimeLineEvents(bool aCoalesces)
+{
+    if (!aCoalesces)
+    {
+        flushTimeLineEvents();
+    }
+    mCoalescesTimeLineEvents = aCoalesces;
+}
+
+void Project::postTimeLineModified(TimeLineEvent& aEvent)
+{
+    ++mDispatchStats.postedCount;
+
+    if (!mCoalescesTimeLineEvents)
+    {
+        QElapsedTimer timer;
+        timer.start();
+        {
+            util::ProfileZone zone("timeline dispatch");
+            onTimeLineModified(aEvent, false);
+        }
+        ++mDispatchStats.dispatchCount;
+        mDispatchStats.dispatchNSec += timer.nsecsElapsed();
+        return;
+    }
+
+    // merges into the last one only, to keep the order of the types
+    if (!mPendingTimeLineEvents.isEmpty() &&
+            mPendingTimeLineEvents.back().type() == aEvent.type())
+    {
+        mPendingTimeLineEvents.back().merge(aEvent);
+    }
+    else
+    {
+        const bool isFirst = mPendingTimeLineEvents.isEmpty();
+        mPendingTimeLineEvents.push_back(aEvent);
+
+        // request a flush once per batch
+        if (isFirst)
+        {
+            onTimeLineEventsPosted();
+        }
+    }
+}
+
+void Project::flushTimeLineEvents()
+{
+    if (mPendingTimeLineEvents.isEmpty()) return;
+
+    // the emission flushes again, with the empty queue
+    QVector<TimeLineEvent> events;
+    events.swap(mPendingTimeLineEvents);
+
+    QElapsedTimer timer;
+    timer.start();
+    {
+        util::ProfileZone zone("timeline dispatch");
+        for (auto& event : events)
+        {
+            onTimeLineModified(event, false);
+        }
+    }
+    mDispatchStats.dispatchCount += events.size();
+    mDispatchStats.dispatchNSec += timer.nsecsElapsed();
+}
+
 TimeInfo Project::currentTimeInfo() const
 {
     TimeInfo time;
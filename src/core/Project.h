@@ -3,14 +3,16 @@
 
 #include <QSize>
 #include <QString>
+#include <QVector>
 #include <QScopedPointer>
 #include <functional>
 #include "util/LifeLink.h"
 #include "util/Signaler.h"
 #include "util/NonCopyable.h"
-#include "thr/Paralleler.h"
+#include "thr/Scheduler.h"
 #include "cmnd/Stack.h"
 #include "core/ObjectTree.h"
+#include "core/GridMesh.h"
 #include "core/Animator.h"
 #include "core/TimeInfo.h"
 #include "core/TimeLineEvent.h"
@@ -45,6 +47,15 @@ public:
         bool mLoop;
     };
 
+    // the cost of the dispatches of the posted timeline events
+    struct DispatchStats
+    {
+        DispatchStats() : postedCount(), dispatchCount(), dispatchNSec() {}
+        int postedCount;
+        int dispatchCount;
+        qint64 dispatchNSec;
+    };
+
     class Hook
     {
     public:
@@ -80,28 +91,51 @@ public:
     ObjectTree& objectTree() { return mObjectTree; }
     const ObjectTree& objectTree() const { return mObjectTree; }
 
-    thr::Paralleler& paralleler() { return *mParalleler; }
-    const thr::Paralleler& paralleler() const { return *mParalleler; }
+    // the tasks of the project on the scheduler of the application
+    thr::TaskGroup& taskGroup() { return mTaskGroup; }
+    const thr::TaskGroup& taskGroup() const { return mTaskGroup; }
 
     Hook* hook() { return mHook.data(); }
 
+    // the meshing options for the new meshes of the project
+    void setMeshingParam(const GridMesh::MeshingParam& aParam) { mMeshingParam = aParam; }
+    const GridMesh::MeshingParam& meshingParam() const { return mMeshingParam; }
+
+    // while coalescing, a posted event is merged into the pending one of the
+    // same type and is dispatched by flushTimeLineEvents(). the first post of
+    // a batch emits onTimeLineEventsPosted, and the display flushes them once
+    // before the next refresh. any emission of the signals below flushes the
+    // pending events first, so that the subscribers keep the order of events.
+    void setCoalescesTimeLineEvents(bool aCoalesces);
+    bool coalescesTimeLineEvents() const { return mCoalescesTimeLineEvents; }
+    void postTimeLineModified(TimeLineEvent& aEvent);
+    void flushTimeLineEvents();
+
+    const DispatchStats& dispatchStats() const { return mDispatchStats; }
+    void resetDispatchStats() { mDispatchStats = DispatchStats(); }
+
     util::Signaler<void(TimeLineEvent&, bool)> onTimeLineModified;
     util::Signaler<void(ObjectNode&, bool)> onNodeAttributeModified;
     util::Signaler<void(ResourceEvent&, bool)> onResourceModified;
     util::Signaler<void(ObjectTreeEvent&, bool)> onTreeRestructured;
     util::Signaler<void(ProjectEvent&, bool)> onProjectAttributeModified;
+    util::Signaler<void()> onTimeLineEventsPosted;
 
 private:
     util::LifeLink mLifeLink;
     QString mFileName;
     Attribute mAttribute;
 
-    QScopedPointer<thr::Paralleler> mParalleler;
+    thr::TaskGroup mTaskGroup;
     ResourceHolder mResourceHolder;
     cmnd::Stack mCommandStack;
     ObjectTree mObjectTree;
     Animator& mAnimator;
     QScopedPointer<Hook> mHook;
+    GridMesh::MeshingParam mMeshingParam;
+    bool mCoalescesTimeLineEvents;
+    QVector<TimeLineEvent> mPendingTimeLineEvents;
+    DispatchStats mDispatchStats;
 };
 
 } // namespace core
@@ -7,6 +7,7 @@
 #include "img/BlendMode.h"
 #include "core/RenderInfo.h"
 #include "core/TimeCacheAccessor.h"
+namespace core { class ObjectNode; }
 
 namespace core
 {
@@ -16,8 +17,9 @@ class Renderer
 public:
     struct SortUnit
     {
-        SortUnit() : renderer(), depth() {}
+        SortUnit() : renderer(), node(), depth() {}
         Renderer* renderer;
+        ObjectNode* node;
         float depth;
     };
 
@@ -8,26 +8,10 @@ SRTExpans::SRTExpans()
     , mRotate()
     , mScale(1.0f, 1.0f)
     , mCentroid()
-    , mSpline()
     , mParentMatrix()
-    , mSplineCache()
 {
 }
 
-bool SRTExpans::hasSplineCache(Frame aFrame) const
-{
-    if (aFrame <= 0 || mSplineCache.min() <= 0) return false;
-
-    if (mSplineCache.isNegative())
-    {
-        return aFrame >= mSplineCache.min() || aFrame <= mSplineCache.max();
-    }
-    else
-    {
-        return mSplineCache.contains(aFrame.getDecimal());
-    }
-}
-
 QMatrix4x4 SRTExpans::localCSRTMatrix() const
 {
     QMatrix4x4 mtx = localSRTMatrix();
@@ -4,7 +4,7 @@
 #include <QRect>
 #include <QMatrix4x4>
 #include "util/Range.h"
-#include "util/FergusonCoonsSpline.h"
+#include "util/MathUtil.h"
 #include "core/Frame.h"
 
 namespace core
@@ -13,16 +13,10 @@ namespace core
 class SRTExpans
 {
 public:
-    typedef util::FergusonCoonsSpline<QVector3D> SplineType;
-
     static QMatrix4x4 getLocalSRMatrix(float aRotate, const QVector2D& aScale);
 
     SRTExpans();
 
-    void setSplineCache(const util::Range& aFrame) { mSplineCache = aFrame; }
-    void clearSplineCache() { mSplineCache = util::Range(-1, 0); }
-    bool hasSplineCache(Frame aFrame) const;
-
     void setPos(const QVector2D& aPos) { mPos = aPos; }
     QVector2D pos() const { return mPos; }
 
@@ -35,9 +29,6 @@ public:
     void setCentroid(const QVector2D& aValue) { mCentroid = aValue; }
     QVector2D centroid() const { return mCentroid; }
 
-    SplineType& spline() { return mSpline; }
-    const SplineType& spline() const { return mSpline; }
-
     QMatrix4x4 localCSRTMatrix() const;
     QMatrix4x4 localSRTMatrix() const;
     QMatrix4x4 localSRMatrix() const;
@@ -53,9 +44,7 @@ private:
     float mRotate;
     QVector2D mScale;
     QVector2D mCentroid;
-    SplineType mSpline;
     QMatrix4x4 mParentMatrix;
-    util::Range mSplineCache;
 };
 
 } // namespace core
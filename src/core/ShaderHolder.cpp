@@ -1,7 +1,36 @@
 #include "gl/ExtendShader.h"
 #include "gl/Global.h"
+#include "gl/ProgramRegistry.h"
 #include "core/ShaderHolder.h"
 
+namespace
+{
+
+void openShaderFiles(gl::ExtendShader& aSource, const QString& aVertPath, const QString& aFragPath)
+{
+    if (!aSource.openFromFileVert(aVertPath))
+    {
+        XC_FATAL_ERROR("FileIO Error", "Failed to open vertex shader file.",
+                       aSource.log());
+    }
+    if (!aSource.openFromFileFrag(aFragPath))
+    {
+        XC_FATAL_ERROR("FileIO Error", "Failed to open fragment shader file.",
+                       aSource.log());
+    }
+}
+
+void resolveShaderVariation(gl::ExtendShader& aSource)
+{
+    if (!aSource.resolveVariation())
+    {
+        XC_FATAL_ERROR("OpenGL Error", "Failed to resolve shader variation.",
+                       aSource.log());
+    }
+}
+
+} // namespace
+
 namespace core
 {
 
@@ -19,23 +48,7 @@ ShaderHolder::ShaderHolder()
 
 ShaderHolder::~ShaderHolder()
 {
-    for (auto p : mShaders)
-    {
-        if (p) delete p;
-    }
-    for (auto p : mGridShaders)
-    {
-        if (p) delete p;
-    }
-    for (auto p : mClipperShaders)
-    {
-        if (p) delete p;
-    }
-    for (auto p : mHSVShaders)
-    {
-        if (p) delete p;
-    }
-
+    // the programs are owned by gl::ProgramRegistry
 }
 
 gl::EasyShaderProgram& ShaderHolder::reserveShader(img::BlendMode aBlendMode, bool aIsClippee)
@@ -43,43 +56,18 @@ gl::EasyShaderProgram& ShaderHolder::reserveShader(img::BlendMode aBlendMode, bo
     const int index = aBlendMode + img::BlendMode_TERM * (int)aIsClippee;
     if (!mShaders[index])
     {
-        mShaders[index] = new gl::EasyShaderProgram();
-        auto shader = mShaders[index];
-
-        gl::ExtendShader source;
-        if (!source.openFromFileVert("./data/shader/LayerDrawingVert.glsl"))
-        {
-            XC_FATAL_ERROR("FileIO Error", "Failed to open vertex shader file.",
-                           source.log());
-        }
-        if (!source.openFromFileFrag("./data/shader/LayerDrawingFrag.glsl"))
-        {
-            XC_FATAL_ERROR("FileIO Error", "Failed to open fragment shader file.",
-                           source.log());
-        }
-
-        auto blendFunc = QString("Blend") + img::getBlendFuncNameFromBlendMode(aBlendMode);
-        source.setVariationValue("BLEND_FUNC", blendFunc);
-
-        source.setVariationValue("IS_CLIPPEE", aIsClippee ? "1" : "0");
-
-        if (!source.resolveVariation())
-        {
-            XC_FATAL_ERROR("OpenGL Error", "Failed to resolve shader variation.",
-                           source.log());
-        }
-
-        if (!shader->setAllSource(source))
-        {
-            XC_FATAL_ERROR("OpenGL Error", "Failed to compile shader.",
-                           shader->log());
-        }
-
-        if (!shader->link())
-        {
-            XC_FATAL_ERROR("OpenGL Error", "Failed to link shader.",
-                           shader->log());
-        }
+        const QString blendFunc = QString("Blend") + img::getBlendFuncNameFromBlendMode(aBlendMode);
+        const QString isClippee = aIsClippee ? "1" : "0";
+        const QString id = "LayerDrawing:BLEND_FUNC=" + blendFunc + ",IS_CLIPPEE=" + isClippee;
+
+        mShaders[index] = &gl::ProgramRegistry::acquire(id, [=](gl::ExtendShader& aSource)
+        {
+            openShaderFiles(aSource, "./data/shader/LayerDrawingVert.glsl",
+                            "./data/shader/LayerDrawingFrag.glsl");
+            aSource.setVariationValue("BLEND_FUNC", blendFunc);
+            aSource.setVariationValue("IS_CLIPPEE", isClippee);
+            resolveShaderVariation(aSource);
+        });
     }
     return *mShaders[index];
 }
@@ -109,38 +97,12 @@ gl::EasyShaderProgram& ShaderHolder::reserveHSVShader()
     const int index = 0;
     if (!mHSVShaders[index])
     {
-        mHSVShaders[index] = new gl::EasyShaderProgram();
-        auto shader = mHSVShaders[index];
-
-        gl::ExtendShader source;
-        if (!source.openFromFileVert("./data/shader/HSVAdjustVert.glsl"))
+        mHSVShaders[index] = &gl::ProgramRegistry::acquire("HSVAdjust", [](gl::ExtendShader& aSource)
         {
-            XC_FATAL_ERROR("FileIO Error", "Failed to open vertex shader file.",
-                           source.log());
-        }
-        if (!source.openFromFileFrag("./data/shader/HSVAdjustFrag.glsl"))
-        {
-            XC_FATAL_ERROR("FileIO Error", "Failed to open fragment shader file.",
-                           source.log());
-        }
-
-        if (!source.resolveVariation())
-        {
-            XC_FATAL_ERROR("OpenGL Error", "Failed to resolve shader variation.",
-                           source.log());
-        }
-
-        if (!shader->setAllSource(source))
-        {
-            XC_FATAL_ERROR("OpenGL Error", "Failed to compile shader.",
-                           shader->log());
-        }
-
-        if (!shader->link())
-        {
-            XC_FATAL_ERROR("OpenGL Error", "Failed to link shader.",
-                           shader->log());
-        }
+            openShaderFiles(aSource, "./data/shader/HSVAdjustVert.glsl",
+                            "./data/shader/HSVAdjustFrag.glsl");
+            resolveShaderVariation(aSource);
+        });
     }
     return *mHSVShaders[index];
 }
@@ -168,38 +130,12 @@ gl::EasyShaderProgram& ShaderHolder::reserveGridShader()
 {
     if (!mGridShaders[0])
     {
-        mGridShaders[0] = new gl::EasyShaderProgram();
-        auto shader = mGridShaders[0];
-
-        gl::ExtendShader source;
-        if (!source.openFromFileVert("./data/shader/GridDrawingVert.glsl"))
-        {
-            XC_FATAL_ERROR("FileIO Error", "Failed to open vertex shader file.",
-                           source.log());
-        }
-        if (!source.openFromFileFrag("./data/shader/GridDrawingFrag.glsl"))
+        mGridShaders[0] = &gl::ProgramRegistry::acquire("GridDrawing", [](gl::ExtendShader& aSource)
         {
-            XC_FATAL_ERROR("FileIO Error", "Failed to open fragment shader file.",
-                           source.log());
-        }
-
-        if (!source.resolveVariation())
-        {
-            XC_FATAL_ERROR("OpenGL Error", "Failed to resolve shader variation.",
-                           source.log());
-        }
-
-        if (!shader->setAllSource(source))
-        {
-            XC_FATAL_ERROR("OpenGL Error", "Failed to compile shader.",
-                           shader->log());
-        }
-
-        if (!shader->link())
-        {
-            XC_FATAL_ERROR("OpenGL Error", "Failed to link shader.",
-                           shader->log());
-        }
+            openShaderFiles(aSource, "./data/shader/GridDrawingVert.glsl",
+                            "./data/shader/GridDrawingFrag.glsl");
+            resolveShaderVariation(aSource);
+        });
     }
     return *mGridShaders[0];
 }
@@ -221,42 +157,21 @@ gl::EasyShaderProgram& ShaderHolder::reserveClipperShader(bool aIsClippee)
 {
     if (!mClipperShaders.at(aIsClippee))
     {
-        mClipperShaders[aIsClippee] = new gl::EasyShaderProgram();
-        auto shader = mClipperShaders[aIsClippee];
-
-        gl::ExtendShader source;
-        if (!source.openFromFileVert("./data/shader/ClipperWritingVert.glsl"))
-        {
-            XC_FATAL_ERROR("FileIO Error", "Failed to open vertex shader file.",
-                           source.log());
-        }
-        if (!source.openFromFileFrag("./data/shader/ClipperWritingFrag.glsl"))
-        {
-            XC_FATAL_ERROR("FileIO Error", "Failed to open fragment shader file.",
-                           source.log());
-        }
+        const QString isClippee = aIsClippee ? "1" : "0";
+        const QString id = "ClipperWriting:IS_CLIPPEE=" + isClippee + ",oClip=0";
 
-        source.setVariationValue("IS_CLIPPEE", aIsClippee ? "1" : "0");
-
-        if (!source.resolveVariation())
+        auto sourceFunc = [=](gl::ExtendShader& aSource)
         {
-            XC_FATAL_ERROR("OpenGL Error", "Failed to resolve shader variation.",
-                           source.log());
-        }
-
-        if (!shader->setAllSource(source))
-        {
-            XC_FATAL_ERROR("OpenGL Error", "Failed to compile shader.",
-                           shader->log());
-        }
-
-        gl::Global::functions().glBindFragDataLocation(shader->id(), 0, "oClip");
-
-        if (!shader->link())
+            openShaderFiles(aSource, "./data/shader/ClipperWritingVert.glsl",
+                            "./data/shader/ClipperWritingFrag.glsl");
+            aSource.setVariationValue("IS_CLIPPEE", isClippee);
+            resolveShaderVariation(aSource);
+        };
+        auto preLinkFunc = [=](gl::EasyShaderProgram& aProgram)
         {
-            XC_FATAL_ERROR("OpenGL Error", "Failed to link shader.",
-                           shader->log());
-        }
+            gl::Global::functions().glBindFragDataLocation(aProgram.id(), 0, "oClip");
+        };
+        mClipperShaders[aIsClippee] = &gl::ProgramRegistry::acquire(id, sourceFunc, preLinkFunc);
     }
     return *mClipperShaders[aIsClippee];
 }
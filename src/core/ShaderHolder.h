@@ -35,6 +35,7 @@ public:
     const gl::EasyShaderProgram& clipperShader(bool aIsClippee) const;
 
 private:
+    // shared programs of gl::ProgramRegistry
     QVector<gl::EasyShaderProgram*> mShaders;
     QVector<gl::EasyShaderProgram*> mHSVShaders;
     QVector<gl::EasyShaderProgram*> mGridShaders;
@@ -9,7 +9,8 @@ namespace core
 
 TimeCacheAccessor::TimeCacheAccessor(
         ObjectNode& aRootNode, TimeCacheLock& aLock,
-        const TimeInfo& aTime, bool aUseWorking)
+        const TimeInfo& aTime, bool aUseWorking,
+        const TimeLineBake* aBake)
     : mLockRef(aUseWorking ? aLock.working : aLock.current)
     , mUseWorking(aUseWorking)
 {
@@ -27,8 +28,13 @@ TimeCacheAccessor::TimeCacheAccessor(
         mLockRef.unlock();
         mLockRef.lockForWrite();
 
-        TimeKeyBlender blender(aRootNode, aUseWorking);
-        blender.updateCurrents(&aRootNode, aTime);
+        // another thread can update the caches before the write lock
+        if (!timeLine || !expans->hasMasterCache(aTime.frame))
+        {
+            TimeKeyBlender blender(aRootNode, aUseWorking);
+            blender.setBake(aBake);
+            blender.updateCurrents(&aRootNode, aTime);
+        }
     }
 }
 
@@ -7,6 +7,7 @@ namespace core { class TimeLine; }
 namespace core { class TimeInfo; }
 namespace core { class TimeCacheLock; }
 namespace core { class TimeKeyExpans; }
+namespace core { class TimeLineBake; }
 
 namespace core
 {
@@ -17,9 +18,11 @@ class TimeCacheAccessor
     bool mUseWorking;
 
 public:
+    // the blending of missing caches reads the bake if it is given
     TimeCacheAccessor(
             ObjectNode& aRootNode, TimeCacheLock& aLock,
-            const TimeInfo& aTime, bool aUseWorking);
+            const TimeInfo& aTime, bool aUseWorking,
+            const TimeLineBake* aBake = nullptr);
     ~TimeCacheAccessor();
     const TimeKeyExpans& get(const ObjectNode& aNode) const;
     const TimeKeyExpans& get(const TimeLine& aLine) const;
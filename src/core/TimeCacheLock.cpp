@@ -6,6 +6,7 @@ namespace core
 TimeCacheLock::TimeCacheLock()
     : working()
     , current()
+    , rendering(QMutex::Recursive)
 {
 }
 
@@ -2,6 +2,7 @@
 #define CORE_TIMECACHELOCK_H
 
 #include <QReadWriteLock>
+#include <QMutex>
 
 namespace core
 {
@@ -12,6 +13,9 @@ public:
     TimeCacheLock();
     QReadWriteLock working;
     QReadWriteLock current;
+
+    // renderers keep the states of their last rendering
+    QMutex rendering;
 };
 
 } // namespace core
@@ -1,11 +1,15 @@
 #include "util/TreeIterator.h"
 #include "util/TreeSeekIterator.h"
 #include "util/MathUtil.h"
+#include "util/Profiler.h"
+#include "util/EasingTable.h"
 #include "core/TimeKeyExpans.h"
 #include "core/TimeKeyBlender.h"
 #include "core/LayerMesh.h"
 #include "core/ObjectNodeUtil.h"
 #include "core/DepthKey.h"
+#include "core/TimeLineBake.h"
+#include "core/MoveSplineCache.h"
 
 namespace core
 {
@@ -212,6 +216,7 @@ QVector2D TimeKeyBlender::getCentroid(const ObjectNode& aNode, const TimeInfo& a
 TimeKeyBlender::TimeKeyBlender(ObjectTree& aTree)
     : mSeeker()
     , mRoot()
+    , mBake()
 {
     static ObjectTreeSeeker sSeeker(false);
     mSeeker = &sSeeker;
@@ -221,6 +226,7 @@ TimeKeyBlender::TimeKeyBlender(ObjectTree& aTree)
 TimeKeyBlender::TimeKeyBlender(ObjectNode& aRootNode, bool aUseWorking)
     : mSeeker()
     , mRoot()
+    , mBake()
 {
     if (aUseWorking)
     {
@@ -239,17 +245,17 @@ TimeKeyBlender::TimeKeyBlender(ObjectNode& aRootNode, bool aUseWorking)
 TimeKeyBlender::TimeKeyBlender(SeekerType& aSeeker, PositionType aRoot)
     : mSeeker(&aSeeker)
     , mRoot(aRoot)
+    , mBake()
 {
 }
 
 void TimeKeyBlender::updateCurrents(ObjectNode* aRootNode, const TimeInfo& aTime)
 {
-    {
-        util::TreeSeekIterator<SeekData, ObjectNode*> itr(*mSeeker, mRoot);
+    util::ProfileZone zone("blend");
 
-        while (itr.hasNext())
+    {
+        auto blendNode = [&](PositionType pos)
         {
-            auto pos = itr.next();
             XC_ASSERT(pos);
 
             // build move, rotate and scale
@@ -278,7 +284,24 @@ void TimeKeyBlender::updateCurrents(ObjectNode* aRootNode, const TimeInfo& aTime
 
             // build ffd
             blendFFDKey(pos, aTime);
+        };
 
+        // the evaluation list of the bake is in the order of the tree
+        const ObjectNode* bakeTop = mBake ? mBake->topNode() : nullptr;
+        if (bakeTop && mSeeker->position(const_cast<ObjectNode*>(bakeTop)) == mRoot)
+        {
+            for (auto& entry : mBake->evaluationList())
+            {
+                blendNode(mSeeker->position(entry.node));
+            }
+        }
+        else
+        {
+            util::TreeSeekIterator<SeekData, ObjectNode*> itr(*mSeeker, mRoot);
+            while (itr.hasNext())
+            {
+                blendNode(itr.next());
+            }
         }
     }
 
@@ -382,8 +405,8 @@ float getEasingRateFromTwoKeys(const TimeKeyGatherer& aGatherer)
     const tKey* k0 = (const tKey*)p0.key;
 
     // calculate easing
-    return util::Easing::calculate(
-                k0->data().easing(), -p0.relativeFrame, 0.0f, 1.0f, frame);
+    return util::EasingTable::instance().rate(
+                k0->data().easing(), -p0.relativeFrame / frame);
 }
 
 template<class tKey, TimeKeyType tType>
@@ -433,20 +456,10 @@ void TimeKeyBlender::getMoveExpans(SRTExpans& aExpans, const ObjectNode& aNode,
         // calculate easing
         const float time = getEasingRateFromTwoKeys<MoveKey>(blend);
 
-        // use spline cache
-        if (aExpans.hasSplineCache(aTime.frame))
-        {
-            aExpans.setPos(aExpans.spline().getByLinear(time).toVector2D());
-        }
-        else
-        {
-            // linear blending
-            auto vels = MoveKey::getCatmullRomVels(kn, k0, k1, k2);
-            aExpans.spline().set(k0->pos(), k1->pos(), vels[0], vels[1]);
-            aExpans.setSplineCache(util::Range(p0.frame, p1.frame));
-
-            aExpans.setPos(aExpans.spline().getByLinear(time).toVector2D());
-        }
+        // the spline of the segment is cached by the timeline
+        const TimeLine& line = *aNode.timeLine();
+        aExpans.setPos(line.moveSplineCache().getPos(
+                           line.map(TimeKeyType_Move), kn, k0, p0.frame, k1, p1.frame, k2, time));
 
         aExpans.setCentroid(k0->centroid() * (1.0f - time) + k1->centroid() * time);
     }
@@ -506,6 +519,114 @@ void TimeKeyBlender::getScaleExpans(SRTExpans& aExpans, const ObjectNode& aNode,
     }
 }
 
+float TimeKeyBlender::getDepth(const ObjectNode& aNode, const TimeInfo& aTime)
+{
+    XC_ASSERT(aNode.timeLine());
+    TimeKeyGatherer blend(aNode.timeLine()->map(TimeKeyType_Depth), aTime);
+
+    if (blend.isEmpty())
+    { // no key is exists
+        auto defaultKey = (const DepthKey*)aNode.timeLine()->defaultKey(TimeKeyType_Depth);
+        return defaultKey ? defaultKey->depth() : DepthKey::Data().depth();
+    }
+    else if (blend.hasSameFrame())
+    { // a key is exists
+        return ((const DepthKey*)blend.point(0).key)->depth();
+    }
+    else if (blend.isSingle())
+    { // perfect following
+        return ((const DepthKey*)blend.singlePoint().key)->depth();
+    }
+    else
+    {
+        const DepthKey* k0 = (const DepthKey*)blend.point(0).key;
+        const DepthKey* k1 = (const DepthKey*)blend.point(1).key;
+        // calculate easing
+        const float time = getEasingRateFromTwoKeys<DepthKey>(blend);
+        // blend
+        return k0->depth() * (1.0f - time) + k1->depth() * time;
+    }
+}
+
+void TimeKeyBlender::getOpaData(OpaKey::Data& aData, const ObjectNode& aNode, const TimeInfo& aTime)
+{
+    XC_ASSERT(aNode.timeLine());
+    TimeKeyGatherer blend(aNode.timeLine()->map(TimeKeyType_Opa), aTime);
+
+    if (blend.isEmpty())
+    { // no key is exists
+        auto defaultKey = (const OpaKey*)aNode.timeLine()->defaultKey(TimeKeyType_Opa);
+        aData = defaultKey ? defaultKey->data() : OpaKey::Data();
+    }
+    else if (blend.hasSameFrame())
+    { // a key is exists
+        aData = ((const OpaKey*)blend.point(0).key)->data();
+    }
+    else if (blend.isSingle())
+    { // perfect following
+        aData = ((const OpaKey*)blend.singlePoint().key)->data();
+    }
+    else
+    {
+        const OpaKey* k0 = (const OpaKey*)blend.point(0).key;
+        const OpaKey* k1 = (const OpaKey*)blend.point(1).key;
+        // calculate easing
+        const float time = getEasingRateFromTwoKeys<OpaKey>(blend);
+        // blend
+        aData.setOpacity(k0->opacity() * (1.0f - time) + k1->opacity() * time);
+    }
+}
+
+const HSVKey::Data* TimeKeyBlender::getHSVData(
+        HSVKey::Data& aData, const ObjectNode& aNode, const TimeInfo& aTime)
+{
+    static const HSVKey::Data kDefaultData;
+
+    XC_ASSERT(aNode.timeLine());
+    TimeKeyGatherer blend(aNode.timeLine()->map(TimeKeyType_HSV), aTime);
+
+    const HSVKey::Data* source = nullptr;
+    if (blend.isEmpty())
+    { // no key is exists
+        auto defaultKey = (const HSVKey*)aNode.timeLine()->defaultKey(TimeKeyType_HSV);
+        source = defaultKey ? &defaultKey->data() : &kDefaultData;
+    }
+    else if (blend.hasSameFrame())
+    { // a key is exists
+        source = &((const HSVKey*)blend.point(0).key)->data();
+    }
+    else if (blend.isSingle())
+    { // perfect following
+        source = &((const HSVKey*)blend.singlePoint().key)->data();
+    }
+    else
+    {
+        // calculate hsv change
+        const float time = getEasingRateFromTwoKeys<HSVKey>(blend);
+        const HSVKey* k0 = (const HSVKey*)blend.point(0).key;
+        const HSVKey* k1 = (const HSVKey*)blend.point(1).key;
+        for (int x = 0; x < 3; x+=1){
+            // blend
+            switch(x){
+            case 0: aData.setHue(k0->hsv().at(0) * (1.0f - time) + k1->hsv().at(0) * time);
+                    break;
+            case 1: aData.setSaturation(k0->hsv().at(1) * (1.0f - time) + k1->hsv().at(1) * time);
+                    break;
+            case 2: aData.setValue(k0->hsv().at(2) * (1.0f - time) + k1->hsv().at(2) * time);
+                    break;
+            }
+        }
+        return nullptr;
+    }
+    aData = *source;
+    return source;
+}
+
+float TimeKeyBlender::getPoseEasingRate(const TimeKeyGatherer& aGatherer)
+{
+    return getEasingRateFromTwoKeys<PoseKey>(aGatherer);
+}
+
 void TimeKeyBlender::blendSRTKeys(PositionType aPos, const TimeInfo& aTime)
 {
     auto seekData = mSeeker->data(aPos);
@@ -515,14 +636,39 @@ void TimeKeyBlender::blendSRTKeys(PositionType aPos, const TimeInfo& aTime)
     if (!node.timeLine()) return;
     auto frame = aTime.frame;
 
+    QVector2D pos, centroid, scale;
+    float rotate = 0.0f;
+
     expans.setKeyCache(TimeKeyType_Move, frame);
-    getMoveExpans(expans.srt(), node, aTime);
+    if (mBake && mBake->getMove(node, aTime, pos, centroid))
+    {
+        expans.srt().setPos(pos);
+        expans.srt().setCentroid(centroid);
+    }
+    else
+    {
+        getMoveExpans(expans.srt(), node, aTime);
+    }
 
     expans.setKeyCache(TimeKeyType_Rotate, frame);
-    getRotateExpans(expans.srt(), node, aTime);
+    if (mBake && mBake->getRotate(node, aTime, rotate))
+    {
+        expans.srt().setRotate(rotate);
+    }
+    else
+    {
+        getRotateExpans(expans.srt(), node, aTime);
+    }
 
     expans.setKeyCache(TimeKeyType_Scale, frame);
-    getScaleExpans(expans.srt(), node, aTime);
+    if (mBake && mBake->getScale(node, aTime, scale))
+    {
+        expans.srt().setScale(scale);
+    }
+    else
+    {
+        getScaleExpans(expans.srt(), node, aTime);
+    }
 
     // update matrix
     expans.srt().setParentMatrix(QMatrix4x4());
@@ -564,34 +710,12 @@ void TimeKeyBlender::blendDepthKey(PositionType aPos, const TimeInfo& aTime)
     // set cache frame
     expans.setKeyCache(TimeKeyType_Depth, aTime.frame);
 
-    // get blend info
-    TimeKeyGatherer blend(node.timeLine()->map(TimeKeyType_Depth), aTime);
-
-    // no key is exists
-    if (blend.isEmpty())
-    {
-        auto defaultKey = (DepthKey*)node.timeLine()->defaultKey(TimeKeyType_Depth);
-        expans.setDepth(defaultKey ? defaultKey->depth() : DepthKey::Data().depth());
-    }
-    else if (blend.hasSameFrame())
-    {
-        // a key is exists
-        expans.setDepth(((const DepthKey*)blend.point(0).key)->depth());
-    }
-    else if (blend.isSingle())
-    {
-        // perfect following
-        expans.setDepth(((const DepthKey*)blend.singlePoint().key)->depth());
-    }
-    else
+    float depth = 0.0f;
+    if (!mBake || !mBake->getDepth(node, aTime, depth))
     {
-        const DepthKey* k0 = (const DepthKey*)blend.point(0).key;
-        const DepthKey* k1 = (const DepthKey*)blend.point(1).key;
-        // calculate easing
-        const float time = getEasingRateFromTwoKeys<DepthKey>(blend);
-        // blend
-        expans.setDepth(k0->depth() * (1.0f - time) + k1->depth() * time);
+        depth = getDepth(node, aTime);
     }
+    expans.setDepth(depth);
 
     // sum depths of parents
     {
@@ -623,42 +747,9 @@ void TimeKeyBlender::blendHSVKey(PositionType aPos, const TimeInfo& aTime)
     // set cache frame
     expans.setKeyCache(TimeKeyType_HSV, aTime.frame);
 
-    // get blend info
-    TimeKeyGatherer blend(node.timeLine()->map(TimeKeyType_HSV), aTime);
-
-    // no key is exists
-    if (blend.isEmpty())
-    {
-        auto defaultKey = (HSVKey*)node.timeLine()->defaultKey(TimeKeyType_HSV);
-        expans.hsv() = defaultKey ? defaultKey->data() : HSVKey::Data();
-    }
-    else if (blend.hasSameFrame())
-    {
-        // a key is exists
-        expans.hsv() = ((const HSVKey*)blend.point(0).key)->data();
-    }
-    else if (blend.isSingle())
+    if (!mBake || !mBake->getHSV(node, aTime, expans.hsv()))
     {
-        // perfect following
-        expans.hsv() = ((const HSVKey*)blend.singlePoint().key)->data();
-    }
-    else
-    {
-        // calculate hsv change
-        const float time = getEasingRateFromTwoKeys<HSVKey>(blend);
-        const HSVKey* k0 = (const HSVKey*)blend.point(0).key;
-        const HSVKey* k1 = (const HSVKey*)blend.point(1).key;
-        for (int x = 0; x < 3; x+=1){
-            // blend
-            switch(x){
-            case 0: expans.hsv().setHue(k0->hsv().at(0) * (1.0f - time) + k1->hsv().at(0) * time);
-                    break;
-            case 1: expans.hsv().setSaturation(k0->hsv().at(1) * (1.0f - time) + k1->hsv().at(1) * time);
-                    break;
-            case 2: expans.hsv().setValue(k0->hsv().at(2) * (1.0f - time) + k1->hsv().at(2) * time);
-                    break;
-            }
-        }
+        getHSVData(expans.hsv(), node, aTime);
     }
 }
 
@@ -674,33 +765,14 @@ void TimeKeyBlender::blendOpaKey(PositionType aPos, const TimeInfo& aTime)
     // set cache frame
     expans.setKeyCache(TimeKeyType_Opa, aTime.frame);
 
-    // get blend info
-    TimeKeyGatherer blend(node.timeLine()->map(TimeKeyType_Opa), aTime);
-
-    // no key is exists
-    if (blend.isEmpty())
-    {
-        auto defaultKey = (OpaKey*)node.timeLine()->defaultKey(TimeKeyType_Opa);
-        expans.opa() = defaultKey ? defaultKey->data() : OpaKey::Data();
-    }
-    else if (blend.hasSameFrame())
-    {
-        // a key is exists
-        expans.opa() = ((const OpaKey*)blend.point(0).key)->data();
-    }
-    else if (blend.isSingle())
+    float opacity = 0.0f;
+    if (mBake && mBake->getOpacity(node, aTime, opacity))
     {
-        // perfect following
-        expans.opa() = ((const OpaKey*)blend.singlePoint().key)->data();
+        expans.opa().setOpacity(opacity);
     }
     else
     {
-        const OpaKey* k0 = (const OpaKey*)blend.point(0).key;
-        const OpaKey* k1 = (const OpaKey*)blend.point(1).key;
-        // calculate easing
-        const float time = getEasingRateFromTwoKeys<OpaKey>(blend);
-        // blend
-        expans.opa().setOpacity(k0->opacity() * (1.0f - time) + k1->opacity() * time);
+        getOpaData(expans.opa(), node, aTime);
     }
 
     // multiply opacity of parents
@@ -767,6 +839,14 @@ void TimeKeyBlender::blendPoseKey(PositionType aPos, const TimeInfo& aTime)
     auto areaBoneKey = expans.bone().areaKey();
     expans.setPoseParent(areaBoneKey);
 
+    // baked
+    bool hasKey = false;
+    if (mBake && mBake->getPose(node, aTime, areaBoneKey, expans.pose(), hasKey))
+    {
+        if (!hasKey) expans.setPoseParent(nullptr);
+        return;
+    }
+
     // get blend info
     TimeKeyGatherer blend(
                 node.timeLine()->map(TimeKeyType_Pose), aTime,
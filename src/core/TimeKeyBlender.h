@@ -10,6 +10,7 @@
 #include "core/TimeKeyExpans.h"
 #include "core/TimeKeyGatherer.h"
 #include "core/TimeCacheLock.h"
+namespace core { class TimeLineBake; }
 
 namespace core
 {
@@ -51,11 +52,16 @@ public:
     TimeKeyBlender(ObjectNode& aRootNode, bool aUseWorking);
     TimeKeyBlender(SeekerType& aSeeker, PositionType aRoot);
 
+    // the blending reads the baked tracks which are valid for the time
+    void setBake(const TimeLineBake* aBake) { mBake = aBake; }
+
     void updateCurrents(ObjectNode* aRootNode, const TimeInfo& aTime);
     void clearCaches(ObjectNode* aRootNode);
     void clearCaches(TimeLineEvent& aEvent);
 
 private:
+    friend class TimeLineBake;
+
     static std::pair<TimeKey*, LayerMesh*> getAreaMeshImpl(ObjectNode& aNode, const TimeInfo& aTime);
     static MeshKey* getMeshKey(const ObjectNode& aNode, const TimeInfo& aTime);
     static ImageKey* getImageKey(const ObjectNode& aNode, const TimeInfo& aTime);
@@ -63,6 +69,11 @@ private:
     static void getMoveExpans(SRTExpans& aExpans, const ObjectNode& aNode, const TimeInfo& aTime);
     static void getRotateExpans(SRTExpans& aExpans, const ObjectNode& aNode, const TimeInfo& aTime);
     static void getScaleExpans(SRTExpans& aExpans, const ObjectNode& aNode, const TimeInfo& aTime);
+    static float getDepth(const ObjectNode& aNode, const TimeInfo& aTime);
+    static void getOpaData(OpaKey::Data& aData, const ObjectNode& aNode, const TimeInfo& aTime);
+    // returns the copied data, or null if the values are blended
+    static const HSVKey::Data* getHSVData(HSVKey::Data& aData, const ObjectNode& aNode, const TimeInfo& aTime);
+    static float getPoseEasingRate(const TimeKeyGatherer& aGatherer);
 
     void blendSRTKeys(PositionType aPos, const TimeInfo& aTime);
     void blendDepthKey(PositionType aPos, const TimeInfo& aTime);
@@ -83,6 +94,7 @@ private:
 
     SeekerType* mSeeker;
     SeekerType::Position mRoot;
+    const TimeLineBake* mBake;
 };
 
 } // namespace core
@@ -1,3 +1,4 @@
+#include "util/HashUtil.h"
 #include "core/TimeKeyExpans.h"
 
 namespace core
@@ -59,7 +60,51 @@ void TimeKeyExpans::clearCaches()
     {
         mKeyCaches[i].set(-1);
     }
-    mSRT.clearSplineCache();
+}
+
+uint64 TimeKeyExpans::fingerprint() const
+{
+    using util::HashUtil;
+
+    auto hashMatrix = [](uint64 aHash, const QMatrix4x4& aMtx)
+    {
+        return HashUtil::combine(aHash, HashUtil::hash64(aMtx.constData(), sizeof(float) * 16));
+    };
+
+    uint64 hash = hashMatrix(0, mSRT.worldCSRTMatrix());
+
+    const float values[] = {
+        mWorldOpacity, mWorldDepth, mImageOffset.x(), mImageOffset.y()
+    };
+    hash = HashUtil::combine(hash, HashUtil::hash64(values, sizeof(values)));
+
+    for (auto value : mHSV.hsv())
+    {
+        hash = HashUtil::combine(hash, (uint64)(uint32)value);
+    }
+
+    const void* keys[] = {
+        mAreaImageKey, mAreaMeshKey, mFFDMesh, mPoseParent,
+        mBone.areaKey(), mBone.influenceMap()
+    };
+    hash = HashUtil::combine(hash, HashUtil::hash64(keys, sizeof(keys)));
+
+    hash = hashMatrix(hash, mBone.worldCSRTMatrix());
+    hash = hashMatrix(hash, mBone.bindingMatrix());
+    hash = HashUtil::combine(hash, (uint64)(uint32)mBone.binderIndex());
+
+    auto matrices = mPosePalette.matrices();
+    for (int i = 0; i < matrices.count(); ++i)
+    {
+        hash = hashMatrix(hash, matrices[i]);
+    }
+
+    if (mFFD.count() > 0)
+    {
+        hash = HashUtil::combine(hash, HashUtil::hash64(
+                                     mFFD.positions(), sizeof(gl::Vector3) * mFFD.count()));
+    }
+    return hash;
 }
 
 //-------------------------------------------------------------------------------------------------
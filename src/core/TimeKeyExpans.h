@@ -35,6 +35,10 @@ public:
 
     void clearCaches();
 
+    // hash of the blended values which affect the rendering. the keys are
+    // identified by their addresses, so it is valid while no key is edited.
+    uint64 fingerprint() const;
+
     SRTExpans& srt() { return mSRT; }
     const SRTExpans& srt() const { return mSRT; }
 
@@ -3,6 +3,7 @@
 #include "cmnd/Scalable.h"
 #include "core/TimeLine.h"
 #include "core/TimeKeyExpans.h"
+#include "core/MoveSplineCache.h"
 #include "core/DepthKey.h"
 #include "core/Project.h"
 
@@ -70,6 +71,7 @@ TimeLine::TimeLine()
     : mMap()
     , mCurrent(new TimeKeyExpans())
     , mWorking(new TimeKeyExpans())
+    , mMoveSplineCache(new MoveSplineCache())
     , mDefaultKeys()
 {
 }
@@ -170,6 +172,7 @@ void TimeLine::clear()
         mMap[i].clear();
     }
     mCurrent.reset(new TimeKeyExpans());
+    mMoveSplineCache->clear();
 }
 
 bool TimeLine::move(TimeKeyType aType, int aFrom, int aTo)
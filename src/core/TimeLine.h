@@ -12,6 +12,7 @@
 namespace core { class Project; }
 namespace core { class ObjectNode; }
 namespace core { class TimeKeyExpans; }
+namespace core { class MoveSplineCache; }
 
 
 namespace core
@@ -52,6 +53,9 @@ public:
     TimeKeyExpans& working() { return *mWorking; }
     const TimeKeyExpans& working() const { return *mWorking; }
 
+    // the cache is shared by the blending of the current and the working
+    MoveSplineCache& moveSplineCache() const { return *mMoveSplineCache; }
+
     bool move(TimeKeyType aType, int aFrom, int aTo);
     cmnd::Base* createPusher(TimeKeyType aType, int aFrame, TimeKey* aTimeKey);
     cmnd::Base* createRemover(TimeKeyType aType, int aFrame, bool aOptional = false);
@@ -70,6 +74,7 @@ private:
     std::array<MapType, TimeKeyType_TERM> mMap;
     QScopedPointer<TimeKeyExpans> mCurrent;
     QScopedPointer<TimeKeyExpans> mWorking;
+    QScopedPointer<MoveSplineCache> mMoveSplineCache;
     std::array<QScopedPointer<TimeKey>, TimeKeyType_TERM> mDefaultKeys;
 };
 
@@ -0,0 +1,579 @@
+#include "util/Profiler.h"
+#include "core/TimeLineBake.h"
+#include "core/TimeKeyBlender.h"
+#include "core/TimeKeyGatherer.h"
+#include "core/ObjectNode.h"
+
+namespace
+{
+static const int kMilliPerFrame = 1000;
+}
+
+namespace core
+{
+
+//-------------------------------------------------------------------------------------------------
+TimeLineBake::Tracks::Tracks()
+    : valid()
+    , sampleCount()
+    , moveX()
+    , moveY()
+    , centroidX()
+    , centroidY()
+    , rotate()
+    , scaleX()
+    , scaleY()
+    , depth()
+    , opacity()
+    , hsvSource()
+    , hue()
+    , saturation()
+    , value()
+    , poseParent()
+    , poseKey()
+    , poseOffset()
+    , poseRotates()
+{
+    valid.fill(false);
+    sampleCount.fill(0);
+}
+
+void TimeLineBake::Tracks::clear(Track aTrack)
+{
+    valid[aTrack] = false;
+    sampleCount[aTrack] = 0;
+
+    switch (aTrack)
+    {
+    case Track_Move:
+        moveX.clear(); moveY.clear(); centroidX.clear(); centroidY.clear();
+        break;
+    case Track_Rotate:
+        rotate.clear();
+        break;
+    case Track_Scale:
+        scaleX.clear(); scaleY.clear();
+        break;
+    case Track_Depth:
+        depth.clear();
+        break;
+    case Track_Opa:
+        opacity.clear();
+        break;
+    case Track_HSV:
+        hsvSource.clear(); hue.clear(); saturation.clear(); value.clear();
+        break;
+    case Track_Pose:
+        poseParent = nullptr;
+        poseKey.clear(); poseOffset.clear(); poseRotates.clear();
+        break;
+    default:
+        break;
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+TimeLineBake::Track TimeLineBake::getTrack(TimeKeyType aType)
+{
+    switch (aType)
+    {
+    case TimeKeyType_Move:   return Track_Move;
+    case TimeKeyType_Rotate: return Track_Rotate;
+    case TimeKeyType_Scale:  return Track_Scale;
+    case TimeKeyType_Depth:  return Track_Depth;
+    case TimeKeyType_Opa:    return Track_Opa;
+    case TimeKeyType_HSV:    return Track_HSV;
+    case TimeKeyType_Pose:   return Track_Pose;
+    default:                 return Track_TERM;
+    }
+}
+
+TimeLineBake::TimeLineBake()
+    : mSubframeCount(1)
+    , mTime()
+    , mEntries()
+    , mIndices()
+    , mTracks()
+{
+}
+
+void TimeLineBake::setSubframeCount(int aCount)
+{
+    XC_ASSERT(aCount > 0 && kMilliPerFrame % aCount == 0);
+    if (mSubframeCount == aCount) return;
+    mSubframeCount = aCount;
+
+    // the arrays of the blended tracks have the other length
+    for (auto& tracks : mTracks)
+    {
+        for (int i = 0; i < Track_TERM; ++i)
+        {
+            if (tracks.sampleCount[i] > 1) tracks.clear((Track)i);
+        }
+    }
+}
+
+void TimeLineBake::invalidate(const TimeLineEvent& aEvent)
+{
+    auto invalidateTargets = [=](const QVector<TimeLineEvent::Target>& aTargets)
+    {
+        for (auto& target : aTargets)
+        {
+            XC_PTR_ASSERT(target.node);
+            const TimeKeyType type = target.pos.type();
+
+            // the poses follow the structures of the bones
+            if (type == TimeKeyType_Bone)
+            {
+                for (auto& tracks : mTracks) tracks.clear(Track_Pose);
+                continue;
+            }
+
+            const Track track = getTrack(type);
+            if (track != Track_TERM)
+            {
+                invalidate(*target.node, track);
+            }
+        }
+    };
+    invalidateTargets(aEvent.targets());
+    invalidateTargets(aEvent.detaulTargets());
+}
+
+void TimeLineBake::invalidate(const ObjectNode& aNode, Track aTrack)
+{
+    auto itr = mIndices.find(&aNode);
+    if (itr != mIndices.end())
+    {
+        mTracks[itr.value()].clear(aTrack);
+    }
+}
+
+void TimeLineBake::invalidateAll()
+{
+    mEntries.clear();
+    mIndices.clear();
+    mTracks.clear();
+}
+
+int TimeLineBake::update(ObjectNode& aTopNode, const TimeInfo& aTime)
+{
+    util::ProfileZone zone("bake");
+
+    if (mEntries.isEmpty() || topNode() != &aTopNode)
+    {
+        resetEntries(aTopNode);
+    }
+    else if (!isSameTime(aTime))
+    {
+        // the range or the loop changes the blending of all tracks
+        for (auto& tracks : mTracks)
+        {
+            for (int i = 0; i < Track_TERM; ++i) tracks.clear((Track)i);
+        }
+    }
+    mTime = aTime;
+    mTime.frame = Frame();
+
+    int count = 0;
+    for (int i = 0; i < mEntries.size(); ++i)
+    {
+        const ObjectNode& node = *mEntries[i].node;
+        Tracks& tracks = mTracks[i];
+        if (!node.timeLine()) continue;
+
+        if (!tracks.valid[Track_Move])   { bakeMove(node, tracks);   ++count; }
+        if (!tracks.valid[Track_Rotate]) { bakeRotate(node, tracks); ++count; }
+        if (!tracks.valid[Track_Scale])  { bakeScale(node, tracks);  ++count; }
+        if (!tracks.valid[Track_Depth])  { bakeDepth(node, tracks);  ++count; }
+        if (!tracks.valid[Track_Opa])    { bakeOpa(node, tracks);    ++count; }
+        if (!tracks.valid[Track_HSV])    { bakeHSV(node, tracks);    ++count; }
+        if (!tracks.valid[Track_Pose])   { bakePose(node, tracks);   ++count; }
+    }
+    return count;
+}
+
+const ObjectNode* TimeLineBake::topNode() const
+{
+    return mEntries.isEmpty() ? nullptr : mEntries.front().node;
+}
+
+size_t TimeLineBake::byteSize() const
+{
+    size_t size = 0;
+    for (auto& tracks : mTracks)
+    {
+        size += sizeof(float) * (tracks.moveX.size() + tracks.moveY.size() +
+                                 tracks.centroidX.size() + tracks.centroidY.size() +
+                                 tracks.rotate.size() + tracks.scaleX.size() +
+                                 tracks.scaleY.size() + tracks.depth.size() +
+                                 tracks.opacity.size() + tracks.poseRotates.size());
+        size += sizeof(int) * (tracks.hue.size() + tracks.saturation.size() +
+                               tracks.value.size() + tracks.poseOffset.size());
+        size += sizeof(void*) * (tracks.hsvSource.size() + tracks.poseKey.size());
+    }
+    return size;
+}
+
+void TimeLineBake::resetEntries(ObjectNode& aTopNode)
+{
+    invalidateAll();
+
+    // the preorder lists the parents before their children
+    Entry top;
+    top.node = &aTopNode;
+    mEntries.push_back(top);
+    mIndices[&aTopNode] = 0;
+
+    ObjectNode::Iterator itr(&aTopNode);
+    while (itr.hasNext())
+    {
+        ObjectNode* node = itr.next();
+        XC_PTR_ASSERT(node);
+        Entry entry;
+        entry.node = node;
+        entry.parent = node->parent() ? mIndices.value(node->parent(), -1) : -1;
+        mIndices[node] = mEntries.size();
+        mEntries.push_back(entry);
+    }
+    mTracks.resize(mEntries.size());
+}
+
+bool TimeLineBake::isSameTime(const TimeInfo& aTime) const
+{
+    return mTime.frameMax == aTime.frameMax && mTime.loop == aTime.loop && mTime.fps == aTime.fps;
+}
+
+int TimeLineBake::sampleIndex(const Frame& aFrame) const
+{
+    const Frame::SerialValue value = aFrame.serialValue();
+    if (value.value < 0 || mTime.frameMax < value.value) return -1;
+    if ((value.milli * mSubframeCount) % kMilliPerFrame != 0) return -1;
+    return value.value * mSubframeCount + value.milli * mSubframeCount / kMilliPerFrame;
+}
+
+TimeInfo TimeLineBake::sampleTime(int aIndex) const
+{
+    Frame::SerialValue value;
+    value.value = aIndex / mSubframeCount;
+    value.milli = (aIndex % mSubframeCount) * kMilliPerFrame / mSubframeCount;
+
+    TimeInfo time = mTime;
+    time.frame.setSerialValue(value);
+    return time;
+}
+
+const TimeLineBake::Tracks* TimeLineBake::findTracks(
+        const ObjectNode& aNode, Track aTrack, const TimeInfo& aTime, int& aIndex) const
+{
+    auto itr = mIndices.find(&aNode);
+    if (itr == mIndices.end()) return nullptr;
+
+    const Tracks& tracks = mTracks[itr.value()];
+    const int count = tracks.sampleCount[aTrack];
+    if (!tracks.valid[aTrack] || count == 0) return nullptr;
+
+    // a track without blending has the same value at any time
+    if (count == 1)
+    {
+        aIndex = 0;
+        return &tracks;
+    }
+    if (!isSameTime(aTime)) return nullptr;
+
+    aIndex = sampleIndex(aTime.frame);
+    if (aIndex < 0 || count <= aIndex) return nullptr;
+    return &tracks;
+}
+
+int TimeLineBake::getSampleCount(const ObjectNode& aNode, TimeKeyType aType) const
+{
+    // no blending without two keys
+    if (aNode.timeLine()->map(aType).size() < 2) return 1;
+    return (mTime.frameMax + 1) * mSubframeCount;
+}
+
+void TimeLineBake::bakeMove(const ObjectNode& aNode, Tracks& aTracks)
+{
+    const int count = getSampleCount(aNode, TimeKeyType_Move);
+    aTracks.clear(Track_Move);
+    aTracks.moveX.resize(count);
+    aTracks.moveY.resize(count);
+    aTracks.centroidX.resize(count);
+    aTracks.centroidY.resize(count);
+
+    // the splines of the segments are cached by the timeline
+    SRTExpans expans;
+    for (int i = 0; i < count; ++i)
+    {
+        TimeKeyBlender::getMoveExpans(expans, aNode, sampleTime(i));
+        aTracks.moveX[i] = expans.pos().x();
+        aTracks.moveY[i] = expans.pos().y();
+        aTracks.centroidX[i] = expans.centroid().x();
+        aTracks.centroidY[i] = expans.centroid().y();
+    }
+    aTracks.sampleCount[Track_Move] = count;
+    aTracks.valid[Track_Move] = true;
+}
+
+void TimeLineBake::bakeRotate(const ObjectNode& aNode, Tracks& aTracks)
+{
+    const int count = getSampleCount(aNode, TimeKeyType_Rotate);
+    aTracks.clear(Track_Rotate);
+    aTracks.rotate.resize(count);
+
+    SRTExpans expans;
+    for (int i = 0; i < count; ++i)
+    {
+        TimeKeyBlender::getRotateExpans(expans, aNode, sampleTime(i));
+        aTracks.rotate[i] = expans.rotate();
+    }
+    aTracks.sampleCount[Track_Rotate] = count;
+    aTracks.valid[Track_Rotate] = true;
+}
+
+void TimeLineBake::bakeScale(const ObjectNode& aNode, Tracks& aTracks)
+{
+    const int count = getSampleCount(aNode, TimeKeyType_Scale);
+    aTracks.clear(Track_Scale);
+    aTracks.scaleX.resize(count);
+    aTracks.scaleY.resize(count);
+
+    SRTExpans expans;
+    for (int i = 0; i < count; ++i)
+    {
+        TimeKeyBlender::getScaleExpans(expans, aNode, sampleTime(i));
+        aTracks.scaleX[i] = expans.scale().x();
+        aTracks.scaleY[i] = expans.scale().y();
+    }
+    aTracks.sampleCount[Track_Scale] = count;
+    aTracks.valid[Track_Scale] = true;
+}
+
+void TimeLineBake::bakeDepth(const ObjectNode& aNode, Tracks& aTracks)
+{
+    const int count = getSampleCount(aNode, TimeKeyType_Depth);
+    aTracks.clear(Track_Depth);
+    aTracks.depth.resize(count);
+
+    for (int i = 0; i < count; ++i)
+    {
+        aTracks.depth[i] = TimeKeyBlender::getDepth(aNode, sampleTime(i));
+    }
+    aTracks.sampleCount[Track_Depth] = count;
+    aTracks.valid[Track_Depth] = true;
+}
+
+void TimeLineBake::bakeOpa(const ObjectNode& aNode, Tracks& aTracks)
+{
+    const int count = getSampleCount(aNode, TimeKeyType_Opa);
+    aTracks.clear(Track_Opa);
+    aTracks.opacity.resize(count);
+
+    OpaKey::Data data;
+    for (int i = 0; i < count; ++i)
+    {
+        TimeKeyBlender::getOpaData(data, aNode, sampleTime(i));
+        aTracks.opacity[i] = data.opacity();
+    }
+    aTracks.sampleCount[Track_Opa] = count;
+    aTracks.valid[Track_Opa] = true;
+}
+
+void TimeLineBake::bakeHSV(const ObjectNode& aNode, Tracks& aTracks)
+{
+    const int count = getSampleCount(aNode, TimeKeyType_HSV);
+    aTracks.clear(Track_HSV);
+    aTracks.hsvSource.resize(count);
+    aTracks.hue.resize(count);
+    aTracks.saturation.resize(count);
+    aTracks.value.resize(count);
+
+    HSVKey::Data data;
+    for (int i = 0; i < count; ++i)
+    {
+        aTracks.hsvSource[i] = TimeKeyBlender::getHSVData(data, aNode, sampleTime(i));
+        aTracks.hue[i] = data.hue();
+        aTracks.saturation[i] = data.saturation();
+        aTracks.value[i] = data.value();
+    }
+    aTracks.sampleCount[Track_HSV] = count;
+    aTracks.valid[Track_HSV] = true;
+}
+
+void TimeLineBake::bakePose(const ObjectNode& aNode, Tracks& aTracks)
+{
+    aTracks.clear(Track_Pose);
+    aTracks.valid[Track_Pose] = true;
+
+    // the keys of several bones are blended by the blender
+    const TimeLine::MapType& map = aNode.timeLine()->map(TimeKeyType_Pose);
+    for (auto key : map)
+    {
+        if (key->parent() != map.first()->parent()) return;
+    }
+
+    const int count = getSampleCount(aNode, TimeKeyType_Pose);
+    aTracks.poseParent = map.isEmpty() ? nullptr : map.first()->parent();
+    aTracks.poseKey.resize(count);
+    aTracks.poseOffset.resize(count);
+
+    for (int i = 0; i < count; ++i)
+    {
+        TimeKeyGatherer blend(map, sampleTime(i), TimeKeyGatherer::ForceType_AssignedParent,
+                              const_cast<TimeKey*>(aTracks.poseParent));
+        aTracks.poseOffset[i] = -1;
+
+        if (blend.isEmpty())
+        {
+            aTracks.poseKey[i] = nullptr;
+        }
+        else if (blend.hasSameFrame())
+        {
+            aTracks.poseKey[i] = (const PoseKey*)blend.point(0).key;
+        }
+        else if (blend.isSingle())
+        {
+            aTracks.poseKey[i] = (const PoseKey*)blend.singlePoint().key;
+        }
+        else
+        {
+            auto key0 = (const PoseKey*)blend.point(0).key;
+            auto key1 = (const PoseKey*)blend.point(1).key;
+            const float time = TimeKeyBlender::getPoseEasingRate(blend);
+
+            aTracks.poseKey[i] = key0;
+            aTracks.poseOffset[i] = (int)aTracks.poseRotates.size();
+
+            if (key0->data().topBones().size() != key1->data().topBones().size())
+            {
+                aTracks.clear(Track_Pose);
+                aTracks.valid[Track_Pose] = true;
+                return;
+            }
+
+            // the order of the blender
+            for (int index = 0; index < key0->data().topBones().size(); ++index)
+            {
+                Bone2::ConstIterator itr0(key0->data().topBones().at(index));
+                Bone2::ConstIterator itr1(key1->data().topBones().at(index));
+                while (itr0.hasNext() && itr1.hasNext())
+                {
+                    aTracks.poseRotates.push_back(
+                                itr0.next()->rotate() * (1.0f - time) +
+                                itr1.next()->rotate() * time);
+                }
+                if (itr0.hasNext() || itr1.hasNext())
+                {
+                    aTracks.clear(Track_Pose);
+                    aTracks.valid[Track_Pose] = true;
+                    return;
+                }
+            }
+        }
+    }
+    aTracks.sampleCount[Track_Pose] = count;
+}
+
+bool TimeLineBake::getMove(const ObjectNode& aNode, const TimeInfo& aTime,
+                           QVector2D& aPos, QVector2D& aCentroid) const
+{
+    int i = 0;
+    const Tracks* tracks = findTracks(aNode, Track_Move, aTime, i);
+    if (!tracks) return false;
+    aPos = QVector2D(tracks->moveX[i], tracks->moveY[i]);
+    aCentroid = QVector2D(tracks->centroidX[i], tracks->centroidY[i]);
+    return true;
+}
+
+bool TimeLineBake::getRotate(const ObjectNode& aNode, const TimeInfo& aTime, float& aRotate) const
+{
+    int i = 0;
+    const Tracks* tracks = findTracks(aNode, Track_Rotate, aTime, i);
+    if (!tracks) return false;
+    aRotate = tracks->rotate[i];
+    return true;
+}
+
+bool TimeLineBake::getScale(const ObjectNode& aNode, const TimeInfo& aTime, QVector2D& aScale) const
+{
+    int i = 0;
+    const Tracks* tracks = findTracks(aNode, Track_Scale, aTime, i);
+    if (!tracks) return false;
+    aScale = QVector2D(tracks->scaleX[i], tracks->scaleY[i]);
+    return true;
+}
+
+bool TimeLineBake::getDepth(const ObjectNode& aNode, const TimeInfo& aTime, float& aDepth) const
+{
+    int i = 0;
+    const Tracks* tracks = findTracks(aNode, Track_Depth, aTime, i);
+    if (!tracks) return false;
+    aDepth = tracks->depth[i];
+    return true;
+}
+
+bool TimeLineBake::getOpacity(const ObjectNode& aNode, const TimeInfo& aTime, float& aOpacity) const
+{
+    int i = 0;
+    const Tracks* tracks = findTracks(aNode, Track_Opa, aTime, i);
+    if (!tracks) return false;
+    aOpacity = tracks->opacity[i];
+    return true;
+}
+
+bool TimeLineBake::getHSV(const ObjectNode& aNode, const TimeInfo& aTime, HSVKey::Data& aData) const
+{
+    int i = 0;
+    const Tracks* tracks = findTracks(aNode, Track_HSV, aTime, i);
+    if (!tracks) return false;
+
+    if (tracks->hsvSource[i])
+    {
+        aData = *tracks->hsvSource[i];
+    }
+    else
+    {
+        // the blender changes the values only
+        aData.setHue(tracks->hue[i]);
+        aData.setSaturation(tracks->saturation[i]);
+        aData.setValue(tracks->value[i]);
+    }
+    return true;
+}
+
+bool TimeLineBake::getPose(const ObjectNode& aNode, const TimeInfo& aTime, const BoneKey* aAreaBone,
+                           PoseKey::Data& aData, bool& aHasKey) const
+{
+    int i = 0;
+    const Tracks* tracks = findTracks(aNode, Track_Pose, aTime, i);
+    if (!tracks) return false;
+
+    const PoseKey* key = tracks->poseKey[i];
+    aHasKey = key && tracks->poseParent == (const TimeKey*)aAreaBone;
+    if (!aHasKey)
+    {
+        aData = PoseKey::Data();
+        return true;
+    }
+
+    aData = key->data();
+    const int offset = tracks->poseOffset[i];
+    if (offset >= 0)
+    {
+        const float* rotate = tracks->poseRotates.data() + offset;
+        for (Bone2* bone : aData.topBones())
+        {
+            Bone2::Iterator itr(bone);
+            while (itr.hasNext())
+            {
+                auto target = itr.next();
+                target->setRotate(*rotate++);
+                target->updateWorldTransform();
+            }
+        }
+    }
+    return true;
+}
+
+} // namespace core
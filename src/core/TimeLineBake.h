@@ -0,0 +1,141 @@
+#ifndef CORE_TIMELINEBAKE_H
+#define CORE_TIMELINEBAKE_H
+
+#include <array>
+#include <vector>
+#include <QHash>
+#include <QVector>
+#include <QVector2D>
+#include "util/NonCopyable.h"
+#include "core/TimeInfo.h"
+#include "core/TimeKeyType.h"
+#include "core/TimeLineEvent.h"
+#include "core/HsvKey.h"
+#include "core/PoseKey.h"
+namespace core { class ObjectNode; }
+
+namespace core
+{
+
+// Compiles the timelines of an object tree into flat arrays of the blended
+// values for each sample, one array for each component of the srt, depth,
+// opacity, hsv and pose rotation tracks. A track without any blending is
+// baked into one sample. The blender reads the arrays instead of gathering
+// and blending the keys, and blends a track which isn't baked as before.
+// The nodes are listed in the order of evaluation, parents first.
+// An edit invalidates the tracks of its targets, and update() bakes them
+// again. The owner serializes the bake against the readers.
+class TimeLineBake : private util::NonCopyable
+{
+public:
+    enum Track
+    {
+        Track_Move,
+        Track_Rotate,
+        Track_Scale,
+        Track_Depth,
+        Track_Opa,
+        Track_HSV,
+        Track_Pose,
+        Track_TERM
+    };
+
+    struct Entry
+    {
+        Entry() : node(), parent(-1) {}
+        ObjectNode* node;
+        // index of the parent entry, -1 for the top
+        int parent;
+    };
+
+    static Track getTrack(TimeKeyType aType);
+
+    TimeLineBake();
+
+    // the samples in a frame which divide 1000 milli frames,
+    // 1 bakes the integral frames only
+    void setSubframeCount(int aCount);
+    int subframeCount() const { return mSubframeCount; }
+
+    void invalidate(const TimeLineEvent& aEvent);
+    void invalidate(const ObjectNode& aNode, Track aTrack);
+    // drops the tracks and the evaluation list
+    void invalidateAll();
+
+    // bakes the invalid tracks of the tree, for the frame range and the
+    // loop of the time. returns the count of the baked tracks.
+    int update(ObjectNode& aTopNode, const TimeInfo& aTime);
+
+    bool isEmpty() const { return mEntries.isEmpty(); }
+    const ObjectNode* topNode() const;
+    const QVector<Entry>& evaluationList() const { return mEntries; }
+    size_t byteSize() const;
+
+    // the readers return false unless the track is baked for the time
+    bool getMove(const ObjectNode& aNode, const TimeInfo& aTime,
+                 QVector2D& aPos, QVector2D& aCentroid) const;
+    bool getRotate(const ObjectNode& aNode, const TimeInfo& aTime, float& aRotate) const;
+    bool getScale(const ObjectNode& aNode, const TimeInfo& aTime, QVector2D& aScale) const;
+    bool getDepth(const ObjectNode& aNode, const TimeInfo& aTime, float& aDepth) const;
+    bool getOpacity(const ObjectNode& aNode, const TimeInfo& aTime, float& aOpacity) const;
+    bool getHSV(const ObjectNode& aNode, const TimeInfo& aTime, HSVKey::Data& aData) const;
+    // the keys whose parent isn't the area bone are ignored as the blender does
+    bool getPose(const ObjectNode& aNode, const TimeInfo& aTime, const BoneKey* aAreaBone,
+                 PoseKey::Data& aData, bool& aHasKey) const;
+
+private:
+    struct Tracks
+    {
+        Tracks();
+        void clear(Track aTrack);
+
+        std::array<bool, Track_TERM> valid;
+        std::array<int, Track_TERM> sampleCount;
+        std::vector<float> moveX;
+        std::vector<float> moveY;
+        std::vector<float> centroidX;
+        std::vector<float> centroidY;
+        std::vector<float> rotate;
+        std::vector<float> scaleX;
+        std::vector<float> scaleY;
+        std::vector<float> depth;
+        std::vector<float> opacity;
+        // the copied key data of each sample, or null for a blended one
+        std::vector<const HSVKey::Data*> hsvSource;
+        std::vector<int> hue;
+        std::vector<int> saturation;
+        std::vector<int> value;
+        // the key of each sample, and the first of its rotations in
+        // poseRotates if the sample is blended, otherwise -1.
+        // all of the keys have the parent
+        const TimeKey* poseParent;
+        std::vector<const PoseKey*> poseKey;
+        std::vector<int> poseOffset;
+        std::vector<float> poseRotates;
+    };
+
+    void resetEntries(ObjectNode& aTopNode);
+    bool isSameTime(const TimeInfo& aTime) const;
+    int sampleIndex(const Frame& aFrame) const;
+    TimeInfo sampleTime(int aIndex) const;
+    const Tracks* findTracks(const ObjectNode& aNode, Track aTrack,
+                             const TimeInfo& aTime, int& aIndex) const;
+    void bakeMove(const ObjectNode& aNode, Tracks& aTracks);
+    void bakeRotate(const ObjectNode& aNode, Tracks& aTracks);
+    void bakeScale(const ObjectNode& aNode, Tracks& aTracks);
+    void bakeDepth(const ObjectNode& aNode, Tracks& aTracks);
+    void bakeOpa(const ObjectNode& aNode, Tracks& aTracks);
+    void bakeHSV(const ObjectNode& aNode, Tracks& aTracks);
+    void bakePose(const ObjectNode& aNode, Tracks& aTracks);
+    int getSampleCount(const ObjectNode& aNode, TimeKeyType aType) const;
+
+    int mSubframeCount;
+    TimeInfo mTime;
+    QVector<Entry> mEntries;
+    QHash<const ObjectNode*, int> mIndices;
+    std::vector<Tracks> mTracks;
+};
+
+} // namespace core
+
+#endif // CORE_TIMELINEBAKE_H
@@ -45,4 +45,30 @@ void TimeLineEvent::pushDefaultTarget(ObjectNode& aNode, TimeKeyType aType)
     mDefaultTargets.push_back(target);
 }
 
+void TimeLineEvent::merge(const TimeLineEvent& aEvent)
+{
+    XC_ASSERT(aEvent.mType == mType);
+
+    auto mergeTargets = [](QVector<Target>& aDst, const QVector<Target>& aSrc)
+    {
+        const int count = aDst.size();
+        for (auto& src : aSrc)
+        {
+            bool exists = false;
+            for (int i = 0; i < count && !exists; ++i)
+            {
+                const Target& dst = aDst[i];
+                exists = dst.node == src.node && dst.pos.type() == src.pos.type() &&
+                         dst.pos.index() == src.pos.index() && dst.subIndex == src.subIndex;
+            }
+            if (!exists)
+            {
+                aDst.push_back(src);
+            }
+        }
+    };
+    mergeTargets(mTargets, aEvent.mTargets);
+    mergeTargets(mDefaultTargets, aEvent.mDefaultTargets);
+}
+
 } // namespace core
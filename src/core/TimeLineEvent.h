@@ -45,6 +45,10 @@ public:
 
     void pushDefaultTarget(ObjectNode& aNode, TimeKeyType aType);
 
+    // appends the targets of the event of the same type, except the ones
+    // which have the same node, key type and key index as an existing one
+    void merge(const TimeLineEvent& aEvent);
+
     Type type() const { return mType; }
     QVector<Target>& targets() { return mTargets; }
     const QVector<Target>& targets() const { return mTargets; }
@@ -82,7 +82,10 @@ SOURCES += \
     TimeCacheLock.cpp \
     TimeCacheAccessor.cpp \
     TimeLineEvent.cpp \
+    TimeLineBake.cpp \
+    MoveSplineCache.cpp \
     MeshKeyUtil.cpp \
+    MeshSpatialIndex.cpp \
     ProjectEvent.cpp \
     MeshTransformerResource.cpp \
     ImageKey.cpp \
@@ -116,6 +119,8 @@ HEADERS += \
     TimeLine.h \
     Animator.h \
     TimeLineEvent.h \
+    TimeLineBake.h \
+    MoveSplineCache.h \
     TimeKeyPos.h \
     Constant.h \
     FFDKey.h \
@@ -149,6 +154,7 @@ HEADERS += \
     TimeCacheAccessor.h \
     Frame.h \
     MeshKeyUtil.h \
+    MeshSpatialIndex.h \
     ProjectEvent.h \
     MeshTransformerResource.h \
     ImageKey.h \
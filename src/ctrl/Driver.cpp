@@ -1,3 +1,5 @@
+#include <QWriteLocker>
+#include <QMutexLocker>
 #include "util/CollDetect.h"
 #include "ctrl/Driver.h"
 
@@ -29,6 +31,9 @@ Driver::Driver(core::Project& aProject, DriverResources& aResources,
     , mOnUpdating(0)
     , mRejectedTarget()
 {
+    // the frames which aren't edited read the baked tracks
+    mBlender.setBake(&aProject.objectTree().bake());
+
     // initialize blending
     mBlender.updateCurrents(
                 mProject.objectTree().topNode(),
@@ -126,7 +131,11 @@ void Driver::updateKey(core::TimeLineEvent& aEvent, bool aUndo)
     (void)aUndo;
 
     // reset blending
-    mBlender.clearCaches(aEvent);
+    {
+        // a render-ahead thread reads the working caches
+        QWriteLocker locker(&mProject.objectTree().timeCacheLock().working);
+        mBlender.clearCaches(aEvent);
+    }
     mBlender.updateCurrents(
                 mProject.objectTree().topNode(),
                 mProject.currentTimeInfo());
@@ -145,9 +154,12 @@ void Driver::updateTree(core::ObjectTreeEvent& aEvent, bool aUndo)
     ScopeCounter counter(mOnUpdating);
 
     // reset blending
-    for (auto root : aEvent.roots())
     {
-        mBlender.clearCaches(root);
+        QWriteLocker locker(&mProject.objectTree().timeCacheLock().working);
+        for (auto root : aEvent.roots())
+        {
+            mBlender.clearCaches(root);
+        }
     }
 
     mBlender.updateCurrents(
@@ -167,7 +179,10 @@ void Driver::updateResource(core::ResourceEvent& aEvent, bool aUndo)
     ScopeCounter counter(mOnUpdating);
 
     // reset blending
-    mBlender.clearCaches(mProject.objectTree().topNode());
+    {
+        QWriteLocker locker(&mProject.objectTree().timeCacheLock().working);
+        mBlender.clearCaches(mProject.objectTree().topNode());
+    }
     mBlender.updateCurrents(
                 mProject.objectTree().topNode(),
                 mProject.currentTimeInfo());
@@ -183,7 +198,10 @@ void Driver::updateProjectAttribute()
     ScopeCounter counter(mOnUpdating);
 
     // reset blending
-    mBlender.clearCaches(mProject.objectTree().topNode());
+    {
+        QWriteLocker locker(&mProject.objectTree().timeCacheLock().working);
+        mBlender.clearCaches(mProject.objectTree().topNode());
+    }
     mBlender.updateCurrents(
                 mProject.objectTree().topNode(),
                 mProject.currentTimeInfo());
@@ -213,6 +231,7 @@ void Driver::renderGL(
     if (aGridTarget && aGridTarget->renderer())
     {
         info.isGrid = true;
+        QMutexLocker locker(&tree.timeCacheLock().rendering);
         core::TimeCacheAccessor accessor(
                     *aGridTarget, tree.timeCacheLock(), info.time, false);
         aGridTarget->renderer()->render(info, accessor);
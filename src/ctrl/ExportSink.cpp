@@ -0,0 +1,112 @@
+#include <algorithm>
+#include <QMutexLocker>
+#include "XC.h"
+#include "util/Profiler.h"
+#include "ctrl/ExportSink.h"
+
+namespace ctrl
+{
+
+//-------------------------------------------------------------------------------------------------
+ExportSink::ExportSink(const Encoder& aEncoder, int aCapacity)
+    : mEncoder(aEncoder)
+    , mCapacity(std::max(aCapacity, 1))
+    , mThread(*this)
+    , mMutex()
+    , mCondition()
+    , mQueue()
+    , mQuit()
+    , mFailed()
+{
+}
+
+ExportSink::~ExportSink()
+{
+    cancel();
+}
+
+void ExportSink::start()
+{
+    XC_ASSERT(!mThread.isRunning());
+    mQuit = false;
+    mThread.start();
+}
+
+bool ExportSink::push(const QImage& aImage, int aIndex)
+{
+    QMutexLocker locker(&mMutex);
+
+    while ((int)mQueue.size() >= mCapacity && !mFailed)
+    {
+        util::ProfileZone zone("export sink full");
+        mCondition.wait(&mMutex);
+    }
+    if (mFailed) return false;
+
+    Frame frame;
+    frame.image = aImage;
+    frame.index = aIndex;
+    mQueue.push_back(frame);
+    mCondition.wakeAll();
+    return true;
+}
+
+bool ExportSink::finish()
+{
+    stop(false);
+    return !mFailed;
+}
+
+void ExportSink::cancel()
+{
+    stop(true);
+}
+
+void ExportSink::stop(bool aDiscards)
+{
+    {
+        QMutexLocker locker(&mMutex);
+        if (aDiscards) mQueue.clear();
+        mQuit = true;
+        mCondition.wakeAll();
+    }
+    mThread.wait();
+}
+
+void ExportSink::run()
+{
+    while (1)
+    {
+        Frame frame;
+        {
+            QMutexLocker locker(&mMutex);
+            while (mQueue.empty() && !mQuit)
+            {
+                mCondition.wait(&mMutex);
+            }
+            // quits after the queued frames
+            if (mQueue.empty()) return;
+
+            frame = mQueue.front();
+            mQueue.pop_front();
+            mCondition.wakeAll();
+        }
+
+        bool success = false;
+        {
+            util::ProfileZone zone("export sink encode");
+            success = mEncoder(frame.image, frame.index);
+        }
+
+        if (!success)
+        {
+            QMutexLocker locker(&mMutex);
+            mFailed = true;
+            mQueue.clear();
+            mCondition.wakeAll();
+            return;
+        }
+    }
+}
+
+} // namespace ctrl
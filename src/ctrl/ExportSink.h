@@ -0,0 +1,69 @@
+#ifndef CTRL_EXPORTSINK_H
+#define CTRL_EXPORTSINK_H
+
+#include <deque>
+#include <functional>
+#include <QThread>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QImage>
+#include "util/NonCopyable.h"
+
+namespace ctrl
+{
+
+// Encodes the frames of an output of the export on its own thread.
+// The rendered frames wait in a bounded queue, and push() blocks while
+// the queue is full so that the rendering doesn't run ahead of a slow
+// encoder. The frames are encoded in the pushed order.
+class ExportSink : private util::NonCopyable
+{
+public:
+    // called on the thread of the sink, a null image repeats the previous
+    // frame. returning false stops the sink.
+    typedef std::function<bool(const QImage& aImage, int aIndex)> Encoder;
+
+    ExportSink(const Encoder& aEncoder, int aCapacity);
+    ~ExportSink();
+
+    void start();
+    // returns false if the encoder has failed
+    bool push(const QImage& aImage, int aIndex);
+    // encodes the queued frames and stops the thread
+    bool finish();
+    // discards the queued frames and stops the thread
+    void cancel();
+
+private:
+    class Thread : public QThread
+    {
+    public:
+        Thread(ExportSink& aOwner) : mOwner(aOwner) {}
+    protected:
+        virtual void run() { mOwner.run(); }
+    private:
+        ExportSink& mOwner;
+    };
+
+    struct Frame
+    {
+        QImage image;
+        int index;
+    };
+
+    void run();
+    void stop(bool aDiscards);
+
+    Encoder mEncoder;
+    const int mCapacity;
+    Thread mThread;
+    QMutex mMutex;
+    QWaitCondition mCondition;
+    std::deque<Frame> mQueue;
+    bool mQuit;
+    bool mFailed;
+};
+
+} // namespace ctrl
+
+#endif // CTRL_EXPORTSINK_H
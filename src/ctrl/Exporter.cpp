@@ -1,9 +1,15 @@
+#include <algorithm>
+#include <cmath>
+#include <limits>
 #include <QFileInfo>
 #include <QBuffer>
+#include <QMutexLocker>
 #include <QApplication>
 #include "util/SelectArgs.h"
+#include "util/Profiler.h"
 #include "gl/Global.h"
 #include "gl/Util.h"
+#include "gl/DeviceInfo.h"
 #include "ctrl/Exporter.h"
 
 namespace ctrl
@@ -26,6 +32,8 @@ Exporter::CommonParam::CommonParam()
     , size()
     , frame()
     , fps()
+    , renderAtExportSize()
+    , supersampling(1)
 {
 }
 
@@ -59,8 +67,8 @@ Exporter::ImageParam::ImageParam()
 
 //-------------------------------------------------------------------------------------------------
 Exporter::GifParam::GifParam()
-    : optimizePalette()
-    , intermediateBps()
+    : perFramePalette()
+    , dithering(true)
 {
 }
 
@@ -74,6 +82,35 @@ Exporter::VideoParam::VideoParam()
 {
 }
 
+//-------------------------------------------------------------------------------------------------
+Exporter::SinkParam::SinkParam()
+    : type(SinkType_Image)
+    , path()
+    , size()
+    , image()
+    , gif()
+    , video()
+{
+}
+
+//-------------------------------------------------------------------------------------------------
+Exporter::DumpParam::DumpParam()
+    : dir()
+    , format("PNG")
+    , quality(-1)
+{
+}
+
+QString Exporter::DumpParam::filePath(int aIndex) const
+{
+    return dir + "/" + QString::number(aIndex) + "." + format.toLower();
+}
+
+QString Exporter::DumpParam::duplicatePath(int aIndex) const
+{
+    return dir + "/" + QString::number(aIndex) + ".dup";
+}
+
 //-------------------------------------------------------------------------------------------------
 Exporter::FFMpeg::FFMpeg()
     : mProcess()
@@ -181,6 +218,49 @@ QString Exporter::FFMpeg::popLog()
     return log;
 }
 
+//-------------------------------------------------------------------------------------------------
+struct Exporter::Output
+{
+    Output(const SinkParam& aParam, const CommonParam& aCommon)
+        : param(aParam)
+        , common(aCommon)
+        , framebuffers()
+        , gifFile()
+        , gifWriter()
+        , ffmpeg()
+        , videoInCodec()
+        , videoInCodecQuality()
+        , encodedMutex()
+        , encoded()
+        , lastEncoded()
+        , lastImagePath()
+        , error()
+        , sink()
+    {
+        common.path = aParam.path;
+        common.size = aParam.size;
+    }
+
+    SinkParam param;
+    // the common parameter with the path and the size of the sink
+    CommonParam common;
+    FramebufferList framebuffers;
+    QScopedPointer<QFile> gifFile;
+    QScopedPointer<img::GIFWriter> gifWriter;
+    FFMpeg ffmpeg;
+    const char* videoInCodec;
+    int videoInCodecQuality;
+    // the video frames are encoded on the thread of the sink, and are
+    // written to ffmpeg on the thread which owns the process
+    QMutex encodedMutex;
+    QList<QByteArray> encoded;
+    QByteArray lastEncoded;
+    QString lastImagePath;
+    QString error;
+    // the thread stops before the other members are destroyed
+    QScopedPointer<ExportSink> sink;
+};
+
 //-------------------------------------------------------------------------------------------------
 Exporter::Exporter(core::Project& aProject)
     : mProject(aProject)
@@ -198,10 +278,24 @@ Exporter::Exporter(core::Project& aProject)
     , mVideoInCodec()
     , mVideoInCodecQuality()
     , mVideoExporting()
+    , mRenderSize()
+    , mGifFile()
+    , mGifWriter()
+    , mDumpParam()
+    , mDumping()
+    , mFrameSource()
+    , mHasFrameSource()
+    , mOutputs()
     , mFFMpeg()
     , mExporting(false)
     , mIndex(0)
-    , mDigitCount(0)
+    , mIndexBegin(0)
+    , mIndexEnd(std::numeric_limits<int>::max())
+    , mLastFingerprint()
+    , mHasLastFrame()
+    , mLastVideoFrame()
+    , mLastImagePath()
+    , mSkippedCount()
     , mProgress(0.0f)
     , mLog()
     , mIsCanceled()
@@ -232,6 +326,19 @@ void Exporter::setUILogger(UILogger& aLogger)
     mUILogger = &aLogger;
 }
 
+void Exporter::setIndexRange(int aBegin, int aEnd)
+{
+    XC_ASSERT(0 <= aBegin && aBegin < aEnd);
+    mIndexBegin = aBegin;
+    mIndexEnd = aEnd;
+}
+
+void Exporter::setFrameSource(const DumpParam& aSource)
+{
+    mFrameSource = aSource;
+    mHasFrameSource = true;
+}
+
 Exporter::Result Exporter::execute(const CommonParam& aCommon, const ImageParam& aImage)
 {
     // check param
@@ -252,6 +359,7 @@ Exporter::Result Exporter::execute(const CommonParam& aCommon, const ImageParam&
     mCommonParam = aCommon;
     mImageParam = aImage;
     mVideoExporting = false;
+    mDumping = false;
     mOriginTimeInfo = mProject.currentTimeInfo();
     mOverwriteConfirmation = false;
     mLog.clear();
@@ -262,46 +370,45 @@ Exporter::Result Exporter::execute(const CommonParam& aCommon, const ImageParam&
 
 Exporter::Result Exporter::execute(const CommonParam& aCommon, const GifParam& aGif)
 {
-    const QString outFile = QFileInfo(aCommon.path).absoluteFilePath();
-    const QString workFile = outFile + "videocache.mp4";
-    const QString palette = outFile + "palettecache.png";
-
-    CommonParam commonParam = aCommon;
-    VideoParam videoParam;
-
-    if (aGif.optimizePalette)
-    {
-        commonParam.path = workFile;
-        videoParam.bps = aGif.intermediateBps;
-    }
-    else
+    // check param
+    if (!aCommon.isValid())
     {
-        videoParam.bps = 0;
+        mLog = "Invalid common parameters.";
+        return Result(ResultCode_InvalidOperation, mLog);
     }
 
+    // check file overwriting
+    mOverwriteConfirmation = false;
+    QFileInfo filePath(aCommon.path);
+    if (!checkOverwriting(filePath))
     {
-        auto result = execute(commonParam, videoParam);
-        if (!result) return result;
+        mLog = "Exporting was canceled.";
+        mIsCanceled = true;
+        return Result(ResultCode_Canceled, mLog);
     }
 
-    if (aGif.optimizePalette)
+    // the frames are encoded in process, without ffmpeg
+    mGifFile.reset(new QFile(filePath.absoluteFilePath()));
+    if (!mGifFile->open(QIODevice::WriteOnly | QIODevice::Truncate))
     {
+        mLog = "Failed to open the file.\n" + mGifFile->errorString();
+        mGifFile.reset();
+        return Result(ResultCode_InvalidOperation, mLog);
+    }
 
-        auto waiter = [=]()->bool { return true; };
-        if (mFFMpeg.execute(" -i " + workFile + " -vf palettegen -y " + palette, waiter)){
-            mFFMpeg.execute(" -i " + workFile + " -i " + palette + " -lavfi paletteuse -y " + outFile, waiter);
-        }
+    const auto paletteMode = aGif.perFramePalette ?
+                img::GIFWriter::PaletteMode_Local :
+                img::GIFWriter::PaletteMode_Global;
+    mGifWriter.reset(new img::GIFWriter(*mGifFile, aCommon.size, paletteMode, aGif.dithering));
 
-        QFile::remove(workFile);
-        QFile::remove(palette);
+    mCommonParam = aCommon;
+    mVideoExporting = false;
+    mDumping = false;
+    mOriginTimeInfo = mProject.currentTimeInfo();
+    mLog.clear();
+    mIsCanceled = false;
 
-        if (mFFMpeg.errorOccurred())
-        {
-            mLog = "FFmpeg error occurred.\n" + mFFMpeg.errorString();
-            return Result(ResultCode_FFMpegError, mLog);
-        }
-    }
-    return Result(ResultCode_Success, "Success.");
+    return execute();
 }
 
 Exporter::Result Exporter::execute(const CommonParam& aCommon, const VideoParam& aVideo)
@@ -325,6 +432,7 @@ Exporter::Result Exporter::execute(const CommonParam& aCommon, const VideoParam&
 
     mCommonParam = aCommon;
     mVideoExporting = true;
+    mDumping = false;
     mOriginTimeInfo = mProject.currentTimeInfo();
     mLog.clear();
     mIsCanceled = false;
@@ -360,78 +468,414 @@ Exporter::Result Exporter::execute(const CommonParam& aCommon, const VideoParam&
     }
 #else
     {
-        QString outPath = filePath.absoluteFilePath();
+        mVideoInCodec = getVideoInCodec(aVideo, mVideoInCodecQuality);
+        const QString command = getVideoCommand(
+                    aVideo, filePath.absoluteFilePath(), mCommonParam.fps);
 
-        VideoCodec videoCodec;
-        if (aVideo.codecIndex != -1)
+        if (!mFFMpeg.start(command))
         {
-            videoCodec = aVideo.format.codecs.at(aVideo.codecIndex);
+            mLog = "FFmpeg error occurred.\n" + mFFMpeg.errorString();
+            return mFFMpeg.errorCode() == QProcess::FailedToStart ?
+                        Result(ResultCode_FFMpegFailedToStart, mLog) :
+                        Result(ResultCode_FFMpegError, mLog);
         }
-        else
+    }
+#endif
+
+    return execute();
+}
+
+Exporter::Result Exporter::execute(const CommonParam& aCommon, const DumpParam& aDump)
+{
+    // check param
+    if (!aCommon.isValid())
+    {
+        mLog = "Invalid common parameters.";
+        return Result(ResultCode_InvalidOperation, mLog);
+    }
+
+    // check directory
+    QFileInfo path(aDump.dir);
+    if (!path.exists() || !path.isDir())
+    {
+        mLog = "Invalid directory path.";
+        return Result(ResultCode_InvalidOperation, mLog);
+    }
+
+    mCommonParam = aCommon;
+    mDumpParam = aDump;
+    mVideoExporting = false;
+    mDumping = true;
+    mOriginTimeInfo = mProject.currentTimeInfo();
+    mOverwriteConfirmation = false;
+    mLog.clear();
+    mIsCanceled = false;
+
+    return execute();
+}
+
+Exporter::Result Exporter::execute(const CommonParam& aCommon, const QVector<SinkParam>& aSinks)
+{
+    // the largest sink decides the render size
+    CommonParam common = aCommon;
+    common.path.clear();
+    common.size = QSize();
+    for (auto& sink : aSinks)
+    {
+        const QSize& size = sink.size;
+        if (size.width() * size.height() > common.size.width() * common.size.height())
         {
-            videoCodec.icodec = aVideo.format.icodec;
+            common.size = size;
         }
-        auto colorIndex = videoCodec.colorspace ? aVideo.colorIndex : 0;
+    }
 
-        mVideoInCodecQuality = -1;
-        if (videoCodec.icodec == "png")
+    // check param
+    if (aSinks.isEmpty() || !common.isValid())
+    {
+        mLog = "Invalid common parameters.";
+        return Result(ResultCode_InvalidOperation, mLog);
+    }
+
+    mCommonParam = common;
+    mVideoExporting = false;
+    mDumping = false;
+    mOriginTimeInfo = mProject.currentTimeInfo();
+    mOverwriteConfirmation = false;
+    mLog.clear();
+    mIsCanceled = false;
+
+    for (auto& sink : aSinks)
+    {
+        auto result = openOutput(sink);
+        if (!result)
         {
-            mVideoInCodec = "PNG";
-            mVideoInCodecQuality = 90;
+            closeOutputs(true);
+            return result;
         }
-        else if (videoCodec.icodec == "ppm")
+    }
+
+    return execute();
+}
+
+Exporter::Result Exporter::openOutput(const SinkParam& aParam)
+{
+    static const int kQueueCapacity = 4;
+
+    OutputPtr output(new Output(aParam, mCommonParam));
+    if (!output->common.isValid())
+    {
+        mLog = "Invalid sink parameters.";
+        return Result(ResultCode_InvalidOperation, mLog);
+    }
+
+    if (aParam.type == SinkType_Image)
+    {
+        QFileInfo path(aParam.path);
+        if (!path.exists() || !path.isDir())
         {
-            mVideoInCodec = "PPM";
+            mLog = "Invalid directory path.";
+            return Result(ResultCode_InvalidOperation, mLog);
         }
-        else if (videoCodec.icodec == "jpg")
+
+        // the overwriting is confirmed here, the thread of the sink can't ask it
+        const int count = getIndexCount(output->common, mOriginTimeInfo);
+        for (int i = 0; i < count; ++i)
         {
-            mVideoInCodec = "JPG";
+            const QFileInfo filePath(getImageFilePath(
+                                         output->common, aParam.image, mOriginTimeInfo.fps, i));
+            if (filePath.exists())
+            {
+                if (!checkOverwriting(filePath))
+                {
+                    mLog = "Exporting was canceled.";
+                    mIsCanceled = true;
+                    return Result(ResultCode_Canceled, mLog);
+                }
+                break;
+            }
         }
-        else if (videoCodec.icodec == "jpeg")
+    }
+    else
+    {
+        QFileInfo filePath(aParam.path);
+        if (!checkOverwriting(filePath))
         {
-            mVideoInCodec = "JPEG";
+            mLog = "Exporting was canceled.";
+            mIsCanceled = true;
+            return Result(ResultCode_Canceled, mLog);
         }
-        else if (videoCodec.icodec == "bmp")
+
+        if (aParam.type == SinkType_Gif)
         {
-            mVideoInCodec = "BMP";
+            output->gifFile.reset(new QFile(filePath.absoluteFilePath()));
+            if (!output->gifFile->open(QIODevice::WriteOnly | QIODevice::Truncate))
+            {
+                mLog = "Failed to open the file.\n" + output->gifFile->errorString();
+                return Result(ResultCode_InvalidOperation, mLog);
+            }
+
+            const auto paletteMode = aParam.gif.perFramePalette ?
+                        img::GIFWriter::PaletteMode_Local :
+                        img::GIFWriter::PaletteMode_Global;
+            output->gifWriter.reset(new img::GIFWriter(
+                                        *output->gifFile, aParam.size,
+                                        paletteMode, aParam.gif.dithering));
         }
         else
         {
-            videoCodec.icodec = "png";
-            mVideoInCodec = "PNG";
-            mVideoInCodecQuality = 90;
+            output->videoInCodec = getVideoInCodec(aParam.video, output->videoInCodecQuality);
+            const QString command = getVideoCommand(
+                        aParam.video, filePath.absoluteFilePath(), mCommonParam.fps);
+
+            if (!output->ffmpeg.start(command))
+            {
+                mLog = "FFmpeg error occurred.\n" + output->ffmpeg.errorString();
+                return output->ffmpeg.errorCode() == QProcess::FailedToStart ?
+                            Result(ResultCode_FFMpegFailedToStart, mLog) :
+                            Result(ResultCode_FFMpegError, mLog);
+            }
         }
+    }
+
+    output->sink.reset(new ExportSink(createEncoder(*output), kQueueCapacity));
+    mOutputs.push_back(std::move(output));
+    return Result(ResultCode_Success, "Success.");
+}
+
+ExportSink::Encoder Exporter::createEncoder(Output& aOutput)
+{
+    Output* output = &aOutput;
+
+    if (aOutput.param.type == SinkType_Gif)
+    {
+        return [=](const QImage& aImage, int aIndex) -> bool
+        {
+            const int delay = this->getGifDelay(aIndex);
+            const bool success = aImage.isNull() ?
+                        output->gifWriter->pushDuplicate(delay) :
+                        output->gifWriter->pushFrame(aImage, delay);
+            if (!success) output->error = output->gifWriter->errorString();
+            return success;
+        };
+    }
+    else if (aOutput.param.type == SinkType_Video)
+    {
+        return [=](const QImage& aImage, int) -> bool
+        {
+            // the encoded frame is sent again for a duplicate
+            if (!aImage.isNull())
+            {
+                QByteArray byteArray;
+                QBuffer buffer(&byteArray);
+                buffer.open(QIODevice::ReadWrite);
+                aImage.save(&buffer, output->videoInCodec, output->videoInCodecQuality);
+                buffer.close();
+                output->lastEncoded = byteArray;
+            }
+
+            QMutexLocker locker(&output->encodedMutex);
+            output->encoded.push_back(output->lastEncoded);
+            return true;
+        };
+    }
+
+    const int originFps = mOriginTimeInfo.fps;
+    return [=](const QImage& aImage, int aIndex) -> bool
+    {
+        const QString path = getImageFilePath(
+                    output->common, output->param.image, originFps, aIndex);
 
-        // qDebug() << "videoCodec : " << videoCodec.command;
-        if (videoCodec.command.isEmpty())
+        if (aImage.isNull())
         {
-            videoCodec.command = "-y -f image2pipe -framerate $ifps -i - -b:v $obps -r $ofps $opath";
+            // the file of the previous frame is copied
+            if (QFileInfo::exists(path)) QFile::remove(path);
+            if (!QFile::copy(output->lastImagePath, path))
+            {
+                output->error = "Failed to copy " + output->lastImagePath + " to " + path;
+                return false;
+            }
+            return true;
         }
 
-        videoCodec.command.replace(QRegExp("\\$ifps(\\s|$)"), QString::number(mCommonParam.fps) + "\\1");
-        videoCodec.command.replace(QRegExp("\\$icodec(\\s|$)"), videoCodec.icodec + "\\1");
-        videoCodec.command.replace(QRegExp("\\$obps(\\s|$)"), QString::number(aVideo.bps * 1000) + "\\1");
-        videoCodec.command.replace(QRegExp("\\$ofps(\\s|$)"), QString::number(mCommonParam.fps) + "\\1");
-        videoCodec.command.replace(QRegExp("\\$ocodec(\\s|$)"), videoCodec.name + "\\1");
-        videoCodec.command.replace(QRegExp("\\$opath(\\s|$)"), outPath.replace(" ", "%20"));
-        videoCodec.command.replace(QRegExp("\\$pixfmt(\\s|$)"), aVideo.pixfmt + "\\1");
-        videoCodec.command.replace(QRegExp("\\$arg_colorfilter(\\s|$)"), (colorIndex == 0 ? QString("-vf colormatrix=bt601:bt709") : QString("")) + "\\1");
-        videoCodec.command.replace(QRegExp("\\$arg_colorspace(\\s|$)"), QString("-colorspace ") + (colorIndex == 0 ? QString("bt709") : QString("smpte170m")) + "\\1");
-        // videoCodec.command.replace("\\", "");
+        if (!aImage.save(path, Q_NULLPTR, output->param.image.quality))
+        {
+            output->error = "Failed to write " + path;
+            return false;
+        }
+        output->lastImagePath = path;
+        return true;
+    };
+}
 
-        // qDebug() << videoCodec.command;
+bool Exporter::pushToOutputs(int aIndex, bool aIsDuplicate)
+{
+    for (auto& output : mOutputs)
+    {
+        // a null image repeats the previous frame
+        QImage image;
+        if (!aIsDuplicate)
+        {
+            image = drawScaling(output->framebuffers).toImage();
+        }
 
-        if (!mFFMpeg.start(videoCodec.command))
+        if (!output->sink->push(image, aIndex))
         {
-            mLog = "FFmpeg error occurred.\n" + mFFMpeg.errorString();
-            return mFFMpeg.errorCode() == QProcess::FailedToStart ?
-                        Result(ResultCode_FFMpegFailedToStart, mLog) :
-                        Result(ResultCode_FFMpegError, mLog);
+            mLog = output->error;
+            return false;
+        }
+
+        if (!writeEncodedVideo(*output))
+        {
+            return false;
         }
     }
-#endif
+    return true;
+}
 
-    return execute();
+bool Exporter::writeEncodedVideo(Output& aOutput)
+{
+    if (aOutput.param.type != SinkType_Video)
+    {
+        return true;
+    }
+
+    QList<QByteArray> encoded;
+    {
+        QMutexLocker locker(&aOutput.encodedMutex);
+        encoded.swap(aOutput.encoded);
+    }
+
+    for (auto& bytes : encoded)
+    {
+        aOutput.ffmpeg.write(bytes);
+    }
+
+    if (aOutput.ffmpeg.errorOccurred())
+    {
+        mLog = "FFmpeg error occurred.\n" + aOutput.ffmpeg.errorString();
+        return false;
+    }
+    return true;
+}
+
+Exporter::Result Exporter::closeOutputs(bool aDiscards)
+{
+    Result result(ResultCode_Success, "Success.");
+
+    for (auto& output : mOutputs)
+    {
+        if (aDiscards)
+        {
+            output->sink->cancel();
+        }
+        else if (!output->sink->finish())
+        {
+            mLog = output->error;
+            result = Result(ResultCode_UnclassfiedError, mLog);
+        }
+
+        if (output->param.type == SinkType_Video)
+        {
+            if (!aDiscards && !writeEncodedVideo(*output))
+            {
+                result = Result(ResultCode_FFMpegError, mLog);
+            }
+
+            auto success = output->ffmpeg.finish([=]()->bool
+            {
+                // update log if necessary
+                this->updateLog();
+                return true;
+            });
+            if (!success && !aDiscards)
+            {
+                mLog = "FFmpeg error occurred.\n" + output->ffmpeg.errorString();
+                result = Result(ResultCode_FFMpegError, mLog);
+            }
+        }
+        else if (output->param.type == SinkType_Gif)
+        {
+            if (!aDiscards && !output->gifWriter->finish())
+            {
+                mLog = output->gifWriter->errorString();
+                result = Result(ResultCode_UnclassfiedError, mLog);
+            }
+            output->gifWriter.reset();
+            output->gifFile->close();
+            if (aDiscards) output->gifFile->remove();
+        }
+    }
+
+    // the framebuffers of the outputs
+    gl::Global::makeCurrent();
+    mOutputs.clear();
+    return result;
+}
+
+QString Exporter::getVideoCommand(const VideoParam& aVideo, const QString& aOutPath, int aFps)
+{
+    QString outPath = aOutPath;
+
+    VideoCodec videoCodec;
+    if (aVideo.codecIndex != -1)
+    {
+        videoCodec = aVideo.format.codecs.at(aVideo.codecIndex);
+    }
+    else
+    {
+        videoCodec.icodec = aVideo.format.icodec;
+    }
+    auto colorIndex = videoCodec.colorspace ? aVideo.colorIndex : 0;
+
+    int quality = 0;
+    videoCodec.icodec = QString(getVideoInCodec(aVideo, quality)).toLower();
+
+    // qDebug() << "videoCodec : " << videoCodec.command;
+    if (videoCodec.command.isEmpty())
+    {
+        videoCodec.command = "-y -f image2pipe -framerate $ifps -i - -b:v $obps -r $ofps $opath";
+    }
+
+    videoCodec.command.replace(QRegExp("\\$ifps(\\s|$)"), QString::number(aFps) + "\\1");
+    videoCodec.command.replace(QRegExp("\\$icodec(\\s|$)"), videoCodec.icodec + "\\1");
+    videoCodec.command.replace(QRegExp("\\$obps(\\s|$)"), QString::number(aVideo.bps * 1000) + "\\1");
+    videoCodec.command.replace(QRegExp("\\$ofps(\\s|$)"), QString::number(aFps) + "\\1");
+    videoCodec.command.replace(QRegExp("\\$ocodec(\\s|$)"), videoCodec.name + "\\1");
+    videoCodec.command.replace(QRegExp("\\$opath(\\s|$)"), outPath.replace(" ", "%20"));
+    videoCodec.command.replace(QRegExp("\\$pixfmt(\\s|$)"), aVideo.pixfmt + "\\1");
+    videoCodec.command.replace(QRegExp("\\$arg_colorfilter(\\s|$)"), (colorIndex == 0 ? QString("-vf colormatrix=bt601:bt709") : QString("")) + "\\1");
+    videoCodec.command.replace(QRegExp("\\$arg_colorspace(\\s|$)"), QString("-colorspace ") + (colorIndex == 0 ? QString("bt709") : QString("smpte170m")) + "\\1");
+    // videoCodec.command.replace("\\", "");
+
+    // qDebug() << videoCodec.command;
+    return videoCodec.command;
+}
+
+const char* Exporter::getVideoInCodec(const VideoParam& aVideo, int& aQuality)
+{
+    const QString icodec = (aVideo.codecIndex != -1) ?
+                aVideo.format.codecs.at(aVideo.codecIndex).icodec :
+                aVideo.format.icodec;
+
+    aQuality = -1;
+    if (icodec == "ppm")
+    {
+        return "PPM";
+    }
+    else if (icodec == "jpg")
+    {
+        return "JPG";
+    }
+    else if (icodec == "jpeg")
+    {
+        return "JPEG";
+    }
+    else if (icodec == "bmp")
+    {
+        return "BMP";
+    }
+    aQuality = 90;
+    return "PNG";
 }
 
 Exporter::Result Exporter::execute()
@@ -477,9 +921,9 @@ Exporter::Result Exporter::execute()
 
             if (mProgressReporter->wasCanceled())
             {
+                mIsCanceled = true;
                 finish();
                 mLog = "Export was canceled.";
-                mIsCanceled = true;
                 return Result(ResultCode_Canceled, mLog);
             }
         }
@@ -499,14 +943,35 @@ Exporter::Result Exporter::execute()
 Exporter::Result Exporter::start()
 {
     // reset value
-    mIndex = 0;
+    mIndex = mIndexBegin;
+    mHasLastFrame = false;
+    mLastVideoFrame.clear();
+    mLastImagePath.clear();
+    mSkippedCount = 0;
     mProgress = 0.0f;
-    mDigitCount = getDigitCount(
-                mCommonParam.frame,
-                mCommonParam.fps,
-                mOriginTimeInfo.fps);
 
-    // initialize graphics
+    // the rendered frames read the baked tracks
+    if (!mHasFrameSource)
+    {
+        mProject.objectTree().updateBake(mOriginTimeInfo);
+    }
+
+    // a shard knows whether its first frame repeats the last frame of
+    // the previous shard, so that the dump marks it as the serial export
+    if (mDumping && mIndexBegin > 0)
+    {
+        double frame = 0.0;
+        if (getFrameOfIndex(mCommonParam, mOriginTimeInfo, mIndexBegin - 1, frame))
+        {
+            core::TimeInfo timeInfo = mOriginTimeInfo;
+            timeInfo.frame = core::Frame::fromDecimal(frame);
+            mLastFingerprint = mProject.objectTree().fingerprint(timeInfo, true);
+            mHasLastFrame = true;
+        }
+    }
+
+    // initialize graphics, the dumped frames are not rendered
+    if (!mHasFrameSource)
     {
         gl::Global::makeCurrent();
 
@@ -517,42 +982,82 @@ Exporter::Result Exporter::start()
             Result(ResultCode_UnclassfiedError, mLog);
         }
 
-        // framebuffers
-        createFramebuffers(mProject.attribute().imageSize(), mCommonParam.size);
+        // framebuffers, the outputs scale the rendered frame for themselves
+        mRenderSize = getRenderSize();
+        createFramebuffers(mRenderSize, mOutputs.empty() ? mCommonParam.size : mRenderSize);
+        for (auto& output : mOutputs)
+        {
+            pushScalingFramebuffers(output->framebuffers, mRenderSize, output->param.size);
+        }
 
         // clipping frame
         mClippingFrame.reset(new core::ClippingFrame());
-        mClippingFrame->resize(mProject.attribute().imageSize());
+        mClippingFrame->resize(mRenderSize);
 
         // create texturizer for destination colors of the framebuffer
         mDestinationTexturizer.reset(new core::DestinationTexturizer());
-        mDestinationTexturizer->resize(mProject.attribute().imageSize());
+        mDestinationTexturizer->resize(mRenderSize);
+    }
+
+    for (auto& output : mOutputs)
+    {
+        output->sink->start();
     }
 
     mExporting = true;
     return Result(ResultCode_Success, "Success.");
 }
 
-bool Exporter::updateTime(core::TimeInfo& aDst)
+bool Exporter::getFrameOfIndex(const CommonParam& aCommon, const core::TimeInfo& aOrigin,
+                               int aIndex, double& aFrame)
 {
-    aDst = mOriginTimeInfo;
-
-    const int range = mCommonParam.frame.diff() + 1;
-    const double current = (mIndex * mOriginTimeInfo.fps) / (double)mCommonParam.fps;
-    const double frame = mCommonParam.frame.min() + current;
+    const double current = (aIndex * aOrigin.fps) / (double)aCommon.fps;
+    aFrame = aCommon.frame.min() + current;
 
     // end of export
-    if (0 < mIndex && mCommonParam.frame.max() < frame)
+    if (0 < aIndex && aCommon.frame.max() < aFrame)
     {
         return false;
     }
-    if (mOriginTimeInfo.frameMax < (int)frame)
+    if (aOrigin.frameMax < (int)aFrame)
+    {
+        return false;
+    }
+    return true;
+}
+
+int Exporter::getIndexCount(const CommonParam& aCommon, const core::TimeInfo& aOrigin)
+{
+    int count = 0;
+    double frame = 0.0;
+    while (getFrameOfIndex(aCommon, aOrigin, count, frame))
+    {
+        ++count;
+    }
+    return count;
+}
+
+bool Exporter::updateTime(core::TimeInfo& aDst)
+{
+    aDst = mOriginTimeInfo;
+
+    double frame = 0.0;
+    if (mIndexEnd <= mIndex ||
+            !getFrameOfIndex(mCommonParam, mOriginTimeInfo, mIndex, frame))
     {
         return false;
     }
 
     aDst.frame = core::Frame::fromDecimal(frame);
-    mProgress = (float)current / range;
+    if (mIndexBegin > 0 || mIndexEnd < std::numeric_limits<int>::max())
+    {
+        mProgress = (float)(mIndex - mIndexBegin) / (mIndexEnd - mIndexBegin);
+    }
+    else
+    {
+        const int range = mCommonParam.frame.diff() + 1;
+        mProgress = (float)(frame - mCommonParam.frame.min()) / range;
+    }
 
     // to next index
     ++mIndex;
@@ -566,6 +1071,7 @@ bool Exporter::update()
     {
         return false;
     }
+    util::ProfileZone zone("export frame");
 
     const int currentIndex = mIndex;
 
@@ -576,6 +1082,22 @@ bool Exporter::update()
         return false;
     }
 
+    if (mHasFrameSource)
+    {
+        return importFrame(currentIndex);
+    }
+
+    // a frame whose blended state equals the previous one reuses
+    // the previous output, as the limited animation does on twos
+    const uint64 fingerprint = mProject.objectTree().fingerprint(timeInfo, true);
+    if (mHasLastFrame && fingerprint == mLastFingerprint)
+    {
+        ++mSkippedCount;
+        updateLog();
+        return exportDuplicate(currentIndex);
+    }
+    mLastFingerprint = fingerprint;
+
     // begin rendering
     gl::Global::makeCurrent();
     gl::Global::Functions& ggl = gl::Global::functions();
@@ -595,13 +1117,20 @@ bool Exporter::update()
     }
 
     // setup
-    gl::Util::setViewportAsActualPixels(originSize);
+    gl::Util::setViewportAsActualPixels(mRenderSize);
     gl::Util::clearColorBuffer(0.0, 0.0, 0.0, 0.0);
     gl::Util::resetRenderState();
 
     // render
     core::RenderInfo renderInfo;
-    renderInfo.camera.reset(originSize, 1.0, originSize, QPoint());
+    renderInfo.camera.reset(mRenderSize, 1.0, originSize, QPoint());
+    if (mRenderSize != originSize)
+    {
+        // the tree is rendered at the export resolution
+        renderInfo.camera.setScale((float)mRenderSize.width() / originSize.width());
+        renderInfo.camera.setCenter(QVector2D(mRenderSize.width() * 0.5f,
+                                              mRenderSize.height() * 0.5f));
+    }
     renderInfo.time = timeInfo;
     renderInfo.framebuffer = mFramebuffers.front()->handle();
     renderInfo.dest = mFramebuffers.front()->texture();
@@ -620,30 +1149,19 @@ bool Exporter::update()
         XC_FATAL_ERROR("OpenGL Error", "Failed to bind framebuffer.", "");
     }
 
-    // scaling
+    // the outputs scale the frame for themselves
+    if (!mOutputs.empty())
     {
-        QOpenGLFramebufferObject* prev = nullptr;
-        for (auto& fbo : mFramebuffers)
-        {
-            if (prev)
-            {
-                fbo->bind();
-
-                const QSize size = fbo->size();
-                gl::Util::setViewportAsActualPixels(size);
-                gl::Util::clearColorBuffer(0.0, 0.0, 0.0, 0.0);
-
-                mTextureDrawer.draw(prev->texture());
-
-                fbo->release();
-            }
-            prev = fbo.get();
-        }
+        const bool success = pushToOutputs(currentIndex, false);
+        ggl.glFlush();
+        updateLog();
+        if (success) mHasLastFrame = true;
+        return success;
     }
 
     {
-        // create image
-        auto outImage = mFramebuffers.back()->toImage();
+        // scaling and create image
+        auto outImage = drawScaling(mFramebuffers).toImage();
 
         // flush
         ggl.glFlush();
@@ -656,13 +1174,79 @@ bool Exporter::update()
         {
             return false;
         }
+        mHasLastFrame = true;
+    }
+
+    return true;
+}
+
+bool Exporter::importFrame(int aIndex)
+{
+    updateLog();
+
+    if (QFileInfo::exists(mFrameSource.duplicatePath(aIndex)))
+    {
+        ++mSkippedCount;
+        return exportDuplicate(aIndex);
     }
 
+    QFile file(mFrameSource.filePath(aIndex));
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        mLog = "Failed to read " + file.fileName();
+        return false;
+    }
+    const QByteArray bytes = file.readAll();
+
+    if (mVideoExporting)
+    {
+        // the frame was encoded in the format of the pipe
+        mFFMpeg.write(bytes);
+        mLastVideoFrame = bytes;
+
+        if (mFFMpeg.errorOccurred())
+        {
+            mLog = "FFmpeg error occurred.\n" + mFFMpeg.errorString();
+            return false;
+        }
+    }
+    else
+    {
+        QImage image;
+        if (!image.loadFromData(bytes, mFrameSource.format.toLatin1().constData()) ||
+                !exportImage(image, aIndex))
+        {
+            if (mLog.isEmpty()) mLog = "Failed to decode " + file.fileName();
+            return false;
+        }
+    }
+    mHasLastFrame = true;
     return true;
 }
 
 bool Exporter::exportImage(const QImage& aFboImage, int aIndex)
 {
+    if (mDumping)
+    {
+        const QString path = mDumpParam.filePath(aIndex);
+        if (!aFboImage.save(path, mDumpParam.format.toLatin1().constData(), mDumpParam.quality))
+        {
+            mLog = "Failed to write " + path;
+            return false;
+        }
+        return true;
+    }
+
+    if (mGifWriter)
+    {
+        if (!mGifWriter->pushFrame(aFboImage, getGifDelay(aIndex)))
+        {
+            mLog = mGifWriter->errorString();
+            return false;
+        }
+        return true;
+    }
+
     // decide file path
     QFileInfo filePath;
     if (!decideImagePath(aIndex, filePath))
@@ -679,6 +1263,7 @@ bool Exporter::exportImage(const QImage& aFboImage, int aIndex)
         //aFboImage.save(&buffer, "PPM");
         buffer.close();
         mFFMpeg.write(byteArray);
+        mLastVideoFrame = byteArray;
 
         if (mFFMpeg.errorOccurred())
         {
@@ -692,15 +1277,90 @@ bool Exporter::exportImage(const QImage& aFboImage, int aIndex)
         //             aFboImage.height(), QImage::Format_ARGB32);
         //image.save(aFilePath);
         aFboImage.save(filePath.filePath(), Q_NULLPTR, mImageParam.quality);
+        mLastImagePath = filePath.filePath();
+    }
+
+    return true;
+}
+
+bool Exporter::exportDuplicate(int aIndex)
+{
+    if (!mOutputs.empty())
+    {
+        return pushToOutputs(aIndex, true);
+    }
+
+    if (mDumping)
+    {
+        // the reader repeats its previous frame
+        QFile marker(mDumpParam.duplicatePath(aIndex));
+        if (!marker.open(QIODevice::WriteOnly | QIODevice::Truncate))
+        {
+            mLog = "Failed to write " + marker.fileName();
+            return false;
+        }
+        return true;
+    }
+
+    if (mGifWriter)
+    {
+        if (!mGifWriter->pushDuplicate(getGifDelay(aIndex)))
+        {
+            mLog = mGifWriter->errorString();
+            return false;
+        }
+        return true;
+    }
+
+    if (mVideoExporting)
+    {
+        // the encoded frame is sent again
+        mFFMpeg.write(mLastVideoFrame);
+
+        if (mFFMpeg.errorOccurred())
+        {
+            mLog = "FFmpeg error occurred.\n" + mFFMpeg.errorString();
+            return false;
+        }
+        return true;
+    }
+
+    QFileInfo filePath;
+    if (!decideImagePath(aIndex, filePath))
+    {
+        return false;
     }
 
+    // the file of the previous frame is copied
+    if (filePath.exists())
+    {
+        QFile::remove(filePath.filePath());
+    }
+    if (!QFile::copy(mLastImagePath, filePath.filePath()))
+    {
+        mLog = "Failed to copy " + mLastImagePath + " to " + filePath.filePath();
+        return false;
+    }
     return true;
 }
 
+int Exporter::getGifDelay(int aIndex) const
+{
+    // the delays are in 1/100 seconds, rounding the accumulated time
+    // keeps the total length of the animation
+    const double fps = mCommonParam.fps;
+    return qRound(100 * (aIndex + 1) / fps) - qRound(100 * aIndex / fps);
+}
+
 Exporter::Result Exporter::finish()
 {
     Result result(ResultCode_Success, "Success.");
 
+    if (!mOutputs.empty())
+    {
+        result = closeOutputs(mIsCanceled || !mExporting);
+    }
+
     if (mExporting)
     {
         if (mVideoExporting)
@@ -718,16 +1378,72 @@ Exporter::Result Exporter::finish()
             }
         }
 
+        if (mGifWriter)
+        {
+            // a canceled gif is removed without encoding the rest
+            if (!mIsCanceled && !mGifWriter->finish())
+            {
+                mLog = mGifWriter->errorString();
+                result = Result(ResultCode_UnclassfiedError, mLog);
+            }
+            mGifWriter.reset();
+            mGifFile->close();
+            if (mIsCanceled) mGifFile->remove();
+            mGifFile.reset();
+        }
+
+        if (mUILogger && mSkippedCount > 0)
+        {
+            mUILogger->pushLog(
+                        QString("%1 of %2 frames were the same as the previous ones "
+                                "and were not rendered again.").arg(mSkippedCount).arg(mIndex),
+                        ctrl::UILogType_Info);
+        }
+
         mExporting = false;
     }
     return result;
 }
 
+QSize Exporter::getRenderSize() const
+{
+    static const int kMaxSupersampling = 4;
+    const QSize originSize = mProject.attribute().imageSize();
+    const QSize exportSize = mCommonParam.size;
+
+    if (!mCommonParam.renderAtExportSize || originSize == exportSize)
+    {
+        return originSize;
+    }
+
+    // the camera has a uniform scale only
+    const double height = originSize.height() * exportSize.width() / (double)originSize.width();
+    if (std::abs(height - exportSize.height()) > 1.0)
+    {
+        return originSize;
+    }
+
+    int maxLength = std::numeric_limits<int>::max();
+    if (gl::DeviceInfo::validInstanceExists())
+    {
+        const gl::DeviceInfo& info = gl::DeviceInfo::instance();
+        maxLength = std::min(info.maxTextureSize, info.maxRenderBufferSize);
+    }
+
+    int factor = std::min(std::max(mCommonParam.supersampling, 1), kMaxSupersampling);
+    while (factor > 1 && std::max(exportSize.width(), exportSize.height()) * factor > maxLength)
+    {
+        --factor;
+    }
+    return exportSize * factor;
+}
+
 void Exporter::destroyFramebuffers()
 {
-    for (auto& fbo : mFramebuffers)
+    mFramebuffers.clear();
+    for (auto& output : mOutputs)
     {
-        fbo.reset();
+        output->framebuffers.clear();
     }
 }
 
@@ -737,40 +1453,63 @@ void Exporter::createFramebuffers(const QSize& aOriginSize, const QSize& aExport
 
     mFramebuffers.emplace_back(
                 FramebufferPtr(new QOpenGLFramebufferObject(aOriginSize)));
+    setTextureParam(*mFramebuffers.back());
 
     // setup buffers for scaling
-    if (aOriginSize != aExportSize)
+    pushScalingFramebuffers(mFramebuffers, aOriginSize, aExportSize);
+}
+
+void Exporter::pushScalingFramebuffers(FramebufferList& aList, const QSize& aOriginSize,
+                                       const QSize& aExportSize)
+{
+    static const int kMaxCount = 3;
+    if (aOriginSize == aExportSize) return;
+
+    QSize size = aOriginSize;
+    for (int i = 0; i < kMaxCount; ++i)
     {
-        static const int kMaxCount = 3;
-        QSize size = aOriginSize;
+        const double scaleX = aExportSize.width() / (double)size.width();
+        const double scaleY = aExportSize.height() / (double)size.height();
+        const double scaleMax = std::max(scaleX, scaleY);
 
-        for (int i = 0; i < kMaxCount; ++i)
+        if (scaleMax >= 0.5 || i == kMaxCount - 1)
         {
-            const double scaleX = aExportSize.width() / (double)size.width();
-            const double scaleY = aExportSize.height() / (double)size.height();
-            const double scaleMax = std::max(scaleX, scaleY);
-
-            if (scaleMax >= 0.5 || i == kMaxCount - 1)
-            {
-                mFramebuffers.emplace_back(
-                            FramebufferPtr(new QOpenGLFramebufferObject(aExportSize)));
-                break;
-            }
-            else
-            {
-                size.setWidth((int)(size.width() * 0.5));
-                size.setHeight((int)(size.height() * 0.5));
-                mFramebuffers.emplace_back(
-                            FramebufferPtr(new QOpenGLFramebufferObject(size)));
-            }
+            size = aExportSize;
         }
+        else
+        {
+            size.setWidth((int)(size.width() * 0.5));
+            size.setHeight((int)(size.height() * 0.5));
+        }
+
+        aList.emplace_back(FramebufferPtr(new QOpenGLFramebufferObject(size)));
+        setTextureParam(*aList.back());
+
+        if (size == aExportSize) break;
     }
+}
 
-    // setup texture
-    for (auto& fbo : mFramebuffers)
+QOpenGLFramebufferObject& Exporter::drawScaling(FramebufferList& aList)
+{
+    // each framebuffer of the list is drawn from the previous one,
+    // beginning with the rendered frame
+    QOpenGLFramebufferObject* prev = mFramebuffers.front().get();
+    for (auto& fbo : aList)
     {
-        setTextureParam(*fbo);
+        if (fbo.get() == prev) continue;
+
+        fbo->bind();
+
+        const QSize size = fbo->size();
+        gl::Util::setViewportAsActualPixels(size);
+        gl::Util::clearColorBuffer(0.0, 0.0, 0.0, 0.0);
+
+        mTextureDrawer.draw(prev->texture());
+
+        fbo->release();
+        prev = fbo.get();
     }
+    return *prev;
 }
 
 void Exporter::setTextureParam(QOpenGLFramebufferObject& aFbo)
@@ -785,11 +1524,17 @@ void Exporter::setTextureParam(QOpenGLFramebufferObject& aFbo)
     ggl.glBindTexture(GL_TEXTURE_2D, 0);
 }
 
+QString Exporter::getImageFilePath(const CommonParam& aCommon, const ImageParam& aImage,
+                                   int aOriginFps, int aIndex)
+{
+    const int digitCount = getDigitCount(aCommon.frame, aCommon.fps, aOriginFps);
+    const QString number = QString("%1").arg(aIndex, digitCount, 10, QChar('0'));
+    return aCommon.path + "/" + aImage.name + number + "." + aImage.suffix;
+}
+
 bool Exporter::decideImagePath(int aIndex, QFileInfo& aPath)
 {
-    const QString number = QString("%1").arg(aIndex, mDigitCount, 10, QChar('0'));
-    QFileInfo filePath(mCommonParam.path + "/" + mImageParam.name +
-                       number + "." + mImageParam.suffix);
+    QFileInfo filePath(getImageFilePath(mCommonParam, mImageParam, mOriginTimeInfo.fps, aIndex));
 
     // check overwrite
     if (!checkOverwriting(filePath))
@@ -835,6 +1580,18 @@ void Exporter::updateLog()
             mUILogger->pushLog(log, ctrl::UILogType_Info);
         }
     }
+
+    for (auto& output : mOutputs)
+    {
+        if (mUILogger && output->param.type == SinkType_Video)
+        {
+            auto log = output->ffmpeg.popLog();
+            if (!log.isEmpty())
+            {
+                mUILogger->pushLog(log, ctrl::UILogType_Info);
+            }
+        }
+    }
 }
 
 } // namespace ctrl
@@ -2,23 +2,28 @@
 #define CTRL_EXPORTER_H
 
 #include <list>
+#include <vector>
 #include <memory>
 #include <functional>
 #include <QString>
 #include <QSize>
 #include <QFileInfo>
 #include <QProcess>
+#include <QFile>
+#include <QVector>
 #include <QOpenGLFramebufferObject>
 #include "util/Range.h"
 #include "util/IProgressReporter.h"
 #include "ctrl/UILogger.h"
 #include "gl/EasyTextureDrawer.h"
+#include "img/GIFWriter.h"
 #include "core/Project.h"
 #include "core/TimeInfo.h"
 #include "core/TimeKeyBlender.h"
 #include "core/ClippingFrame.h"
 #include "core/DestinationTexturizer.h"
 #include "ctrl/VideoFormat.h"
+#include "ctrl/ExportSink.h"
 
 namespace ctrl
 {
@@ -55,6 +60,11 @@ public:
         QSize size;
         util::Range frame;
         int fps;
+        // renders the tree at the export size instead of scaling down the
+        // image of the project size. it is ignored if the aspect changes.
+        bool renderAtExportSize;
+        // render size multiplier of renderAtExportSize, 1 to 4
+        int supersampling;
         bool isValid() const;
     };
 
@@ -71,8 +81,8 @@ public:
     struct GifParam
     {
         GifParam();
-        bool optimizePalette;
-        int intermediateBps;
+        bool perFramePalette;
+        bool dithering;
     };
 
     struct ImageParam
@@ -83,19 +93,73 @@ public:
         int quality;
     };
 
+    enum SinkType
+    {
+        SinkType_Image,
+        SinkType_Gif,
+        SinkType_Video
+    };
+
+    // an output of the export which shares the rendered frames with
+    // the other outputs, and encodes them on its own thread
+    struct SinkParam
+    {
+        SinkParam();
+        SinkType type;
+        // the directory of an image sequence, or the file of a gif or a video
+        QString path;
+        QSize size;
+        ImageParam image;
+        GifParam gif;
+        VideoParam video;
+    };
+
+    // the frames which a worker of the sharded export renders into
+    // a directory, a file per frame index
+    struct DumpParam
+    {
+        DumpParam();
+        QString dir;
+        // the image format of QImage::save
+        QString format;
+        int quality;
+        QString filePath(int aIndex) const;
+        // the empty file which marks a frame repeating the previous one
+        QString duplicatePath(int aIndex) const;
+    };
+
     Exporter(core::Project& aProject);
     ~Exporter();
 
     void setOverwriteConfirmer(const OverwriteConfirmer& aConfirmer);
     void setProgressReporter(util::IProgressReporter& aReporter);
     void setUILogger(ctrl::UILogger& aLogger);
+    // exports the frame indices [aBegin, aEnd) only
+    void setIndexRange(int aBegin, int aEnd);
+    // the frames are read from the dump instead of rendering them
+    void setFrameSource(const DumpParam& aSource);
 
     Result execute(const CommonParam& aCommon, const ImageParam& aImage);
     Result execute(const CommonParam& aCommon, const GifParam& aGif);
     Result execute(const CommonParam& aCommon, const VideoParam& aVideo);
+    Result execute(const CommonParam& aCommon, const DumpParam& aDump);
+    // renders each frame once for all of the sinks. the path and the size
+    // of the common parameter are replaced by the ones of the sinks.
+    Result execute(const CommonParam& aCommon, const QVector<SinkParam>& aSinks);
 
     const QString& log() const { return mLog; }
     bool isCanceled() const { return mIsCanceled; }
+    // count of the frames which reused the previous output
+    int skippedFrameCount() const { return mSkippedCount; }
+
+    // count of the frame indices to export
+    static int getIndexCount(const CommonParam& aCommon, const core::TimeInfo& aOrigin);
+    static QString getImageFilePath(const CommonParam& aCommon, const ImageParam& aImage,
+                                    int aOriginFps, int aIndex);
+    // the image format which is piped into ffmpeg
+    static const char* getVideoInCodec(const VideoParam& aVideo, int& aQuality);
+    // the arguments of ffmpeg
+    static QString getVideoCommand(const VideoParam& aVideo, const QString& aOutPath, int aFps);
 
 private:
     typedef std::unique_ptr<QOpenGLFramebufferObject> FramebufferPtr;
@@ -123,15 +187,32 @@ private:
         QStringList mLogs;
     };
 
+    struct Output;
+    typedef std::unique_ptr<Output> OutputPtr;
+
     int mTick = 0;
     Result execute();
     Result start();
     bool update();
     Result finish();
     bool updateTime(core::TimeInfo& aDst);
+    static bool getFrameOfIndex(const CommonParam& aCommon, const core::TimeInfo& aOrigin,
+                                int aIndex, double& aFrame);
+    bool importFrame(int aIndex);
     bool exportImage(const QImage& aFboImage, int aIndex);
+    bool exportDuplicate(int aIndex);
+    Result openOutput(const SinkParam& aParam);
+    ExportSink::Encoder createEncoder(Output& aOutput);
+    bool pushToOutputs(int aIndex, bool aIsDuplicate);
+    bool writeEncodedVideo(Output& aOutput);
+    Result closeOutputs(bool aDiscards);
+    int getGifDelay(int aIndex) const;
+    QSize getRenderSize() const;
     void destroyFramebuffers();
     void createFramebuffers(const QSize& aOriginSize, const QSize& aExportSize);
+    void pushScalingFramebuffers(FramebufferList& aList, const QSize& aOriginSize,
+                                 const QSize& aExportSize);
+    QOpenGLFramebufferObject& drawScaling(FramebufferList& aList);
     void setTextureParam(QOpenGLFramebufferObject& aFbo);
     static int getDigitCount(const util::Range& aRange, int aFps, int aFpsOrigin);
     bool decideImagePath(int aIndex, QFileInfo& aPath);
@@ -154,11 +235,25 @@ private:
     const char* mVideoInCodec;
     int mVideoInCodecQuality;
     bool mVideoExporting;
+    QSize mRenderSize;
+    QScopedPointer<QFile> mGifFile;
+    QScopedPointer<img::GIFWriter> mGifWriter;
+    DumpParam mDumpParam;
+    bool mDumping;
+    DumpParam mFrameSource;
+    bool mHasFrameSource;
+    std::vector<OutputPtr> mOutputs;
 
     FFMpeg mFFMpeg;
     bool mExporting;
     int mIndex;
-    int mDigitCount;
+    int mIndexBegin;
+    int mIndexEnd;
+    uint64 mLastFingerprint;
+    bool mHasLastFrame;
+    QByteArray mLastVideoFrame;
+    QString mLastImagePath;
+    int mSkippedCount;
     float mProgress;
     QString mLog;
     bool mIsCanceled;
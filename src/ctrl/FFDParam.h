@@ -25,6 +25,8 @@ public:
         , eraseRadius(100)
         , erasePressure(0.1f)
         , focusRadius(1.0f)
+        , asyncReadback(false)
+        , sampleBudget(8)
     {}
     Type type;
 
@@ -41,6 +43,10 @@ public:
 
     // focuser
     float focusRadius;
+
+    // dispatch of deformer and eraser
+    bool asyncReadback; // apply the results a few frames later
+    int sampleBudget; // 1~, samples coalesced into one dispatch
 };
 
 } // namespace ctrl
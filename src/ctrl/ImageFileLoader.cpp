@@ -9,6 +9,7 @@
 #include "img/Util.h"
 #include "img/BlendMode.h"
 #include "core/LayerNode.h"
+#include "core/ImageKey.h"
 #include "core/FolderNode.h"
 #include "core/HeightMap.h"
 #include "core/ObjectNodeUtil.h"
@@ -159,7 +160,7 @@ bool ImageFileLoader::loadImage(
         // create layer node
         LayerNode* layerNode = new LayerNode(name, aProject.objectTree().shaderHolder());
         layerNode->setInitialRect(resNode->data().rect());
-        layerNode->setDefaultImage(resNode->handle());
+        layerNode->setDefaultImage(resNode->handle(), true, aProject.meshingParam());
         layerNode->setDefaultOpacity(1.0f);
         layerNode->setDefaultPosture(resNode->data().center());
         topNode->children().pushBack(layerNode);
@@ -251,6 +252,9 @@ bool ImageFileLoader::loadPsd(
     resStack.push_back(createFolderResource("topnode", QPoint(0, 0)));
     aProject.resourceHolder().pushImageTree(*resStack.back(), mFileInfo.absoluteFilePath());
 
+    // grid meshes are generated at once after the tree building
+    QVector<ImageKey*> imageKeys;
+
     // for each layer
     for (ReverseIterator itr = layers.rbegin(); itr != layers.rend(); ++itr)
     {
@@ -284,12 +288,15 @@ bool ImageFileLoader::loadPsd(
             layerNode->setVisibility(layer.isVisible());
             layerNode->setClipped(layer.clipping != 0);
             layerNode->setInitialRect(rect);
-            layerNode->setDefaultImage(resNode->handle());
+            layerNode->setDefaultImage(resNode->handle(), false);
             layerNode->setDefaultDepth(globalDepth - parentDepth);
             layerNode->setDefaultOpacity(layer.opacity / 255.0f);
 
             current->children().pushBack(layerNode);
 
+            auto imageKey = (ImageKey*)layerNode->timeLine()->defaultKey(TimeKeyType_Image);
+            if (imageKey) imageKeys.push_back(imageKey);
+
             // update depth
             globalDepth -= 1.0f;
         }
@@ -328,6 +335,12 @@ bool ImageFileLoader::loadPsd(
         aReporter.setProgress(progress);
     }
 
+    // create grid meshes of all layers concurrently
+    aReporter.setSection("Creating Meshes...");
+    ImageKey::resetGridMeshes(
+                imageKeys, QVector<int>(imageKeys.size(), ImageKey::kDefaultMeshCellSize),
+                aProject.meshingParam());
+
     // setup default positions
     setDefaultPosturesFromInitialRects(*topNode);
 
@@ -0,0 +1,474 @@
+#include <cstdlib>
+#include <memory>
+#include <vector>
+#include <algorithm>
+#include <QCoreApplication>
+#include <QTemporaryDir>
+#include <QFileInfo>
+#include <QProcess>
+#include <QTextStream>
+#include <QDir>
+#include "XC.h"
+#include "gl/OffscreenContext.h"
+#include "core/Animator.h"
+#include "ctrl/ProjectSaver.h"
+#include "ctrl/ProjectLoader.h"
+#include "ctrl/ShardedExporter.h"
+
+namespace
+{
+
+//-------------------------------------------------------------------------------------------------
+// the worker renders the frames which the job gives, the animation doesn't play
+class WorkerAnimator : public core::Animator
+{
+public:
+    virtual core::Frame currentFrame() const { return core::Frame(0); }
+    virtual void stop() {}
+    virtual void suspend() {}
+    virtual void resume() {}
+    virtual bool isSuspended() const { return false; }
+};
+
+//-------------------------------------------------------------------------------------------------
+class NullReporter : public util::IProgressReporter
+{
+public:
+    virtual void setSection(const QString&) {}
+    virtual void setMaximum(int) {}
+    virtual void setProgress(int) {}
+    virtual bool wasCanceled() const { return false; }
+};
+
+//-------------------------------------------------------------------------------------------------
+// the progress of a worker is read by the coordinator as "progress <percent>" lines
+class StdoutReporter : public util::IProgressReporter
+{
+public:
+    StdoutReporter(QTextStream& aOut)
+        : mOut(aOut)
+        , mLast(-1)
+    {
+    }
+
+    virtual void setSection(const QString&) {}
+    virtual void setMaximum(int) {}
+    virtual void setProgress(int aValue)
+    {
+        if (aValue == mLast) return;
+        mLast = aValue;
+        mOut << "progress " << aValue << "\n";
+        mOut.flush();
+    }
+    virtual bool wasCanceled() const { return false; }
+
+private:
+    QTextStream& mOut;
+    int mLast;
+};
+
+//-------------------------------------------------------------------------------------------------
+void writeCommonParam(QSettings& aJob, const ctrl::Exporter::CommonParam& aCommon)
+{
+    aJob.setValue("common/path", aCommon.path);
+    aJob.setValue("common/width", aCommon.size.width());
+    aJob.setValue("common/height", aCommon.size.height());
+    aJob.setValue("common/frameMin", aCommon.frame.min());
+    aJob.setValue("common/frameMax", aCommon.frame.max());
+    aJob.setValue("common/fps", aCommon.fps);
+    aJob.setValue("common/renderAtExportSize", aCommon.renderAtExportSize);
+    aJob.setValue("common/supersampling", aCommon.supersampling);
+}
+
+ctrl::Exporter::CommonParam readCommonParam(const QSettings& aJob)
+{
+    ctrl::Exporter::CommonParam common;
+    common.path = aJob.value("common/path").toString();
+    common.size = QSize(aJob.value("common/width").toInt(),
+                        aJob.value("common/height").toInt());
+    common.frame = util::Range(aJob.value("common/frameMin").toInt(),
+                               aJob.value("common/frameMax").toInt());
+    common.fps = aJob.value("common/fps").toInt();
+    common.renderAtExportSize = aJob.value("common/renderAtExportSize").toBool();
+    common.supersampling = aJob.value("common/supersampling").toInt();
+    return common;
+}
+
+} // namespace
+
+namespace ctrl
+{
+
+const char* const ShardedExporter::kWorkerOption = "--export-shard";
+
+//-------------------------------------------------------------------------------------------------
+ShardedExporter::ShardedExporter(core::Project& aProject)
+    : mProject(aProject)
+    , mShardCount(1)
+    , mOverwriteConfirmer()
+    , mProgressReporter()
+    , mUILogger()
+    , mLog()
+    , mIsCanceled()
+{
+}
+
+void ShardedExporter::setShardCount(int aCount)
+{
+    mShardCount = std::max(aCount, 1);
+}
+
+void ShardedExporter::setOverwriteConfirmer(const Exporter::OverwriteConfirmer& aConfirmer)
+{
+    mOverwriteConfirmer = aConfirmer;
+}
+
+void ShardedExporter::setProgressReporter(util::IProgressReporter& aReporter)
+{
+    mProgressReporter = &aReporter;
+}
+
+void ShardedExporter::setUILogger(UILogger& aLogger)
+{
+    mUILogger = &aLogger;
+}
+
+int ShardedExporter::getShardCount(int aIndexCount) const
+{
+    return std::max(1, std::min(mShardCount, aIndexCount));
+}
+
+template<class tParam>
+Exporter::Result ShardedExporter::runExporter(
+        const Exporter::CommonParam& aCommon, const tParam& aParam,
+        const Exporter::DumpParam* aSource)
+{
+    Exporter exporter(mProject);
+    if (mOverwriteConfirmer) exporter.setOverwriteConfirmer(mOverwriteConfirmer);
+    if (mProgressReporter) exporter.setProgressReporter(*mProgressReporter);
+    if (mUILogger) exporter.setUILogger(*mUILogger);
+    if (aSource) exporter.setFrameSource(*aSource);
+
+    auto result = exporter.execute(aCommon, aParam);
+    mLog = exporter.log();
+    mIsCanceled = exporter.isCanceled();
+    return result;
+}
+
+Exporter::Result ShardedExporter::execute(
+        const Exporter::CommonParam& aCommon, const Exporter::ImageParam& aImage)
+{
+    mLog.clear();
+    mIsCanceled = false;
+
+    const core::TimeInfo timeInfo = mProject.currentTimeInfo();
+    const int indexCount = aCommon.isValid() ? Exporter::getIndexCount(aCommon, timeInfo) : 0;
+    if (getShardCount(indexCount) <= 1 || !QFileInfo(aCommon.path).isDir())
+    {
+        return runExporter(aCommon, aImage, nullptr);
+    }
+
+    // the overwriting is confirmed here once, the workers overwrite silently
+    for (int i = 0; i < indexCount; ++i)
+    {
+        const QString path = Exporter::getImageFilePath(aCommon, aImage, timeInfo.fps, i);
+        if (QFileInfo::exists(path))
+        {
+            if (!mOverwriteConfirmer || !mOverwriteConfirmer(path))
+            {
+                mLog = "Exporting was canceled.";
+                mIsCanceled = true;
+                return Exporter::Result(Exporter::ResultCode_Canceled, mLog);
+            }
+            break;
+        }
+    }
+
+    QTemporaryDir workDir;
+    if (!workDir.isValid())
+    {
+        mLog = "Failed to create a work directory.";
+        return Exporter::Result(Exporter::ResultCode_UnclassfiedError, mLog);
+    }
+
+    // the files are written by the workers directly
+    int skippedCount = 0;
+    auto result = renderShards(workDir.path(), aCommon, indexCount, [&](QSettings& aJob)
+    {
+        aJob.setValue("kind", "image");
+        aJob.setValue("image/name", aImage.name);
+        aJob.setValue("image/suffix", aImage.suffix);
+        aJob.setValue("image/quality", aImage.quality);
+    }, skippedCount);
+
+    if (result && mUILogger && skippedCount > 0)
+    {
+        mUILogger->pushLog(
+                    QString("%1 of %2 frames were the same as the previous ones "
+                            "and were not rendered again.").arg(skippedCount).arg(indexCount),
+                    ctrl::UILogType_Info);
+    }
+    return result;
+}
+
+Exporter::Result ShardedExporter::execute(
+        const Exporter::CommonParam& aCommon, const Exporter::GifParam& aGif)
+{
+    // lossless, the palette is made from the same pixels as the serial export
+    return executeWithDump(aCommon, aGif, "PNG", -1);
+}
+
+Exporter::Result ShardedExporter::execute(
+        const Exporter::CommonParam& aCommon, const Exporter::VideoParam& aVideo)
+{
+    // the bytes of the pipe are dumped as they are
+    int quality = -1;
+    const char* format = Exporter::getVideoInCodec(aVideo, quality);
+    return executeWithDump(aCommon, aVideo, format, quality);
+}
+
+template<class tParam>
+Exporter::Result ShardedExporter::executeWithDump(
+        const Exporter::CommonParam& aCommon, const tParam& aParam,
+        const QString& aFormat, int aQuality)
+{
+    mLog.clear();
+    mIsCanceled = false;
+
+    const int indexCount = aCommon.isValid() ?
+                Exporter::getIndexCount(aCommon, mProject.currentTimeInfo()) : 0;
+    if (getShardCount(indexCount) <= 1)
+    {
+        return runExporter(aCommon, aParam, nullptr);
+    }
+
+    QTemporaryDir workDir;
+    Exporter::DumpParam dump;
+    dump.dir = workDir.path() + "/frames";
+    dump.format = aFormat;
+    dump.quality = aQuality;
+    if (!workDir.isValid() || !QDir().mkpath(dump.dir))
+    {
+        mLog = "Failed to create a work directory.";
+        return Exporter::Result(Exporter::ResultCode_UnclassfiedError, mLog);
+    }
+
+    // the skipped frames are counted again by the reader of the dump
+    int skippedCount = 0;
+    auto result = renderShards(workDir.path(), aCommon, indexCount, [&](QSettings& aJob)
+    {
+        aJob.setValue("kind", "dump");
+        aJob.setValue("dump/dir", dump.dir);
+        aJob.setValue("dump/format", dump.format);
+        aJob.setValue("dump/quality", dump.quality);
+    }, skippedCount);
+    if (!result) return result;
+
+    // encoding in frame order
+    return runExporter(aCommon, aParam, &dump);
+}
+
+Exporter::Result ShardedExporter::renderShards(
+        const QString& aWorkDir, const Exporter::CommonParam& aCommon,
+        int aIndexCount, const JobWriter& aWriter, int& aSkippedCount)
+{
+    static const int kMSec = 50;
+
+    struct Shard
+    {
+        std::unique_ptr<QProcess> process;
+        int begin;
+        int end;
+        int progress;
+        int skippedCount;
+        QString error;
+    };
+
+    // the workers load the current state, which may not be saved yet
+    const QString projectPath = aWorkDir + "/project.anie";
+    {
+        ProjectSaver saver;
+        if (!saver.save(projectPath, mProject))
+        {
+            mLog = "Failed to save the project for the workers.\n" + saver.log();
+            return Exporter::Result(Exporter::ResultCode_UnclassfiedError, mLog);
+        }
+    }
+
+    const int shardCount = getShardCount(aIndexCount);
+    std::vector<Shard> shards(shardCount);
+
+    for (int i = 0; i < shardCount; ++i)
+    {
+        Shard& shard = shards[i];
+        shard.begin = (int)((qint64)aIndexCount * i / shardCount);
+        shard.end = (int)((qint64)aIndexCount * (i + 1) / shardCount);
+        shard.progress = 0;
+        shard.skippedCount = 0;
+
+        const QString jobPath = aWorkDir + QString("/job%1.ini").arg(i);
+        {
+            QSettings job(jobPath, QSettings::IniFormat);
+            job.setValue("project", projectPath);
+            job.setValue("begin", shard.begin);
+            job.setValue("end", shard.end);
+            writeCommonParam(job, aCommon);
+            aWriter(job);
+            job.sync();
+            if (job.status() != QSettings::NoError)
+            {
+                mLog = "Failed to write " + jobPath;
+                return Exporter::Result(Exporter::ResultCode_UnclassfiedError, mLog);
+            }
+        }
+
+        shard.process.reset(new QProcess());
+        shard.process->start(QCoreApplication::applicationFilePath(),
+                             QStringList() << kWorkerOption << jobPath);
+    }
+
+    if (mProgressReporter)
+    {
+        mProgressReporter->setSection(
+                    QCoreApplication::translate("Exporter", "Rendering in %1 processes")
+                    .arg(shardCount));
+        mProgressReporter->setMaximum(100);
+    }
+
+    while (1)
+    {
+        bool running = false;
+        qint64 done = 0;
+
+        for (auto& shard : shards)
+        {
+            QProcess& process = *shard.process;
+            if (process.state() != QProcess::NotRunning)
+            {
+                process.waitForFinished(kMSec / shardCount + 1);
+                running |= (process.state() != QProcess::NotRunning);
+            }
+
+            while (process.canReadLine())
+            {
+                const QStringList words = QString(process.readLine()).simplified().split(' ');
+                if (words.size() != 2) continue;
+
+                if (words[0] == "progress") shard.progress = words[1].toInt();
+                else if (words[0] == "skipped") shard.skippedCount = words[1].toInt();
+            }
+            done += (qint64)shard.progress * (shard.end - shard.begin);
+        }
+
+        if (mProgressReporter)
+        {
+            mProgressReporter->setProgress((int)(done / aIndexCount));
+
+            if (mProgressReporter->wasCanceled())
+            {
+                for (auto& shard : shards)
+                {
+                    shard.process->kill();
+                    shard.process->waitForFinished();
+                }
+                mLog = "Export was canceled.";
+                mIsCanceled = true;
+                return Exporter::Result(Exporter::ResultCode_Canceled, mLog);
+            }
+        }
+
+        if (!running) break;
+    }
+
+    aSkippedCount = 0;
+    for (int i = 0; i < shardCount; ++i)
+    {
+        QProcess& process = *shards[i].process;
+        if (process.error() != QProcess::UnknownError ||
+                process.exitStatus() != QProcess::NormalExit || process.exitCode() != 0)
+        {
+            mLog = QString("The worker of the frames %1 to %2 failed.\n")
+                    .arg(shards[i].begin).arg(shards[i].end - 1) +
+                    process.errorString() + "\n" +
+                    QString::fromLocal8Bit(process.readAllStandardError());
+            return Exporter::Result(Exporter::ResultCode_UnclassfiedError, mLog);
+        }
+        aSkippedCount += shards[i].skippedCount;
+    }
+    return Exporter::Result(Exporter::ResultCode_Success, "Success.");
+}
+
+int ShardedExporter::runWorker(const QString& aJobPath)
+{
+    QTextStream out(stdout);
+    QTextStream err(stderr);
+
+    QSettings job(aJobPath, QSettings::IniFormat);
+    const QString projectPath = job.value("project").toString();
+    const QString kind = job.value("kind").toString();
+    const Exporter::CommonParam common = readCommonParam(job);
+    const int begin = job.value("begin").toInt();
+    const int end = job.value("end").toInt();
+    if (job.status() != QSettings::NoError || begin < 0 || end <= begin)
+    {
+        err << "Invalid job file " << aJobPath << "\n";
+        return EXIT_FAILURE;
+    }
+
+    gl::OffscreenContext context;
+    if (!context.isValid())
+    {
+        err << "OpenGL " << gl::Global::kVersion.first << "."
+            << gl::Global::kVersion.second << " context is not available.\n";
+        return EXIT_FAILURE;
+    }
+
+    WorkerAnimator animator;
+    QScopedPointer<core::Project> project(new core::Project(projectPath, animator, nullptr));
+    {
+        NullReporter reporter;
+        ProjectLoader loader;
+        if (!loader.load(projectPath, *project, context.deviceInfo(), reporter))
+        {
+            err << loader.log().join("\n") << "\nFailed to load " << projectPath << "\n";
+            return EXIT_FAILURE;
+        }
+    }
+
+    StdoutReporter reporter(out);
+    Exporter exporter(*project);
+    exporter.setOverwriteConfirmer([](const QString&) { return true; });
+    exporter.setProgressReporter(reporter);
+    exporter.setIndexRange(begin, end);
+
+    Exporter::Result result;
+    if (kind == "image")
+    {
+        Exporter::ImageParam image;
+        image.name = job.value("image/name").toString();
+        image.suffix = job.value("image/suffix").toString();
+        image.quality = job.value("image/quality").toInt();
+        result = exporter.execute(common, image);
+    }
+    else
+    {
+        Exporter::DumpParam dump;
+        dump.dir = job.value("dump/dir").toString();
+        dump.format = job.value("dump/format").toString();
+        dump.quality = job.value("dump/quality").toInt();
+        result = exporter.execute(common, dump);
+    }
+
+    // a failure of a frame stops the export with the log
+    if (!result || !exporter.log().isEmpty())
+    {
+        err << exporter.log() << "\n";
+        return EXIT_FAILURE;
+    }
+
+    out << "skipped " << exporter.skippedFrameCount() << "\n";
+    out.flush();
+    return EXIT_SUCCESS;
+}
+
+} // namespace ctrl
@@ -0,0 +1,76 @@
+#ifndef CTRL_SHARDEDEXPORTER_H
+#define CTRL_SHARDEDEXPORTER_H
+
+#include <functional>
+#include <QString>
+#include <QSettings>
+#include "util/IProgressReporter.h"
+#include "core/Project.h"
+#include "ctrl/UILogger.h"
+#include "ctrl/Exporter.h"
+
+namespace ctrl
+{
+
+// Splits the frame indices of an export into chunks, and renders each
+// chunk in a worker process which runs the executable of the application
+// with kWorkerOption and a job file. A worker has its own opengl context
+// and loads a copy of the project which is saved for the export.
+// The image sequences are written by the workers directly. The frames of
+// a gif or a video are dumped by the workers, and are encoded in frame
+// order by an Exporter which reads the dump, so that the encoder gets
+// the same input as the serial export.
+class ShardedExporter
+{
+public:
+    static const char* const kWorkerOption;
+
+    ShardedExporter(core::Project& aProject);
+
+    // 1 exports serially in this process
+    void setShardCount(int aCount);
+    void setOverwriteConfirmer(const Exporter::OverwriteConfirmer& aConfirmer);
+    void setProgressReporter(util::IProgressReporter& aReporter);
+    void setUILogger(ctrl::UILogger& aLogger);
+
+    Exporter::Result execute(const Exporter::CommonParam& aCommon,
+                             const Exporter::ImageParam& aImage);
+    Exporter::Result execute(const Exporter::CommonParam& aCommon,
+                             const Exporter::GifParam& aGif);
+    Exporter::Result execute(const Exporter::CommonParam& aCommon,
+                             const Exporter::VideoParam& aVideo);
+
+    const QString& log() const { return mLog; }
+    bool isCanceled() const { return mIsCanceled; }
+
+    // the entry point of a worker process, returns the exit code.
+    // it creates its own opengl context.
+    static int runWorker(const QString& aJobPath);
+
+private:
+    typedef std::function<void(QSettings&)> JobWriter;
+
+    int getShardCount(int aIndexCount) const;
+    // exports in this process, reading the dump if it is given
+    template<class tParam>
+    Exporter::Result runExporter(const Exporter::CommonParam& aCommon,
+                                 const tParam& aParam, const Exporter::DumpParam* aSource);
+    // dumps the frames by the workers and encodes them in this process
+    template<class tParam>
+    Exporter::Result executeWithDump(const Exporter::CommonParam& aCommon,
+                                     const tParam& aParam, const QString& aFormat, int aQuality);
+    Exporter::Result renderShards(const QString& aWorkDir, const Exporter::CommonParam& aCommon,
+                                  int aIndexCount, const JobWriter& aWriter, int& aSkippedCount);
+
+    core::Project& mProject;
+    int mShardCount;
+    Exporter::OverwriteConfirmer mOverwriteConfirmer;
+    util::IProgressReporter* mProgressReporter;
+    ctrl::UILogger* mUILogger;
+    QString mLog;
+    bool mIsCanceled;
+};
+
+} // namespace ctrl
+
+#endif // CTRL_SHARDEDEXPORTER_H
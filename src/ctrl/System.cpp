@@ -3,6 +3,7 @@
 #include <qstandardpaths.h>
 #include "gl/Global.h"
 #include "gl/DeviceInfo.h"
+#include "gl/ProgramRegistry.h"
 #include "ctrl/System.h"
 #include "ctrl/ProjectSaver.h"
 #include "ctrl/ProjectLoader.h"
@@ -66,6 +67,7 @@ System::System(const QString& aResourceDir, const QString& aCacheDir)
     , mProjects()
     , mAnimator()
 {
+    gl::ProgramRegistry::setCacheDir(mCacheDir + "/shader");
 }
 
 System::~System()
@@ -83,7 +85,8 @@ System::LoadResult System::newProject(
         const core::Project::Attribute& aAttr,
         core::Project::Hook* aHookGrabbed,
         util::IProgressReporter& aReporter,
-        bool aSpecifiesCanvasSize)
+        bool aSpecifiesCanvasSize,
+        const core::GridMesh::MeshingParam& aMeshing)
 {
     QScopedPointer<core::Project::Hook> hookScope(aHookGrabbed);
 
@@ -95,6 +98,7 @@ System::LoadResult System::newProject(
     QScopedPointer<core::Project> projectScope;
     projectScope.reset(new Project(QString(), *mAnimator, hookScope.take()));
     projectScope->attribute() = aAttr;
+    projectScope->setMeshingParam(aMeshing);
     projectScope->resourceHolder().setRootPath(QFileInfo(aFileName).path());
 
     ctrl::ImageFileLoader loader(gl::DeviceInfo::instance());
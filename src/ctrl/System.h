@@ -43,7 +43,8 @@ public:
             const core::Project::Attribute& aAttr,
             core::Project::Hook* aHookGrabbed,
             util::IProgressReporter& aReporter,
-            bool aSpecifiesCanvasSize);
+            bool aSpecifiesCanvasSize,
+            const core::GridMesh::MeshingParam& aMeshing);
 
     LoadResult openProject(
             const QString& aFileName,
@@ -33,6 +33,7 @@ TimeLineEditor::TimeLineEditor()
     , mTimeCurrent(kTimeLineMargin)
     , mTimeScale()
     , mFocus(mRows, mTimeScale, kTimeLineMargin)
+    , mChildKeys()
     , mMoveRef()
     , mMoveFrame()
     , mOnUpdatingKey(false)
@@ -63,6 +64,7 @@ void TimeLineEditor::setMaxFrame(int aValue)
 void TimeLineEditor::setProject(Project* aProject)
 {
     clearRows();
+    mChildKeys.clear();
     mProject.reset();
 
     if (aProject)
@@ -108,14 +110,22 @@ void TimeLineEditor::updateRowSelection(const core::ObjectNode* aRepresent)
     }
 }
 
-void TimeLineEditor::updateKey()
+void TimeLineEditor::updateKey(const core::TimeLineEvent& aEvent)
 {
+    mChildKeys.invalidate(aEvent);
+
     if (!mOnUpdatingKey)
     {
         clearState();
     }
 }
 
+void TimeLineEditor::updateTree()
+{
+    // nodes may be moved or deleted
+    mChildKeys.clear();
+}
+
 void TimeLineEditor::updateProjectAttribute()
 {
     clearState();
@@ -515,6 +525,7 @@ void TimeLineEditor::render(QPainter& aPainter, const CameraInfo& aCamera, theme
     renderer.setMargin(margin);
     renderer.setRange(util::Range(bgn, end));
     renderer.setTimeScale(mTimeScale);
+    renderer.setChildKeyIndex(mChildKeys);
 
     renderer.renderLines(mRows, camRect, cullRect);
     renderer.renderHeader(kHeaderHeight, kTimeLineFpsA);
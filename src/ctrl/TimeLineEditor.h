@@ -17,6 +17,7 @@
 #include "ctrl/time/time_Current.h"
 #include "ctrl/time/time_Scaler.h"
 #include "ctrl/time/time_Focuser.h"
+#include "ctrl/time/time_ChildKeyIndex.h"
 #include "gui/theme/TimeLine.h"
 
 namespace ctrl
@@ -41,7 +42,8 @@ public:
 
     UpdateFlags updateCursor(const core::AbstractCursor& aCursor);
     void updateWheel(int aDelta, bool aInvertScaling);
-    void updateKey();
+    void updateKey(const core::TimeLineEvent& aEvent);
+    void updateTree();
     void updateProjectAttribute();
 
     void clearRows();
@@ -83,6 +85,7 @@ private:
     time::Current mTimeCurrent;
     time::Scaler mTimeScale;
     time::Focuser mFocus;
+    time::ChildKeyIndex mChildKeys;
 
     TimeLineUtil::MoveFrameOfKey* mMoveRef;
     int mMoveFrame;
@@ -393,7 +393,8 @@ void assignImageKeyResource(
         // image key
         aProject.commandStack().push(
                     ImageKeyUpdater::createResourceUpdater(
-                        *aKey, aNewData, workspace, createTransitions));
+                        *aKey, aNewData, workspace, createTransitions,
+                        aProject.meshingParam()));
 
         // ffd key should be called finally
         if (createTransitions)
@@ -445,7 +446,8 @@ void assignImageKeyCellSize(
         // image key
         aProject.commandStack().push(
                     ImageKeyUpdater::createGridMeshUpdater(
-                        *aKey, aNewData, workspace, createTransitions));
+                        *aKey, aNewData, workspace, createTransitions,
+                        aProject.meshingParam()));
 
         // ffd key should be called finally
         if (createTransitions)
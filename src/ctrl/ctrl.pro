@@ -73,6 +73,8 @@ SOURCES += \
     ffd/ffd_Task.cpp \
     bone/bone_GeoBuilder.cpp \
     Exporter.cpp \
+    ExportSink.cpp \
+    ShardedExporter.cpp \
     bone/bone_PaintInflMode.cpp \
     bone/bone_EraseInflMode.cpp \
     MeshEditor.cpp \
@@ -102,9 +104,12 @@ SOURCES += \
     time/time_Scaler.cpp \
     TimeLineRow.cpp \
     time/time_Current.cpp \
+    time/time_ChildKeyIndex.cpp \
     ffd/ffd_Target.cpp \
     ffd/ffd_DragMode.cpp \
     ffd/ffd_BrushMode.cpp \
+    ffd/ffd_VertexGrid.cpp \
+    ffd/ffd_Readback.cpp \
     CmndName.cpp \
     VideoFormat.cpp \
     PoseParam.cpp \
@@ -155,6 +160,8 @@ HEADERS += \
     bone/bone_Target.h \
     pose/pose_Target.h \
     Exporter.h \
+    ExportSink.h \
+    ShardedExporter.h \
     bone/bone_PaintInflMode.h \
     bone/bone_EraseInflMode.h \
     MeshEditor.h \
@@ -191,10 +198,13 @@ HEADERS += \
     time/time_Renderer.h \
     time/time_Scaler.h \
     time/time_Current.h \
+    time/time_ChildKeyIndex.h \
     ffd/ffd_Target.h \
     ffd/ffd_IMode.h \
     ffd/ffd_DragMode.h \
     ffd/ffd_BrushMode.h \
+    ffd/ffd_VertexGrid.h \
+    ffd/ffd_Readback.h \
     CmndName.h \
     UILogger.h \
     UILogType.h \
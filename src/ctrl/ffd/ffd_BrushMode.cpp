@@ -1,3 +1,4 @@
+#include <algorithm>
 #include "cmnd/ScopedMacro.h"
 #include "cmnd/BasicCommands.h"
 #include "gl/Global.h"
@@ -7,6 +8,12 @@
 
 using namespace core;
 
+namespace
+{
+static const size_t kCopySize = 1024;
+static const int kFrameMSec = 16;
+}
+
 namespace ctrl {
 namespace ffd {
 
@@ -15,6 +22,10 @@ BrushMode::Status::Status()
     : state(State_Idle)
     , brush(QVector2D(), 1.0f)
     , commandRef()
+    , pendingCenter()
+    , pendingMove()
+    , pendingCount()
+    , dispatchTimer()
 {
 }
 
@@ -22,6 +33,9 @@ void BrushMode::Status::clear()
 {
     state = State_Idle;
     commandRef = nullptr;
+    pendingCenter = QVector2D();
+    pendingMove = QVector2D();
+    pendingCount = 0;
 }
 
 bool BrushMode::Status::hasValidBrush() const
@@ -42,7 +56,14 @@ BrushMode::BrushMode(core::Project& aProject, Targets& aTargets)
     , mStatus()
     , mToolPressure(1.0f)
     , mPenPressure(1.0f)
+    , mAsync(false)
+    , mSampleBudget(1)
+    , mPollTimer()
+    , mApplyBuffer()
+    , mStrokeStats()
 {
+    mPollTimer.setSingleShot(true);
+    QObject::connect(&mPollTimer, &QTimer::timeout, [=]() { onPollTimer(); });
 }
 
 void BrushMode::updateParam(const FFDParam& aParam)
@@ -68,6 +89,18 @@ bool BrushMode::updateCursor(const core::CameraInfo&, const core::AbstractCursor
             if (mStatus.hasValidBrush() && mTargets.hasValidTarget())
             {
                 mStatus.state = State_Draw;
+                mStatus.dispatchTimer.start();
+                mStrokeStats = StrokeStats();
+
+                // keep the dispatch mode during a stroke
+                mAsync = mParam.asyncReadback;
+                mSampleBudget = std::max(1, mParam.sampleBudget);
+
+                // the meshes may be changed since the last stroke
+                for (auto target : mTargets)
+                {
+                    if (target->task) target->task->resetRegion();
+                }
             }
         }
     }
@@ -79,15 +112,20 @@ bool BrushMode::updateCursor(const core::CameraInfo&, const core::AbstractCursor
         // deform
         if (aCursor.emitsLeftDraggedEvent())
         {
+            ++mStrokeStats.sampleCount;
+
             // execute task
-            if (!executeDrawTask(prevCenter, aCursor.worldVel()))
+            const bool success = mAsync ?
+                        pushAsyncSample(prevCenter, aCursor.worldVel()) :
+                        executeDrawTask(prevCenter, aCursor.worldVel());
+            if (!success)
             {
-                mStatus.clear();
+                endStroke(false);
             }
         }
         else if (aCursor.emitsLeftReleasedEvent())
         {
-            mStatus.clear();
+            endStroke(true);
         }
     }
 
@@ -113,10 +151,191 @@ void BrushMode::renderQt(const core::RenderInfo& aInfo, QPainter& aPainter)
     }
 }
 
-bool BrushMode::executeDrawTask(const QVector2D& aCenter, const QVector2D& aMove)
+void BrushMode::endStroke(bool aApplies)
+{
+    if (mAsync)
+    {
+        mPollTimer.stop();
+        gl::Global::makeCurrent();
+
+        if (aApplies && flushAsyncSamples())
+        {
+            applyReadbacks(Wait_All);
+        }
+
+        // drop the rest
+        for (auto target : mTargets)
+        {
+            if (target->task) target->task->resetRegion();
+        }
+    }
+
+    mStatus.clear();
+}
+
+bool BrushMode::pushAsyncSample(const QVector2D& aCenter, const QVector2D& aMove)
 {
-    static const size_t kCopySize = 1024;
+    // coalesce samples from the start point of the first one
+    if (mStatus.pendingCount == 0)
+    {
+        mStatus.pendingCenter = aCenter;
+    }
+    mStatus.pendingMove += aMove;
+    ++mStatus.pendingCount;
+
+    // one dispatch per display frame, or per the sample budget
+    const qint64 elapsed = mStatus.dispatchTimer.elapsed();
+    if (mStatus.pendingCount >= mSampleBudget || elapsed >= kFrameMSec)
+    {
+        return flushAsyncSamples();
+    }
+
+    if (!mPollTimer.isActive())
+    {
+        mPollTimer.start(kFrameMSec - (int)elapsed);
+    }
+    return true;
+}
+
+bool BrushMode::flushAsyncSamples()
+{
+    if (mStatus.pendingCount <= 0) return true;
+
+    const QVector2D center = mStatus.pendingCenter;
+    const QVector2D move = mStatus.pendingMove;
+    mStatus.pendingCenter = QVector2D();
+    mStatus.pendingMove = QVector2D();
+    mStatus.pendingCount = 0;
+    mStatus.dispatchTimer.restart();
+
+    return executeAsyncDrawTask(center, move);
+}
+
+void BrushMode::onPollTimer()
+{
+    if (!mAsync || mStatus.state != State_Draw) return;
+
+    bool success = true;
+    if (mStatus.pendingCount > 0)
+    {
+        success = flushAsyncSamples();
+    }
+    else
+    {
+        gl::Global::makeCurrent();
+        success = applyReadbacks(Wait_None);
+    }
 
+    if (!success)
+    {
+        endStroke(false);
+        return;
+    }
+
+    // keep polling while some results are in flight
+    if (!mPollTimer.isActive())
+    {
+        for (auto target : mTargets)
+        {
+            if (target->task && target->task->readbackCount() > 0)
+            {
+                mPollTimer.start(kFrameMSec);
+                break;
+            }
+        }
+    }
+}
+
+void BrushMode::setupTask(int aIndex, const QVector2D& aCenter, const QVector2D& aMove)
+{
+    auto task = mTargets[aIndex]->task.data();
+    ObjectNode* node = mTargets[aIndex]->node;
+    LayerMesh* mesh = mTargets[aIndex]->keyOwner.getParentMesh(node);
+    ffd::KeyOwner& owner = mTargets[aIndex]->keyOwner;
+    FFDKey* key = owner.key;
+    XC_PTR_ASSERT(node);
+    XC_PTR_ASSERT(mesh);
+    XC_PTR_ASSERT(key);
+    XC_ASSERT(mesh->vertexCount() == key->data().count());
+
+    // set task type
+    task->setType(
+                mParam.type == FFDParam::Type_Pencil ?
+                    Task::Type_Deformer : Task::Type_Eraser);
+
+    // write vertex positions
+    task->writeSrc(
+                node->timeLine()->current(),
+                key->data().positions(),
+                *mesh, mParam);
+
+    // set brush
+    task->setBrush(aCenter, aMove);
+}
+
+void BrushMode::pushCommand(bool aAssignsTaskResults)
+{
+    cmnd::Stack& stack = mProject.commandStack();
+    const int frame = mProject.animator().currentFrame().get();
+
+    cmnd::ScopedMacro macro(stack, CmndName::tr("Update FFD"));
+
+    // set notifier
+    auto notifier = new TimeLineUtil::Notifier(mProject);
+    macro.grabListener(notifier);
+    notifier->event().setType(TimeLineEvent::Type_PushKey);
+    for (int i = 0; i < mTargets.size(); ++i)
+    {
+        XC_PTR_ASSERT(mTargets[i]->node->timeLine());
+        notifier->event().pushTarget(
+                    *mTargets[i]->node, TimeKeyType_FFD, frame);
+    }
+
+    // push owns keys
+    for (int i = 0; i < mTargets.size(); ++i)
+    {
+        XC_PTR_ASSERT(mTargets[i]->keyOwner.key);
+
+        if (mTargets[i]->keyOwner.owns())
+        {
+            mTargets[i]->keyOwner.pushOwnsKey(
+                        stack, *mTargets[i]->node->timeLine(), frame);
+        }
+    }
+
+    // create deform command
+    mStatus.commandRef = new ffd::MoveVertices();
+
+    // push memory assign commands
+    for (int i = 0; i < mTargets.size(); ++i)
+    {
+        FFDKey* key = mTargets[i]->keyOwner.key;
+        ffd::Task* task = mTargets[i]->task.data();
+        XC_PTR_ASSERT(key->data().positions());
+
+        // the asynchronous results are assigned later
+        const void* value = key->data().positions();
+        if (aAssignsTaskResults)
+        {
+            XC_PTR_ASSERT(task->dstMesh());
+
+            // wait end of task
+            finishTask(*task);
+            value = task->dstMesh();
+        }
+
+        mStatus.commandRef->push(
+                    new cmnd::AssignMemory(
+                        key->data().positions(),
+                        value, task->dstSize(), kCopySize));
+    }
+
+    // push deform command
+    stack.push(mStatus.commandRef);
+}
+
+bool BrushMode::executeDrawTask(const QVector2D& aCenter, const QVector2D& aMove)
+{
     // setup input buffers
     gl::Global::makeCurrent();
 
@@ -125,33 +344,12 @@ bool BrushMode::executeDrawTask(const QVector2D& aCenter, const QVector2D& aMove
     // request gl task
     for (int i = 0; i < mTargets.size(); ++i)
     {
-        auto task = mTargets[i]->task.data();
-        ObjectNode* node = mTargets[i]->node;
-        LayerMesh* mesh = mTargets[i]->keyOwner.getParentMesh(node);
-        ffd::KeyOwner& owner = mTargets[i]->keyOwner;
-        FFDKey* key = owner.key;
-        XC_PTR_ASSERT(node);
-        XC_PTR_ASSERT(mesh);
-        XC_PTR_ASSERT(key);
-        XC_ASSERT(mesh->vertexCount() == key->data().count());
-
-        // set task type
-        task->setType(
-                    mParam.type == FFDParam::Type_Pencil ?
-                        Task::Type_Deformer : Task::Type_Eraser);
-
-        // write vertex positions
-        task->writeSrc(
-                    node->timeLine()->current(),
-                    key->data().positions(),
-                    *mesh, mParam);
-
-        // set brush
-        task->setBrush(aCenter, aMove);
+        setupTask(i, aCenter, aMove);
 
         // execute
-        task->request();
+        mTargets[i]->task->request();
     }
+    ++mStrokeStats.dispatchCount;
 
     // make commands
     {
@@ -160,53 +358,7 @@ bool BrushMode::executeDrawTask(const QVector2D& aCenter, const QVector2D& aMove
 
         if (!mStatus.commandRef)
         {
-            cmnd::ScopedMacro macro(stack, CmndName::tr("Update FFD"));
-
-            // set notifier
-            auto notifier = new TimeLineUtil::Notifier(mProject);
-            macro.grabListener(notifier);
-            notifier->event().setType(TimeLineEvent::Type_PushKey);
-            for (int i = 0; i < mTargets.size(); ++i)
-            {
-                XC_PTR_ASSERT(mTargets[i]->node->timeLine());
-                notifier->event().pushTarget(
-                            *mTargets[i]->node, TimeKeyType_FFD, frame);
-            }
-
-            // push owns keys
-            for (int i = 0; i < mTargets.size(); ++i)
-            {
-                XC_PTR_ASSERT(mTargets[i]->keyOwner.key);
-
-                if (mTargets[i]->keyOwner.owns())
-                {
-                    mTargets[i]->keyOwner.pushOwnsKey(
-                                stack, *mTargets[i]->node->timeLine(), frame);
-                }
-            }
-
-            // create deform command
-            mStatus.commandRef = new ffd::MoveVertices();
-
-            // push memory assign commands
-            for (int i = 0; i < mTargets.size(); ++i)
-            {
-                FFDKey* key = mTargets[i]->keyOwner.key;
-                ffd::Task* task = mTargets[i]->task.data();
-                XC_PTR_ASSERT(key->data().positions());
-                XC_PTR_ASSERT(task->dstMesh());
-
-                // wait end of task
-                task->finish();
-
-                mStatus.commandRef->push(
-                            new cmnd::AssignMemory(
-                                key->data().positions(),
-                                task->dstMesh(), task->dstSize(), kCopySize));
-            }
-
-            // push deform command
-            stack.push(mStatus.commandRef);
+            pushCommand(true);
         }
         else
         {
@@ -221,7 +373,7 @@ bool BrushMode::executeDrawTask(const QVector2D& aCenter, const QVector2D& aMove
                 ObjectNode& node = *mTargets[i]->node;
 
                 // wait end of task
-                task->finish();
+                finishTask(*task);
 
                 if (modifiable)
                 {
@@ -229,7 +381,12 @@ bool BrushMode::executeDrawTask(const QVector2D& aCenter, const QVector2D& aMove
                     auto assign = mStatus.commandRef->assign(i);
                     XC_ASSERT(assign->size() == task->dstSize());
                     XC_ASSERT(assign->target() == key->data().positions());
-                    assign->modifyValue(task->dstMesh());
+                    for (auto range : task->dstRanges())
+                    {
+                        const size_t offset = sizeof(gl::Vector3) * range.min();
+                        const size_t size = sizeof(gl::Vector3) * (range.diff() + 1);
+                        assign->modifyValue(task->dstMesh() + range.min(), offset, size);
+                    }
 
                     // push event target
                     event.pushTarget(node, TimeKeyType_FFD, frame);
@@ -239,7 +396,7 @@ bool BrushMode::executeDrawTask(const QVector2D& aCenter, const QVector2D& aMove
             // notify
             if (event.targets().size())
             {
-                mProject.onTimeLineModified(event, false);
+                mProject.postTimeLineModified(event);
             }
 
             return modifiable;
@@ -248,5 +405,134 @@ bool BrushMode::executeDrawTask(const QVector2D& aCenter, const QVector2D& aMove
     return true;
 }
 
+void BrushMode::finishTask(Task& aTask)
+{
+    QElapsedTimer stall;
+    stall.start();
+    aTask.finish();
+    mStrokeStats.stallNSec += stall.nsecsElapsed();
+}
+
+bool BrushMode::executeAsyncDrawTask(const QVector2D& aCenter, const QVector2D& aMove)
+{
+    // setup input buffers
+    gl::Global::makeCurrent();
+
+    mParam.pressure = mToolPressure * mPenPressure;
+
+    // make commands which are modified by each result
+    if (!mStatus.commandRef)
+    {
+        pushCommand(false);
+    }
+
+    // apply finished results, and make a room for the new request
+    if (!applyReadbacks(Wait_Room))
+    {
+        return false;
+    }
+
+    // request gl task
+    for (int i = 0; i < mTargets.size(); ++i)
+    {
+        setupTask(i, aCenter, aMove);
+
+        // execute
+        mTargets[i]->task->requestAsync();
+    }
+
+    int inFlight = 0;
+    for (auto target : mTargets)
+    {
+        inFlight = std::max(inFlight, target->task->readbackCount());
+    }
+    ++mStrokeStats.dispatchCount;
+    mStrokeStats.inFlightSum += inFlight;
+    mStrokeStats.inFlightMax = std::max(mStrokeStats.inFlightMax, inFlight);
+
+    if (!mPollTimer.isActive())
+    {
+        mPollTimer.start(kFrameMSec);
+    }
+    return true;
+}
+
+bool BrushMode::applyReadbacks(ReadbackWait aWait)
+{
+    cmnd::Stack& stack = mProject.commandStack();
+    if (!mStatus.commandRef || !stack.isModifiable(mStatus.commandRef))
+    {
+        return false;
+    }
+
+    const int frame = mProject.animator().currentFrame().get();
+    TimeLineEvent event;
+    event.setType(TimeLineEvent::Type_ChangeKeyValue);
+
+    for (int i = 0; i < mTargets.size(); ++i)
+    {
+        ffd::Task* task = mTargets[i]->task.data();
+        bool applied = false;
+
+        while (true)
+        {
+            const bool waits = (aWait == Wait_All) ||
+                    (aWait == Wait_Room && !task->hasFreeReadback());
+
+            QElapsedTimer stall;
+            stall.start();
+            auto readback = task->retireReadback(waits);
+            if (waits) mStrokeStats.stallNSec += stall.nsecsElapsed();
+            if (!readback) break;
+
+            applyReadback(i, *readback);
+            applied = true;
+        }
+
+        if (applied)
+        {
+            event.pushTarget(*mTargets[i]->node, TimeKeyType_FFD, frame);
+        }
+    }
+
+    // notify
+    if (event.targets().size())
+    {
+        mProject.postTimeLineModified(event);
+    }
+    return true;
+}
+
+void BrushMode::applyReadback(int aIndex, const Readback& aReadback)
+{
+    FFDKey* key = mTargets[aIndex]->keyOwner.key;
+    XC_PTR_ASSERT(key);
+    gl::Vector3* positions = key->data().positions();
+
+    auto assign = mStatus.commandRef->assign(aIndex);
+    XC_ASSERT(assign->target() == positions);
+
+    const gl::Vector3* results = aReadback.results();
+    const gl::Vector3* sources = aReadback.sources();
+    int packed = 0;
+
+    for (auto range : aReadback.ranges())
+    {
+        const int begin = range.min();
+        const int count = range.diff() + 1;
+        mApplyBuffer.resize(count);
+
+        // add the moves, since the source can be older than the current positions
+        for (int k = 0; k < count; ++k)
+        {
+            mApplyBuffer[k] = positions[begin + k] + (results[packed + k] - sources[packed + k]);
+        }
+
+        assign->modifyValue(mApplyBuffer.data(),
+                            sizeof(gl::Vector3) * begin, sizeof(gl::Vector3) * count);
+        packed += count;
+    }
+}
+
 } // namespace ffd
 } // namespace ctrl
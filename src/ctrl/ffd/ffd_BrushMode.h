@@ -1,6 +1,8 @@
 #ifndef CTRL_FFD_BRUSHMODE_H
 #define CTRL_FFD_BRUSHMODE_H
 
+#include <QTimer>
+#include <QElapsedTimer>
 #include "core/Project.h"
 #include "ctrl/ffd/ffd_Target.h"
 #include "ctrl/ffd/ffd_IMode.h"
@@ -12,11 +14,26 @@ namespace ffd {
 class BrushMode : public IMode
 {
 public:
+    // counters of the last stroke, which are reset at the start of a stroke
+    struct StrokeStats
+    {
+        StrokeStats()
+            : sampleCount(), dispatchCount()
+            , inFlightSum(), inFlightMax(), stallNSec() {}
+        int sampleCount;
+        int dispatchCount;
+        int inFlightSum; // readbacks in flight after each dispatch
+        int inFlightMax;
+        qint64 stallNSec; // waiting for the gl results
+    };
+
     BrushMode(core::Project& aProject, Targets& aTargets);
     virtual void updateParam(const FFDParam&);
     virtual bool updateCursor(const core::CameraInfo&, const core::AbstractCursor&);
     virtual void renderQt(const core::RenderInfo& aInfo, QPainter& aPainter);
 
+    const StrokeStats& strokeStats() const { return mStrokeStats; }
+
 private:
     enum State
     {
@@ -24,6 +41,13 @@ private:
         State_Draw,
     };
 
+    enum ReadbackWait
+    {
+        Wait_None,
+        Wait_Room,
+        Wait_All
+    };
+
     struct Status
     {
         Status();
@@ -33,9 +57,28 @@ private:
         State state;
         util::Circle brush;
         MoveVertices* commandRef;
+
+        // coalesced samples for the asynchronous mode
+        QVector2D pendingCenter;
+        QVector2D pendingMove;
+        int pendingCount;
+        QElapsedTimer dispatchTimer;
     };
 
+    void endStroke(bool aApplies);
+    void setupTask(int aIndex, const QVector2D& aCenter, const QVector2D& aMove);
+    void pushCommand(bool aAssignsTaskResults);
     bool executeDrawTask(const QVector2D& aCenter, const QVector2D& aMove);
+    void finishTask(Task& aTask);
+
+    // the asynchronous mode dispatches the coalesced samples once per
+    // display frame, and applies the results when their fences are signaled.
+    bool pushAsyncSample(const QVector2D& aCenter, const QVector2D& aMove);
+    bool flushAsyncSamples();
+    void onPollTimer();
+    bool executeAsyncDrawTask(const QVector2D& aCenter, const QVector2D& aMove);
+    bool applyReadbacks(ReadbackWait aWait);
+    void applyReadback(int aIndex, const Readback& aReadback);
 
     core::Project& mProject;
     Targets& mTargets;
@@ -43,6 +86,11 @@ private:
     Status mStatus;
     float mToolPressure;
     float mPenPressure;
+    bool mAsync;
+    int mSampleBudget;
+    QTimer mPollTimer;
+    QVector<gl::Vector3> mApplyBuffer;
+    StrokeStats mStrokeStats;
 };
 
 } // namespace ffd
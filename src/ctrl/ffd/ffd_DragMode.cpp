@@ -246,7 +246,7 @@ void DragMode::assignDragging(const QVector2D& aMove)
         TimeLineEvent event;
         event.setType(TimeLineEvent::Type_ChangeKeyValue);
         event.pushTarget(*node, TimeKeyType_FFD, frame);
-        mProject.onTimeLineModified(event, false);
+        mProject.postTimeLineModified(event);
     }
 }
 
@@ -0,0 +1,87 @@
+#include <cstring>
+#include "XC.h"
+#include "gl/Global.h"
+#include "ctrl/ffd/ffd_Readback.h"
+
+namespace ctrl {
+namespace ffd {
+
+//-------------------------------------------------------------------------------------------------
+Readback::Readback()
+    : mBuffer(GL_COPY_WRITE_BUFFER)
+    , mCapacity()
+    , mSrcBufferId()
+    , mRanges()
+    , mSources()
+    , mResults()
+    , mCount()
+{
+}
+
+void Readback::set(gl::BufferObject& aSrcBuffer, const gl::Vector3* aSrcMesh,
+                   const QVector<util::Range>& aRanges)
+{
+    mSrcBufferId = aSrcBuffer.id();
+    mRanges = aRanges;
+
+    mCount = 0;
+    for (auto range : mRanges)
+    {
+        mCount += range.diff() + 1;
+    }
+
+    mSources.resize(aSrcMesh ? mCount : 0);
+    mResults.resize(mCount);
+
+    int packed = 0;
+    for (auto range : mRanges)
+    {
+        if (!aSrcMesh) break;
+        const int count = range.diff() + 1;
+        memcpy(mSources.data() + packed, aSrcMesh + range.min(), sizeof(gl::Vector3) * count);
+        packed += count;
+    }
+
+    if (mCapacity < mCount)
+    {
+        mCapacity = mCount;
+        mBuffer.resetData<gl::Vector3>(mCapacity, GL_STREAM_READ);
+    }
+}
+
+void Readback::onRequested()
+{
+    gl::Global::Functions& ggl = gl::Global::functions();
+
+    ggl.glBindBuffer(GL_COPY_READ_BUFFER, mSrcBufferId);
+    ggl.glBindBuffer(GL_COPY_WRITE_BUFFER, mBuffer.id());
+
+    int packed = 0;
+    for (auto range : mRanges)
+    {
+        const int count = range.diff() + 1;
+        ggl.glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER,
+                                sizeof(gl::Vector3) * range.min(),
+                                sizeof(gl::Vector3) * packed,
+                                sizeof(gl::Vector3) * count);
+        packed += count;
+    }
+
+    ggl.glBindBuffer(GL_COPY_READ_BUFFER, 0);
+    ggl.glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    GL_CHECK_ERROR();
+}
+
+void Readback::onFinished()
+{
+    if (mCount <= 0) return;
+
+    gl::Global::Functions& ggl = gl::Global::functions();
+    ggl.glBindBuffer(GL_COPY_READ_BUFFER, mBuffer.id());
+    ggl.glGetBufferSubData(GL_COPY_READ_BUFFER, 0, sizeof(gl::Vector3) * mCount, mResults.data());
+    ggl.glBindBuffer(GL_COPY_READ_BUFFER, 0);
+    GL_CHECK_ERROR();
+}
+
+} // namespace ffd
+} // namespace ctrl
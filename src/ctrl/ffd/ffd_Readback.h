@@ -0,0 +1,46 @@
+#ifndef CTRL_FFD_READBACK_H
+#define CTRL_FFD_READBACK_H
+
+#include <QVector>
+#include "util/Range.h"
+#include "gl/Vector3.h"
+#include "gl/Task.h"
+#include "gl/BufferObject.h"
+
+namespace ctrl {
+namespace ffd {
+
+// copies vertex ranges of a feedback buffer on the gpu, and reads them
+// after the fence is signaled. the values are packed in the range order.
+class Readback : public gl::Task
+{
+public:
+    Readback();
+
+    // aSrcMesh is the input of the pass which wrote aSrcBuffer, or null
+    // if the sources are not needed.
+    void set(gl::BufferObject& aSrcBuffer, const gl::Vector3* aSrcMesh,
+             const QVector<util::Range>& aRanges);
+
+    const QVector<util::Range>& ranges() const { return mRanges; }
+    const gl::Vector3* sources() const { return mSources.data(); }
+    const gl::Vector3* results() const { return mResults.data(); }
+    int count() const { return mCount; }
+
+private:
+    virtual void onRequested();
+    virtual void onFinished();
+
+    gl::BufferObject mBuffer;
+    int mCapacity;
+    GLuint mSrcBufferId;
+    QVector<util::Range> mRanges;
+    QVector<gl::Vector3> mSources;
+    QVector<gl::Vector3> mResults;
+    int mCount;
+};
+
+} // namespace ffd
+} // namespace ctrl
+
+#endif // CTRL_FFD_READBACK_H
@@ -1,3 +1,5 @@
+#include <cstring>
+#include <algorithm>
 #include <QElapsedTimer>
 #include "XC.h"
 #include "gl/Global.h"
@@ -9,6 +11,13 @@
 
 using namespace core;
 
+namespace
+{
+// indices closer than this are evaluated in one pass
+static const int kRangeGap = 64;
+static const int kMaxRangeCount = 32;
+}
+
 namespace ctrl {
 namespace ffd {
 
@@ -39,6 +48,18 @@ Task::Task(TaskResource& aResource, core::MeshTransformerResource& aMeshRes)
     , mFocusIndex(-1)
     , mDragIndex(-1)
     , mDragMove()
+    , mVertexGrid()
+    , mRanges()
+    , mMovedRanges()
+    , mCandidates()
+    , mWorldPositions()
+    , mWorldReadback()
+    , mXArrowReadback()
+    , mYArrowReadback()
+    , mWorldRequested()
+    , mReadbacks()
+    , mReadbackHead()
+    , mReadbackCount()
 {
     //GLint val;
     //glGetIntegerv(GL_MAX_TEXTURE_SIZE, &val);
@@ -59,6 +80,7 @@ void Task::resetDst(int aVtxCount)
 {
     XC_ASSERT(aVtxCount > 0);
 
+    resetRegion();
     mVtxCount = aVtxCount;
     if (mDstBufferCount < aVtxCount)
     {
@@ -121,6 +143,159 @@ void Task::setBrush(
     mBrushVel = aBrushVel;
 }
 
+void Task::resetRegion()
+{
+    mVertexGrid.clear();
+    mRanges.clear();
+    mMovedRanges.clear();
+    mWorldRequested = false;
+    mReadbackHead = 0;
+    mReadbackCount = 0;
+}
+
+void Task::requestAsync()
+{
+    XC_ASSERT(mType == Type_Deformer || mType == Type_Eraser);
+    XC_ASSERT(hasFreeReadback());
+
+    request();
+
+    const int index = (mReadbackHead + mReadbackCount) % kReadbackDepth;
+    if (!mReadbacks[index])
+    {
+        mReadbacks[index].reset(new Readback());
+    }
+    mReadbacks[index]->set(mOutMesh, mSrcMesh.array(), mRanges);
+    mReadbacks[index]->request();
+    ++mReadbackCount;
+}
+
+const Readback* Task::retireReadback(bool aWait)
+{
+    if (mReadbackCount <= 0) return nullptr;
+
+    Readback& readback = *mReadbacks[mReadbackHead];
+    if (!aWait && readback.isRunning()) return nullptr;
+
+    readback.finish();
+    mReadbackHead = (mReadbackHead + 1) % kReadbackDepth;
+    --mReadbackCount;
+
+    // the source mesh has not been updated by this result yet
+    pollVertexGrid();
+
+    // the world positions of them will be changed
+    if (mVertexGrid.vertexCount() == mVtxCount)
+    {
+        mMovedRanges += readback.ranges();
+    }
+    return &readback;
+}
+
+bool Task::limitsRegion() const
+{
+    // the blur refers the neighbors of the written vertices
+    return (mType == Type_Deformer || mType == Type_Eraser) && !mUseBlur;
+}
+
+QRectF Task::brushSweptRect() const
+{
+    const float radius = (mType == Type_Eraser) ? mParam.eraseRadius : mParam.radius;
+    const QVector2D p0 = mBrushCenter;
+    const QVector2D p1 = mBrushCenter + mBrushVel;
+    return QRectF(
+                QPointF(std::min(p0.x(), p1.x()) - radius, std::min(p0.y(), p1.y()) - radius),
+                QPointF(std::max(p0.x(), p1.x()) + radius, std::max(p0.y(), p1.y()) + radius));
+}
+
+void Task::updateRegion()
+{
+    const int vtxCount = mSrcMesh.count();
+
+    if (mVertexGrid.vertexCount() != vtxCount)
+    {
+        // evaluate all until the readbacks of the stroke start finish
+        if (!mWorldRequested)
+        {
+            requestWorldReadbacks();
+        }
+        mRanges.clear();
+        mRanges.push_back(util::Range(0, vtxCount - 1));
+        return;
+    }
+
+    // only the vertices written by the finished steps have moved
+    for (auto range : mMovedRanges)
+    {
+        for (int i = range.min(); i <= range.max(); ++i)
+        {
+            mVertexGrid.update(i, worldPosition(i).pos2D());
+        }
+    }
+    mMovedRanges.clear();
+
+    mVertexGrid.find(brushSweptRect(), mCandidates);
+    VertexGrid::makeRanges(mCandidates, kRangeGap, mRanges);
+
+    // one pass is cheaper than many small passes
+    if (mCandidates.size() > vtxCount / 2 || mRanges.size() > kMaxRangeCount)
+    {
+        mRanges.clear();
+        mRanges.push_back(util::Range(0, vtxCount - 1));
+    }
+}
+
+void Task::requestWorldReadbacks()
+{
+    // the arrows are the linear part of the vertex transforms, which are
+    // fixed during a stroke. they move the world positions of the start
+    // by the later changes of the sources.
+    const QVector<util::Range> ranges(1, util::Range(0, mSrcMesh.count() - 1));
+    mWorldReadback.set(mMeshTransformer.positions(), mSrcMesh.array(), ranges);
+    mXArrowReadback.set(mMeshTransformer.xArrows(), nullptr, ranges);
+    mYArrowReadback.set(mMeshTransformer.yArrows(), nullptr, ranges);
+    mWorldReadback.request();
+    mXArrowReadback.request();
+    mYArrowReadback.request();
+    mWorldRequested = true;
+}
+
+void Task::pollVertexGrid()
+{
+    const int vtxCount = mSrcMesh.count();
+    if (!mWorldRequested || mVertexGrid.vertexCount() == vtxCount) return;
+
+    // the fences are signaled in order. never wait for them
+    if (mYArrowReadback.isRunning()) return;
+
+    mWorldReadback.finish();
+    mXArrowReadback.finish();
+    mYArrowReadback.finish();
+
+    if (mWorldReadback.count() != vtxCount)
+    {
+        mWorldRequested = false;
+        return;
+    }
+
+    // the sources may be changed since the readbacks were requested
+    mWorldPositions.resize(vtxCount);
+    for (int i = 0; i < vtxCount; ++i)
+    {
+        mWorldPositions[i] = worldPosition(i);
+    }
+    mVertexGrid.reset(mWorldPositions.data(), vtxCount);
+    mMovedRanges.clear();
+}
+
+gl::Vector3 Task::worldPosition(int aIndex) const
+{
+    const gl::Vector3 move = mSrcMesh.array()[aIndex] - mWorldReadback.sources()[aIndex];
+    return mWorldReadback.results()[aIndex] +
+            mXArrowReadback.results()[aIndex] * move.x +
+            mYArrowReadback.results()[aIndex] * move.y;
+}
+
 gl::EasyShaderProgram& Task::selectShaderProgram() const
 {
     switch (mType)
@@ -155,6 +330,20 @@ void Task::onRequested()
         const int srcVtxCount = mSrcMesh.count();
         gl::EasyShaderProgram& program = selectShaderProgram();
 
+        // select vertices to evaluate
+        if (limitsRegion())
+        {
+            updateRegion();
+        }
+        else
+        {
+            mVertexGrid.clear();
+            mMovedRanges.clear();
+            mWorldRequested = false;
+            mRanges.clear();
+            mRanges.push_back(util::Range(0, srcVtxCount - 1));
+        }
+
         gl::Util::resetRenderState();
         ggl.glEnable(GL_RASTERIZER_DISCARD);
 
@@ -172,9 +361,6 @@ void Task::onRequested()
             program.setUniformValue("uBrushRadius", (float)mParam.radius);
             program.setUniformValue("uBrushPressure", mParam.pressure);
             program.setUniformValue("uDividable", Constant::dividable());
-
-            ggl.glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0, mOutMesh.id());
-            ggl.glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 1, mOutWeight.id());
         }
         else if (mType == Type_Eraser)
         {
@@ -185,8 +371,6 @@ void Task::onRequested()
             program.setUniformValue("uBrushCenter", mBrushCenter);
             program.setUniformValue("uBrushRadius", (float)mParam.eraseRadius);
             program.setUniformValue("uBrushPressure", mParam.erasePressure);
-
-            ggl.glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0, mOutMesh.id());
         }
         else if (mType == Type_Focuser)
         {
@@ -194,14 +378,30 @@ void Task::onRequested()
 
             program.setUniformValue("uBrushCenter", mBrushCenter);
             program.setUniformValue("uBrushRadius", mParam.focusRadius);
-
-            ggl.glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0, mOutMesh.id());
-            ggl.glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 1, mOutWeight.id());
         }
 
-        ggl.glBeginTransformFeedback(GL_POINTS);
-        ggl.glDrawArrays(GL_POINTS, 0, mSrcMesh.count());
-        ggl.glEndTransformFeedback();
+        // the eraser has no weight output
+        const bool writesWeight = (mType != Type_Eraser);
+
+        for (auto range : mRanges)
+        {
+            const int begin = range.min();
+            const int count = range.diff() + 1;
+
+            ggl.glBindBufferRange(
+                        GL_TRANSFORM_FEEDBACK_BUFFER, 0, mOutMesh.id(),
+                        begin * sizeof(gl::Vector3), count * sizeof(gl::Vector3));
+            if (writesWeight)
+            {
+                ggl.glBindBufferRange(
+                            GL_TRANSFORM_FEEDBACK_BUFFER, 1, mOutWeight.id(),
+                            begin * sizeof(GLfloat), count * sizeof(GLfloat));
+            }
+
+            ggl.glBeginTransformFeedback(GL_POINTS);
+            ggl.glDrawArrays(GL_POINTS, begin, count);
+            ggl.glEndTransformFeedback();
+        }
 
         program.release();
         ggl.glDisable(GL_RASTERIZER_DISCARD);
@@ -342,11 +542,34 @@ void Task::onFinished()
     }
     else
     {
+        XC_ASSERT(mSrcMesh.count() == mVtxCount);
+
+        // the vertices out of the ranges keep the source positions
+        if (mRanges.size() != 1 || mRanges.front().diff() + 1 != mVtxCount)
+        {
+            memcpy(mDstMesh.data(), mSrcMesh.array(), sizeof(gl::Vector3) * mVtxCount);
+        }
+
         // read output mesh
         mOutMesh.bind();
-        ggl.glGetBufferSubData(GL_TRANSFORM_FEEDBACK_BUFFER, 0,
-                               sizeof(gl::Vector3) * mVtxCount, mDstMesh.data());
+        for (auto range : mRanges)
+        {
+            const int begin = range.min();
+            const int count = range.diff() + 1;
+            ggl.glGetBufferSubData(GL_TRANSFORM_FEEDBACK_BUFFER, sizeof(gl::Vector3) * begin,
+                                   sizeof(gl::Vector3) * count, mDstMesh.data() + begin);
+        }
         mOutMesh.release();
+
+        // the source mesh is updated by the caller after this
+        if (limitsRegion())
+        {
+            pollVertexGrid();
+            if (mVertexGrid.vertexCount() == mVtxCount)
+            {
+                mMovedRanges += mRanges;
+            }
+        }
     }
     GL_CHECK_ERROR();
     //qDebug() << timer.nsecsElapsed();
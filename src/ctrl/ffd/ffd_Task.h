@@ -14,6 +14,8 @@
 #include "core/LayerMesh.h"
 #include "ctrl/FFDParam.h"
 #include "ctrl/ffd/ffd_TaskResource.h"
+#include "ctrl/ffd/ffd_VertexGrid.h"
+#include "ctrl/ffd/ffd_Readback.h"
 
 namespace ctrl {
 namespace ffd {
@@ -47,17 +49,45 @@ public:
             const QVector2D& aBrushCenter,
             const QVector2D& aBrushVel);
 
+    // deformer and eraser evaluate only the vertices around the brush.
+    // call this at the beginning of each stroke to rebuild the vertex index.
+    // it also drops the readbacks in flight.
+    // the index is built from a fenced readback of the world positions at
+    // the stroke start, all vertices are evaluated until it finishes.
+    void resetRegion();
+
+    // asynchronous mode for deformer and eraser. the result is read through
+    // a ring of fenced readbacks instead of dstMesh().
+    // make sure that hasFreeReadback() is true before requesting.
+    void requestAsync();
+    bool hasFreeReadback() const { return mReadbackCount < kReadbackDepth; }
+    int readbackCount() const { return mReadbackCount; }
+    // finish the oldest readback. returns null if there is none or it is
+    // still running and aWait is false. the result is valid until the next
+    // request. the caller has to apply it to the source mesh.
+    const Readback* retireReadback(bool aWait);
+
     gl::Vector3* dstMesh() const { return mDstMesh.data(); }
     size_t dstSize() const { return sizeof(gl::Vector3) * mVtxCount; }
+    // vertex ranges written by the last deformer or eraser
+    const QVector<util::Range>& dstRanges() const { return mRanges; }
 
     QVector2D dragMove() const { return mDragMove; } // for Dragger
     int focusIndex() const { return mFocusIndex; } // for Focuser
 
 private:
+    enum { kReadbackDepth = 3 };
+
     virtual void onRequested();
     virtual void onFinished();
     void requestBlur();
     gl::EasyShaderProgram& selectShaderProgram() const;
+    bool limitsRegion() const;
+    void updateRegion();
+    void requestWorldReadbacks();
+    void pollVertexGrid();
+    gl::Vector3 worldPosition(int aIndex) const;
+    QRectF brushSweptRect() const;
 
     TaskResource& mResource;
 
@@ -89,6 +119,20 @@ private:
     int mFocusIndex;
     int mDragIndex;
     QVector2D mDragMove;
+
+    VertexGrid mVertexGrid;
+    QVector<util::Range> mRanges;
+    QVector<util::Range> mMovedRanges;
+    QVector<int> mCandidates;
+    QVector<gl::Vector3> mWorldPositions;
+    Readback mWorldReadback;
+    Readback mXArrowReadback;
+    Readback mYArrowReadback;
+    bool mWorldRequested;
+
+    QScopedPointer<Readback> mReadbacks[kReadbackDepth];
+    int mReadbackHead;
+    int mReadbackCount;
 };
 
 } // namespace ffd
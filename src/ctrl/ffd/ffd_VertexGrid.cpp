@@ -0,0 +1,159 @@
+#include <cmath>
+#include <algorithm>
+#include "XC.h"
+#include "ctrl/ffd/ffd_VertexGrid.h"
+
+namespace
+{
+static const int kVerticesPerCell = 8;
+static const int kMaxTableWidth = 1024;
+}
+
+namespace ctrl {
+namespace ffd {
+
+//-------------------------------------------------------------------------------------------------
+VertexGrid::VertexGrid()
+    : mBounds()
+    , mCellSize(1.0f)
+    , mWidth()
+    , mHeight()
+    , mVtxCount()
+    , mCells()
+    , mVtxCells()
+    , mPositions()
+{
+}
+
+void VertexGrid::clear()
+{
+    mBounds = QRectF();
+    mCellSize = 1.0f;
+    mWidth = 0;
+    mHeight = 0;
+    mVtxCount = 0;
+    mCells.clear();
+    mVtxCells.clear();
+    mPositions.clear();
+}
+
+void VertexGrid::reset(const gl::Vector3* aPositions, int aCount)
+{
+    clear();
+    if (aCount <= 0) return;
+    XC_PTR_ASSERT(aPositions);
+
+    // bounds
+    float l = aPositions[0].x;
+    float t = aPositions[0].y;
+    float r = l;
+    float b = t;
+    for (int i = 1; i < aCount; ++i)
+    {
+        l = std::min(l, aPositions[i].x);
+        t = std::min(t, aPositions[i].y);
+        r = std::max(r, aPositions[i].x);
+        b = std::max(b, aPositions[i].y);
+    }
+    mBounds = QRectF(QPointF(l, t), QPointF(r, b));
+
+    // cell size for about kVerticesPerCell vertices per cell
+    const float area = std::max((r - l) * (b - t), 1.0f);
+    const int cellCount = std::max(aCount / kVerticesPerCell, 1);
+    mCellSize = std::max(std::sqrt(area / cellCount), 1.0f);
+    mCellSize = std::max(mCellSize, std::max(r - l, b - t) / kMaxTableWidth);
+    mWidth = std::max((int)((r - l) / mCellSize) + 1, 1);
+    mHeight = std::max((int)((b - t) / mCellSize) + 1, 1);
+
+    mCells.resize(mWidth * mHeight);
+    mVtxCells.resize(aCount);
+    mPositions.resize(aCount);
+    mVtxCount = aCount;
+
+    for (int i = 0; i < aCount; ++i)
+    {
+        const QVector2D pos = aPositions[i].pos2D();
+        const int cell = cellX(pos.x()) + cellY(pos.y()) * mWidth;
+        mCells[cell].push_back(i);
+        mVtxCells[i] = cell;
+        mPositions[i] = pos;
+    }
+}
+
+void VertexGrid::update(int aIndex, const QVector2D& aPos)
+{
+    XC_ASSERT(0 <= aIndex && aIndex < mVtxCount);
+    mPositions[aIndex] = aPos;
+
+    const int cell = cellX(aPos.x()) + cellY(aPos.y()) * mWidth;
+    const int prevCell = mVtxCells[aIndex];
+    if (cell == prevCell) return;
+
+    // the order in a cell is meaningless
+    QVector<int>& prevIndices = mCells[prevCell];
+    const int pos = prevIndices.indexOf(aIndex);
+    XC_ASSERT(pos >= 0);
+    prevIndices[pos] = prevIndices.back();
+    prevIndices.pop_back();
+
+    mCells[cell].push_back(aIndex);
+    mVtxCells[aIndex] = cell;
+}
+
+void VertexGrid::find(const QRectF& aRect, QVector<int>& aDest) const
+{
+    aDest.clear();
+    if (mVtxCount <= 0) return;
+
+    const int l = cellX(aRect.left());
+    const int t = cellY(aRect.top());
+    const int r = cellX(aRect.right());
+    const int b = cellY(aRect.bottom());
+
+    for (int y = t; y <= b; ++y)
+    {
+        for (int x = l; x <= r; ++x)
+        {
+            for (auto index : mCells[x + y * mWidth])
+            {
+                if (aRect.contains(mPositions[index].toPointF()))
+                {
+                    aDest.push_back(index);
+                }
+            }
+        }
+    }
+    std::sort(aDest.begin(), aDest.end());
+}
+
+void VertexGrid::makeRanges(
+        const QVector<int>& aIndices, int aGap, QVector<util::Range>& aDest)
+{
+    aDest.clear();
+    for (auto index : aIndices)
+    {
+        if (!aDest.isEmpty() && index - aDest.back().max() <= aGap)
+        {
+            aDest.back().setMax(index);
+        }
+        else
+        {
+            aDest.push_back(util::Range(index, index));
+        }
+    }
+}
+
+int VertexGrid::cellX(float aX) const
+{
+    const int x = (int)std::floor((aX - mBounds.left()) / mCellSize);
+    return std::min(std::max(x, 0), mWidth - 1);
+}
+
+int VertexGrid::cellY(float aY) const
+{
+    const int y = (int)std::floor((aY - mBounds.top()) / mCellSize);
+    return std::min(std::max(y, 0), mHeight - 1);
+}
+
+} // namespace ffd
+} // namespace ctrl
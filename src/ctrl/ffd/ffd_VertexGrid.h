@@ -0,0 +1,51 @@
+#ifndef CTRL_FFD_VERTEXGRID_H
+#define CTRL_FFD_VERTEXGRID_H
+
+#include <QRectF>
+#include <QVector>
+#include <QVector2D>
+#include "util/Range.h"
+#include "gl/Vector3.h"
+
+namespace ctrl {
+namespace ffd {
+
+// uniform grid of vertex indices over the world space positions of a mesh.
+// the positions out of the initial bounds are clamped into the border cells.
+class VertexGrid
+{
+public:
+    VertexGrid();
+
+    void reset(const gl::Vector3* aPositions, int aCount);
+    void clear();
+    bool isValid() const { return mVtxCount > 0; }
+    int vertexCount() const { return mVtxCount; }
+
+    void update(int aIndex, const QVector2D& aPos);
+
+    // sorted indices of the vertices in aRect
+    void find(const QRectF& aRect, QVector<int>& aDest) const;
+
+    // merge sorted indices into ranges, closer ranges than aGap are joined
+    static void makeRanges(const QVector<int>& aIndices, int aGap,
+                           QVector<util::Range>& aDest);
+
+private:
+    int cellX(float aX) const;
+    int cellY(float aY) const;
+
+    QRectF mBounds;
+    float mCellSize;
+    int mWidth;
+    int mHeight;
+    int mVtxCount;
+    QVector<QVector<int>> mCells;
+    QVector<int> mVtxCells;
+    QVector<QVector2D> mPositions;
+};
+
+} // namespace ffd
+} // namespace ctrl
+
+#endif // CTRL_FFD_VERTEXGRID_H
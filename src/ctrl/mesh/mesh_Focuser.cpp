@@ -1,10 +1,12 @@
+#include <algorithm>
 #include <QPolygonF>
 #include "util/CollDetect.h"
 #include "ctrl/mesh/mesh_Focuser.h"
 
 namespace
 {
-static const float kVtxSqRadius = 8.0f * 8.0f;
+static const float kVtxRadius = 8.0f;
+static const float kVtxSqRadius = kVtxRadius * kVtxRadius;
 static const float kEdgeSqRadius = 8.0f * 8.0f;
 }
 
@@ -40,44 +42,73 @@ void Focuser::update(const core::CameraInfo& aCamera, const core::AbstractCursor
 
     const QVector2D focusPos = aCursor.screenPos();
 
+    // model space area which may hit the cursor
+    QRectF modelRect;
+    const bool useIndex = getModelRect(aCamera, focusPos, kVtxRadius, modelRect);
+
     // vertex
     if (mEnable[0])
     {
-        for (auto& vtx : mMesh->vertices())
+        const QVector<MeshVtx*> vertices = useIndex ?
+                    mMesh->spatialIndex().findVertices(modelRect) :
+                    mMesh->vertices().toVector();
+        float nearest = kVtxSqRadius;
+
+        for (auto vtx : vertices)
         {
             const QVector2D vtxPos = getScreenPos(aCamera, vtx->vec());
+            const float sqLength = (focusPos - vtxPos).lengthSquared();
 
-            if ((focusPos - vtxPos).lengthSquared() < kVtxSqRadius)
+            if (sqLength < nearest)
             {
                 mFocus.vtx = vtx;
-                updateFocusChanged(prev, mFocus);
-                return;
+                nearest = sqLength;
             }
         }
+        if (mFocus.vtx)
+        {
+            updateFocusChanged(prev, mFocus);
+            return;
+        }
     }
 
     // edge
     if (mEnable[1])
     {
-        for (auto& edge : mMesh->edges())
+        const QVector<MeshEdge*> edges = useIndex ?
+                    mMesh->spatialIndex().findEdges(modelRect) :
+                    mMesh->edges().toVector();
+        float nearest = kEdgeSqRadius;
+
+        for (auto edge : edges)
         {
             const QVector2D v0 = getScreenPos(aCamera, edge->vtx(0)->vec());
             const QVector2D v1 = getScreenPos(aCamera, edge->vtx(1)->vec());
             auto c = util::CollDetect::getPosOnSegment(
                         util::Segment2D(v0, v1 - v0), focusPos);
-            if ((focusPos - c).lengthSquared() < kEdgeSqRadius)
+            const float sqLength = (focusPos - c).lengthSquared();
+
+            if (sqLength < nearest)
             {
                 mFocus.edge = edge;
-                updateFocusChanged(prev, mFocus);
-                return;
+                nearest = sqLength;
             }
         }
+        if (mFocus.edge)
+        {
+            updateFocusChanged(prev, mFocus);
+            return;
+        }
     }
 
     // face
     if (mEnable[2])
     {
-        for (auto& face : mMesh->faces())
+        const QVector<MeshFace*> faces = useIndex ?
+                    mMesh->spatialIndex().findFaces(modelRect) :
+                    mMesh->faces().toVector();
+
+        for (auto face : faces)
         {
             auto vtx = face->vertices();
             QPolygonF poly;
@@ -97,6 +128,34 @@ void Focuser::update(const core::CameraInfo& aCamera, const core::AbstractCursor
     updateFocusChanged(prev, mFocus);
 }
 
+bool Focuser::getModelRect(
+        const core::CameraInfo& aCamera, const QVector2D& aScreenPos,
+        float aRadius, QRectF& aDst) const
+{
+    bool invertible = false;
+    const QMatrix4x4 invMtx = mTargetMtx.inverted(&invertible);
+    if (!invertible) return false;
+
+    const QVector2D corners[4] = {
+        aScreenPos + QVector2D(-aRadius, -aRadius),
+        aScreenPos + QVector2D( aRadius, -aRadius),
+        aScreenPos + QVector2D( aRadius,  aRadius),
+        aScreenPos + QVector2D(-aRadius,  aRadius) };
+
+    QPointF lt, rb;
+    for (int i = 0; i < 4; ++i)
+    {
+        const QVector3D world(aCamera.toWorldPos(corners[i]));
+        const QPointF model = (invMtx * world).toPointF();
+        lt.setX(i == 0 ? model.x() : std::min(lt.x(), model.x()));
+        lt.setY(i == 0 ? model.y() : std::min(lt.y(), model.y()));
+        rb.setX(i == 0 ? model.x() : std::max(rb.x(), model.x()));
+        rb.setY(i == 0 ? model.y() : std::max(rb.y(), model.y()));
+    }
+    aDst = QRectF(lt, rb);
+    return true;
+}
+
 void Focuser::updateFocusChanged(const Focus& aPrev, const Focus& aNext)
 {
     mFocusChanged =
@@ -47,6 +47,8 @@ public:
 
 private:
     QVector2D getScreenPos(const core::CameraInfo&, const QVector2D& aModelPos) const;
+    bool getModelRect(const core::CameraInfo&, const QVector2D& aScreenPos,
+                      float aRadius, QRectF& aDst) const;
     void updateFocusChanged(const Focus& aPrev, const Focus& aNext);
 
     MeshAccessor* mMesh;
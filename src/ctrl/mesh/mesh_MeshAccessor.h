@@ -26,6 +26,7 @@ public:
     const VtxList& vertices() const { return mKey->data().vertices(); }
     const EdgeList& edges() const { return mKey->data().edges(); }
     const FaceList& faces() const { return mKey->data().faces(); }
+    const core::MeshSpatialIndex& spatialIndex() const { return mKey->data().spatialIndex(); }
 
     void setKey(core::MeshKey& aKey)
     {
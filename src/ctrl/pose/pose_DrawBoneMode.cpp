@@ -155,7 +155,7 @@ void DrawBoneMode::pullBone(Bone2& aTarget, const QVector2D& aPull, float aPullP
             TimeLineEvent event;
             event.setType(TimeLineEvent::Type_ChangeKeyValue);
             event.pushTarget(mTarget, TimeKeyType_Pose, frame);
-            mProject.onTimeLineModified(event, false);
+            mProject.postTimeLineModified(event);
         }
         else
         {
@@ -94,7 +94,7 @@ void ErasePoseMode::updatePaint()
         TimeLineEvent event;
         event.setType(TimeLineEvent::Type_ChangeKeyValue);
         event.pushTarget(mTarget, TimeKeyType_Pose, frame);
-        mProject.onTimeLineModified(event, false);
+        mProject.postTimeLineModified(event);
     }
     else
     {
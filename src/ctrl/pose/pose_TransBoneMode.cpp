@@ -113,7 +113,7 @@ void TransBoneMode::rotateBone(Bone2& aTarget, float aRotate)
         TimeLineEvent event;
         event.setType(TimeLineEvent::Type_ChangeKeyValue);
         event.pushTarget(mTarget, TimeKeyType_Pose, frame);
-        mProject.onTimeLineModified(event, false);
+        mProject.postTimeLineModified(event);
     }
     else
     {
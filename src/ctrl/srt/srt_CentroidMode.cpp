@@ -128,7 +128,7 @@ void CentroidMode::moveCentroid(const QVector2D& aNewCentroid, const QVector2D&
         TimeLineEvent event;
         event.setType(TimeLineEvent::Type_ChangeKeyValue);
         event.pushTarget(mTarget, TimeKeyType_Move, frame);
-        mProject.onTimeLineModified(event, false);
+        mProject.postTimeLineModified(event);
     }
     else
     {
@@ -184,7 +184,7 @@ void MoveMode::notifyAssignModification(TimeKeyType aKeyType)
     TimeLineEvent event;
     event.setType(TimeLineEvent::Type_ChangeKeyValue);
     event.pushTarget(mTarget, aKeyType, frame);
-    mProject.onTimeLineModified(event, false);
+    mProject.postTimeLineModified(event);
 }
 
 void MoveMode::assignMoveKey(MoveKey::Data& aNewData)
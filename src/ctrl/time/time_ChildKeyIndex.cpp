@@ -0,0 +1,124 @@
+#include <algorithm>
+#include <iterator>
+#include "ctrl/time/time_ChildKeyIndex.h"
+
+using namespace core;
+
+namespace ctrl {
+namespace time {
+
+//-------------------------------------------------------------------------------------------------
+ChildKeyIndex::Summary::Summary()
+    : own()
+    , descendants()
+    , hasOwn(false)
+    , hasDescendants(false)
+{
+}
+
+//-------------------------------------------------------------------------------------------------
+ChildKeyIndex::ChildKeyIndex()
+    : mSummaries()
+{
+}
+
+void ChildKeyIndex::clear()
+{
+    mSummaries.clear();
+}
+
+void ChildKeyIndex::invalidate(const ObjectNode& aNode)
+{
+    auto itr = mSummaries.find(&aNode);
+    if (itr != mSummaries.end())
+    {
+        itr->hasOwn = false;
+    }
+
+    // every ancestor contains the node in its descendant summary
+    for (const ObjectNode* node = aNode.parent(); node; node = node->parent())
+    {
+        auto parentItr = mSummaries.find(node);
+        if (parentItr == mSummaries.end()) continue;
+        parentItr->hasDescendants = false;
+    }
+}
+
+void ChildKeyIndex::invalidate(const TimeLineEvent& aEvent)
+{
+    for (auto target : aEvent.targets())
+    {
+        if (target.node) invalidate(*target.node);
+    }
+    for (auto target : aEvent.detaulTargets())
+    {
+        if (target.node) invalidate(*target.node);
+    }
+}
+
+const ChildKeyIndex::FrameList& ChildKeyIndex::descendantFrames(const ObjectNode& aNode)
+{
+    {
+        Summary& summary = mSummaries[&aNode];
+        if (summary.hasDescendants) return summary.descendants;
+    }
+
+    FrameList frames;
+    for (auto child : aNode.children())
+    {
+        mergeFrames(frames, ownFrames(*child));
+        mergeFrames(frames, descendantFrames(*child));
+    }
+
+    // lookup again, the recursion above may have rehashed the table
+    Summary& summary = mSummaries[&aNode];
+    summary.descendants.swap(frames);
+    summary.hasDescendants = true;
+    return summary.descendants;
+}
+
+const ChildKeyIndex::FrameList& ChildKeyIndex::ownFrames(const ObjectNode& aNode)
+{
+    Summary& summary = mSummaries[&aNode];
+    if (summary.hasOwn) return summary.own;
+
+    summary.own.clear();
+    if (aNode.timeLine())
+    {
+        const TimeLine& timeLine = *(aNode.timeLine());
+        for (int i = 0; i < TimeKeyType_TERM; ++i)
+        {
+            const TimeLine::MapType& map = timeLine.map((TimeKeyType)i);
+            if (map.isEmpty()) continue;
+
+            FrameList frames;
+            frames.reserve(map.size());
+            for (auto itr = map.begin(); itr != map.end(); ++itr)
+            {
+                frames.push_back(itr.key());
+            }
+            mergeFrames(summary.own, frames);
+        }
+    }
+    summary.hasOwn = true;
+    return summary.own;
+}
+
+void ChildKeyIndex::mergeFrames(FrameList& aDst, const FrameList& aSrc)
+{
+    if (aSrc.isEmpty()) return;
+    if (aDst.isEmpty())
+    {
+        aDst = aSrc;
+        return;
+    }
+
+    FrameList merged;
+    merged.reserve(aDst.size() + aSrc.size());
+    std::set_union(aDst.begin(), aDst.end(), aSrc.begin(), aSrc.end(),
+                   std::back_inserter(merged));
+    aDst.swap(merged);
+}
+
+} // namespace time
+} // namespace ctrl
@@ -0,0 +1,49 @@
+#ifndef CTRL_TIME_CHILDKEYINDEX_H
+#define CTRL_TIME_CHILDKEYINDEX_H
+
+#include <QHash>
+#include <QVector>
+#include "core/ObjectNode.h"
+#include "core/TimeLineEvent.h"
+
+namespace ctrl {
+namespace time {
+
+// hierarchical summary of the key frames owned by the descendants of each node.
+// each summary is a sorted unique frame list which is built lazily and merged
+// from the summaries of the children, so an edit only invalidates the edited
+// node and its ancestors.
+class ChildKeyIndex
+{
+public:
+    typedef QVector<int> FrameList;
+
+    ChildKeyIndex();
+
+    void clear();
+    void invalidate(const core::ObjectNode& aNode);
+    void invalidate(const core::TimeLineEvent& aEvent);
+
+    // sorted unique frames of all keys in the subtree except the node itself
+    const FrameList& descendantFrames(const core::ObjectNode& aNode);
+
+private:
+    struct Summary
+    {
+        Summary();
+        FrameList own;
+        FrameList descendants;
+        bool hasOwn;
+        bool hasDescendants;
+    };
+
+    const FrameList& ownFrames(const core::ObjectNode& aNode);
+    static void mergeFrames(FrameList& aDst, const FrameList& aSrc);
+
+    QHash<const core::ObjectNode*, Summary> mSummaries;
+};
+
+} // namespace time
+} // namespace ctrl
+
+#endif // CTRL_TIME_CHILDKEYINDEX_H
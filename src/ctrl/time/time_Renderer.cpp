@@ -1,3 +1,4 @@
+#include <algorithm>
 #include "ctrl/time/time_Renderer.h"
 
 using namespace core;
@@ -12,6 +13,7 @@ Renderer::Renderer(QPainter& aPainter, const CameraInfo& aCamera, const theme::T
     , mMargin()
     , mRange()
     , mScale()
+    , mChildKeys()
 {
 }
 
@@ -239,38 +241,26 @@ void Renderer::drawKeys(const ObjectNode* aNode, const TimeLineRow& aRow)
 
 void Renderer::drawChildKeys(const ObjectNode* aNode, const QPoint& aPos)
 {
+    if (!mChildKeys) return;
+
     const QBrush kBrushKey(QColor(170, 170, 170, 255));
 
     mPainter.setPen(QPen(kBrushKey, 1));
     mPainter.setBrush(kBrushKey);
 
-    for (auto child : aNode->children())
-    {
-        ObjectNode::ConstIterator treeItr(child);
-        while (treeItr.hasNext())
-        {
-            const ObjectNode* node = treeItr.next();
-            if (!node->timeLine()) continue;
-            const TimeLine& timeLine = *(node->timeLine());
+    const ChildKeyIndex::FrameList& frames = mChildKeys->descendantFrames(*aNode);
 
-            for (int i = 0; i < TimeKeyType_TERM; ++i)
-            {
-                auto type = TimeLine::getTimeKeyTypeInOrderOfOperations(i);
-                const TimeLine::MapType& map = timeLine.map(type);
+    // cull to the visible range
+    auto itr = std::lower_bound(frames.begin(), frames.end(), mRange.min());
 
-                auto itr = map.lowerBound(mRange.min());
-                while (itr != map.end() && itr.key() <= mRange.max())
-                {
-                    auto attr = mScale->attribute(itr.key());
-                    QPointF pos[3];
-                    pos[0] = QPointF(aPos.x() + attr.grid.x() + 0.5, aPos.y());
-                    pos[1] = pos[0] + QPointF( 3, -5);
-                    pos[2] = pos[0] + QPointF(-3, -5);
-                    mPainter.drawConvexPolygon(pos, 3);
-                    ++itr;
-                }
-            }
-        }
+    for (; itr != frames.end() && *itr <= mRange.max(); ++itr)
+    {
+        const int x = mScale->pixelWidth(*itr);
+        QPointF pos[3];
+        pos[0] = QPointF(aPos.x() + x + 0.5, aPos.y());
+        pos[1] = pos[0] + QPointF( 3, -5);
+        pos[2] = pos[0] + QPointF(-3, -5);
+        mPainter.drawConvexPolygon(pos, 3);
     }
 }
 
@@ -10,6 +10,7 @@
 #include "core/TimeFormat.h"
 #include "ctrl/TimeLineRow.h"
 #include "ctrl/time/time_Scaler.h"
+#include "ctrl/time/time_ChildKeyIndex.h"
 #include "gui/theme/TimeLine.h"
 
 namespace ctrl {
@@ -23,6 +24,7 @@ public:
     void setMargin(int aMargin) { mMargin = aMargin; }
     void setRange(const util::Range& aRange) { mRange = aRange; }
     void setTimeScale(const Scaler& aScale) { mScale = &aScale; }
+    void setChildKeyIndex(ChildKeyIndex& aIndex) { mChildKeys = &aIndex; }
 
     void renderLines(const QVector<TimeLineRow>& aRows, const QRect& aCameraRect, const QRect& aCullRect);
     void renderHeader(int aHeight, int aFps);
@@ -40,6 +42,7 @@ private:
     int mMargin;
     util::Range mRange;
     const Scaler* mScale;
+    ChildKeyIndex* mChildKeys;
 };
 
 } // namespace time
@@ -39,6 +39,11 @@ bool EasyShaderProgram::setFragmentSource(const QString& aSource)
     return mImpl.addShaderFromSourceCode(QOpenGLShader::Fragment, aSource);
 }
 
+bool EasyShaderProgram::create()
+{
+    return mImpl.create();
+}
+
 bool EasyShaderProgram::link()
 {
     return mImpl.link();
@@ -25,6 +25,8 @@ public:
     bool setVertexSource(const QString& aSource);
     bool setFragmentSource(const QString& aSource);
 
+    // create an empty program object, e.g. to load a program binary into it.
+    bool create();
     bool link();
     QString log() const;
 
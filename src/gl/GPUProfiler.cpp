@@ -0,0 +1,154 @@
+#include <QVector>
+#include "XC.h"
+#include "util/Profiler.h"
+#include "gl/GPUProfiler.h"
+
+namespace
+{
+// queries are skipped while the results are not collected
+static const int kMaxPendingCount = 4096;
+
+struct Pending
+{
+    const char* name;
+    QString detail;
+    GLuint begin;
+    GLuint end;
+};
+
+struct ThreadQueries
+{
+    ThreadQueries() : isAvailable(-1), freeQueries(), pendings() {}
+    int isAvailable; // unknown if negative
+    QVector<GLuint> freeQueries;
+    QVector<Pending> pendings;
+};
+
+thread_local ThreadQueries* tQueries = nullptr;
+
+ThreadQueries* threadQueries()
+{
+    if (!tQueries)
+    {
+        tQueries = new ThreadQueries();
+    }
+    if (tQueries->isAvailable < 0)
+    {
+        // some drivers have no timer
+        GLint bits = 0;
+        gl::Global::functions().glGetQueryiv(GL_TIMESTAMP, GL_QUERY_COUNTER_BITS, &bits);
+        tQueries->isAvailable = bits > 0 ? 1 : 0;
+    }
+    return tQueries->isAvailable ? tQueries : nullptr;
+}
+
+GLuint takeQuery(ThreadQueries& aQueries)
+{
+    if (aQueries.freeQueries.isEmpty())
+    {
+        GLuint id = 0;
+        gl::Global::functions().glGenQueries(1, &id);
+        return id;
+    }
+    const GLuint id = aQueries.freeQueries.back();
+    aQueries.freeQueries.pop_back();
+    return id;
+}
+}
+
+namespace gl
+{
+
+//-------------------------------------------------------------------------------------------------
+int GPUProfiler::begin(const char* aName, const QString& aDetail)
+{
+    auto queries = threadQueries();
+    if (!queries || queries->pendings.size() >= kMaxPendingCount) return -1;
+
+    Pending pending = { aName, aDetail, takeQuery(*queries), 0 };
+    Global::functions().glQueryCounter(pending.begin, GL_TIMESTAMP);
+    queries->pendings.push_back(pending);
+    return queries->pendings.size() - 1;
+}
+
+void GPUProfiler::end(int aIndex)
+{
+    XC_PTR_ASSERT(tQueries);
+    XC_ASSERT(0 <= aIndex && aIndex < tQueries->pendings.size());
+    Pending& pending = tQueries->pendings[aIndex];
+    pending.end = takeQuery(*tQueries);
+    Global::functions().glQueryCounter(pending.end, GL_TIMESTAMP);
+}
+
+void GPUProfiler::resolve()
+{
+    if (!tQueries || tQueries->pendings.isEmpty()) return;
+    auto& ggl = Global::functions();
+
+    // the gpu clock is mapped to the profiler clock
+    GLint64 gpuNow = 0;
+    ggl.glGetInteger64v(GL_TIMESTAMP, &gpuNow);
+    const qint64 offset = util::Profiler::now() - (qint64)gpuNow;
+
+    // the queries finish in order
+    int count = 0;
+    for (auto& pending : tQueries->pendings)
+    {
+        if (pending.end == 0) break;
+
+        GLuint available = GL_FALSE;
+        ggl.glGetQueryObjectuiv(pending.end, GL_QUERY_RESULT_AVAILABLE, &available);
+        if (!available) break;
+
+        GLuint64 begin = 0;
+        GLuint64 end = 0;
+        ggl.glGetQueryObjectui64v(pending.begin, GL_QUERY_RESULT, &begin);
+        ggl.glGetQueryObjectui64v(pending.end, GL_QUERY_RESULT, &end);
+        util::Profiler::record(pending.name, pending.detail,
+                               (qint64)begin + offset, (qint64)end + offset, true);
+
+        tQueries->freeQueries.push_back(pending.begin);
+        tQueries->freeQueries.push_back(pending.end);
+        ++count;
+    }
+    tQueries->pendings.erase(tQueries->pendings.begin(), tQueries->pendings.begin() + count);
+}
+
+void GPUProfiler::clearThread()
+{
+    if (!tQueries) return;
+    auto& ggl = Global::functions();
+
+    for (auto& pending : tQueries->pendings)
+    {
+        ggl.glDeleteQueries(1, &pending.begin);
+        if (pending.end) ggl.glDeleteQueries(1, &pending.end);
+    }
+    if (!tQueries->freeQueries.isEmpty())
+    {
+        ggl.glDeleteQueries(tQueries->freeQueries.size(), tQueries->freeQueries.constData());
+    }
+    delete tQueries;
+    tQueries = nullptr;
+}
+
+//-------------------------------------------------------------------------------------------------
+GPUProfileZone::GPUProfileZone(const char* aName)
+    : mIndex(util::Profiler::isEnabled() ? GPUProfiler::begin(aName, QString()) : -1)
+{
+}
+
+GPUProfileZone::GPUProfileZone(const char* aName, const QString& aDetail)
+    : mIndex(util::Profiler::isEnabled() ? GPUProfiler::begin(aName, aDetail) : -1)
+{
+}
+
+GPUProfileZone::~GPUProfileZone()
+{
+    if (mIndex >= 0)
+    {
+        GPUProfiler::end(mIndex);
+    }
+}
+
+} // namespace gl
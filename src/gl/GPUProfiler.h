@@ -0,0 +1,42 @@
+#ifndef GL_GPUPROFILER_H
+#define GL_GPUPROFILER_H
+
+#include <QString>
+#include "gl/Global.h"
+
+namespace gl
+{
+
+// Timestamp queries of the gpu zones, recorded in util::Profiler.
+// Query objects are not shared between contexts, so each thread has its own
+// queries. The results are collected by resolve() on the same thread some
+// frames later, and the thread has to clear them before its context is lost.
+class GPUProfiler
+{
+public:
+    static void resolve();
+    static void clearThread();
+
+private:
+    friend class GPUProfileZone;
+    GPUProfiler() {}
+    static int begin(const char* aName, const QString& aDetail);
+    static void end(int aIndex);
+};
+
+//-------------------------------------------------------------------------------------------------
+class GPUProfileZone
+{
+public:
+    explicit GPUProfileZone(const char* aName);
+    // aDetail is copied only while the profiler is enabled
+    GPUProfileZone(const char* aName, const QString& aDetail);
+    ~GPUProfileZone();
+
+private:
+    int mIndex;
+};
+
+} // namespace gl
+
+#endif // GL_GPUPROFILER_H
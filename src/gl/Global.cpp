@@ -4,6 +4,7 @@
 namespace
 {
 gl::Global::Functions* gGLGlobalFunctions = nullptr;
+thread_local gl::Global::Functions* tGLThreadFunctions = nullptr;
 //QOpenGLContext* gGLGlobalContext = nullptr;
 //QSurface* gGlobalSurface = nullptr;
 QOpenGLWidget* gGLGlobalWidget = nullptr;
@@ -25,10 +26,19 @@ void Global::clearFunctions()
 
 Global::Functions& Global::functions()
 {
+    if (tGLThreadFunctions)
+    {
+        return *tGLThreadFunctions;
+    }
     XC_PTR_ASSERT(gGLGlobalFunctions);
     return *gGLGlobalFunctions;
 }
 
+void Global::setThreadFunctions(Functions* aFunctions)
+{
+    tGLThreadFunctions = aFunctions;
+}
+
 #if 0
 void Global::setContext(QOpenGLContext& aContext, QSurface& aSurface)
 {
@@ -67,12 +77,15 @@ void Global::clearContext()
 
 void Global::makeCurrent()
 {
+    // a thread which has its own context keeps it current
+    if (tGLThreadFunctions) return;
     XC_PTR_ASSERT(gGLGlobalWidget);
     gGLGlobalWidget->makeCurrent();
 }
 
 void Global::doneCurrent()
 {
+    if (tGLThreadFunctions) return;
     XC_PTR_ASSERT(gGLGlobalWidget);
     gGLGlobalWidget->doneCurrent();
 }
@@ -19,6 +19,9 @@ public:
     static void clearFunctions();
     static Functions& functions();
 
+    // functions of a context on another thread, override the global ones on the thread
+    static void setThreadFunctions(Functions* aFunctions);
+
     //static void setContext(QOpenGLContext& aContext, QSurface& aSurface);
     static void setContext(QOpenGLWidget& aWidget);
     static void clearContext();
@@ -0,0 +1,63 @@
+#include <QSurfaceFormat>
+#include "gl/ProgramRegistry.h"
+#include "gl/OffscreenContext.h"
+
+namespace gl
+{
+
+OffscreenContext::OffscreenContext()
+    : mIsValid(false)
+    , mSurface()
+    , mContext()
+    , mDeviceInfo()
+    , mDefaultVAO()
+{
+    QSurfaceFormat format;
+#if defined(USE_GL_CORE_PROFILE)
+    format.setVersion(Global::kVersion.first, Global::kVersion.second);
+    format.setProfile(QSurfaceFormat::CoreProfile);
+#endif
+    mSurface.setFormat(format);
+    mSurface.create();
+    mContext.setFormat(format);
+
+    if (!mSurface.isValid() || !mContext.create() ||
+            mContext.format().version() < Global::kVersion ||
+            !mContext.makeCurrent(&mSurface))
+    {
+        return;
+    }
+
+    auto functions = mContext.versionFunctions<Global::Functions>();
+    if (!functions || !functions->initializeOpenGLFunctions())
+    {
+        mContext.doneCurrent();
+        return;
+    }
+
+    // the context keeps current, so makeCurrent of Global does nothing
+    Global::setThreadFunctions(functions);
+
+    mDeviceInfo.load();
+    DeviceInfo::setInstance(&mDeviceInfo);
+
+#ifdef USE_GL_CORE_PROFILE
+    mDefaultVAO.reset(new VertexArrayObject());
+    mDefaultVAO->bind(); // keep binding
+#endif
+    mIsValid = true;
+}
+
+OffscreenContext::~OffscreenContext()
+{
+    if (!mIsValid) return;
+
+    mDefaultVAO.reset();
+    ProgramRegistry::clear();
+    DeviceInfo::setInstance(nullptr);
+    Global::setThreadFunctions(nullptr);
+    mContext.doneCurrent();
+    mSurface.destroy();
+}
+
+} // namespace gl
@@ -0,0 +1,38 @@
+#ifndef GL_OFFSCREENCONTEXT_H
+#define GL_OFFSCREENCONTEXT_H
+
+#include <QScopedPointer>
+#include <QOpenGLContext>
+#include <QOffscreenSurface>
+#include "gl/Global.h"
+#include "gl/DeviceInfo.h"
+#include "gl/VertexArrayObject.h"
+
+namespace gl
+{
+
+// An opengl context without a window, which is kept current on the main
+// thread as the context of the display widget in the application.
+// The processes without the main window use it, as the benchmark and
+// the workers of the sharded export.
+class OffscreenContext
+{
+public:
+    OffscreenContext();
+    ~OffscreenContext();
+
+    // false if the context of the required version is not available
+    bool isValid() const { return mIsValid; }
+    const DeviceInfo& deviceInfo() const { return mDeviceInfo; }
+
+private:
+    bool mIsValid;
+    QOffscreenSurface mSurface;
+    QOpenGLContext mContext;
+    DeviceInfo mDeviceInfo;
+    QScopedPointer<VertexArrayObject> mDefaultVAO;
+};
+
+} // namespace gl
+
+#endif // GL_OFFSCREENCONTEXT_H
@@ -0,0 +1,262 @@
+#include <QMap>
+#include <QDir>
+#include <QFile>
+#include <QSaveFile>
+#include <QDataStream>
+#include <QCryptographicHash>
+#include <QOpenGLContext>
+#include "XC.h"
+#include "gl/Global.h"
+#include "gl/DeviceInfo.h"
+#include "gl/ProgramRegistry.h"
+
+#ifndef GL_PROGRAM_BINARY_RETRIEVABLE_HINT
+#define GL_PROGRAM_BINARY_RETRIEVABLE_HINT 0x8257
+#endif
+#ifndef GL_PROGRAM_BINARY_LENGTH
+#define GL_PROGRAM_BINARY_LENGTH 0x8741
+#endif
+#ifndef GL_NUM_PROGRAM_BINARY_FORMATS
+#define GL_NUM_PROGRAM_BINARY_FORMATS 0x87FE
+#endif
+
+namespace
+{
+
+// ARB_get_program_binary is core since 4.1, so resolve it at runtime.
+typedef void (QOPENGLF_APIENTRYP GetProgramBinaryProc)(
+        GLuint, GLsizei, GLsizei*, GLenum*, void*);
+typedef void (QOPENGLF_APIENTRYP ProgramBinaryProc)(
+        GLuint, GLenum, const void*, GLsizei);
+typedef void (QOPENGLF_APIENTRYP ProgramParameteriProc)(
+        GLuint, GLenum, GLint);
+
+static const quint32 kBinaryFileMagic = 0x41455042;
+static const quint32 kBinaryFileVersion = 1;
+
+struct BinaryFunctions
+{
+    BinaryFunctions()
+        : resolved()
+        , getProgramBinary()
+        , programBinary()
+        , programParameteri()
+    {
+    }
+
+    bool isValid() const
+    {
+        return getProgramBinary && programBinary && programParameteri;
+    }
+
+    bool resolved;
+    GetProgramBinaryProc getProgramBinary;
+    ProgramBinaryProc programBinary;
+    ProgramParameteriProc programParameteri;
+};
+
+QMap<QString, gl::EasyShaderProgram*> gProgramRegistryMap;
+QString gProgramRegistryCacheDir;
+BinaryFunctions gProgramBinaryFunctions;
+
+void resolveBinaryFunctions()
+{
+    BinaryFunctions& funcs = gProgramBinaryFunctions;
+    if (funcs.resolved) return;
+
+    QOpenGLContext* context = QOpenGLContext::currentContext();
+    if (!context) return;
+    funcs.resolved = true;
+
+    const QPair<int, int> version = context->format().version();
+    const bool supported = version >= qMakePair(4, 1) ||
+            context->hasExtension(QByteArrayLiteral("GL_ARB_get_program_binary"));
+    if (!supported) return;
+
+    // some drivers expose the functions without any binary format
+    GLint formatCount = 0;
+    gl::Global::functions().glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formatCount);
+    if (formatCount <= 0) return;
+
+    funcs.getProgramBinary = reinterpret_cast<GetProgramBinaryProc>(
+                context->getProcAddress("glGetProgramBinary"));
+    funcs.programBinary = reinterpret_cast<ProgramBinaryProc>(
+                context->getProcAddress("glProgramBinary"));
+    funcs.programParameteri = reinterpret_cast<ProgramParameteriProc>(
+                context->getProcAddress("glProgramParameteri"));
+}
+
+QString makeBinaryFilePath(const QString& aId, const gl::ExtendShader& aSource)
+{
+    const gl::DeviceInfo& device = gl::DeviceInfo::instance();
+
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    hash.addData(aId.toUtf8());
+    hash.addData(QByteArray(1, '\0'));
+    hash.addData(aSource.vertexCode().toUtf8());
+    hash.addData(QByteArray(1, '\0'));
+    hash.addData(aSource.fragmentCode().toUtf8());
+    hash.addData(QByteArray(1, '\0'));
+    hash.addData(device.vender.c_str());
+    hash.addData(device.renderer.c_str());
+    hash.addData(device.version.c_str());
+
+    return gProgramRegistryCacheDir + "/" + QString(hash.result().toHex()) + ".bin";
+}
+
+bool loadBinary(gl::EasyShaderProgram& aProgram, const QString& aPath)
+{
+    QFile file(aPath);
+    if (!file.open(QIODevice::ReadOnly)) return false;
+
+    quint32 magic = 0;
+    quint32 version = 0;
+    quint32 format = 0;
+    QByteArray binary;
+
+    QDataStream in(&file);
+    in >> magic >> version >> format >> binary;
+
+    if (in.status() != QDataStream::Ok || magic != kBinaryFileMagic ||
+            version != kBinaryFileVersion || binary.isEmpty())
+    {
+        return false;
+    }
+
+    if (!aProgram.create()) return false;
+
+    gProgramBinaryFunctions.programBinary(
+                aProgram.id(), (GLenum)format, binary.constData(), binary.size());
+
+    // a binary of another driver is rejected with an error flag
+    gl::Global::functions().glGetError();
+
+    // link() only checks the link status if the program has no shader
+    return aProgram.link();
+}
+
+void saveBinary(const gl::EasyShaderProgram& aProgram, const QString& aPath)
+{
+    GLint length = 0;
+    gl::Global::functions().glGetProgramiv(aProgram.id(), GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0) return;
+
+    QByteArray binary(length, '\0');
+    GLsizei written = 0;
+    GLenum format = 0;
+    gProgramBinaryFunctions.getProgramBinary(
+                aProgram.id(), length, &written, &format, binary.data());
+    if (written <= 0) return;
+    binary.resize(written);
+
+    if (!QDir().mkpath(gProgramRegistryCacheDir)) return;
+
+    QSaveFile file(aPath);
+    if (!file.open(QIODevice::WriteOnly)) return;
+
+    QDataStream out(&file);
+    out << kBinaryFileMagic << kBinaryFileVersion << (quint32)format << binary;
+    file.commit();
+}
+
+void buildProgram(
+        gl::EasyShaderProgram& aProgram, const gl::ExtendShader& aSource,
+        const gl::ProgramRegistry::PreLinkFunc& aPreLink, bool aRetrievable)
+{
+    const bool compiled = aSource.fragmentCode().isEmpty() ?
+                aProgram.setVertexSource(aSource) : aProgram.setAllSource(aSource);
+    if (!compiled)
+    {
+        XC_FATAL_ERROR("OpenGL Error", "Failed to compile shader.",
+                       aProgram.log());
+    }
+
+    if (aPreLink)
+    {
+        aPreLink(aProgram);
+    }
+
+    if (aRetrievable)
+    {
+        gProgramBinaryFunctions.programParameteri(
+                    aProgram.id(), GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    }
+
+    if (!aProgram.link())
+    {
+        XC_FATAL_ERROR("OpenGL Error", "Failed to link shader.",
+                       aProgram.log());
+    }
+}
+
+} // namespace
+
+namespace gl
+{
+
+void ProgramRegistry::setCacheDir(const QString& aDir)
+{
+    gProgramRegistryCacheDir = aDir;
+}
+
+void ProgramRegistry::clear()
+{
+    qDeleteAll(gProgramRegistryMap);
+    gProgramRegistryMap.clear();
+
+    // the next context can be another driver
+    gProgramBinaryFunctions = BinaryFunctions();
+}
+
+EasyShaderProgram& ProgramRegistry::acquire(
+        const QString& aId, const SourceFunc& aSource, const PreLinkFunc& aPreLink)
+{
+    auto itr = gProgramRegistryMap.find(aId);
+    if (itr != gProgramRegistryMap.end())
+    {
+        return *(itr.value());
+    }
+
+    ExtendShader source;
+    aSource(source);
+
+    resolveBinaryFunctions();
+    const bool useCache =
+            !gProgramRegistryCacheDir.isEmpty() &&
+            gProgramBinaryFunctions.isValid() &&
+            DeviceInfo::validInstanceExists();
+    const QString cachePath = useCache ? makeBinaryFilePath(aId, source) : QString();
+
+    EasyShaderProgram* program = nullptr;
+
+    if (useCache)
+    {
+        program = new EasyShaderProgram();
+        if (!loadBinary(*program, cachePath))
+        {
+            delete program;
+            program = nullptr;
+        }
+    }
+
+    if (!program)
+    {
+        program = new EasyShaderProgram();
+        buildProgram(*program, source, aPreLink, useCache);
+
+        if (useCache)
+        {
+            saveBinary(*program, cachePath);
+        }
+    }
+
+    gProgramRegistryMap.insert(aId, program);
+    return *program;
+}
+
+int ProgramRegistry::programCount()
+{
+    return gProgramRegistryMap.size();
+}
+
+} // namespace gl
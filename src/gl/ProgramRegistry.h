@@ -0,0 +1,44 @@
+#ifndef GL_PROGRAMREGISTRY_H
+#define GL_PROGRAMREGISTRY_H
+
+#include <functional>
+#include <QString>
+#include "gl/ExtendShader.h"
+#include "gl/EasyShaderProgram.h"
+
+namespace gl
+{
+
+// Process wide holder of linked shader programs.
+// A program is built once per id and shared by every requester until clear().
+// If a cache directory is given, linked program binaries are written there
+// and reused by later launches as long as the source and the driver match.
+// Use this class on the gl thread only.
+class ProgramRegistry
+{
+public:
+    // write the resolved source of the program into aDest.
+    typedef std::function<void(ExtendShader& aDest)> SourceFunc;
+    // called after compiling and before linking, e.g. to bind output names.
+    typedef std::function<void(EasyShaderProgram& aProgram)> PreLinkFunc;
+
+    static void setCacheDir(const QString& aDir);
+    static void clear();
+
+    // aId must identify the program uniquely in this process, including the
+    // variation values and what aPreLink does. The functions are called only
+    // when the program is not registered yet.
+    // A source which has an empty fragment code builds a vertex only program.
+    static EasyShaderProgram& acquire(
+            const QString& aId, const SourceFunc& aSource,
+            const PreLinkFunc& aPreLink = PreLinkFunc());
+
+    static int programCount();
+
+private:
+    ProgramRegistry() {}
+};
+
+} // namespace gl
+
+#endif // GL_PROGRAMREGISTRY_H
@@ -40,7 +40,10 @@ SOURCES += \
     PrimitiveDrawer.cpp \
     Triangulator.cpp \
     FontDrawer.cpp \
-    TextObject.cpp
+    TextObject.cpp \
+    ProgramRegistry.cpp \
+    GPUProfiler.cpp \
+    OffscreenContext.cpp
 
 HEADERS += \
     EasyShaderProgram.h \
@@ -64,4 +67,7 @@ HEADERS += \
     PrimitiveDrawer.h \
     Triangulator.h \
     FontDrawer.h \
-    TextObject.h
+    TextObject.h \
+    ProgramRegistry.h \
+    GPUProfiler.h \
+    OffscreenContext.h
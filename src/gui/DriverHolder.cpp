@@ -11,6 +11,8 @@ DriverHolder::DriverHolder(ViaPoint& aViaPoint)
     , mTimeLineSlot()
     , mResourceSlot()
     , mTreeSlot()
+    , mIsLazyFrameUpdate(false)
+    , mHasPendingFrame(false)
 {
 }
 
@@ -44,8 +46,26 @@ void DriverHolder::destroy()
     }
 }
 
+void DriverHolder::setLazyFrameUpdate(bool aIsLazy)
+{
+    mIsLazyFrameUpdate = aIsLazy;
+    if (!mIsLazyFrameUpdate && mHasPendingFrame)
+    {
+        onFrameUpdated();
+    }
+}
+
 void DriverHolder::onFrameUpdated()
 {
+    if (mIsLazyFrameUpdate)
+    {
+        // the display renders uncached frames by itself
+        mHasPendingFrame = true;
+        onVisualUpdated();
+        return;
+    }
+
+    mHasPendingFrame = false;
     if (mDriver)
     {
         mDriver->updateFrame();
@@ -23,6 +23,9 @@ public:
     void create(core::Project& aProject, ctrl::GraphicStyle& aGraphicStyle);
     void destroy();
 
+    // defer the blending of frames while a playback draws cached frames
+    void setLazyFrameUpdate(bool aIsLazy);
+
     ctrl::Driver* driver() { return mDriver.data(); }
     const ctrl::Driver* driver() const { return mDriver.data(); }
 
@@ -46,6 +49,8 @@ private:
     util::SlotId mTimeLineSlot;
     util::SlotId mResourceSlot;
     util::SlotId mTreeSlot;
+    bool mIsLazyFrameUpdate;
+    bool mHasPendingFrame;
 };
 
 } // namespace gui
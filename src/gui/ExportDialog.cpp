@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <QHBoxLayout>
 #include <QVBoxLayout>
 #include <QFormLayout>
@@ -13,6 +14,7 @@
 #include <QFileInfo>
 #include <QPlainTextEdit>
 #include <QFontMetrics>
+#include <QThread>
 #include "MainMenuBar.h"
 #include "util/SelectArgs.h"
 #include "gui/ExportDialog.h"
@@ -42,6 +44,9 @@ ExportDialog::ExportDialog(core::Project& aProject, const QString& aPath, QWidge
     , mFrameMax()
     , mFixAspect(true)
     , mSizeUpdating(false)
+    , mShardCount(1)
+    , mAddsImageSequence(false)
+    , mAddsGif(false)
 {
     mCommonParam.path = aPath;
 
@@ -128,6 +133,28 @@ void ExportDialog::pushSizeBox(QFormLayout& aLayout)
         aLayout.addRow(tr("Image height :"), y);
         aLayout.addRow(tr("Fix aspect ratio :"), fix);
     }
+
+    // scaling
+    {
+        static const int kSupersamplings[] = { 1, 1, 2, 4 };
+        auto scaling = new QComboBox();
+        scaling->addItem(tr("Scale the project image"));
+        scaling->addItem(tr("Render at export size"));
+        scaling->addItem(tr("Render at export size (2x supersampling)"));
+        scaling->addItem(tr("Render at export size (4x supersampling)"));
+        scaling->setCurrentIndex(mCommonParam.renderAtExportSize ? 1 : 0);
+        scaling->setToolTip(tr("Rendering at export size is faster when the export size is "
+                               "smaller than the project. It needs a fixed aspect ratio."));
+        setMinMaxOptionWidth(scaling);
+
+        this->connect(scaling, util::SelectArgs<int>::from(&QComboBox::currentIndexChanged), [=](int aIndex)
+        {
+            this->mCommonParam.renderAtExportSize = (aIndex > 0);
+            this->mCommonParam.supersampling = kSupersamplings[aIndex];
+        });
+
+        aLayout.addRow(tr("Scaling :"), scaling);
+    }
 }
 
 void ExportDialog::pushFrameBox(QFormLayout& aLayout)
@@ -185,6 +212,56 @@ void ExportDialog::pushFpsBox(QFormLayout& aLayout)
     aLayout.addRow(tr("FPS :"), fps);
 }
 
+void ExportDialog::pushProcessBox(QFormLayout& aLayout)
+{
+    auto processes = new QSpinBox();
+    processes->setRange(1, std::max(1, QThread::idealThreadCount()));
+    processes->setValue(mShardCount);
+    processes->setToolTip(tr("The frames are rendered in parallel by the processes, "
+                             "each of which loads a copy of the project."));
+    setMinMaxOptionWidth(processes);
+
+    this->connect(processes, &QSpinBox::editingFinished, [=]()
+    {
+        this->mShardCount = processes->value();
+    });
+
+    aLayout.addRow(tr("Processes :"), processes);
+}
+
+void ExportDialog::pushOutputBox(QFormLayout& aLayout, bool aImageSequence, bool aGif)
+{
+    const QString tip = tr("Each frame is rendered once for all of the outputs, "
+                           "in this process.");
+    if (aImageSequence)
+    {
+        auto images = new QCheckBox();
+        images->setChecked(mAddsImageSequence);
+        images->setToolTip(tip);
+
+        this->connect(images, &QCheckBox::clicked, [=](bool aCheck)
+        {
+            this->mAddsImageSequence = aCheck;
+        });
+
+        aLayout.addRow(tr("Also export png sequence :"), images);
+    }
+
+    if (aGif)
+    {
+        auto gif = new QCheckBox();
+        gif->setChecked(mAddsGif);
+        gif->setToolTip(tip);
+
+        this->connect(gif, &QCheckBox::clicked, [=](bool aCheck)
+        {
+            this->mAddsGif = aCheck;
+        });
+
+        aLayout.addRow(tr("Also export gif :"), gif);
+    }
+}
+
 //-------------------------------------------------------------------------------------------------
 ImageExportDialog::ImageExportDialog(
         core::Project& aProject, const QString& aDirPath,
@@ -250,6 +327,7 @@ QLayout* ImageExportDialog::createImageOption()
     this->pushSizeBox(*form);
     this->pushFrameBox(*form);
     this->pushFpsBox(*form);
+    this->pushProcessBox(*form);
 
     return form;
 }
@@ -263,8 +341,8 @@ GifExportDialog::GifExportDialog(
     {
         int fpsCheck = this->commonParam().fps != 0 && this->commonParam().fps <= 500 ? this->commonParam().fps : 30;
         this->commonParam().fps = fpsCheck;
-        mGifParam.optimizePalette = true;
-        mGifParam.intermediateBps = 5 * 1000 * 1000;
+        mGifParam.perFramePalette = false;
+        mGifParam.dithering = true;
     }
 
     // option
@@ -286,34 +364,33 @@ QLayout* GifExportDialog::createGifOption()
     this->pushSizeBox(*form);
     this->pushFrameBox(*form);
     this->pushFpsBox(*form);
+    this->pushProcessBox(*form);
+    this->pushOutputBox(*form, true, false);
 
-    // bit rate
-    auto kbps = new QSpinBox();
+    // palette for each frame
     {
-        setMinMaxOptionWidth(kbps);
-        kbps->setRange(0, 100 * 1000);
-        kbps->setValue(mGifParam.intermediateBps / 1000);
+        auto perFrame = new QCheckBox();
+        perFrame->setChecked(mGifParam.perFramePalette);
 
-        this->connect(kbps, &QSpinBox::editingFinished, [=]()
+        this->connect(perFrame, &QCheckBox::clicked, [=](bool aCheck)
         {
-            this->mGifParam.intermediateBps = kbps->value();
+            this->mGifParam.perFramePalette = aCheck;
         });
+
+        form->addRow(tr("Palette per frame :"), perFrame);
     }
 
-    // optimize palette
+    // dithering
     {
-        auto opti = new QCheckBox();
-        opti->setChecked(mGifParam.optimizePalette);
-        kbps->setEnabled(mGifParam.optimizePalette);
+        auto dither = new QCheckBox();
+        dither->setChecked(mGifParam.dithering);
 
-        this->connect(opti, &QCheckBox::clicked, [=](bool aCheck)
+        this->connect(dither, &QCheckBox::clicked, [=](bool aCheck)
         {
-            this->mGifParam.optimizePalette = aCheck;
-            kbps->setEnabled(aCheck);
+            this->mGifParam.dithering = aCheck;
         });
 
-        form->addRow(tr("Optimize palette :"), opti);
-        form->addRow(tr("Relay bit rate (Kbps) :"), kbps);
+        form->addRow(tr("Dithering :"), dither);
     }
 
     return form;
@@ -486,6 +563,8 @@ QLayout* VideoExportDialog::createVideoOption()
     this->pushSizeBox(*form);
     this->pushFrameBox(*form);
     this->pushFpsBox(*form);
+    this->pushProcessBox(*form);
+    this->pushOutputBox(*form, true, true);
 
     // bit rate
     {
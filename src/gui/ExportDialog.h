@@ -22,11 +22,18 @@ public:
     ExportDialog(core::Project& aProject, const QString& aPath, QWidget* aParent);
     const ctrl::Exporter::CommonParam& commonParam() const { return mCommonParam; }
     ctrl::Exporter::CommonParam& commonParam() { return mCommonParam; }
+    // count of the processes which render the frames
+    int shardCount() const { return mShardCount; }
+    // the outputs which are written beside the file from the same frames
+    bool addsImageSequence() const { return mAddsImageSequence; }
+    bool addsGif() const { return mAddsGif; }
 
 protected:
     void pushSizeBox(QFormLayout& aLayout);
     void pushFrameBox(QFormLayout& aLayout);
     void pushFpsBox(QFormLayout& aLayout);
+    void pushProcessBox(QFormLayout& aLayout);
+    void pushOutputBox(QFormLayout& aLayout, bool aImageSequence, bool aGif);
 
 private:
     core::Project& mProject;
@@ -35,6 +42,9 @@ private:
     int mFrameMax;
     bool mFixAspect;
     bool mSizeUpdating;
+    int mShardCount;
+    bool mAddsImageSequence;
+    bool mAddsGif;
     bool mWarningShown = false;
 };
 
@@ -0,0 +1,205 @@
+#include <cstring>
+#include <algorithm>
+#include "gui/FrameCache.h"
+
+namespace
+{
+static const uint32 kRunFlag = 0x80000000u;
+static const int kMinRun = 3;
+
+// a header word is followed by one pixel of a run or the pixels of a literal.
+// returns false if the encoded data is not smaller than the source.
+bool encodeRuns(const uint32* aSrc, int aCount, QByteArray& aDest)
+{
+    const int limit = aCount - 1;
+    QVector<uint32> words;
+    words.reserve(aCount / 4);
+
+    int i = 0;
+    while (i < aCount)
+    {
+        int run = 1;
+        while (i + run < aCount && aSrc[i + run] == aSrc[i]) ++run;
+
+        if (run >= kMinRun)
+        {
+            words.push_back(kRunFlag | (uint32)run);
+            words.push_back(aSrc[i]);
+            i += run;
+        }
+        else
+        {
+            int end = i + run;
+            while (end < aCount)
+            {
+                if (end + kMinRun <= aCount &&
+                        aSrc[end] == aSrc[end + 1] && aSrc[end] == aSrc[end + 2])
+                {
+                    break;
+                }
+                ++end;
+            }
+            words.push_back((uint32)(end - i));
+            for (int k = i; k < end; ++k) words.push_back(aSrc[k]);
+            i = end;
+        }
+
+        if (words.size() >= limit) return false;
+    }
+
+    aDest = QByteArray((const char*)words.constData(), words.size() * (int)sizeof(uint32));
+    return true;
+}
+
+void decodeRuns(const QByteArray& aSrc, uint32* aDest, int aCount)
+{
+    const uint32* src = (const uint32*)aSrc.constData();
+    const uint32* srcEnd = src + aSrc.size() / sizeof(uint32);
+    uint32* dest = aDest;
+    uint32* destEnd = aDest + aCount;
+
+    while (src < srcEnd && dest < destEnd)
+    {
+        const uint32 header = *src++;
+        const int count = std::min((int)(header & ~kRunFlag), (int)(destEnd - dest));
+        if (header & kRunFlag)
+        {
+            std::fill(dest, dest + count, *src++);
+        }
+        else
+        {
+            std::memcpy(dest, src, count * sizeof(uint32));
+            src += count;
+        }
+        dest += count;
+    }
+    XC_ASSERT(dest == destEnd);
+}
+}
+
+namespace gui
+{
+
+//-------------------------------------------------------------------------------------------------
+FrameCache::FrameCache()
+    : mByteBudget(0)
+    , mByteSize(0)
+    , mFrameSize()
+    , mPass(0)
+    , mEntries()
+    , mOrder()
+{
+}
+
+void FrameCache::setByteBudget(size_t aBytes)
+{
+    mByteBudget = aBytes;
+    while (mByteSize > mByteBudget && !mOrder.empty())
+    {
+        remove(mOrder.back());
+    }
+}
+
+void FrameCache::setFrameSize(const QSize& aSize)
+{
+    if (mFrameSize == aSize) return;
+    clear();
+    mFrameSize = aSize;
+}
+
+size_t FrameCache::frameBytes() const
+{
+    return (size_t)mFrameSize.width() * mFrameSize.height() * sizeof(uint32);
+}
+
+void FrameCache::beginPass()
+{
+    ++mPass;
+}
+
+bool FrameCache::insert(int aFrame, const uint8* aPixels)
+{
+    XC_PTR_ASSERT(aPixels);
+    const int pixelCount = mFrameSize.width() * mFrameSize.height();
+    if (pixelCount <= 0) return false;
+
+    if (mEntries.contains(aFrame))
+    {
+        remove(aFrame);
+    }
+
+    Entry entry;
+    if (!encodeRuns((const uint32*)aPixels, pixelCount, entry.data))
+    {
+        entry.data = QByteArray((const char*)aPixels, (int)frameBytes());
+        entry.isRaw = true;
+    }
+    const size_t size = (size_t)entry.data.size();
+
+    while (mByteSize + size > mByteBudget)
+    {
+        if (mOrder.empty()) return false;
+        const int victim = mOrder.back();
+        if (mEntries[victim].pass == mPass) return false;
+        remove(victim);
+    }
+
+    mOrder.push_front(aFrame);
+    entry.pass = mPass;
+    entry.order = mOrder.begin();
+    mEntries.insert(aFrame, entry);
+    mByteSize += size;
+    return true;
+}
+
+bool FrameCache::load(int aFrame, QByteArray& aPixels)
+{
+    auto itr = mEntries.find(aFrame);
+    if (itr == mEntries.end()) return false;
+
+    Entry& entry = itr.value();
+    mOrder.splice(mOrder.begin(), mOrder, entry.order);
+
+    aPixels.resize((int)frameBytes());
+    if (entry.isRaw)
+    {
+        std::memcpy(aPixels.data(), entry.data.constData(), frameBytes());
+    }
+    else
+    {
+        decodeRuns(entry.data, (uint32*)aPixels.data(),
+                   mFrameSize.width() * mFrameSize.height());
+    }
+    return true;
+}
+
+void FrameCache::invalidate(const util::Range& aFrames)
+{
+    QVector<int> frames;
+    for (auto itr = mEntries.cbegin(); itr != mEntries.cend(); ++itr)
+    {
+        if (aFrames.contains(itr.key())) frames.push_back(itr.key());
+    }
+    for (auto frame : frames)
+    {
+        remove(frame);
+    }
+}
+
+void FrameCache::clear()
+{
+    mEntries.clear();
+    mOrder.clear();
+    mByteSize = 0;
+}
+
+void FrameCache::remove(int aFrame)
+{
+    auto itr = mEntries.find(aFrame);
+    XC_ASSERT(itr != mEntries.end());
+    mByteSize -= (size_t)itr.value().data.size();
+    mOrder.erase(itr.value().order);
+    mEntries.erase(itr);
+}
+
+} // namespace gui
@@ -0,0 +1,70 @@
+#ifndef GUI_FRAMECACHE_H
+#define GUI_FRAMECACHE_H
+
+#include <list>
+#include <QHash>
+#include <QVector>
+#include <QSize>
+#include <QByteArray>
+#include "XC.h"
+#include "util/Range.h"
+
+namespace gui
+{
+
+// Rendered frames of the ram preview.
+// The rgba pixels are stored as runs of equal pixels, which decode at about
+// the speed of a copy. The least recently used frames are evicted to keep
+// the byte budget, but never the frames inserted in the current pass.
+class FrameCache
+{
+public:
+    FrameCache();
+
+    void setByteBudget(size_t aBytes);
+    size_t byteBudget() const { return mByteBudget; }
+    size_t byteSize() const { return mByteSize; }
+    int count() const { return mEntries.size(); }
+
+    // another size clears the cache
+    void setFrameSize(const QSize& aSize);
+    QSize frameSize() const { return mFrameSize; }
+    size_t frameBytes() const;
+
+    // the frames inserted after this can be evicted by the next pass only
+    void beginPass();
+
+    bool contains(int aFrame) const { return mEntries.contains(aFrame); }
+
+    // returns false if the budget is filled with the frames of this pass
+    bool insert(int aFrame, const uint8* aPixels);
+
+    // aPixels is resized to frameBytes()
+    bool load(int aFrame, QByteArray& aPixels);
+
+    void invalidate(const util::Range& aFrames);
+    void clear();
+
+private:
+    struct Entry
+    {
+        Entry() : data(), isRaw(), pass(), order() {}
+        QByteArray data;
+        bool isRaw;
+        int pass;
+        std::list<int>::iterator order;
+    };
+
+    void remove(int aFrame);
+
+    size_t mByteBudget;
+    size_t mByteSize;
+    QSize mFrameSize;
+    int mPass;
+    QHash<int, Entry> mEntries;
+    std::list<int> mOrder; // most recently used first
+};
+
+} // namespace gui
+
+#endif // GUI_FRAMECACHE_H
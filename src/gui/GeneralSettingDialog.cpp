@@ -9,6 +9,7 @@
 #include "MainWindow.h"
 #include "gui/GeneralSettingDialog.h"
 #include "util/NetworkUtil.h"
+#include "util/SelectArgs.h"
 
 namespace
 {
@@ -204,6 +205,36 @@ GeneralSettingDialog::GeneralSettingDialog(GUIResources &aGUIResources, QWidget*
 
         auto isAutoShowMesh = settings.value("generalsettings/tools/autoshowmesh");
         bAutoShowMesh = isAutoShowMesh.isValid()? isAutoShowMesh.toBool() : false;
+
+        auto isAdaptiveMesh = settings.value("generalsettings/mesh/adaptive");
+        bAdaptiveMesh = isAdaptiveMesh.isValid()? isAdaptiveMesh.toBool() : false;
+
+        auto isMeshVertexBudget = settings.value("generalsettings/mesh/vertexBudget");
+        mMeshVertexBudget = isMeshVertexBudget.isValid()? isMeshVertexBudget.toInt() : 0;
+
+        auto isAsyncFFD = settings.value("generalsettings/ffd/asyncReadback");
+        bAsyncFFD = isAsyncFFD.isValid()? isAsyncFFD.toBool() : false;
+
+        auto isFFDSampleBudget = settings.value("generalsettings/ffd/sampleBudget");
+        mFFDSampleBudget = isFFDSampleBudget.isValid()? isFFDSampleBudget.toInt() : 8;
+
+        auto isUndoBudget = settings.value("generalsettings/undo/budgetMB");
+        mUndoBudget = isUndoBudget.isValid()? isUndoBudget.toInt() : 512;
+
+        auto isUndoSpill = settings.value("generalsettings/undo/spillToDisk");
+        bUndoSpill = isUndoSpill.isValid()? isUndoSpill.toBool() : false;
+
+        auto isPreviewEnabled = settings.value("generalsettings/preview/enabled");
+        bPreviewEnabled = isPreviewEnabled.isValid()? isPreviewEnabled.toBool() : false;
+
+        auto isPreviewBudget = settings.value("generalsettings/preview/budgetMB");
+        mPreviewBudget = isPreviewBudget.isValid()? isPreviewBudget.toInt() : 1024;
+
+        auto isRenderAhead = settings.value("generalsettings/preview/renderAheadFrames");
+        mRenderAheadFrames = isRenderAhead.isValid()? isRenderAhead.toInt() : 0;
+
+        auto isCoalesceEvents = settings.value("generalsettings/timeline/coalesceEvents");
+        bCoalesceEvents = isCoalesceEvents.isValid()? isCoalesceEvents.toBool() : true;
     }
 
     auto form = new QFormLayout();
@@ -270,6 +301,87 @@ GeneralSettingDialog::GeneralSettingDialog(GUIResources &aGUIResources, QWidget*
            });
         projectSaving->addRow(tr("Automatically show mesh when selecting FFD : "), mAutoShowMesh);
 
+        mAsyncFFD = new QCheckBox();
+        mAsyncFFD->setChecked(bAsyncFFD);
+        mAsyncFFD->setToolTip(tr("Apply FFD brush results a few frames later instead of waiting for the GPU"));
+        connect(mAsyncFFD, &QPushButton::clicked, [=]() {
+                QSettings settings;
+                settings.setValue("generalsettings/ffd/asyncReadback", mAsyncFFD->isChecked());
+           });
+        projectSaving->addRow(tr("Asynchronous FFD brush : "), mAsyncFFD);
+
+        mFFDSampleBudgetBox = new QSpinBox();
+        mFFDSampleBudgetBox->setRange(1, 64);
+        mFFDSampleBudgetBox->setValue(mFFDSampleBudget);
+        mFFDSampleBudgetBox->setToolTip(tr("Maximum count of tablet samples merged into one FFD brush step"));
+        connect(mFFDSampleBudgetBox, util::SelectArgs<int>::from(&QSpinBox::valueChanged), [=](int aValue) {
+                QSettings settings;
+                settings.setValue("generalsettings/ffd/sampleBudget", aValue);
+           });
+        projectSaving->addRow(tr("FFD brush samples per frame : "), mFFDSampleBudgetBox);
+
+        mUndoBudgetBox = new QSpinBox();
+        mUndoBudgetBox->setRange(16, 65536);
+        mUndoBudgetBox->setSingleStep(64);
+        mUndoBudgetBox->setSuffix(tr(" MB"));
+        mUndoBudgetBox->setValue(mUndoBudget);
+        mUndoBudgetBox->setToolTip(tr("Memory used by the undo history of each project"));
+        connect(mUndoBudgetBox, util::SelectArgs<int>::from(&QSpinBox::valueChanged), [=](int aValue) {
+                QSettings settings;
+                settings.setValue("generalsettings/undo/budgetMB", aValue);
+           });
+        projectSaving->addRow(tr("Undo history memory : "), mUndoBudgetBox);
+
+        mUndoSpill = new QCheckBox();
+        mUndoSpill->setChecked(bUndoSpill);
+        mUndoSpill->setToolTip(tr("Move old undo history to a temporary file instead of discarding it"));
+        connect(mUndoSpill, &QPushButton::clicked, [=]() {
+                QSettings settings;
+                settings.setValue("generalsettings/undo/spillToDisk", mUndoSpill->isChecked());
+           });
+        projectSaving->addRow(tr("Keep old undo history on disk : "), mUndoSpill);
+
+        mPreviewEnabled = new QCheckBox();
+        mPreviewEnabled->setChecked(bPreviewEnabled);
+        mPreviewEnabled->setToolTip(tr("Render the frames into memory while idle and play them back at the exact fps"));
+        connect(mPreviewEnabled, &QPushButton::clicked, [=]() {
+                QSettings settings;
+                settings.setValue("generalsettings/preview/enabled", mPreviewEnabled->isChecked());
+           });
+        projectSaving->addRow(tr("RAM preview : "), mPreviewEnabled);
+
+        mPreviewBudgetBox = new QSpinBox();
+        mPreviewBudgetBox->setRange(64, 65536);
+        mPreviewBudgetBox->setSingleStep(256);
+        mPreviewBudgetBox->setSuffix(tr(" MB"));
+        mPreviewBudgetBox->setValue(mPreviewBudget);
+        mPreviewBudgetBox->setToolTip(tr("Memory used by the frames of the RAM preview"));
+        connect(mPreviewBudgetBox, util::SelectArgs<int>::from(&QSpinBox::valueChanged), [=](int aValue) {
+                QSettings settings;
+                settings.setValue("generalsettings/preview/budgetMB", aValue);
+           });
+        projectSaving->addRow(tr("RAM preview memory : "), mPreviewBudgetBox);
+
+        mRenderAheadBox = new QSpinBox();
+        mRenderAheadBox->setRange(0, 16);
+        mRenderAheadBox->setSpecialValueText(tr("Off"));
+        mRenderAheadBox->setValue(mRenderAheadFrames);
+        mRenderAheadBox->setToolTip(tr("Frames rendered ahead by another thread during playback"));
+        connect(mRenderAheadBox, util::SelectArgs<int>::from(&QSpinBox::valueChanged), [=](int aValue) {
+                QSettings settings;
+                settings.setValue("generalsettings/preview/renderAheadFrames", aValue);
+           });
+        projectSaving->addRow(tr("Render-ahead frames : "), mRenderAheadBox);
+
+        mCoalesceEvents = new QCheckBox();
+        mCoalesceEvents->setChecked(bCoalesceEvents);
+        mCoalesceEvents->setToolTip(tr("Update the panels once per screen refresh while dragging keys"));
+        connect(mCoalesceEvents, &QPushButton::clicked, [=]() {
+                QSettings settings;
+                settings.setValue("generalsettings/timeline/coalesceEvents", mCoalesceEvents->isChecked());
+           });
+        projectSaving->addRow(tr("Coalesce key updates : "), mCoalesceEvents);
+
         mResetButton = new QPushButton(tr("Reset recent files list"));
         mResetButton->setToolTip(tr("Deletes all project entries from your recents"));
         connect(mResetButton, &QPushButton::clicked, [=]() {
@@ -280,6 +392,30 @@ GeneralSettingDialog::GeneralSettingDialog(GUIResources &aGUIResources, QWidget*
         projectSaving->addRow(mResetButton);
     }
 
+    auto meshSettings = new QFormLayout();
+    {
+        mAdaptiveMesh = new QCheckBox();
+        mAdaptiveMesh->setChecked(bAdaptiveMesh);
+        mAdaptiveMesh->setToolTip(tr("Use sparse meshes inside opaque areas of new or reloaded layers"));
+        connect(mAdaptiveMesh, &QPushButton::clicked, [=]() {
+                QSettings settings;
+                settings.setValue("generalsettings/mesh/adaptive", mAdaptiveMesh->isChecked());
+           });
+        meshSettings->addRow(tr("Adaptive mesh density : "), mAdaptiveMesh);
+
+        mMeshVertexBudgetBox = new QSpinBox();
+        mMeshVertexBudgetBox->setRange(0, 1000000);
+        mMeshVertexBudgetBox->setSingleStep(1000);
+        mMeshVertexBudgetBox->setSpecialValueText(tr("Unlimited"));
+        mMeshVertexBudgetBox->setValue(mMeshVertexBudget);
+        mMeshVertexBudgetBox->setToolTip(tr("Enlarges the mesh cells of new layers until the mesh fits in, a mesh size chosen for a key is kept"));
+        connect(mMeshVertexBudgetBox, util::SelectArgs<int>::from(&QSpinBox::valueChanged), [=](int aValue) {
+                QSettings settings;
+                settings.setValue("generalsettings/mesh/vertexBudget", aValue);
+           });
+        meshSettings->addRow(tr("Mesh vertex budget per layer : "), mMeshVertexBudgetBox);
+    }
+
     auto keysettings = new QFormLayout();
     {
         mHSVBlendColor = new QCheckBox();
@@ -500,6 +636,7 @@ GeneralSettingDialog::GeneralSettingDialog(GUIResources &aGUIResources, QWidget*
     createTab(tr("FFmpeg"), ffmpegSettings);
     createTab(tr("Animation keys"), keysettings);
     createTab(tr("Keybindings"), keybindingSettings);
+    createTab(tr("Mesh"), meshSettings);
 
 
     this->setMainWidget(mTabs, false);
@@ -19,7 +19,7 @@ public:
     GeneralSettingDialog(GUIResources& aGUIResources, QWidget* aParent);
     QFormLayout* createTab(const QString& aTitle, QFormLayout *aForm);
     void selectTab(int aIndex){
-        //General - 0 ; Project settings - 1 ; FFmpeg settings - 2 ; Animation keys - 3 ; Keybindings - 4
+        //General - 0 ; Project settings - 1 ; FFmpeg settings - 2 ; Animation keys - 3 ; Keybindings - 4 ; Mesh - 5
         mTabs->setCurrentIndex(aIndex);
     }
     bool easingHasChanged();
@@ -81,6 +81,36 @@ private:
     bool bAutoShowMesh;
     QCheckBox* mAutoShowMesh;
 
+    bool bAdaptiveMesh;
+    QCheckBox* mAdaptiveMesh;
+
+    int mMeshVertexBudget;
+    QSpinBox* mMeshVertexBudgetBox;
+
+    bool bAsyncFFD;
+    QCheckBox* mAsyncFFD;
+
+    int mFFDSampleBudget;
+    QSpinBox* mFFDSampleBudgetBox;
+
+    int mUndoBudget;
+    QSpinBox* mUndoBudgetBox;
+
+    bool bUndoSpill;
+    QCheckBox* mUndoSpill;
+
+    bool bPreviewEnabled;
+    QCheckBox* mPreviewEnabled;
+
+    int mPreviewBudget;
+    QSpinBox* mPreviewBudgetBox;
+
+    int mRenderAheadFrames;
+    QSpinBox* mRenderAheadBox;
+
+    bool bCoalesceEvents;
+    QCheckBox* mCoalesceEvents;
+
     QPushButton* ffmpegTroubleshoot;
     QPushButton* selectFromExe;
     QPushButton* autoSetup;
@@ -1,5 +1,6 @@
 #include "gui/MSVCMemoryLeakDebugger.h" // first of all
 #include <QApplication>
+#include <QGuiApplication>
 #include <QDir>
 #include <QFile>
 #include <QMessageBox>
@@ -8,6 +9,7 @@
 #include "XC.h"
 #include "gl/Global.h"
 #include "ctrl/System.h"
+#include "ctrl/ShardedExporter.h"
 #include "gui/MainWindow.h"
 #include "gui/GUIResources.h"
 #include "gui/MSVCBackTracer.h"
@@ -60,6 +62,19 @@ public:
     }
 };
 
+// a worker process has no window to show the error
+class AEWorkerErrorHandler : public XCErrorHandler
+{
+public:
+    virtual void critical(
+            const QString& aText, const QString& aInfo,
+            const QString& aDetail) const
+    {
+        XC_REPORT() << aText << "\n" << aInfo << "\n" << aDetail;
+        std::exit(EXIT_FAILURE);
+    }
+};
+
 XCAssertHandler* gXCAssertHandler = nullptr;
 XCErrorHandler* gXCErrorHandler = nullptr;
 static AEAssertHandler sAEAssertHandler;
@@ -99,6 +114,16 @@ int entryPoint(int argc, char *argv[])
 {
     int result = 0;
 
+    // a worker process of the sharded export renders without the main window
+    if (argc == 3 && QString(argv[1]) == ctrl::ShardedExporter::kWorkerOption)
+    {
+        static AEWorkerErrorHandler workerErrorHandler;
+        gXCErrorHandler = &workerErrorHandler;
+
+        QGuiApplication app(argc, argv);
+        return ctrl::ShardedExporter::runWorker(app.arguments().at(2));
+    }
+
     // create qt application
     QApplication::setAttribute(Qt::AA_EnableHighDpiScaling);
     QApplication app(argc, argv);
@@ -1,13 +1,21 @@
 #include <functional>
+#include <algorithm>
 #include <QMouseEvent>
+#include <QMutexLocker>
 #include <QOpenGLFunctions>
 #include <QGuiApplication>
+#include <QScreen>
+#include <QSettings>
 #include "XC.h"
 #include "util/Finally.h"
+#include "util/Profiler.h"
 #include "gl/Util.h"
 #include "gl/Framebuffer.h"
 #include "gl/Texture.h"
+#include "gl/ProgramRegistry.h"
+#include "gl/GPUProfiler.h"
 #include "core/ClippingFrame.h"
+#include "core/TimeLine.h"
 #include "gui/MainDisplayWidget.h"
 #include "gui/ProjectHook.h"
 #include "gui/ViaPoint.h"
@@ -15,6 +23,38 @@
 #include "gui/KeyCommandMap.h"
 #include "gui/MouseSetting.h"
 
+namespace
+{
+// rendering waits for the user to stop editing
+static const int kPreviewQuietMSec = 300;
+static const int kDefaultPreviewBudgetMB = 1024;
+
+// the render-ahead thread waits while the user is operating
+static const int kInputQuietMSec = 250;
+static const int kPlayBackRateMSec = 1000;
+
+// the blended value of a frame depends on two keys on each side
+util::Range keyNeighborhood(const core::TimeLine::MapType& aMap, int aFrame, int aMaxFrame)
+{
+    int begin = 0;
+    auto prev = aMap.lowerBound(aFrame);
+    for (int i = 0; i < 2 && prev != aMap.begin(); ++i)
+    {
+        --prev;
+        begin = prev.key();
+    }
+
+    int end = aMaxFrame;
+    auto next = aMap.upperBound(aFrame);
+    if (next != aMap.end())
+    {
+        end = next.key();
+        if (++next != aMap.end()) end = next.key();
+    }
+    return util::Range(std::min(begin, aFrame), std::max(end, aFrame));
+}
+}
+
 namespace gui
 {
 
@@ -44,11 +84,51 @@ MainDisplayWidget::MainDisplayWidget(ViaPoint& aViaPoint, QWidget* aParent)
     , mMovingCanvasByKey(false)
     , mMovingCanvasByMiddleMouseButton(false)
     , mDevicePixelRatio(1.0)
+    , mTimeLineSlot()
+    , mNodeAttrSlot()
+    , mResourceSlot()
+    , mTreeSlot()
+    , mProjAttrSlot()
+    , mPostedSlot()
+    , mFlushTimer()
+    , mPreviewEnabled(false)
+    , mPreviewRestart(true)
+    , mIsPlaying(false)
+    , mPreviewCursor(0)
+    , mFrameCache()
+    , mPreviewTimer()
+    , mPreviewFramebuffer()
+    , mPreviewClippingFrame()
+    , mPreviewTexturizer()
+    , mPreviewTexture()
+    , mPreviewTextureFrame(-1)
+    , mPreviewPixels()
+    , mRenderAheadFrames(0)
+    , mRenderAhead()
+    , mInputQuietTimer()
+    , mInputPausing(false)
+    , mAnimatorPausing(false)
+    , mRateTimer()
+    , mPresentedCount(0)
+    , mLastPresentedFrame(-1)
 {
     this->setObjectName(QStringLiteral("MainDisplayWidget"));
     this->setMouseTracking(true);
     this->setAutoFillBackground(false); // avoid auto fill on QPainter::begin()
 
+    mPreviewTimer.setSingleShot(true);
+    this->connect(&mPreviewTimer, &QTimer::timeout, this, &MainDisplayWidget::onPreviewTimeout);
+    loadPreviewSetting();
+
+    // the posted timeline events are flushed after the queued input
+    mFlushTimer.setSingleShot(true);
+    mFlushTimer.setInterval(0);
+    this->connect(&mFlushTimer, &QTimer::timeout, this, &MainDisplayWidget::flushTimeLineEvents);
+
+    mInputQuietTimer.setSingleShot(true);
+    this->connect(&mInputQuietTimer, &QTimer::timeout, [=]() { this->setInputPausing(false); });
+    loadRenderAheadSetting();
+
     // key binding
     if (mViaPoint.keyCommandMap())
     {
@@ -136,12 +216,22 @@ MainDisplayWidget::MainDisplayWidget(ViaPoint& aViaPoint, QWidget* aParent)
 
 MainDisplayWidget::~MainDisplayWidget()
 {
+    stopRenderAhead();
+    mRenderAhead.reset();
+    this->makeCurrent();
+    gl::GPUProfiler::clearThread();
+    mPreviewTimer.stop();
+    mPreviewTexture.destroy();
+    mPreviewTexturizer.reset();
+    mPreviewClippingFrame.reset();
+    mPreviewFramebuffer.reset();
     mPainterHandle.reset();
     mTextureDrawer.reset();
     mDestinationTexturizer.reset();
     mClippingFrame.reset();
     mFramebuffer.reset();
     mDefaultVAO.reset();
+    gl::ProgramRegistry::clear();
 
     gl::DeviceInfo::setInstance(nullptr);
     gl::Global::clearFunctions();
@@ -149,14 +239,43 @@ MainDisplayWidget::~MainDisplayWidget()
 
 void MainDisplayWidget::setProject(core::Project* aProject)
 {
+    if (mProject)
+    {
+        mFlushTimer.stop();
+        mProject->flushTimeLineEvents();
+        mProject->onTimeLineEventsPosted.disconnect(mPostedSlot);
+        mProject->onTimeLineModified.disconnect(mTimeLineSlot);
+        mProject->onNodeAttributeModified.disconnect(mNodeAttrSlot);
+        mProject->onResourceModified.disconnect(mResourceSlot);
+        mProject->onTreeRestructured.disconnect(mTreeSlot);
+        mProject->onProjectAttributeModified.disconnect(mProjAttrSlot);
+    }
+    stopRenderAhead();
     mProject.reset();
 
     mRenderInfo = nullptr;
     mAbstractCursor = core::AbstractCursor();
 
+    // the cache holds the frames of one project
+    loadPreviewSetting();
+    invalidatePreview();
+
     if (aProject)
     {
         mProject = aProject->pointee();
+        mTimeLineSlot = mProject->onTimeLineModified.connect(
+                    this, &MainDisplayWidget::onTimeLineModified);
+        mNodeAttrSlot = mProject->onNodeAttributeModified.connect(
+                    this, &MainDisplayWidget::onNodeAttributeModified);
+        mResourceSlot = mProject->onResourceModified.connect(
+                    this, &MainDisplayWidget::onResourceModified);
+        mTreeSlot = mProject->onTreeRestructured.connect(
+                    this, &MainDisplayWidget::onTreeRestructured);
+        mProjAttrSlot = mProject->onProjectAttributeModified.connect(
+                    this, &MainDisplayWidget::onProjectAttributeModified);
+        mPostedSlot = mProject->onTimeLineEventsPosted.connect(
+                    this, &MainDisplayWidget::onTimeLineEventsPosted);
+
         mRenderInfo = &(static_cast<ProjectHook*>(mProject->hook())->renderInfo());
         mRenderInfo->camera.setDevicePixelRatio(this->devicePixelRatioF());
         mRenderInfo->camera.setScreenSize(this->size());
@@ -164,6 +283,7 @@ void MainDisplayWidget::setProject(core::Project* aProject)
         mCanvasMover.setCamera(&(mRenderInfo->camera));
     }
 
+    schedulePreview(true);
     updateRender();
 }
 
@@ -283,6 +403,15 @@ void MainDisplayWidget::paintGL()
 {
     gl::Global::Functions& ggl = gl::Global::functions();
 
+    // the queries of previous frames
+    gl::GPUProfiler::resolve();
+    util::ProfileZone zone("paint");
+
+    if (drawPreviewFrame() || drawRenderAheadFrame())
+    {
+        return;
+    }
+
     // clear clipping
     mClippingFrame->clearTexture();
     mClippingFrame->resetClippingId();
@@ -323,7 +452,12 @@ void MainDisplayWidget::paintGL()
         XC_PTR_ASSERT(mRenderInfo);
         auto gridTarget = mViewSetting.showLayerMesh ?
                               mDriver->currentTarget() : nullptr;
+
+        // the render-ahead thread rewrites the buffers of renderers after this
+        const bool isShared = mProject && mRenderAhead && mRenderAhead->isRunning();
+        QMutexLocker locker(isShared ? &mProject->objectTree().timeCacheLock().rendering : nullptr);
         mDriver->renderGL(*mRenderInfo, gridTarget);
+        if (isShared) ggl.glFinish();
         GL_CHECK_ERROR();
     }
 
@@ -352,6 +486,11 @@ void MainDisplayWidget::paintGL()
 
     ggl.glFlush();
     GL_CHECK_ERROR();
+
+    if (mProject && mIsPlaying)
+    {
+        presentFrame(mProject->currentTimeInfo().frame.get());
+    }
 }
 
 void MainDisplayWidget::paintEvent(QPaintEvent* aEvent)
@@ -371,10 +510,68 @@ void MainDisplayWidget::paintEvent(QPaintEvent* aEvent)
         mDriver->renderQt(*mRenderInfo, *painter);
         GL_CHECK_ERROR();
     }
+
+    if (util::Profiler::isEnabled())
+    {
+        drawProfilerOverlay(*painter);
+        util::Profiler::markFrame();
+    }
     // we must call end function
     mPainterHandle->end();
 }
 
+void MainDisplayWidget::drawProfilerOverlay(QPainter& aPainter)
+{
+    const util::Profiler::Frame frame = util::Profiler::lastFrame();
+
+    QStringList lines;
+    lines << QString("frame %1 ms").arg(frame.msec, 0, 'f', 2);
+    for (auto& zone : frame.zones)
+    {
+        lines << QString("%1%2  %3 ms  x%4").arg(zone.isGPU ? "[gpu] " : "")
+                 .arg(zone.name).arg(zone.msec, 0, 'f', 2).arg(zone.count);
+    }
+    if (mProject)
+    {
+        // the posted events against the dispatched ones since the last overlay
+        const core::Project::DispatchStats& stats = mProject->dispatchStats();
+        lines << QString("timeline events  %1 posted  %2 dispatched  %3 ms")
+                 .arg(stats.postedCount).arg(stats.dispatchCount)
+                 .arg(stats.dispatchNSec / 1000000.0, 0, 'f', 2);
+        mProject->resetDispatchStats();
+    }
+    if (!frame.nodes.isEmpty())
+    {
+        lines << QString();
+        for (auto& node : frame.nodes)
+        {
+            lines << QString("%1%2  %3 ms").arg(node.isGPU ? "[gpu] " : "")
+                     .arg(node.detail).arg(node.msec, 0, 'f', 2);
+        }
+    }
+
+    QFont font("Monospace");
+    font.setStyleHint(QFont::TypeWriter);
+    font.setPointSize(9);
+    aPainter.setFont(font);
+
+    const QFontMetrics metrics(font);
+    const int lineHeight = metrics.height();
+    int width = 0;
+    for (auto& line : lines)
+    {
+        width = std::max(width, metrics.width(line));
+    }
+
+    const QRect rect(8, 8, width + 16, lineHeight * lines.size() + 12);
+    aPainter.fillRect(rect, QColor(0, 0, 0, 160));
+    aPainter.setPen(QColor(230, 230, 230));
+    for (int i = 0; i < lines.size(); ++i)
+    {
+        aPainter.drawText(rect.left() + 8, rect.top() + 6 + metrics.ascent() + i * lineHeight, lines[i]);
+    }
+}
+
 void MainDisplayWidget::resizeGL(int w, int h)
 {
     // currrent device pixel ratio (Attention that it is variable.)
@@ -502,6 +699,25 @@ void MainDisplayWidget::tabletEvent(QTabletEvent* aEvent)
 void MainDisplayWidget::onVisualUpdated()
 {
     updateRender();
+    schedulePreview(false);
+}
+
+void MainDisplayWidget::onTimeLineEventsPosted()
+{
+    if (!mFlushTimer.isActive())
+    {
+        mFlushTimer.start();
+    }
+}
+
+void MainDisplayWidget::flushTimeLineEvents()
+{
+    // the subscribers request the refresh through onVisualUpdated
+    if (mProject)
+    {
+        mProject->flushTimeLineEvents();
+    }
+    updateRender();
 }
 
 void MainDisplayWidget::onToolChanged(ctrl::ToolType aType)
@@ -558,6 +774,466 @@ void MainDisplayWidget::onProjectAttributeUpdated()
     }
 }
 
+void MainDisplayWidget::onVisibilityUpdated()
+{
+    invalidatePreview();
+    updateRender();
+}
+
+void MainDisplayWidget::onPlayBackStateChanged(bool aIsActive)
+{
+    mIsPlaying = aIsActive;
+    if (mIsPlaying)
+    {
+        loadPreviewSetting();
+        mPreviewTimer.stop();
+        if (mProject)
+        {
+            // the playback reads the baked tracks
+            mProject->objectTree().updateBake(mProject->currentTimeInfo());
+        }
+        startRenderAhead();
+
+        mPresentedCount = 0;
+        mLastPresentedFrame = -1;
+        mRateTimer.start();
+    }
+    else
+    {
+        stopRenderAhead();
+        onPlayBackRateUpdated(-1.0f, 0);
+
+        // the playback has reordered the frames
+        schedulePreview(true);
+    }
+    updateRender();
+}
+
+void MainDisplayWidget::onAnimatorSuspensionChanged(bool aIsSuspended)
+{
+    setAnimatorPausing(aIsSuspended);
+}
+
+void MainDisplayWidget::onTimeLineModified(core::TimeLineEvent& aEvent, bool)
+{
+    // the previous positions of moved keys are unknown
+    if (!mProject || aEvent.type() == core::TimeLineEvent::Type_MoveKey ||
+            !aEvent.defaultTargets().isEmpty())
+    {
+        invalidatePreview();
+        return;
+    }
+
+    const int maxFrame = mProject->attribute().maxFrame();
+    for (auto& target : aEvent.targets())
+    {
+        const core::TimeLine* line = target.pos.line();
+        if (!line)
+        {
+            invalidatePreview();
+            return;
+        }
+        mFrameCache.invalidate(keyNeighborhood(
+                                   line->map(target.pos.type()), target.pos.index(), maxFrame));
+    }
+    mPreviewTextureFrame = -1;
+    if (mRenderAhead) mRenderAhead->invalidate();
+    schedulePreview(true);
+}
+
+void MainDisplayWidget::onNodeAttributeModified(core::ObjectNode&, bool)
+{
+    invalidatePreview();
+}
+
+void MainDisplayWidget::onResourceModified(core::ResourceEvent&, bool)
+{
+    invalidatePreview();
+}
+
+void MainDisplayWidget::onTreeRestructured(core::ObjectTreeEvent&, bool)
+{
+    invalidatePreview();
+}
+
+void MainDisplayWidget::onProjectAttributeModified(core::ProjectEvent&, bool)
+{
+    invalidatePreview();
+
+    // the frame count and the image size can be changed
+    if (mRenderAhead && mRenderAhead->isRunning())
+    {
+        startRenderAhead();
+    }
+}
+
+void MainDisplayWidget::loadPreviewSetting()
+{
+    QSettings settings;
+    auto enabled = settings.value("generalsettings/preview/enabled");
+    auto budget = settings.value("generalsettings/preview/budgetMB");
+
+    const bool wasEnabled = mPreviewEnabled;
+    mPreviewEnabled = enabled.isValid() ? enabled.toBool() : false;
+    const int budgetMB = budget.isValid() ? budget.toInt() : kDefaultPreviewBudgetMB;
+    mFrameCache.setByteBudget(mPreviewEnabled ? (size_t)budgetMB * 1024 * 1024 : 0);
+
+    if (mPreviewEnabled && !wasEnabled)
+    {
+        schedulePreview(true);
+    }
+}
+
+void MainDisplayWidget::invalidatePreview()
+{
+    mFrameCache.clear();
+    mPreviewTextureFrame = -1;
+    if (mRenderAhead) mRenderAhead->invalidate();
+    schedulePreview(true);
+}
+
+void MainDisplayWidget::schedulePreview(bool aRestart)
+{
+    if (aRestart)
+    {
+        mPreviewRestart = true;
+    }
+
+    if (!mPreviewEnabled || !mProject || mIsPlaying)
+    {
+        mPreviewTimer.stop();
+        return;
+    }
+
+    // wait while the user is working
+    if (aRestart || mPreviewTimer.isActive())
+    {
+        mPreviewTimer.start(kPreviewQuietMSec);
+    }
+}
+
+void MainDisplayWidget::onPreviewTimeout()
+{
+    if (!mPreviewEnabled || !mProject || mIsPlaying) return;
+    if (!mFramebuffer) return; // not initialized yet
+
+    // the project is being modified by another task
+    if (!mRenderingLock.tryLockForRead())
+    {
+        mPreviewTimer.start(kPreviewQuietMSec);
+        return;
+    }
+    util::Finally unlocker([=](){ this->mRenderingLock.unlock(); });
+
+    const int frameCount = mProject->attribute().maxFrame() + 1;
+    if (mPreviewRestart)
+    {
+        mPreviewRestart = false;
+        mFrameCache.beginPass();
+        mPreviewCursor = mProject->currentTimeInfo().frame.get();
+        mProject->objectTree().updateBake(mProject->currentTimeInfo());
+    }
+
+    // the first frame which is not cached from the cursor
+    int frame = -1;
+    for (int i = 0; i < frameCount; ++i)
+    {
+        const int candidate = (mPreviewCursor + i) % frameCount;
+        if (!mFrameCache.contains(candidate))
+        {
+            frame = candidate;
+            break;
+        }
+    }
+    if (frame < 0) return;
+
+    // a filled budget ends this pass
+    if (!renderPreviewFrame(frame)) return;
+
+    mPreviewCursor = frame;
+    mPreviewTimer.start(0);
+}
+
+bool MainDisplayWidget::renderPreviewFrame(int aFrame)
+{
+    XC_ASSERT(mProject);
+    const QSize imageSize = mProject->attribute().imageSize();
+    const QSize size = previewSize();
+    if (size.isEmpty()) return false;
+
+    mFrameCache.setFrameSize(size);
+
+    this->makeCurrent();
+    gl::Global::Functions& ggl = gl::Global::functions();
+
+    if (!mPreviewFramebuffer || mPreviewFramebuffer->size() != size)
+    {
+        mPreviewFramebuffer.reset();
+        mPreviewFramebuffer.reset(new QOpenGLFramebufferObject(size));
+        mPreviewClippingFrame.reset(new core::ClippingFrame());
+        mPreviewClippingFrame->resize(size);
+        mPreviewTexturizer.reset(new core::DestinationTexturizer());
+        mPreviewTexturizer->resize(size);
+    }
+
+    mPreviewClippingFrame->clearTexture();
+    mPreviewClippingFrame->resetClippingId();
+    mPreviewTexturizer->clearTexture();
+
+    if (!mPreviewFramebuffer->bind())
+    {
+        XC_FATAL_ERROR("OpenGL Error", "Failed to bind framebuffer.", "");
+    }
+
+    gl::Util::setViewportAsActualPixels(size);
+    gl::Util::clearColorBuffer(0.25f, 0.25f, 0.25f, 1.0f);
+    gl::Util::resetRenderState();
+
+    // the image is fitted to the preview size
+    core::RenderInfo renderInfo;
+    RenderAhead::setupFittedCamera(renderInfo.camera, size, imageSize);
+    renderInfo.time = mProject->currentTimeInfo();
+    renderInfo.time.frame = core::Frame(aFrame);
+    renderInfo.framebuffer = mPreviewFramebuffer->handle();
+    renderInfo.dest = mPreviewFramebuffer->texture();
+    renderInfo.isGrid = false;
+    renderInfo.clippingId = 0;
+    renderInfo.clippingFrame = mPreviewClippingFrame.data();
+    renderInfo.destTexturizer = mPreviewTexturizer.data();
+
+    // the working cache keeps the current frame of the editors
+    mProject->objectTree().render(renderInfo, true);
+
+    mPreviewPixels.resize((int)mFrameCache.frameBytes());
+    ggl.glReadPixels(0, 0, size.width(), size.height(),
+                     GL_RGBA, GL_UNSIGNED_BYTE, mPreviewPixels.data());
+
+    if (!mPreviewFramebuffer->release())
+    {
+        XC_FATAL_ERROR("OpenGL Error", "Failed to unbind framebuffer.", "");
+    }
+    GL_CHECK_ERROR();
+    this->doneCurrent();
+
+    return mFrameCache.insert(aFrame, (const uint8*)mPreviewPixels.constData());
+}
+
+bool MainDisplayWidget::drawPreviewFrame()
+{
+    if (!mIsPlaying || !mPreviewEnabled || !mProject) return false;
+    XC_PTR_ASSERT(mRenderInfo);
+
+    // the frames between integers are not cached
+    const core::TimeInfo timeInfo = mProject->currentTimeInfo();
+    const int frame = timeInfo.frame.get();
+    if (!(timeInfo.frame == core::Frame(frame))) return false;
+
+    const QSize size = mFrameCache.frameSize();
+    if (mPreviewTextureFrame != frame)
+    {
+        if (!mFrameCache.load(frame, mPreviewPixels)) return false;
+
+        if (mPreviewTexture.size() != size)
+        {
+            mPreviewTexture.create(size);
+            mPreviewTexture.setFilter(GL_LINEAR);
+        }
+        gl::Global::Functions& ggl = gl::Global::functions();
+        ggl.glBindTexture(GL_TEXTURE_2D, mPreviewTexture.id());
+        ggl.glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, size.width(), size.height(),
+                            GL_RGBA, GL_UNSIGNED_BYTE, mPreviewPixels.constData());
+        ggl.glBindTexture(GL_TEXTURE_2D, 0);
+        mPreviewTextureFrame = frame;
+    }
+    mRenderInfo->time = timeInfo;
+
+    drawFrameTexture(mPreviewTexture.id(), size);
+    gl::Global::functions().glFlush();
+    GL_CHECK_ERROR();
+
+    presentFrame(frame);
+    return true;
+}
+
+void MainDisplayWidget::drawFrameTexture(GLuint aTexture, const QSize& aSize)
+{
+    XC_PTR_ASSERT(mRenderInfo);
+    gl::Global::functions().glBindFramebuffer(GL_FRAMEBUFFER, this->defaultFramebufferObject());
+    gl::Util::setViewportAsActualPixels(deviceSize());
+    gl::Util::clearColorBuffer(0.25f, 0.25f, 0.25f, 1.0f);
+
+    const std::array<QVector2D, 4> texQuad = {
+        QVector2D(0.0f, 0.0f), QVector2D(0.0f, aSize.height()),
+        QVector2D(aSize.width(), aSize.height()), QVector2D(aSize.width(), 0.0f) };
+    mTextureDrawer->draw(aTexture,
+                         mRenderInfo->camera.screenImageQuadangle(),
+                         mRenderInfo->camera.screenSize(), texQuad, aSize);
+}
+
+QSize MainDisplayWidget::previewSize() const
+{
+    XC_ASSERT(mProject);
+    const QSize imageSize = mProject->attribute().imageSize();
+    if (imageSize.isEmpty()) return QSize();
+
+    // no finer than the screen, which does not depend on the window size
+    QSize limit = imageSize;
+    auto screen = QGuiApplication::primaryScreen();
+    if (screen)
+    {
+        limit = screen->size() * screen->devicePixelRatio();
+    }
+    const double scale = std::min(1.0, std::min(
+            (double)limit.width() / imageSize.width(),
+            (double)limit.height() / imageSize.height()));
+
+    return QSize(std::max((int)(imageSize.width() * scale), 1),
+                 std::max((int)(imageSize.height() * scale), 1));
+}
+
+void MainDisplayWidget::loadRenderAheadSetting()
+{
+    QSettings settings;
+    auto frames = settings.value("generalsettings/preview/renderAheadFrames");
+    mRenderAheadFrames = frames.isValid() ? std::max(frames.toInt(), 0) : 0;
+}
+
+void MainDisplayWidget::startRenderAhead()
+{
+    stopRenderAhead();
+    loadRenderAheadSetting();
+    if (!mProject || !mFramebuffer || mRenderAheadFrames <= 0) return;
+
+    // one more framebuffer is kept for the displayed frame
+    const int ringSize = mRenderAheadFrames + 1;
+    if (!mRenderAhead || mRenderAhead->ringSize() != ringSize)
+    {
+        mRenderAhead.reset();
+        mRenderAhead.reset(new RenderAhead(*this->context(), mRenderingLock, ringSize));
+        if (mInputPausing) mRenderAhead->pause();
+        if (mAnimatorPausing) mRenderAhead->pause();
+    }
+    if (!mRenderAhead->isValid())
+    {
+        mRenderAhead.reset();
+        return;
+    }
+
+    const QSize size = previewSize();
+    if (size.isEmpty()) return;
+
+    // the objects of this context have to be complete for the other
+    this->makeCurrent();
+    gl::Global::functions().glFinish();
+    this->doneCurrent();
+
+    mRenderAhead->start(*mProject, mProject->currentTimeInfo(), size);
+    qApp->installEventFilter(this);
+}
+
+void MainDisplayWidget::stopRenderAhead()
+{
+    if (!mRenderAhead || !mRenderAhead->isRunning()) return;
+    qApp->removeEventFilter(this);
+    mRenderAhead->stop();
+}
+
+bool MainDisplayWidget::drawRenderAheadFrame()
+{
+    if (!mIsPlaying || !mProject || !mRenderAhead || !mRenderAhead->isRunning()) return false;
+    XC_PTR_ASSERT(mRenderInfo);
+
+    // the last frame is kept while the next one is not in time
+    const core::TimeInfo timeInfo = mProject->currentTimeInfo();
+    int shownFrame = -1;
+    const GLuint texture = mRenderAhead->acquire(timeInfo.frame.get(), shownFrame);
+    if (!texture) return false;
+
+    mRenderInfo->time = timeInfo;
+
+    drawFrameTexture(texture, mRenderAhead->frameSize());
+    // the thread can rewrite the texture after the next acquisition
+    gl::Global::functions().glFinish();
+    GL_CHECK_ERROR();
+
+    presentFrame(shownFrame);
+    return true;
+}
+
+bool MainDisplayWidget::eventFilter(QObject* aObject, QEvent* aEvent)
+{
+    switch (aEvent->type())
+    {
+    case QEvent::MouseButtonPress:
+    case QEvent::MouseButtonRelease:
+    case QEvent::MouseButtonDblClick:
+    case QEvent::KeyPress:
+    case QEvent::KeyRelease:
+    case QEvent::Wheel:
+    case QEvent::TabletPress:
+    case QEvent::TabletRelease:
+    case QEvent::Drop:
+        setInputPausing(true);
+        break;
+    case QEvent::MouseMove:
+    case QEvent::TabletMove:
+        // dragging can modify the project
+        if (QGuiApplication::mouseButtons() != Qt::NoButton)
+        {
+            setInputPausing(true);
+        }
+        break;
+    default:
+        break;
+    }
+    return QOpenGLWidget::eventFilter(aObject, aEvent);
+}
+
+void MainDisplayWidget::setInputPausing(bool aIsPausing)
+{
+    if (aIsPausing)
+    {
+        mInputQuietTimer.start(kInputQuietMSec);
+    }
+    if (mInputPausing == aIsPausing) return;
+
+    mInputPausing = aIsPausing;
+    if (mRenderAhead)
+    {
+        if (aIsPausing) mRenderAhead->pause(); else mRenderAhead->resume();
+    }
+}
+
+void MainDisplayWidget::setAnimatorPausing(bool aIsPausing)
+{
+    if (mAnimatorPausing == aIsPausing) return;
+
+    mAnimatorPausing = aIsPausing;
+    if (mRenderAhead)
+    {
+        if (aIsPausing) mRenderAhead->pause(); else mRenderAhead->resume();
+    }
+}
+
+void MainDisplayWidget::presentFrame(int aFrame)
+{
+    if (!mIsPlaying || !mProject) return;
+
+    if (aFrame != mLastPresentedFrame)
+    {
+        mLastPresentedFrame = aFrame;
+        ++mPresentedCount;
+    }
+
+    const qint64 elapsed = mRateTimer.elapsed();
+    if (elapsed >= kPlayBackRateMSec)
+    {
+        onPlayBackRateUpdated(mPresentedCount * 1000.0f / elapsed, mProject->attribute().fps());
+        mPresentedCount = 0;
+        mRateTimer.restart();
+    }
+}
+
 void MainDisplayWidget::updateCursor()
 {
     if (mDriver)
@@ -5,13 +5,17 @@
 #include <QOpenGLFramebufferObject>
 #include <QScopedPointer>
 #include <QTabBar>
+#include <QTimer>
+#include <QElapsedTimer>
 #include <QReadWriteLock>
 #include <QtMath>
 #include "util/LinkPointer.h"
+#include "util/Signaler.h"
 #include "gl/Global.h"
 #include "gl/Root.h"
 #include "gl/VertexArrayObject.h"
 #include "gl/EasyTextureDrawer.h"
+#include "gl/Texture.h"
 #include "core/Project.h"
 #include "core/AbstractCursor.h"
 #include "core/TimeInfo.h"
@@ -21,6 +25,8 @@
 #include "ctrl/Painter.h"
 #include "gui/MainViewSetting.h"
 #include "gui/CanvasMover.h"
+#include "gui/FrameCache.h"
+#include "gui/RenderAhead.h"
 namespace gui { class ProjectTabBar; }
 namespace gui { class ViaPoint; }
 
@@ -43,6 +49,15 @@ public:
     QReadWriteLock& renderingLock() { return mRenderingLock; }
     const QReadWriteLock& renderingLock() const { return mRenderingLock; }
 
+    // ram preview, the frames are rendered while idle and drawn on playback
+    bool isPreviewEnabled() const { return mPreviewEnabled; }
+    const FrameCache& frameCache() const { return mFrameCache; }
+
+    // the frames following the displayed one are rendered by another thread on playback
+    bool isRenderAheadEnabled() const { return mRenderAheadFrames > 0; }
+
+    // achieved and target frames per second on playback, -1 when it stops
+    util::Signaler<void(float, int)> onPlayBackRateUpdated;
 
     // boostlike signals
 public:
@@ -51,6 +66,9 @@ public:
     void onFinalizeTool(ctrl::ToolType);
     void onViewSettingChanged(const MainViewSetting&);
     void onProjectAttributeUpdated();
+    void onVisibilityUpdated();
+    void onPlayBackStateChanged(bool aIsActive);
+    void onAnimatorSuspensionChanged(bool aIsSuspended);
 
 private:
     class GLContextAccessor : public gl::ContextAccessor
@@ -73,9 +91,38 @@ private:
     virtual void wheelEvent(QWheelEvent* event);
     virtual void tabletEvent(QTabletEvent* event);
 
+    // from QObject
+    virtual bool eventFilter(QObject* aObject, QEvent* aEvent);
+
     void updateCursor();
     QSize deviceSize() const { return this->size() * mDevicePixelRatio; }
 
+    void onTimeLineModified(core::TimeLineEvent& aEvent, bool aUndo);
+    void onNodeAttributeModified(core::ObjectNode& aNode, bool aUndo);
+    void onResourceModified(core::ResourceEvent& aEvent, bool aUndo);
+    void onTreeRestructured(core::ObjectTreeEvent& aEvent, bool aUndo);
+    void onProjectAttributeModified(core::ProjectEvent& aEvent, bool aUndo);
+    void onTimeLineEventsPosted();
+    void flushTimeLineEvents();
+
+    void loadPreviewSetting();
+    void invalidatePreview();
+    void schedulePreview(bool aRestart);
+    void onPreviewTimeout();
+    bool renderPreviewFrame(int aFrame);
+    bool drawPreviewFrame();
+    QSize previewSize() const;
+    void drawFrameTexture(GLuint aTexture, const QSize& aSize);
+
+    void loadRenderAheadSetting();
+    void startRenderAhead();
+    void stopRenderAhead();
+    bool drawRenderAheadFrame();
+    void setInputPausing(bool aIsPausing);
+    void setAnimatorPausing(bool aIsPausing);
+    void presentFrame(int aFrame);
+    void drawProfilerOverlay(QPainter& aPainter);
+
     ViaPoint& mViaPoint;
     gl::DeviceInfo mGLDeviceInfo;
     util::LinkPointer<core::Project> mProject;
@@ -99,6 +146,37 @@ private:
     bool mMovingCanvasByKey;
     bool mMovingCanvasByMiddleMouseButton;
     double mDevicePixelRatio;
+
+    util::SlotId mTimeLineSlot;
+    util::SlotId mNodeAttrSlot;
+    util::SlotId mResourceSlot;
+    util::SlotId mTreeSlot;
+    util::SlotId mProjAttrSlot;
+    util::SlotId mPostedSlot;
+    QTimer mFlushTimer;
+
+    bool mPreviewEnabled;
+    bool mPreviewRestart;
+    bool mIsPlaying;
+    int mPreviewCursor;
+    FrameCache mFrameCache;
+    QTimer mPreviewTimer;
+    QScopedPointer<QOpenGLFramebufferObject> mPreviewFramebuffer;
+    QScopedPointer<core::ClippingFrame> mPreviewClippingFrame;
+    QScopedPointer<core::DestinationTexturizer> mPreviewTexturizer;
+    gl::Texture mPreviewTexture;
+    int mPreviewTextureFrame;
+    QByteArray mPreviewPixels;
+
+    int mRenderAheadFrames;
+    QScopedPointer<RenderAhead> mRenderAhead;
+    QTimer mInputQuietTimer;
+    bool mInputPausing;
+    bool mAnimatorPausing;
+
+    QElapsedTimer mRateTimer;
+    int mPresentedCount;
+    int mLastPresentedFrame;
 };
 
 } // namespace gui
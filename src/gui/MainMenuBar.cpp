@@ -2,12 +2,14 @@
 #include <QMenu>
 #include <QAction>
 #include <QMessageBox>
+#include <QFileDialog>
 #include <QDomDocument>
 #include <QJsonDocument>
 #include <qstandardpaths.h>
 #include <QDesktopServices>
 #include "qprocess.h"
 #include "util/TextUtil.h"
+#include "util/Profiler.h"
 #include "cmnd/BasicCommands.h"
 #include "cmnd/ScopedMacro.h"
 #include "core/ObjectNodeUtil.h"
@@ -246,7 +248,35 @@ MainMenuBar::MainMenuBar(MainWindow& aMainWindow, ViaPoint& aViaPoint, GUIResour
             }
         });
 
+        QAction* profiler = new QAction(tr("Profiler Overlay"), this);
+        profiler->setCheckable(true);
+        connect(profiler, &QAction::triggered, [=](bool aChecked)
+        {
+            util::Profiler::clear();
+            util::Profiler::setEnabled(aChecked);
+            this->onVisualUpdated();
+        });
+
+        QAction* trace = new QAction(tr("Save Profiler Trace..."), this);
+        connect(trace, &QAction::triggered, [=](bool)
+        {
+            const QString path = QFileDialog::getSaveFileName(
+                        this, tr("Save Profiler Trace"), QString(), "Trace Event JSON (*.json)");
+            if (path.isEmpty()) return;
+
+            QFile file(path);
+            if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate) ||
+                    !util::Profiler::writeTrace(file))
+            {
+                QMessageBox::warning(nullptr, tr("Operation Error"),
+                                     tr("Failed to save the profiler trace."));
+            }
+        });
+
         windowMenu->addAction(resource);
+        windowMenu->addSeparator();
+        windowMenu->addAction(profiler);
+        windowMenu->addAction(trace);
     }
 
     QMenu* optionMenu = new QMenu(tr("Option"), this);
@@ -265,6 +295,8 @@ MainMenuBar::MainMenuBar(MainWindow& aMainWindow, ViaPoint& aViaPoint, GUIResour
                 if(generalSettingsDialog->themeHasChanged())
                     this->mGUIResources.setTheme(generalSettingsDialog->theme());
             }
+            // some rows are saved as soon as they are edited
+            this->onGeneralSettingsChanged();
         });
 
         connect(mouse, &QAction::triggered, [&](bool)
@@ -31,6 +31,7 @@ public:
     util::Signaler<void()> onVisualUpdated;
     util::Signaler<void()> onProjectAttributeUpdated;
     util::Signaler<void()> onTimeFormatChanged;
+    util::Signaler<void()> onGeneralSettingsChanged;
 
 private:
     QScopedPointer<QProcess> mProcess;
@@ -1,17 +1,19 @@
+#include <algorithm>
 #include <QApplication>
 #include <QDesktopWidget>
 #include <QSettings>
 #include <QFileDialog>
+#include <QDir>
 #include <QDockWidget>
 #include <QGraphicsDropShadowEffect>
 #include <QShortcut>
 #include <QElapsedTimer>
 #include <QMessageBox>
-#include <QFileSystemWatcher>
 #include "GeneralSettingDialog.h"
 #include "util/IProgressReporter.h"
 #include "gl/Global.h"
 #include "ctrl/Exporter.h"
+#include "ctrl/ShardedExporter.h"
 #include "gui/MainWindow.h"
 #include "gui/ExportDialog.h"
 #include "gui/NewProjectDialog.h"
@@ -34,6 +36,18 @@ public:
     }
 };
 
+QString historyUsageText(const cmnd::Stack& aStack)
+{
+    const double kMB = 1024.0 * 1024.0;
+    QString text = QString(" (history %1 MB").arg(aStack.memoryUsage() / kMB, 0, 'f', 1);
+    const qint64 disk = aStack.diskUsage();
+    if (disk > 0)
+    {
+        text += QString(", %1 MB on disk").arg(disk / kMB, 0, 'f', 1);
+    }
+    return text + ")";
+}
+
 }
 
 namespace gui
@@ -229,7 +243,7 @@ MainWindow::MainWindow(ctrl::System& aSystem, GUIResources& aResources, const Lo
         driver.onVisualUpdated.connect(&disp, &MainDisplayWidget::onVisualUpdated);
         tool.onVisualUpdated.connect(&disp, &MainDisplayWidget::onVisualUpdated);
         prop.onVisualUpdated.connect(&disp, &MainDisplayWidget::onVisualUpdated);
-        objTree.onVisibilityUpdated.connect(&disp, &MainDisplayWidget::onVisualUpdated);
+        objTree.onVisibilityUpdated.connect(&disp, &MainDisplayWidget::onVisibilityUpdated);
         menu.onVisualUpdated.connect(&disp, &MainDisplayWidget::onVisualUpdated);
         via.onVisualUpdated.connect(&disp, &MainDisplayWidget::onVisualUpdated);
 
@@ -247,11 +261,25 @@ MainWindow::MainWindow(ctrl::System& aSystem, GUIResources& aResources, const Lo
         timeLine.onFrameUpdated.connect(&driver, &DriverHolder::onFrameUpdated);
         timeLine.onFrameUpdated.connect(&prop, &PropertyWidget::onFrameUpdated);
         timeLine.onPlayBackStateChanged.connect(&prop, &PropertyWidget::onPlayBackStateChanged);
+        timeLine.onPlayBackStateChanged.connect(&disp, &MainDisplayWidget::onPlayBackStateChanged);
+        {
+            DriverHolder* driverPtr = &driver;
+            MainDisplayWidget* dispPtr = &disp;
+            timeLine.onPlayBackStateChanged.connect([=](bool aIsActive)
+            {
+                driverPtr->setLazyFrameUpdate(
+                            aIsActive && (dispPtr->isPreviewEnabled() || dispPtr->isRenderAheadEnabled()));
+            });
+        }
+        disp.onPlayBackRateUpdated.connect(&mTarget->playBackWidget(), &PlayBackWidget::setPlayBackRate);
+        mTarget->onSuspensionChanged.connect(&disp, &MainDisplayWidget::onAnimatorSuspensionChanged);
 
         menu.onProjectAttributeUpdated.connect(&disp, &MainDisplayWidget::onProjectAttributeUpdated);
         menu.onProjectAttributeUpdated.connect(&timeLine, &TimeLineWidget::onProjectAttributeUpdated);
         menu.onProjectAttributeUpdated.connect(&driver, &DriverHolder::onProjectAttributeUpdated);
         menu.onTimeFormatChanged.connect(&timeLine, &TimeLineWidget::triggerOnTimeFormatChanged);
+        menu.onGeneralSettingsChanged.connect(this, &MainWindow::onGeneralSettingsChanged);
+        applyToolSettings();
 
         mGUIResources.onThemeChanged.connect(this, &MainWindow::onThemeUpdated);
 
@@ -394,7 +422,7 @@ void MainWindow::testNewProject(const QString& aFilePath)
 
     core::Project::Attribute attribute;
     auto result = mSystem.newProject(
-                aFilePath, attribute, new ProjectHook(), progress, false);
+                aFilePath, attribute, new ProjectHook(), progress, false, meshingSetting());
 
     if (result)
     {
@@ -416,6 +444,16 @@ void MainWindow::resetProjectRefs(core::Project* aProject)
 {
     mCurrent = aProject;
 
+    // the tasks of the current project run before the ones of the other tabs
+    for (int i = 0; i < mSystem.projectCount(); ++i)
+    {
+        core::Project* project = mSystem.project(i);
+        project->taskGroup().setPriority(project == aProject ?
+                                             thr::Scheduler::Priority_Interactive :
+                                             thr::Scheduler::Priority_Background);
+        applyGeneralSettings(*project);
+    }
+
     /// @note Maybe a sequence of connections is meaningful.
 
     if (aProject)
@@ -438,6 +476,55 @@ void MainWindow::resetProjectRefs(core::Project* aProject)
     mTool->setDriver(mDriverHolder->driver());
 }
 
+core::GridMesh::MeshingParam MainWindow::meshingSetting() const
+{
+    QSettings settings;
+    auto adaptive = settings.value("generalsettings/mesh/adaptive");
+    auto budget = settings.value("generalsettings/mesh/vertexBudget");
+    return core::GridMesh::MeshingParam(
+                adaptive.isValid() ? adaptive.toBool() : false,
+                budget.isValid() ? std::max(0, budget.toInt()) : 0);
+}
+
+void MainWindow::applyGeneralSettings(core::Project& aProject) const
+{
+    static const int kDefaultUndoBudgetMB = 512;
+    static const qint64 kUndoSpillBudgetMB = 4096;
+
+    aProject.setMeshingParam(meshingSetting());
+
+    QSettings settings;
+    auto budget = settings.value("generalsettings/undo/budgetMB");
+    const int budgetMB = budget.isValid() ? budget.toInt() : kDefaultUndoBudgetMB;
+    aProject.commandStack().setByteBudget((size_t)std::max(budgetMB, 1) * 1024 * 1024);
+
+    auto spill = settings.value("generalsettings/undo/spillToDisk");
+    const bool spills = spill.isValid() ? spill.toBool() : false;
+    aProject.commandStack().setSpillBudget(spills ? kUndoSpillBudgetMB * 1024 * 1024 : 0);
+
+    auto coalesce = settings.value("generalsettings/timeline/coalesceEvents");
+    aProject.setCoalescesTimeLineEvents(coalesce.isValid() ? coalesce.toBool() : true);
+}
+
+void MainWindow::applyToolSettings()
+{
+    QSettings settings;
+    auto async = settings.value("generalsettings/ffd/asyncReadback");
+    auto budget = settings.value("generalsettings/ffd/sampleBudget");
+    mTool->setFFDDispatchParam(
+                async.isValid() ? async.toBool() : false,
+                budget.isValid() ? std::max(1, budget.toInt()) : ctrl::FFDParam().sampleBudget);
+}
+
+void MainWindow::onGeneralSettingsChanged()
+{
+    for (int i = 0; i < mSystem.projectCount(); ++i)
+    {
+        applyGeneralSettings(*mSystem.project(i));
+    }
+    applyToolSettings();
+}
+
 void MainWindow::onProjectTabChanged(core::Project& aProject)
 {
     resetProjectRefs(&aProject);
@@ -679,7 +766,8 @@ void MainWindow::onUndoTriggered()
         auto ret = mCurrent->commandStack().undo(&undone);
         if (undone)
         {
-            mViaPoint.pushUndoneLog(tr("Undone : ") + ret);
+            mViaPoint.pushUndoneLog(tr("Undone : ") + ret +
+                                    historyUsageText(mCurrent->commandStack()));
             mMainDisplay->updateRender();
         }
     }
@@ -737,7 +825,8 @@ void MainWindow::onRedoTriggered()
         auto ret = mCurrent->commandStack().redo(&redone);
         if (redone)
         {
-            mViaPoint.pushRedoneLog(tr("Redone : ") + ret);
+            mViaPoint.pushRedoneLog(tr("Redone : ") + ret +
+                                    historyUsageText(mCurrent->commandStack()));
             mMainDisplay->updateRender();
         }
     }
@@ -775,7 +864,7 @@ void MainWindow::onNewProjectTriggered()
 
         result = mSystem.newProject(
                     fileName, attribute, new ProjectHook(),
-                    progress, specifiesCanvasSize);
+                    progress, specifiesCanvasSize, meshingSetting());
     }
 
     if (result.project)
@@ -796,12 +885,6 @@ void MainWindow::onNewProjectTriggered()
     }
 }
 
-QFileSystemWatcher* globalWatcher = new QFileSystemWatcher();
-
-QFileSystemWatcher* MainWindow::getWatcher(){
-    return globalWatcher;
-}
-
 void MainWindow::showInfoPopup(const QString& aTitle, const QString& aDetailText, const QString& aIcon, const QString& aDetailed)
 {
     QMessageBox box;
@@ -951,15 +1034,6 @@ void MainWindow::onCloseProjectTriggered()
 {
     if (mCurrent)
     {
-
-        // Sneaky potential crash
-        QFileSystemWatcher* watcher = MainWindow::getWatcher();
-        for (unsigned int x = 0; x < mCurrent->resourceHolder().imageTrees().size(); x += 1){
-            if (watcher->files().contains(mCurrent->resourceHolder().findAbsoluteFilePath(*mCurrent->resourceHolder().imageTree(x).topNode))){
-                watcher->removePath(mCurrent->resourceHolder().findAbsoluteFilePath(*mCurrent->resourceHolder().imageTree(x).topNode));
-            }
-        }
-
         if (mCurrent->isModified())
         {
             auto result = confirmProjectClosing(true);
@@ -1003,6 +1077,7 @@ void MainWindow::onExportImageSeqTriggered(const QString& aSuffix)
     // export param
     ctrl::Exporter::CommonParam cparam;
     ctrl::Exporter::ImageParam iparam;
+    int shardCount = 1;
     {
         QScopedPointer<ImageExportDialog> dialog(
                     new ImageExportDialog(*mCurrent, dirName, aSuffix, this));
@@ -1012,6 +1087,7 @@ void MainWindow::onExportImageSeqTriggered(const QString& aSuffix)
 
         cparam = dialog->commonParam();
         iparam = dialog->imageParam();
+        shardCount = dialog->shardCount();
     }
 
     // gui for confirm overwrite
@@ -1027,7 +1103,8 @@ void MainWindow::onExportImageSeqTriggered(const QString& aSuffix)
     };
 
     menu::ProgressReporter progress(true, this);
-    ctrl::Exporter exporter(*mCurrent);
+    ctrl::ShardedExporter exporter(*mCurrent);
+    exporter.setShardCount(shardCount);
     exporter.setOverwriteConfirmer(overwriteConfirmer);
     exporter.setProgressReporter(progress);
 
@@ -1046,10 +1123,14 @@ void MainWindow::onExportImageSeqTriggered(const QString& aSuffix)
 void MainWindow::onExportVideoTriggered(const ctrl::VideoFormat& aFormat)
 {
     if (!mCurrent) return;
+    const QString suffix = aFormat.name;
+    const bool isGif = (suffix == "gif");
+
     QSettings settings;
     settings.sync();
     auto ffCheck = settings.value("ffmpeg_check");
-    if(!ffCheck.isValid() || ffCheck == true){
+    // gif is encoded without ffmpeg
+    if(!isGif && (!ffCheck.isValid() || ffCheck == true)){
         util::NetworkUtil networking;
         QFileInfo ffmpeg_file;
         QString ffmpeg;
@@ -1094,9 +1175,7 @@ void MainWindow::onExportVideoTriggered(const ctrl::VideoFormat& aFormat)
     // stop animation and main display rendering
     EventSuspender suspender(*mMainDisplay, *mTarget);
 
-    const QString suffix = aFormat.name;
     const QString targetVideos = "Videos (*." + suffix + ")";
-    const bool isGif = (suffix == "gif");
 
     // get export file name
     QString fileName = QFileDialog::getSaveFileName(
@@ -1125,6 +1204,9 @@ void MainWindow::onExportVideoTriggered(const ctrl::VideoFormat& aFormat)
     ctrl::Exporter::CommonParam cparam;
     ctrl::Exporter::VideoParam vparam;
     ctrl::Exporter::GifParam gparam;
+    int shardCount = 1;
+    bool addsImages = false;
+    bool addsGif = false;
     if (isGif)
     {
         QScopedPointer<GifExportDialog> dialog(
@@ -1134,6 +1216,8 @@ void MainWindow::onExportVideoTriggered(const ctrl::VideoFormat& aFormat)
 
         cparam = dialog->commonParam();
         gparam = dialog->gifParam();
+        shardCount = dialog->shardCount();
+        addsImages = dialog->addsImageSequence();
     }
     else
     {
@@ -1145,19 +1229,82 @@ void MainWindow::onExportVideoTriggered(const ctrl::VideoFormat& aFormat)
 
         cparam = dialog->commonParam();
         vparam = dialog->videoParam();
+        shardCount = dialog->shardCount();
+        addsImages = dialog->addsImageSequence();
+        addsGif = dialog->addsGif();
     }
     //vparam.codec = codec;
 
+    // the added outputs are written beside the file
+    QVector<ctrl::Exporter::SinkParam> sinks;
+    if (addsImages || addsGif)
+    {
+        const QFileInfo outInfo(fileName);
+        const QString base = outInfo.dir().filePath(outInfo.completeBaseName());
+
+        ctrl::Exporter::SinkParam sink;
+        sink.path = fileName;
+        sink.size = cparam.size;
+        sink.type = isGif ? ctrl::Exporter::SinkType_Gif : ctrl::Exporter::SinkType_Video;
+        sink.gif = gparam;
+        sink.video = vparam;
+        sinks.push_back(sink);
+
+        if (addsImages)
+        {
+            ctrl::Exporter::SinkParam images;
+            images.type = ctrl::Exporter::SinkType_Image;
+            images.path = base + "_png";
+            images.size = cparam.size;
+            images.image.name = outInfo.completeBaseName() + "_";
+            images.image.suffix = "png";
+            if (!QDir().mkpath(images.path))
+            {
+                QMessageBox::warning(nullptr, tr("Operation Error"),
+                                     tr("Failed to create the folder of the png sequence."));
+                return;
+            }
+            sinks.push_back(images);
+        }
+
+        if (addsGif)
+        {
+            ctrl::Exporter::SinkParam gif;
+            gif.type = ctrl::Exporter::SinkType_Gif;
+            gif.path = base + ".gif";
+            gif.size = cparam.size;
+            sinks.push_back(gif);
+        }
+    }
+
     menu::LoggableProgressReporter progress(true, this);
-    ctrl::Exporter exporter(*mCurrent);
-    exporter.setOverwriteConfirmer([=](const QString&)->bool { return true; });
-    exporter.setProgressReporter(progress);
-    exporter.setUILogger(progress);
+    ctrl::Exporter::Result result;
+    QString log;
 
     // execute
-    auto result = isGif ?
-                exporter.execute(cparam, gparam) :
-                exporter.execute(cparam, vparam);
+    if (!sinks.isEmpty())
+    {
+        ctrl::Exporter exporter(*mCurrent);
+        exporter.setOverwriteConfirmer([=](const QString&)->bool { return true; });
+        exporter.setProgressReporter(progress);
+        exporter.setUILogger(progress);
+
+        result = exporter.execute(cparam, sinks);
+        log = exporter.log();
+    }
+    else
+    {
+        ctrl::ShardedExporter exporter(*mCurrent);
+        exporter.setShardCount(shardCount);
+        exporter.setOverwriteConfirmer([=](const QString&)->bool { return true; });
+        exporter.setProgressReporter(progress);
+        exporter.setUILogger(progress);
+
+        result = isGif ?
+                    exporter.execute(cparam, gparam) :
+                    exporter.execute(cparam, vparam);
+        log = exporter.log();
+    }
 
     if (!result)
     {
@@ -1182,7 +1329,7 @@ void MainWindow::onExportVideoTriggered(const ctrl::VideoFormat& aFormat)
         }
         else
         {
-            QMessageBox::warning(nullptr, tr("Export Error"), exporter.log());
+            QMessageBox::warning(nullptr, tr("Export Error"), log);
         }
     }
 }
@@ -23,7 +23,6 @@
 #include "gui/ResourceDialog.h"
 #include "gui/LocaleParam.h"
 #include "gui/MouseSetting.h"
-#include "qfilesystemwatcher.h"
 #include "res/res_ResourceUpdater.h"
 
 namespace gui
@@ -43,7 +42,6 @@ public:
     void saveCurrentSettings(int aResultCode);
     void testNewProject(const QString& aFilePath);
     void closeAllProjects();
-    static QFileSystemWatcher* getWatcher();
     QElapsedTimer timeElapsed;
     qint64 lastPress;
     qint64 lastRelease;
@@ -75,6 +73,10 @@ private:
     virtual void closeEvent(QCloseEvent* aEvent);
 
     void resetProjectRefs(core::Project* aProject);
+    core::GridMesh::MeshingParam meshingSetting() const;
+    void applyGeneralSettings(core::Project& aProject) const;
+    void applyToolSettings();
+    void onGeneralSettingsChanged();
     bool processProjectSaving(core::Project& aProject, bool aRename = false);
     int confirmProjectClosing(bool aCurrentOnly);
     void onProjectTabChanged(core::Project&);
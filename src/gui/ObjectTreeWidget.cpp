@@ -582,7 +582,7 @@ void ObjectTreeWidget::onObjectActionTriggered(bool)
 							resNode->data().identifier(),
 							mProject->objectTree().shaderHolder());
 				ptr->setVisibility(true);
-				ptr->setDefaultImage(resNode->handle());
+				ptr->setDefaultImage(resNode->handle(), true, mProject->meshingParam());
 				ptr->setDefaultPosture(QVector2D());
 				ptr->setDefaultDepth(depth);
 				ptr->setDefaultOpacity(1.0f); // @todo support default opacity
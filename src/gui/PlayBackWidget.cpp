@@ -17,6 +17,7 @@ PlayBackWidget::PlayBackWidget(GUIResources& aResources, QWidget* aParent)
     : QWidget(aParent)
     , mGUIResources(aResources)
     , mButtons()
+    , mRateLabel()
 {
     this->setGeometry(0, 0, kButtonSize, kButtonSize * kButtonCount);
 
@@ -27,6 +28,13 @@ PlayBackWidget::PlayBackWidget(GUIResources& aResources, QWidget* aParent)
     mButtons.push_back(createButton("fast",     false, 4, tr("Advance to final frame")));
     mButtons.push_back(createButton("loop",     true,  5, tr("Loop")));
 
+    mRateLabel = new QLabel(this);
+    mRateLabel->setObjectName("playbackrate");
+    mRateLabel->setAlignment(Qt::AlignCenter);
+    mRateLabel->setToolTip(tr("Achieved / target frames per second"));
+    mRateLabel->setGeometry(0, 2 + kButtonSize * 6, kButtonSize, kButtonSize + 4);
+    mRateLabel->hide();
+
     mGUIResources.onThemeChanged.connect(this, &PlayBackWidget::onThemeUpdated);
 }
 
@@ -103,6 +111,18 @@ void PlayBackWidget::pushPauseButton()
     }
 }
 
+void PlayBackWidget::setPlayBackRate(float aAchieved, int aTarget)
+{
+    if (aAchieved < 0.0f)
+    {
+        mRateLabel->clear();
+        mRateLabel->hide();
+        return;
+    }
+    mRateLabel->setText(QString::number(qRound(aAchieved)) + "\n/" + QString::number(aTarget));
+    mRateLabel->show();
+}
+
 QPushButton* PlayBackWidget::createButton(
         const QString& aName, bool aIsCheckable, int aColumn, const QString& aToolTip)
 {
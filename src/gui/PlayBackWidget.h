@@ -5,6 +5,7 @@
 #include <functional>
 #include <QWidget>
 #include <QPushButton>
+#include <QLabel>
 #include "gui/GUIResources.h"
 
 namespace gui
@@ -36,12 +37,16 @@ public:
     int constantWidth() const;
     void pushPauseButton();
 
+    // frames per second which the display achieves, a negative value hides it
+    void setPlayBackRate(float aAchieved, int aTarget);
+
 private:
     QPushButton* createButton(
             const QString& aName, bool aIsCheckable,
             int aColumn, const QString& aToolTip);
     GUIResources& mGUIResources;
     std::vector<QPushButton*> mButtons;
+    QLabel* mRateLabel;
     PushDelegate mPushDelegate;
     void onThemeUpdated(theme::Theme&);
 };
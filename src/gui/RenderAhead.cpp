@@ -0,0 +1,363 @@
+#include <memory>
+#include <algorithm>
+#include <vector>
+#include <QCoreApplication>
+#include <QOpenGLFramebufferObject>
+#include <QMutexLocker>
+#include "XC.h"
+#include "util/Finally.h"
+#include "util/Profiler.h"
+#include "gl/Util.h"
+#include "gl/VertexArrayObject.h"
+#include "gl/GPUProfiler.h"
+#include "core/ClippingFrame.h"
+#include "core/DestinationTexturizer.h"
+#include "gui/RenderAhead.h"
+
+namespace
+{
+// retry interval while the project is locked by another task
+static const unsigned long kRetryMSec = 2;
+}
+
+namespace gui
+{
+
+//-------------------------------------------------------------------------------------------------
+RenderAhead::RenderAhead(QOpenGLContext& aShareContext, QReadWriteLock& aRenderingLock, int aRingSize)
+    : mShareContext(aShareContext)
+    , mRenderingLock(aRenderingLock)
+    , mRingSize(std::max(aRingSize, 1))
+    , mIsValid(false)
+    , mIsRunning(false)
+    , mSurface()
+    , mContext()
+    , mThread(*this)
+    , mProject()
+    , mTime()
+    , mFrameSize()
+    , mMutex()
+    , mCondition()
+    , mSlots()
+    , mNext(-1)
+    , mShown(-1)
+    , mGeneration(0)
+    , mPauseCount(0)
+    , mQuit(false)
+{
+    // the surface has to be created on the gui thread
+    mSurface.setFormat(mShareContext.format());
+    mSurface.create();
+
+    mContext.reset(new QOpenGLContext());
+    mContext->setFormat(mShareContext.format());
+    mContext->setShareContext(&mShareContext);
+    mIsValid = mSurface.isValid() && mContext->create() &&
+            mContext->shareContext() == &mShareContext;
+}
+
+RenderAhead::~RenderAhead()
+{
+    stop();
+    mContext.reset();
+    mSurface.destroy();
+}
+
+void RenderAhead::start(core::Project& aProject, const core::TimeInfo& aTime, const QSize& aSize)
+{
+    stop();
+    if (!mIsValid || aSize.isEmpty() || aTime.frameMax < 0) return;
+
+    mProject = &aProject;
+    mTime = aTime;
+    mFrameSize = aSize;
+
+    mSlots.fill(Slot(), mRingSize);
+    mNext = (aTime.frame.get() + 1) % frameCount();
+    mShown = -1;
+    ++mGeneration;
+    mQuit = false;
+
+    mContext->moveToThread(&mThread);
+    mThread.start();
+    mIsRunning = true;
+}
+
+void RenderAhead::stop()
+{
+    if (!mIsRunning) return;
+    {
+        QMutexLocker locker(&mMutex);
+        mQuit = true;
+        mCondition.wakeAll();
+    }
+    mThread.wait();
+
+    mIsRunning = false;
+    mProject = nullptr;
+    mSlots.clear();
+    mNext = -1;
+    mShown = -1;
+}
+
+void RenderAhead::pause()
+{
+    QMutexLocker locker(&mMutex);
+    ++mPauseCount;
+    waitIdle();
+}
+
+void RenderAhead::resume()
+{
+    QMutexLocker locker(&mMutex);
+    XC_ASSERT(mPauseCount > 0);
+    if (mPauseCount > 0) --mPauseCount;
+    mCondition.wakeAll();
+}
+
+void RenderAhead::invalidate()
+{
+    QMutexLocker locker(&mMutex);
+    // busy slots are discarded by the generation
+    ++mGeneration;
+    for (auto& slot : mSlots)
+    {
+        if (!slot.busy)
+        {
+            slot.frame = -1;
+            slot.ready = false;
+        }
+    }
+    mShown = -1;
+    mCondition.wakeAll();
+}
+
+GLuint RenderAhead::acquire(int aFrame, int& aShownFrame)
+{
+    aShownFrame = -1;
+    if (!mIsRunning) return 0;
+
+    QMutexLocker locker(&mMutex);
+
+    int found = -1;
+    for (int i = 0; i < mSlots.size(); ++i)
+    {
+        if (mSlots[i].ready && mSlots[i].frame == aFrame) found = i;
+    }
+    if (found >= 0) mShown = found;
+
+    // release the frames which the playback has passed
+    for (int i = 0; i < mSlots.size(); ++i)
+    {
+        Slot& slot = mSlots[i];
+        if (!slot.ready || i == mShown) continue;
+
+        const int ahead = distance(aFrame, slot.frame);
+        if (ahead == 0 || ahead > mRingSize)
+        {
+            slot.frame = -1;
+            slot.ready = false;
+        }
+    }
+
+    // skip the frames which can not be in time
+    const int next = distance(aFrame, mNext);
+    if (next == 0 || next > mRingSize + 1)
+    {
+        mNext = (aFrame + 1) % frameCount();
+    }
+    mCondition.wakeAll();
+
+    if (mShown < 0) return 0;
+    aShownFrame = mSlots[mShown].frame;
+    return mSlots[mShown].texture;
+}
+
+void RenderAhead::setupFittedCamera(
+        core::CameraInfo& aCamera, const QSize& aSize, const QSize& aImageSize)
+{
+    aCamera.reset(aSize, 1.0, aImageSize, QPoint());
+    aCamera.setScale((float)aSize.width() / aImageSize.width());
+    aCamera.setCenter(QVector2D(aSize.width() * 0.5f, aSize.height() * 0.5f));
+}
+
+void RenderAhead::run()
+{
+    mContext->makeCurrent(&mSurface);
+
+    auto functions = mContext->versionFunctions<gl::Global::Functions>();
+    if (functions && functions->initializeOpenGLFunctions())
+    {
+        gl::Global::setThreadFunctions(functions);
+        gl::Global::Functions& ggl = gl::Global::functions();
+        {
+#ifdef USE_GL_CORE_PROFILE
+            // vertex array objects are not shared
+            gl::VertexArrayObject vao;
+            vao.bind();
+#endif
+            // framebuffers are not shared, but their textures are
+            std::vector<std::unique_ptr<QOpenGLFramebufferObject>> framebuffers;
+            for (int i = 0; i < mRingSize; ++i)
+            {
+                framebuffers.emplace_back(new QOpenGLFramebufferObject(mFrameSize));
+                ggl.glBindTexture(GL_TEXTURE_2D, framebuffers.back()->texture());
+                ggl.glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+                ggl.glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+                ggl.glBindTexture(GL_TEXTURE_2D, 0);
+            }
+            {
+                QMutexLocker locker(&mMutex);
+                for (int i = 0; i < mRingSize; ++i)
+                {
+                    mSlots[i].texture = framebuffers[i]->texture();
+                }
+            }
+
+            core::ClippingFrame clippingFrame;
+            clippingFrame.resize(mFrameSize);
+            core::DestinationTexturizer texturizer;
+            texturizer.resize(mFrameSize);
+
+            int slot = 0;
+            int frame = 0;
+            int generation = 0;
+            while (waitJob(slot, frame, generation))
+            {
+                // the project is being modified by another task
+                if (!mRenderingLock.tryLockForRead())
+                {
+                    cancelJob(slot);
+                    QThread::msleep(kRetryMSec);
+                    continue;
+                }
+                util::Finally unlocker([=](){ this->mRenderingLock.unlock(); });
+
+                auto& framebuffer = *framebuffers[slot];
+                {
+                    util::ProfileZone zone("render ahead");
+                    QMutexLocker locker(&mProject->objectTree().timeCacheLock().rendering);
+
+                    clippingFrame.clearTexture();
+                    clippingFrame.resetClippingId();
+                    texturizer.clearTexture();
+
+                    framebuffer.bind();
+                    gl::Util::setViewportAsActualPixels(mFrameSize);
+                    gl::Util::clearColorBuffer(0.25f, 0.25f, 0.25f, 1.0f);
+                    gl::Util::resetRenderState();
+
+                    core::RenderInfo renderInfo;
+                    setupFittedCamera(renderInfo.camera, mFrameSize,
+                                      mProject->attribute().imageSize());
+                    renderInfo.time = mTime;
+                    renderInfo.time.frame = core::Frame(frame);
+                    renderInfo.framebuffer = framebuffer.handle();
+                    renderInfo.dest = framebuffer.texture();
+                    renderInfo.isGrid = false;
+                    renderInfo.clippingId = 0;
+                    renderInfo.clippingFrame = &clippingFrame;
+                    renderInfo.destTexturizer = &texturizer;
+
+                    // the working cache keeps the current frame of the editors
+                    mProject->objectTree().render(renderInfo, true);
+                    framebuffer.release();
+
+                    // the buffers of renderers are rewritten by the next rendering
+                    ggl.glFinish();
+                    GL_CHECK_ERROR();
+                }
+                finishJob(slot, frame, generation);
+                gl::GPUProfiler::resolve();
+            }
+        }
+        gl::GPUProfiler::clearThread();
+        gl::Global::setThreadFunctions(nullptr);
+    }
+
+    mContext->doneCurrent();
+    mContext->moveToThread(QCoreApplication::instance()->thread());
+}
+
+bool RenderAhead::waitJob(int& aSlot, int& aFrame, int& aGeneration)
+{
+    QMutexLocker locker(&mMutex);
+    while (!mQuit)
+    {
+        if (mPauseCount == 0 && mNext >= 0)
+        {
+            int free = -1;
+            bool nextIsDone = false;
+            for (int i = 0; i < mSlots.size(); ++i)
+            {
+                const Slot& slot = mSlots[i];
+                if ((slot.ready || slot.busy) && slot.frame == mNext) nextIsDone = true;
+                if (free < 0 && !slot.ready && !slot.busy && i != mShown) free = i;
+            }
+
+            if (nextIsDone)
+            {
+                mNext = (mNext + 1) % frameCount();
+                continue;
+            }
+
+            if (free >= 0)
+            {
+                Slot& slot = mSlots[free];
+                slot.busy = true;
+                slot.frame = mNext;
+                aSlot = free;
+                aFrame = mNext;
+                aGeneration = mGeneration;
+                mNext = (mNext + 1) % frameCount();
+                return true;
+            }
+        }
+        mCondition.wait(&mMutex);
+    }
+    return false;
+}
+
+void RenderAhead::finishJob(int aSlot, int aFrame, int aGeneration)
+{
+    QMutexLocker locker(&mMutex);
+    Slot& slot = mSlots[aSlot];
+    slot.busy = false;
+    slot.ready = (aGeneration == mGeneration);
+    slot.frame = slot.ready ? aFrame : -1;
+    mCondition.wakeAll();
+}
+
+void RenderAhead::cancelJob(int aSlot)
+{
+    QMutexLocker locker(&mMutex);
+    Slot& slot = mSlots[aSlot];
+    // retry the frame unless the playback has passed it
+    if (distance(slot.frame, mNext) <= mRingSize) mNext = slot.frame;
+    slot.busy = false;
+    slot.ready = false;
+    slot.frame = -1;
+    mCondition.wakeAll();
+}
+
+int RenderAhead::distance(int aFrom, int aTo) const
+{
+    const int count = frameCount();
+    return ((aTo - aFrom) % count + count) % count;
+}
+
+void RenderAhead::waitIdle()
+{
+    while (true)
+    {
+        bool busy = false;
+        for (auto& slot : mSlots)
+        {
+            if (slot.busy) busy = true;
+        }
+        if (!busy) return;
+        mCondition.wait(&mMutex);
+    }
+}
+
+} // namespace gui
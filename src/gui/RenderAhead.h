@@ -0,0 +1,111 @@
+#ifndef GUI_RENDERAHEAD_H
+#define GUI_RENDERAHEAD_H
+
+#include <QThread>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QReadWriteLock>
+#include <QScopedPointer>
+#include <QOpenGLContext>
+#include <QOffscreenSurface>
+#include <QVector>
+#include <QSize>
+#include "gl/Global.h"
+#include "core/Project.h"
+#include "core/TimeInfo.h"
+#include "core/RenderInfo.h"
+
+namespace gui
+{
+
+// Renders the frames following the displayed one on a thread which has a
+// context shared with the display. The frames are kept in a ring of
+// framebuffers, and the display takes the texture of a rendered frame
+// instead of rendering it. A frame which is not ready in time is dropped
+// and the thread continues from the frame after the displayed one.
+// Renderers keep their states of the last rendering, so the renderings of
+// both threads are serialized by the rendering mutex of the object tree.
+class RenderAhead
+{
+public:
+    RenderAhead(QOpenGLContext& aShareContext, QReadWriteLock& aRenderingLock, int aRingSize);
+    ~RenderAhead();
+
+    // false if the shared context is not available
+    bool isValid() const { return mIsValid; }
+    int ringSize() const { return mRingSize; }
+    QSize frameSize() const { return mFrameSize; }
+
+    void start(core::Project& aProject, const core::TimeInfo& aTime, const QSize& aSize);
+    void stop();
+    bool isRunning() const { return mIsRunning; }
+
+    // the editing waits for the current rendering, the calls are counted
+    void pause();
+    void resume();
+
+    // the rendered frames are obsolete
+    void invalidate();
+
+    // returns the texture of the frame, or the last returned texture if the
+    // frame is not ready, or 0. aShownFrame is set to the frame of the texture.
+    GLuint acquire(int aFrame, int& aShownFrame);
+
+    // the camera of a frame which fits the image to aSize
+    static void setupFittedCamera(core::CameraInfo& aCamera,
+                                  const QSize& aSize, const QSize& aImageSize);
+
+private:
+    class Thread : public QThread
+    {
+    public:
+        Thread(RenderAhead& aOwner) : mOwner(aOwner) {}
+    protected:
+        virtual void run() { mOwner.run(); }
+    private:
+        RenderAhead& mOwner;
+    };
+
+    struct Slot
+    {
+        Slot() : frame(-1), ready(), busy(), texture() {}
+        int frame;
+        bool ready;
+        bool busy;
+        GLuint texture;
+    };
+
+    void run();
+    bool waitJob(int& aSlot, int& aFrame, int& aGeneration);
+    void finishJob(int aSlot, int aFrame, int aGeneration);
+    void cancelJob(int aSlot);
+    int distance(int aFrom, int aTo) const;
+    int frameCount() const { return mTime.frameMax + 1; }
+    void waitIdle(); // mMutex has to be locked
+
+    QOpenGLContext& mShareContext;
+    QReadWriteLock& mRenderingLock;
+    const int mRingSize;
+    bool mIsValid;
+    bool mIsRunning;
+    QOffscreenSurface mSurface;
+    QScopedPointer<QOpenGLContext> mContext;
+    Thread mThread;
+
+    core::Project* mProject;
+    core::TimeInfo mTime;
+    QSize mFrameSize;
+
+    QMutex mMutex;
+    QWaitCondition mCondition;
+    QVector<Slot> mSlots;
+    int mNext;
+    int mShown;
+    int mGeneration;
+    int mPauseCount;
+    bool mQuit;
+};
+
+} // namespace gui
+
+#endif // GUI_RENDERAHEAD_H
@@ -1,8 +1,5 @@
 #include <QMenu>
 #include <QFileDialog>
-#include <chrono>
-#include <thread>
-#include "qfilesystemwatcher.h"
 #include "qmessagebox.h"
 #include "util/TreeUtil.h"
 #include "cmnd/BasicCommands.h"
@@ -30,6 +27,7 @@ ResourceTreeWidget::ResourceTreeWidget(ViaPoint& aViaPoint, bool aUseCustomConte
     , mWatchRemove()
     , mDeleteAction()
     , mRenaming()
+    , mFileWatcher(new res::FileWatcher(aViaPoint, *this))
 {
     //this->setSelectionMode(QAbstractItemView::ExtendedSelection);
     this->setObjectName("resourceTree");
@@ -139,6 +137,9 @@ void ResourceTreeWidget::setProject(core::Project* aProject)
             resetTreeView(mProject->resourceHolder());
         }
     }
+
+    // reload the files modified while the project was not current
+    mFileWatcher->setProject(mProject.get());
 }
 
 void ResourceTreeWidget::load(const QString& aFileName)
@@ -352,29 +353,20 @@ void ResourceTreeWidget::onWatchTriggered(bool)
     if (!mProject) return;
     res::Item* item = res::Item::cast(mActionItem);
     if (!item) return;
-    if (!QFile(mProject->resourceHolder().findAbsoluteFilePath(item->node())).exists()){
-        MainWindow::showInfoPopup(tr("File not found"), tr("The file couldn't be found, please change "
-                                                           "its file path using the button above."), "Warn");
-        return;
-    }
-    auto fileWatcher = MainWindow::getWatcher();
 
-    qDebug() << "files : " << fileWatcher->files();
-    if (fileWatcher->files().contains(QString(mProject->resourceHolder().findAbsoluteFilePath(item->node())))){
+    img::ResourceNode& topNode = util::TreeUtil::getTreeRoot(item->node());
+    if (mFileWatcher->isWatching(*mProject, topNode))
+    {
         MainWindow::showInfoPopup(tr("Invalid Selection"), tr("Already watching for changes in this file"), "Warn");
         return;
     }
-    fileWatcher->addPath(mProject->resourceHolder().findAbsoluteFilePath(item->node()));
-    if (true){
-        connect(fileWatcher, &QFileSystemWatcher::fileChanged, this, [=]{
-            using namespace std::chrono;
-            using namespace std::this_thread;
-            sleep_for(milliseconds(500));
-            res::ResourceUpdater updater(mViaPoint, *mProject);
-            updater.reload(*item);});
-        MainWindow::showInfoPopup(tr("Success"), tr("This file will be monitored for changes."), "Info");
-        qDebug() << "Watching path: " << mProject->resourceHolder().findAbsoluteFilePath(item->node());
+    if (!mFileWatcher->watch(*mProject, topNode))
+    {
+        MainWindow::showInfoPopup(tr("File not found"), tr("The file couldn't be found, please change "
+                                                           "its file path using the button above."), "Warn");
+        return;
     }
+    MainWindow::showInfoPopup(tr("Success"), tr("This file will be monitored for changes."), "Info");
 }
 
 void ResourceTreeWidget::onWatchRemoveTriggered(bool)
@@ -383,15 +375,14 @@ void ResourceTreeWidget::onWatchRemoveTriggered(bool)
     res::Item* item = res::Item::cast(mActionItem);
     if (!item) return;
 
-    auto fileWatcher = MainWindow::getWatcher();
-
-    qDebug() << "files : " << fileWatcher->files();
-    if (fileWatcher->files().contains(QString(mProject->resourceHolder().findAbsoluteFilePath(item->node())))){
-        fileWatcher->removePath(mProject->resourceHolder().findAbsoluteFilePath(item->node()));
+    img::ResourceNode& topNode = util::TreeUtil::getTreeRoot(item->node());
+    if (mFileWatcher->isWatching(*mProject, topNode))
+    {
+        mFileWatcher->unwatch(*mProject, topNode);
         MainWindow::showInfoPopup(tr("Success"), tr("The file will no longer be monitored"), "Info");
-        return;
     }
-    else{
+    else
+    {
         MainWindow::showInfoPopup(tr("File not monitored"), tr("The file is not being currently monitored"), "Warn");
     }
 }
@@ -3,6 +3,7 @@
 
 #include <QTreeWidget>
 #include <QAction>
+#include <QScopedPointer>
 #include "util/Signaler.h"
 #include "util/LinkPointer.h"
 #include "cmnd/Stack.h"
@@ -11,6 +12,7 @@
 #include "core/Project.h"
 #include "gui/ViaPoint.h"
 #include "gui/res/res_Notifier.h"
+#include "gui/res/res_FileWatcher.h"
 
 namespace gui {
 
@@ -54,6 +56,7 @@ private:
     QAction* mWatchRemove;
     QAction* mDeleteAction;
     bool mRenaming;
+    QScopedPointer<res::FileWatcher> mFileWatcher;
 };
 
 } // namespace gui
@@ -70,12 +70,20 @@ void TargetWidget::stop()
 void TargetWidget::suspend()
 {
     ++mSuspendCount;
+    if (mSuspendCount == 1)
+    {
+        onSuspensionChanged(true);
+    }
 }
 
 void TargetWidget::resume()
 {
     XC_ASSERT(mSuspendCount > 0);
     --mSuspendCount;
+    if (mSuspendCount == 0)
+    {
+        onSuspensionChanged(false);
+    }
 }
 
 bool TargetWidget::isSuspended() const
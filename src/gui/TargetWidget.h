@@ -2,6 +2,7 @@
 #define GUI_CONTROLWIDGET_H
 
 #include <QSplitter>
+#include "util/Signaler.h"
 #include "gui/ObjectTreeWidget.h"
 #include "gui/TimeLineWidget.h"
 #include "gui/GUIResources.h"
@@ -41,6 +42,9 @@ public:
     virtual void resume();
     virtual bool isSuspended() const;
 
+    // boostlike signals
+    util::Signaler<void(bool)> onSuspensionChanged;
+
 private:
     virtual void resizeEvent(QResizeEvent* aEvent);
     virtual QSize sizeHint() const { return mSizeHint; }
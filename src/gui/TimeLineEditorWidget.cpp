@@ -291,19 +291,20 @@ void TimeLineEditorWidget::paintEvent(QPaintEvent* aEvent)
     painter.end();
 }
 
-void TimeLineEditorWidget::onTimeLineModified(core::TimeLineEvent&, bool)
+void TimeLineEditorWidget::onTimeLineModified(core::TimeLineEvent& aEvent, bool)
 {
     if (!mOnPasting)
     {
         mCopyTargets = core::TimeLineEvent();
     }
-    mEditor->updateKey();
+    mEditor->updateKey(aEvent);
     this->update();
 }
 
 void TimeLineEditorWidget::onTreeRestructured(core::ObjectTreeEvent&, bool)
 {
     mCopyTargets = core::TimeLineEvent();
+    mEditor->updateTree();
 }
 
 void TimeLineEditorWidget::onProjectAttributeModified(core::ProjectEvent&, bool)
@@ -27,6 +27,7 @@ TimeLineWidget::TimeLineWidget(GUIResources& aResources, ViaPoint& aViaPoint, co
     this->setHorizontalScrollBarPolicy(Qt::ScrollBarAsNeeded);
     this->setVerticalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
     this->setMouseTracking(true);
+    mTimer.setTimerType(Qt::PreciseTimer); // cached frames play at the exact fps
     this->connect(&mTimer, &QTimer::timeout, this, &TimeLineWidget::onPlayBackUpdated);
 
     mGUIResources.onThemeChanged.connect(this, &TimeLineWidget::onThemeUpdated);
@@ -94,6 +94,11 @@ void ToolWidget::setDriver(ctrl::Driver* aDriver)
     }
 }
 
+void ToolWidget::setFFDDispatchParam(bool aAsyncReadback, int aSampleBudget)
+{
+    mFFDPanel->setDispatchParam(aAsyncReadback, aSampleBudget);
+}
+
 void ToolWidget::createViewPanel()
 {
     if (mViewPanel) delete mViewPanel;
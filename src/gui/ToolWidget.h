@@ -29,6 +29,7 @@ public:
                const QSize& aSizeHint, QWidget* aParent);
 
     void setDriver(ctrl::Driver* aDriver);
+    void setFFDDispatchParam(bool aAsyncReadback, int aSampleBudget);
 
     util::Signaler<void()> onVisualUpdated;
     util::Signaler<void(ctrl::ToolType)> onToolChanged;
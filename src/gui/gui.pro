@@ -57,6 +57,8 @@ DEPENDPATH  += ..
 SOURCES += \
     Main.cpp \
     MainDisplayWidget.cpp \
+    FrameCache.cpp \
+    RenderAhead.cpp \
     MainWindow.cpp \
     ObjectTreeWidget.cpp \
     PlayBackWidget.cpp \
@@ -96,6 +98,7 @@ SOURCES += \
     MainMenuBar.cpp \
     tool/tool_SRTPanel.cpp \
     res/res_ResourceUpdater.cpp \
+    res/res_FileWatcher.cpp \
     ProjectHook.cpp \
     ProjectTabBar.cpp \
     EasyDialog.cpp \
@@ -124,6 +127,8 @@ SOURCES += \
 HEADERS += \
     MainDisplayMode.h \
     MainDisplayWidget.h \
+    FrameCache.h \
+    RenderAhead.h \
     MainWindow.h \
     ObjectTreeWidget.h \
     PlayBackWidget.h \
@@ -165,6 +170,7 @@ HEADERS += \
     MainMenuBar.h \
     tool/tool_SRTPanel.h \
     res/res_ResourceUpdater.h \
+    res/res_FileWatcher.h \
     ProjectHook.h \
     ProjectTabBar.h \
     EasyDialog.h \
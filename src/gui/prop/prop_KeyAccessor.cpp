@@ -424,7 +424,7 @@ void KeyAccessor::knockNewImage(const img::ResourceHandle& aHandle)
     ASSERT_AND_RETURN_INVALID_TARGET();
     auto newKey = new core::ImageKey();
     newKey->setImage(aHandle);
-    newKey->resetGridMesh();
+    newKey->resetGridMesh(core::ImageKey::kDefaultMeshCellSize, mProject->meshingParam());
     newKey->setImageOffsetByCenter();
 
     ctrl::TimeLineUtil::pushNewImageKey(*mProject, *mTarget, getFrame(), newKey);
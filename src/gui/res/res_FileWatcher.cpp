@@ -0,0 +1,433 @@
+#include <fstream>
+#include <vector>
+#include <QSet>
+#include <QFileInfo>
+#include <QImage>
+#include <QRunnable>
+#include "util/Finally.h"
+#include "thr/ParallelFor.h"
+#include "img/PSDReader.h"
+#include "img/Util.h"
+#include "gui/res/res_Item.h"
+#include "gui/res/res_ResourceUpdater.h"
+#include "gui/res/res_FileWatcher.h"
+
+namespace
+{
+// editors write a file in several steps
+static const int kQuietMSec = 500;
+
+img::ResourceNode* parseTree(
+        const QString& aFilePath, std::unique_ptr<img::PSDFormat>& aFormat, QString& aError)
+{
+    const QFileInfo fileInfo(aFilePath);
+    if (!fileInfo.isFile())
+    {
+        aError = gui::res::FileWatcher::tr("File not found.");
+        return nullptr;
+    }
+
+    if (fileInfo.suffix() == "psd")
+    {
+        std::ifstream file(aFilePath.toLocal8Bit(), std::ios::binary);
+        if (file.fail())
+        {
+            aError = gui::res::FileWatcher::tr("Failed to open the file.");
+            return nullptr;
+        }
+
+        img::PSDReader reader(file);
+        if (reader.resultCode() != img::PSDReader::ResultCode_Success)
+        {
+            aError = "error(" + QString::number(reader.resultCode()) + ") " +
+                    QString::fromStdString(reader.resultMessage());
+            return nullptr;
+        }
+        file.close();
+
+        aFormat = std::move(reader.format());
+        return img::Util::createResourceNodes(*aFormat, false);
+    }
+
+    QImage image(aFilePath);
+    if (image.isNull())
+    {
+        aError = gui::res::FileWatcher::tr("Failed to load image file.");
+        return nullptr;
+    }
+    return img::Util::createResourceNode(image, fileInfo.baseName(), false);
+}
+
+// decode the layers which are not in the current tree
+void decodeUnknownLayers(img::ResourceNode& aTree, const QSet<uint64>& aKnownHashes)
+{
+    std::vector<img::ResourceData*> targets;
+    img::ResourceNode::Iterator itr(&aTree);
+    while (itr.hasNext())
+    {
+        auto& data = itr.next()->data();
+        if (data.isLayer() && !aKnownHashes.contains(data.contentHash()))
+        {
+            targets.push_back(&data);
+        }
+    }
+
+    thr::ParallelFor::run((int)targets.size(), 1, [&](int aBegin, int aEnd)
+    {
+        for (int i = aBegin; i < aEnd; ++i)
+        {
+            auto success = targets[i]->loadImage();
+            XC_ASSERT(success); (void)success;
+        }
+    });
+}
+
+bool holdsTree(const core::Project& aProject, const img::ResourceNode* aTopNode)
+{
+    for (auto& tree : aProject.resourceHolder().imageTrees())
+    {
+        if (tree.topNode == aTopNode) return true;
+    }
+    return false;
+}
+}
+
+namespace gui {
+namespace res {
+
+//-------------------------------------------------------------------------------------------------
+struct FileWatcher::Entry
+{
+    Entry()
+        : id()
+        , project()
+        , topNode()
+        , path()
+        , timer()
+        , pending()
+        , running()
+        , dirty()
+    {
+    }
+
+    int id;
+    util::LinkPointer<core::Project> project;
+    const img::ResourceNode* topNode;
+    QString path;
+    QTimer timer;
+    bool pending; // modified while the project is not current
+    bool running;
+    bool dirty; // modified while running
+};
+
+//-------------------------------------------------------------------------------------------------
+struct FileWatcher::Job
+{
+    Job()
+        : entryId()
+        , path()
+        , knownHashes()
+        , format()
+        , tree()
+        , error()
+    {
+    }
+
+    int entryId;
+    QString path;
+    QSet<uint64> knownHashes;
+    std::unique_ptr<img::PSDFormat> format;
+    std::unique_ptr<img::ResourceNode> tree;
+    QString error;
+};
+
+//-------------------------------------------------------------------------------------------------
+class FileWatcher::Runner : public QRunnable
+{
+public:
+    Runner(FileWatcher& aOwner, const std::shared_ptr<Job>& aJob)
+        : mOwner(aOwner)
+        , mJob(aJob)
+    {
+    }
+
+    virtual void run()
+    {
+        Job& job = *mJob;
+        job.tree.reset(parseTree(job.path, job.format, job.error));
+        if (job.tree)
+        {
+            decodeUnknownLayers(*job.tree, job.knownHashes);
+        }
+
+        FileWatcher* owner = &mOwner;
+        std::shared_ptr<Job> result = mJob;
+        QMetaObject::invokeMethod(owner, [=]() { owner->onJobFinished(result); },
+                                  Qt::QueuedConnection);
+    }
+
+private:
+    FileWatcher& mOwner;
+    std::shared_ptr<Job> mJob;
+};
+
+//-------------------------------------------------------------------------------------------------
+FileWatcher::FileWatcher(ViaPoint& aViaPoint, QTreeWidget& aTree)
+    : mViaPoint(aViaPoint)
+    , mTree(aTree)
+    , mProject()
+    , mWatcher()
+    , mPool()
+    , mEntries()
+    , mNextId(0)
+{
+    // one file at a time, parsing itself runs in parallel
+    mPool.setMaxThreadCount(1);
+
+    this->connect(&mWatcher, &QFileSystemWatcher::fileChanged,
+                  this, &FileWatcher::onFileChanged);
+}
+
+FileWatcher::~FileWatcher()
+{
+    // results posted after this are discarded with the object
+    mPool.waitForDone();
+    qDeleteAll(mEntries);
+    mEntries.clear();
+}
+
+void FileWatcher::setProject(core::Project* aProject)
+{
+    if (aProject)
+    {
+        mProject = aProject->pointee();
+    }
+    else
+    {
+        mProject.reset();
+    }
+
+    removeDeadEntries();
+    if (!mProject) return;
+
+    // reload the files which were modified meanwhile
+    for (auto entry : mEntries)
+    {
+        if (entry->pending && entry->project.get() == mProject.get())
+        {
+            entry->pending = false;
+            onQuiet(*entry);
+        }
+    }
+}
+
+bool FileWatcher::watch(core::Project& aProject, img::ResourceNode& aTopNode)
+{
+    removeDeadEntries();
+    if (findEntry(aProject, aTopNode)) return true;
+
+    const QString path = aProject.resourceHolder().findAbsoluteFilePath(aTopNode);
+    if (path.isEmpty() || !QFileInfo(path).isFile()) return false;
+
+    auto entry = new Entry();
+    entry->id = mNextId++;
+    entry->project = aProject.pointee();
+    entry->topNode = &aTopNode;
+    entry->path = path;
+    entry->timer.setSingleShot(true);
+    entry->timer.setInterval(kQuietMSec);
+    this->connect(&entry->timer, &QTimer::timeout, this, [=]() { this->onQuiet(*entry); });
+    mEntries.push_back(entry);
+
+    if (!mWatcher.files().contains(path))
+    {
+        mWatcher.addPath(path);
+    }
+    return true;
+}
+
+void FileWatcher::unwatch(const core::Project& aProject, const img::ResourceNode& aTopNode)
+{
+    auto entry = findEntry(aProject, aTopNode);
+    if (entry)
+    {
+        removeEntry(entry);
+    }
+}
+
+bool FileWatcher::isWatching(const core::Project& aProject, const img::ResourceNode& aTopNode) const
+{
+    return findEntry(aProject, aTopNode);
+}
+
+FileWatcher::Entry* FileWatcher::findEntry(
+        const core::Project& aProject, const img::ResourceNode& aTopNode) const
+{
+    for (auto entry : mEntries)
+    {
+        if (entry->project.get() == &aProject && entry->topNode == &aTopNode)
+        {
+            return entry;
+        }
+    }
+    return nullptr;
+}
+
+FileWatcher::Entry* FileWatcher::findEntry(int aId) const
+{
+    for (auto entry : mEntries)
+    {
+        if (entry->id == aId) return entry;
+    }
+    return nullptr;
+}
+
+void FileWatcher::removeEntry(Entry* aEntry)
+{
+    XC_PTR_ASSERT(aEntry);
+    const QString path = aEntry->path;
+    mEntries.removeOne(aEntry);
+    delete aEntry;
+
+    for (auto entry : mEntries)
+    {
+        if (entry->path == path) return;
+    }
+    mWatcher.removePath(path);
+}
+
+void FileWatcher::removeDeadEntries()
+{
+    QList<Entry*> deads;
+    for (auto entry : mEntries)
+    {
+        if (!entry->project) deads.push_back(entry);
+    }
+    for (auto entry : deads)
+    {
+        removeEntry(entry);
+    }
+}
+
+void FileWatcher::onFileChanged(const QString& aPath)
+{
+    removeDeadEntries();
+
+    // some editors replace the file, which drops it from the watcher
+    if (!mWatcher.files().contains(aPath) && QFileInfo(aPath).isFile())
+    {
+        mWatcher.addPath(aPath);
+    }
+
+    for (auto entry : mEntries)
+    {
+        if (entry->path == aPath)
+        {
+            entry->timer.start();
+        }
+    }
+}
+
+void FileWatcher::onQuiet(Entry& aEntry)
+{
+    if (!mWatcher.files().contains(aEntry.path) && QFileInfo(aEntry.path).isFile())
+    {
+        mWatcher.addPath(aEntry.path);
+    }
+
+    if (!aEntry.project) return;
+
+    if (aEntry.project.get() != mProject.get())
+    {
+        aEntry.pending = true;
+    }
+    else if (aEntry.running)
+    {
+        aEntry.dirty = true;
+    }
+    else
+    {
+        startJob(aEntry);
+    }
+}
+
+void FileWatcher::startJob(Entry& aEntry)
+{
+    const core::Project& project = *aEntry.project;
+    if (!holdsTree(project, aEntry.topNode)) return;
+
+    std::shared_ptr<Job> job = std::make_shared<Job>();
+    job->entryId = aEntry.id;
+    job->path = aEntry.path;
+
+    // the layers which have these sources are not decoded
+    img::ResourceNode::ConstIterator itr(aEntry.topNode);
+    while (itr.hasNext())
+    {
+        const uint64 hash = itr.next()->data().contentHash();
+        if (hash != 0) job->knownHashes.insert(hash);
+    }
+
+    aEntry.running = true;
+    mPool.start(new Runner(*this, job));
+}
+
+void FileWatcher::onJobFinished(const std::shared_ptr<Job>& aJob)
+{
+    Entry* entry = findEntry(aJob->entryId);
+    if (!entry) return;
+
+    entry->running = false;
+
+    if (!aJob->tree)
+    {
+        // a file being written fails, the next notification retries
+        mViaPoint.pushLog(tr("Failed to reload ") + QFileInfo(entry->path).fileName() +
+                          " : " + aJob->error, ctrl::UILogType_Warn);
+    }
+    else if (entry->project && entry->project.get() == mProject.get())
+    {
+        apply(*entry, *aJob);
+    }
+    else
+    {
+        entry->pending = true;
+    }
+
+    if (entry->dirty)
+    {
+        entry->dirty = false;
+        entry->timer.start();
+    }
+}
+
+bool FileWatcher::apply(Entry& aEntry, Job& aJob)
+{
+    core::Project& project = *aEntry.project;
+    if (!holdsTree(project, aEntry.topNode)) return false;
+
+    Item* item = nullptr;
+    for (int i = 0; i < mTree.topLevelItemCount(); ++i)
+    {
+        auto topItem = Item::cast(mTree.topLevelItem(i));
+        if (topItem && &topItem->node() == aEntry.topNode)
+        {
+            item = topItem;
+            break;
+        }
+    }
+    if (!item) return false;
+
+    // the playback renderers must not see the tree being replaced
+    project.animator().suspend();
+    util::Finally resumer([&](){ project.animator().resume(); });
+
+    ResourceUpdater updater(mViaPoint, project);
+    if (!updater.reload(*item, *aJob.tree)) return false;
+
+    mViaPoint.pushLog(tr("Reloaded ") + QFileInfo(aEntry.path).fileName(), ctrl::UILogType_Info);
+    return true;
+}
+
+} // namespace res
+} // namespace gui
@@ -0,0 +1,66 @@
+#ifndef GUI_RES_FILEWATCHER_H
+#define GUI_RES_FILEWATCHER_H
+
+#include <memory>
+#include <QObject>
+#include <QList>
+#include <QTimer>
+#include <QThreadPool>
+#include <QFileSystemWatcher>
+#include <QTreeWidget>
+#include "util/LinkPointer.h"
+#include "img/ResourceNode.h"
+#include "core/Project.h"
+#include "gui/ViaPoint.h"
+
+namespace gui {
+namespace res {
+
+// Watches the files of image trees and reloads them after modifications.
+// A modified file is parsed on a worker thread after a short quiet time,
+// and only the layers with unknown sources are decoded there. The result
+// is applied on the gui thread as one undoable command.
+// The trees of the projects which are not current are reloaded when
+// the project becomes current again.
+class FileWatcher : public QObject
+{
+    Q_OBJECT
+public:
+    FileWatcher(ViaPoint& aViaPoint, QTreeWidget& aTree);
+    ~FileWatcher();
+
+    void setProject(core::Project* aProject);
+
+    // returns false if the file does not exist
+    bool watch(core::Project& aProject, img::ResourceNode& aTopNode);
+    void unwatch(const core::Project& aProject, const img::ResourceNode& aTopNode);
+    bool isWatching(const core::Project& aProject, const img::ResourceNode& aTopNode) const;
+
+private:
+    struct Entry;
+    struct Job;
+    class Runner;
+
+    Entry* findEntry(const core::Project& aProject, const img::ResourceNode& aTopNode) const;
+    Entry* findEntry(int aId) const;
+    void removeEntry(Entry* aEntry);
+    void removeDeadEntries();
+    void onFileChanged(const QString& aPath);
+    void onQuiet(Entry& aEntry);
+    void startJob(Entry& aEntry);
+    void onJobFinished(const std::shared_ptr<Job>& aJob);
+    bool apply(Entry& aEntry, Job& aJob);
+
+    ViaPoint& mViaPoint;
+    QTreeWidget& mTree;
+    util::LinkPointer<core::Project> mProject;
+    QFileSystemWatcher mWatcher;
+    QThreadPool mPool;
+    QList<Entry*> mEntries;
+    int mNextId;
+};
+
+} // namespace res
+} // namespace gui
+
+#endif // GUI_RES_FILEWATCHER_H
@@ -12,14 +12,17 @@ class ImageSetter : public cmnd::Stable
     img::ResourceNode& mNode;
     XCMemBlock mBlock;
     QRect mRect;
+    uint64 mContentHash;
     img::ResourceHandle mAnotherHandle;
     bool mDoneOnce;
 
 public:
-    ImageSetter(img::ResourceNode& aNode, const XCMemBlock& aBlock, const QRect& aRect)
+    ImageSetter(img::ResourceNode& aNode, const XCMemBlock& aBlock, const QRect& aRect,
+                uint64 aContentHash = 0)
         : mNode(aNode)
         , mBlock(aBlock)
         , mRect(aRect)
+        , mContentHash(aContentHash)
         , mAnotherHandle()
         , mDoneOnce(false)
     {
@@ -37,9 +40,17 @@ public:
     void exec()
     {
         mAnotherHandle = mNode.updateHandle(mBlock, mRect);
+        mNode.data().setContentHash(mContentHash);
         mDoneOnce = true;
     }
 
+    // the image which is not on the node
+    size_t byteSize() const
+    {
+        if (!mDoneOnce) return mBlock.size;
+        return mAnotherHandle ? mAnotherHandle->image().size() : 0;
+    }
+
     void redo()
     {
         mNode.swapData(mAnotherHandle);
@@ -137,6 +137,20 @@ public:
         redo();
     }
 
+    // the images of the removed tree
+    virtual size_t byteSize() const
+    {
+        if (!mDone || !mTree.topNode) return 0;
+
+        size_t size = 0;
+        img::ResourceNode::ConstIterator itr(mTree.topNode);
+        while (itr.hasNext())
+        {
+            size += itr.next()->data().image().size();
+        }
+        return size;
+    }
+
     virtual void undo()
     {
         mHolder.insertImageTree(mTree, mIndex);
@@ -409,14 +423,20 @@ void ResourceUpdater::reload(Item& aItem)
     QScopedPointer<img::ResourceNode> newTree(createResourceTree(filePath, false));
     if (!newTree) return;
 
+    reload(aItem, *newTree);
+}
+
+bool ResourceUpdater::reload(Item& aItem, img::ResourceNode& aNewTree)
+{
     RESOURCE_UPDATER_DUMP("begin reload");
 
     // reload images
-    if (!tryReloadCorrespondingImages(aItem, newTree.data()))
+    if (!tryReloadCorrespondingImages(aItem, &aNewTree))
     {
-        return;
+        return false;
     }
     RESOURCE_UPDATER_DUMP("end reload");
+    return true;
 }
 
 std::pair<int, img::ResourceNode*> findCorrespondingNode(
@@ -491,7 +511,7 @@ img::ResourceNode* createNewAppendNode(ModificationNotifier& aNotifier, img::Res
 
     aNotifier.event().pushTarget(*newNode);
 
-    if (newNode->data().isLayer())
+    if (newNode->data().isLayer() && !newNode->data().hasImage())
     {
         auto success = newNode->data().loadImage();
         XC_ASSERT(success); (void)success;
@@ -538,25 +558,39 @@ bool ResourceUpdater::createImageReloaderRecursive(
     {
         XC_ASSERT(aNewNode.data().isLayer());
 
-        // load new image
-        auto success = aNewNode.data().loadImage();
-        XC_ASSERT(success); (void)success;
-
-        // if layer data be modified
-        if (!aCurNode.data().hasSameLayerDataWith(aNewNode.data()))
+        if (aCurNode.data().hasSameLayerSourceWith(aNewNode.data()))
         {
-            // push to targets
-            aNotifier.event().pushTarget(aCurNode);
-
-            // push reload image command
-            XCMemBlock newImagePtr = aNewNode.data().image().block();
-            const QRect newImageRect(aNewNode.data().pos(), aNewNode.data().image().pixelSize());
-            aNewNode.data().releaseImage();
-            aStack.push(new ImageSetter(aCurNode, newImagePtr, newImageRect));
+            // the source is not modified, so the image need not be decoded
+            RESOURCE_UPDATER_DUMP("skip unmodified image");
         }
         else
         {
-            aNewNode.data().freeImage();
+            // load new image unless it was decoded beforehand
+            if (!aNewNode.data().hasImage())
+            {
+                auto success = aNewNode.data().loadImage();
+                XC_ASSERT(success); (void)success;
+            }
+
+            // if layer data be modified
+            if (!aCurNode.data().hasSameLayerDataWith(aNewNode.data()))
+            {
+                // push to targets
+                aNotifier.event().pushTarget(aCurNode);
+
+                // push reload image command
+                XCMemBlock newImagePtr = aNewNode.data().image().block();
+                const QRect newImageRect(aNewNode.data().pos(), aNewNode.data().image().pixelSize());
+                aNewNode.data().releaseImage();
+                aStack.push(new ImageSetter(aCurNode, newImagePtr, newImageRect,
+                                            aNewNode.data().contentHash()));
+            }
+            else
+            {
+                // remember the source to skip decoding at the next reload
+                aCurNode.data().setContentHash(aNewNode.data().contentHash());
+                aNewNode.data().freeImage();
+            }
         }
     }
 
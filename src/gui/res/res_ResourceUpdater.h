@@ -22,6 +22,9 @@ public:
     ResourceUpdater(ViaPoint& aViaPoint, core::Project& aProject);
     void load(QTreeWidget& aTree, const QString& aFilePath);
     void reload(Item& aItem);
+    // reload with a tree parsed beforehand. the layers of aNewTree may have
+    // their images already, the others are decoded on demand.
+    bool reload(Item& aItem, img::ResourceNode& aNewTree);
     void remove(QTreeWidget& aTree, Item& aTopItem);
 
 private:
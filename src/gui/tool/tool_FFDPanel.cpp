@@ -130,6 +130,13 @@ void FFDPanel::createBrush()
     });
 }
 
+void FFDPanel::setDispatchParam(bool aAsyncReadback, int aSampleBudget)
+{
+    mParam.asyncReadback = aAsyncReadback;
+    mParam.sampleBudget = aSampleBudget;
+    this->onParamUpdated(false);
+}
+
 void FFDPanel::updateTypeParam(ctrl::FFDParam::Type aType)
 {
     const bool showPencil = (aType == ctrl::FFDParam::Type_Pencil);
@@ -24,6 +24,8 @@ public:
     int updateGeometry(const QPoint& aPos, int aWidth);
 
     const ctrl::FFDParam& param() const { return mParam; }
+    // from the general settings
+    void setDispatchParam(bool aAsyncReadback, int aSampleBudget);
 
     // boost like signals
     util::Signaler<void(bool)> onParamUpdated;
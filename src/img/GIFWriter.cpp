@@ -0,0 +1,860 @@
+#include <algorithm>
+#include <climits>
+#include <QMutex>
+#include <QMutexLocker>
+#include "thr/ParallelFor.h"
+#include "img/GIFWriter.h"
+
+namespace
+{
+
+static const int kHistogramBits = 5;
+static const int kHistogramSize = 1 << (3 * kHistogramBits);
+static const int kMaxColorCount = 255; // and a transparent index
+static const int kAlphaThreshold = 128;
+static const int kDitherSpread = 32;
+static const int kMaxDelay = 0xffff;
+static const int kBandMinPixels = 64 * 1024;
+
+static const int kDisposal_Keep = 1;
+static const int kDisposal_Background = 2;
+
+// 8x8 bayer matrix, an ordered dithering keeps the unchanged pixels
+// unchanged between frames, unlike an error diffusion
+static const uint8 kBayer[64] =
+{
+     0, 32,  8, 40,  2, 34, 10, 42,
+    48, 16, 56, 24, 50, 18, 58, 26,
+    12, 44,  4, 36, 14, 46,  6, 38,
+    60, 28, 52, 20, 62, 30, 54, 22,
+     3, 35, 11, 43,  1, 33,  9, 41,
+    51, 19, 59, 27, 49, 17, 57, 25,
+    15, 47,  7, 39, 13, 45,  5, 37,
+    63, 31, 55, 23, 61, 29, 53, 21
+};
+
+inline int binOf(QRgb aPixel)
+{
+    return ((aPixel >> 9) & 0x7c00) | ((aPixel >> 6) & 0x03e0) | ((aPixel >> 3) & 0x001f);
+}
+
+inline int binOf(int aR, int aG, int aB)
+{
+    return ((aR >> 3) << 10) | ((aG >> 3) << 5) | (aB >> 3);
+}
+
+inline int clampByte(int aValue)
+{
+    return aValue < 0 ? 0 : (aValue > 255 ? 255 : aValue);
+}
+
+void forEachBand(int aRowCount, int aRowWidth, const thr::ParallelFor::BodyType& aFunc)
+{
+    const int grain = std::max(1, kBandMinPixels / std::max(aRowWidth, 1));
+    thr::ParallelFor::run(aRowCount, grain, aFunc);
+}
+
+//-------------------------------------------------------------------------------------------------
+// variable length code compression of the gif format
+class LZWEncoder
+{
+public:
+    LZWEncoder(QByteArray& aOut, int aMinCodeSize)
+        : mOut(aOut)
+        , mMinCodeSize(aMinCodeSize)
+        , mClearCode(1 << aMinCodeSize)
+        , mNextCode()
+        , mCodeSize()
+        , mKeys(kHashSize)
+        , mCodes(kHashSize)
+        , mBits()
+        , mBitCount()
+        , mBlock()
+    {
+    }
+
+    void encode(const uint8* aIndices, int aCount)
+    {
+        mOut.append((char)mMinCodeSize);
+        mBlock.reserve(255);
+
+        reset();
+        put(mClearCode);
+
+        int prefix = aIndices[0];
+        for (int i = 1; i < aCount; ++i)
+        {
+            const int value = aIndices[i];
+            const int key = (prefix << 8) | value;
+
+            int hash = ((value << 4) ^ prefix) % kHashSize;
+            while (mKeys[hash] != -1 && mKeys[hash] != key)
+            {
+                if (++hash == kHashSize) hash = 0;
+            }
+
+            if (mKeys[hash] == key)
+            {
+                prefix = mCodes[hash];
+                continue;
+            }
+
+            put(prefix);
+            if (mNextCode < kMaxCode)
+            {
+                mKeys[hash] = key;
+                mCodes[hash] = mNextCode++;
+                if (mNextCode > (1 << mCodeSize) && mCodeSize < kMaxCodeSize)
+                {
+                    ++mCodeSize;
+                }
+            }
+            else
+            {
+                put(mClearCode);
+                reset();
+            }
+            prefix = value;
+        }
+        put(prefix);
+        put(mClearCode + 1); // end of information
+
+        if (mBitCount > 0)
+        {
+            pushByte((uint8)(mBits & 0xff));
+        }
+        flushBlock();
+        mOut.append((char)0); // block terminator
+    }
+
+private:
+    enum { kHashSize = 5003, kMaxCode = 4096, kMaxCodeSize = 12 };
+
+    void reset()
+    {
+        std::fill(mKeys.begin(), mKeys.end(), -1);
+        mNextCode = mClearCode + 2;
+        mCodeSize = mMinCodeSize + 1;
+    }
+
+    void put(int aCode)
+    {
+        mBits |= (uint32)aCode << mBitCount;
+        mBitCount += mCodeSize;
+        while (mBitCount >= 8)
+        {
+            pushByte((uint8)(mBits & 0xff));
+            mBits >>= 8;
+            mBitCount -= 8;
+        }
+    }
+
+    void pushByte(uint8 aByte)
+    {
+        mBlock.push_back(aByte);
+        if (mBlock.size() == 255) flushBlock();
+    }
+
+    void flushBlock()
+    {
+        if (mBlock.empty()) return;
+        mOut.append((char)mBlock.size());
+        mOut.append((const char*)mBlock.data(), (int)mBlock.size());
+        mBlock.clear();
+    }
+
+    QByteArray& mOut;
+    const int mMinCodeSize;
+    const int mClearCode;
+    int mNextCode;
+    int mCodeSize;
+    std::vector<int> mKeys;
+    std::vector<int> mCodes;
+    uint32 mBits;
+    int mBitCount;
+    std::vector<uint8> mBlock;
+};
+
+void appendUInt16(QByteArray& aOut, int aValue)
+{
+    aOut.append((char)(aValue & 0xff));
+    aOut.append((char)((aValue >> 8) & 0xff));
+}
+
+void appendColorTable(QByteArray& aOut, const std::vector<QRgb>& aColors, int aTableBits)
+{
+    const int tableSize = 1 << aTableBits;
+    for (int i = 0; i < tableSize; ++i)
+    {
+        const QRgb color = i < (int)aColors.size() ? aColors[i] : 0;
+        aOut.append((char)qRed(color));
+        aOut.append((char)qGreen(color));
+        aOut.append((char)qBlue(color));
+    }
+}
+
+} // namespace
+
+namespace img
+{
+
+//-------------------------------------------------------------------------------------------------
+struct GIFWriter::Histogram
+{
+    struct Bin
+    {
+        uint64 count;
+        uint64 r;
+        uint64 g;
+        uint64 b;
+    };
+
+    Histogram()
+        : bins(kHistogramSize, Bin())
+    {
+    }
+
+    void accumulate(const std::vector<QRgb>& aPixels, const QSize& aSize)
+    {
+        QMutex lock;
+        const int width = aSize.width();
+
+        forEachBand(aSize.height(), width, [&](int aBegin, int aEnd)
+        {
+            Histogram local;
+            const QRgb* pixel = aPixels.data() + aBegin * width;
+            const QRgb* end = aPixels.data() + aEnd * width;
+            for (; pixel != end; ++pixel)
+            {
+                if (*pixel == 0) continue;
+                Bin& bin = local.bins[binOf(*pixel)];
+                ++bin.count;
+                bin.r += qRed(*pixel);
+                bin.g += qGreen(*pixel);
+                bin.b += qBlue(*pixel);
+            }
+
+            QMutexLocker locker(&lock);
+            this->merge(local);
+        });
+    }
+
+    void merge(const Histogram& aOther)
+    {
+        for (int i = 0; i < kHistogramSize; ++i)
+        {
+            const Bin& src = aOther.bins[i];
+            if (src.count == 0) continue;
+            Bin& dst = bins[i];
+            dst.count += src.count;
+            dst.r += src.r;
+            dst.g += src.g;
+            dst.b += src.b;
+        }
+    }
+
+    std::vector<Bin> bins;
+};
+
+//-------------------------------------------------------------------------------------------------
+GIFWriter::Palette::Palette()
+    : colors()
+    , lut()
+{
+}
+
+int GIFWriter::Palette::tableBits() const
+{
+    int bits = 1;
+    while ((1 << bits) < transparentIndex() + 1) ++bits;
+    return bits;
+}
+
+//-------------------------------------------------------------------------------------------------
+GIFWriter::Frame::Frame()
+    : rect()
+    , indices()
+    , delay()
+    , disposal(kDisposal_Keep)
+    , transparentIndex()
+    , tableBits()
+    , localColors()
+{
+}
+
+//-------------------------------------------------------------------------------------------------
+GIFWriter::GIFWriter(QIODevice& aOut, const QSize& aSize,
+                     PaletteMode aPaletteMode, bool aDithering)
+    : mOut(aOut)
+    , mSize(aSize)
+    , mPaletteMode(aPaletteMode)
+    , mDithering(aDithering)
+    , mGlobalHistogram()
+    , mSpool()
+    , mPrevious()
+    , mPending()
+    , mHeaderWritten()
+    , mFinished()
+    , mFrameCount()
+    , mErrorString()
+{
+    XC_ASSERT(aSize.width() > 0 && aSize.height() > 0);
+    XC_ASSERT(aSize.width() <= 0xffff && aSize.height() <= 0xffff);
+
+    if (mPaletteMode == PaletteMode_Global)
+    {
+        mGlobalHistogram.reset(new Histogram());
+        mSpool.reset(new QTemporaryFile());
+        if (!mSpool->open())
+        {
+            setError("Failed to open a temporary file. " + mSpool->errorString());
+        }
+    }
+}
+
+GIFWriter::~GIFWriter()
+{
+}
+
+bool GIFWriter::pushFrame(const QImage& aImage, int aDelay)
+{
+    if (mFinished || !mErrorString.isEmpty()) return false;
+
+    if (aImage.size() != mSize)
+    {
+        return setError("Invalid frame size.");
+    }
+
+    std::vector<QRgb> pixels;
+    normalize(aImage, pixels);
+    const int delay = std::min(std::max(aDelay, 0), kMaxDelay);
+    ++mFrameCount;
+
+    if (mPaletteMode == PaletteMode_Global)
+    {
+        mGlobalHistogram->accumulate(pixels, mSize);
+
+        const qint32 header[] = { delay, 0 };
+        const qint64 length = (qint64)pixels.size() * sizeof(QRgb);
+        if (mSpool->write((const char*)header, sizeof(header)) != sizeof(header) ||
+                mSpool->write((const char*)pixels.data(), length) != length)
+        {
+            return setError("Failed to write a temporary file. " + mSpool->errorString());
+        }
+        return true;
+    }
+    else
+    {
+        Histogram histogram;
+        histogram.accumulate(pixels, mSize);
+
+        Palette palette;
+        makePalette(histogram, palette);
+
+        if (!writeHeader(nullptr)) return false;
+        return encodeFrame(pixels, delay, palette, true);
+    }
+}
+
+bool GIFWriter::pushDuplicate(int aDelay)
+{
+    if (mFinished || !mErrorString.isEmpty()) return false;
+
+    if (mFrameCount == 0)
+    {
+        return setError("No frame to be duplicated.");
+    }
+
+    const int delay = std::min(std::max(aDelay, 0), kMaxDelay);
+    ++mFrameCount;
+
+    if (mPaletteMode == PaletteMode_Global)
+    {
+        const qint32 header[] = { delay, 1 };
+        if (mSpool->write((const char*)header, sizeof(header)) != sizeof(header))
+        {
+            return setError("Failed to write a temporary file. " + mSpool->errorString());
+        }
+    }
+    else
+    {
+        XC_ASSERT(mPending);
+        mPending->delay = std::min(mPending->delay + delay, kMaxDelay);
+    }
+    return true;
+}
+
+bool GIFWriter::finish()
+{
+    if (mFinished) return mErrorString.isEmpty();
+    mFinished = true;
+
+    if (!mErrorString.isEmpty()) return false;
+
+    if (mPaletteMode == PaletteMode_Global)
+    {
+        Palette palette;
+        makePalette(*mGlobalHistogram, palette);
+        mGlobalHistogram.reset();
+
+        if (!writeHeader(&palette)) return false;
+
+        if (!mSpool->seek(0))
+        {
+            return setError("Failed to read a temporary file. " + mSpool->errorString());
+        }
+
+        std::vector<QRgb> pixels(mSize.width() * mSize.height());
+        const qint64 length = (qint64)pixels.size() * sizeof(QRgb);
+        for (int i = 0; i < mFrameCount; ++i)
+        {
+            qint32 header[2] = {};
+            if (mSpool->read((char*)header, sizeof(header)) != sizeof(header))
+            {
+                return setError("Failed to read a temporary file. " + mSpool->errorString());
+            }
+            if (header[1])
+            {
+                XC_ASSERT(mPending);
+                mPending->delay = std::min(mPending->delay + header[0], kMaxDelay);
+                continue;
+            }
+            if (mSpool->read((char*)pixels.data(), length) != length)
+            {
+                return setError("Failed to read a temporary file. " + mSpool->errorString());
+            }
+            if (!encodeFrame(pixels, header[0], palette, false)) return false;
+        }
+        mSpool.reset();
+    }
+    else if (!writeHeader(nullptr))
+    {
+        return false;
+    }
+
+    if (mPending)
+    {
+        if (!writeFrame(*mPending)) return false;
+        mPending.reset();
+    }
+
+    QByteArray trailer;
+    trailer.append((char)0x3b);
+    return writeBytes(trailer);
+}
+
+void GIFWriter::normalize(const QImage& aImage, std::vector<QRgb>& aPixels) const
+{
+    const QImage image = aImage.format() == QImage::Format_ARGB32 ?
+                aImage : aImage.convertToFormat(QImage::Format_ARGB32);
+    const int width = mSize.width();
+    aPixels.resize(width * mSize.height());
+
+    // gif has no translucency, the colors of opaque pixels are kept as is
+    forEachBand(mSize.height(), width, [&](int aBegin, int aEnd)
+    {
+        for (int y = aBegin; y < aEnd; ++y)
+        {
+            const QRgb* src = (const QRgb*)image.constScanLine(y);
+            QRgb* dst = aPixels.data() + y * width;
+            for (int x = 0; x < width; ++x)
+            {
+                dst[x] = qAlpha(src[x]) >= kAlphaThreshold ? (src[x] | 0xff000000u) : 0u;
+            }
+        }
+    });
+}
+
+void GIFWriter::makePalette(const Histogram& aHistogram, Palette& aPalette) const
+{
+    struct Box
+    {
+        int begin;
+        int end;
+        uint64 count;
+        int minValue[3];
+        int maxValue[3];
+        int longestAxis() const
+        {
+            int axis = 0;
+            for (int i = 1; i < 3; ++i)
+            {
+                if (maxValue[i] - minValue[i] > maxValue[axis] - minValue[axis]) axis = i;
+            }
+            return axis;
+        }
+        double score() const
+        {
+            const int axis = longestAxis();
+            return (double)count * (maxValue[axis] - minValue[axis]);
+        }
+    };
+
+    static const int kMask = (1 << kHistogramBits) - 1;
+    auto channel = [=](int aBin, int aAxis)
+    {
+        return (aBin >> (kHistogramBits * (2 - aAxis))) & kMask;
+    };
+
+    std::vector<int> bins;
+    for (int i = 0; i < kHistogramSize; ++i)
+    {
+        if (aHistogram.bins[i].count > 0) bins.push_back(i);
+    }
+
+    auto shrink = [&](Box& aBox)
+    {
+        aBox.count = 0;
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            aBox.minValue[axis] = kMask;
+            aBox.maxValue[axis] = 0;
+        }
+        for (int i = aBox.begin; i < aBox.end; ++i)
+        {
+            aBox.count += aHistogram.bins[bins[i]].count;
+            for (int axis = 0; axis < 3; ++axis)
+            {
+                const int value = channel(bins[i], axis);
+                aBox.minValue[axis] = std::min(aBox.minValue[axis], value);
+                aBox.maxValue[axis] = std::max(aBox.maxValue[axis], value);
+            }
+        }
+    };
+
+    // median cut
+    std::vector<Box> boxes;
+    if (!bins.empty())
+    {
+        Box box;
+        box.begin = 0;
+        box.end = (int)bins.size();
+        shrink(box);
+        boxes.push_back(box);
+    }
+
+    while ((int)boxes.size() < kMaxColorCount)
+    {
+        int target = -1;
+        double bestScore = 0.0;
+        for (int i = 0; i < (int)boxes.size(); ++i)
+        {
+            const double score = boxes[i].score();
+            if (score > bestScore)
+            {
+                bestScore = score;
+                target = i;
+            }
+        }
+        if (target < 0) break; // every box has a single bin
+
+        Box& box = boxes[target];
+        const int axis = box.longestAxis();
+        std::sort(bins.begin() + box.begin, bins.begin() + box.end, [&](int aL, int aR)
+        {
+            return channel(aL, axis) < channel(aR, axis);
+        });
+
+        // split at the weighted median, both halves keep at least one bin
+        uint64 half = box.count / 2;
+        int split = box.begin + 1;
+        uint64 sum = aHistogram.bins[bins[box.begin]].count;
+        while (split < box.end - 1 && sum < half)
+        {
+            sum += aHistogram.bins[bins[split]].count;
+            ++split;
+        }
+
+        Box upper = box;
+        upper.begin = split;
+        box.end = split;
+        shrink(box);
+        shrink(upper);
+        boxes.push_back(upper);
+    }
+
+    aPalette.colors.clear();
+    for (auto& box : boxes)
+    {
+        uint64 r = 0, g = 0, b = 0;
+        for (int i = box.begin; i < box.end; ++i)
+        {
+            const Histogram::Bin& bin = aHistogram.bins[bins[i]];
+            r += bin.r;
+            g += bin.g;
+            b += bin.b;
+        }
+        aPalette.colors.push_back(qRgb((int)(r / box.count),
+                                       (int)(g / box.count),
+                                       (int)(b / box.count)));
+    }
+
+    // nearest colors of each bin
+    aPalette.lut.assign(kHistogramSize, 0);
+    if (aPalette.colors.empty()) return;
+
+    const std::vector<QRgb>& colors = aPalette.colors;
+    std::vector<uint8>& lut = aPalette.lut;
+    thr::ParallelFor::run(kHistogramSize, 1024, [&](int aBegin, int aEnd)
+    {
+        for (int i = aBegin; i < aEnd; ++i)
+        {
+            const int r = (channel(i, 0) << 3) | 4;
+            const int g = (channel(i, 1) << 3) | 4;
+            const int b = (channel(i, 2) << 3) | 4;
+
+            int nearest = 0;
+            int nearestDist = INT_MAX;
+            for (int k = 0; k < (int)colors.size(); ++k)
+            {
+                const int dr = qRed(colors[k]) - r;
+                const int dg = qGreen(colors[k]) - g;
+                const int db = qBlue(colors[k]) - b;
+                const int dist = dr * dr + dg * dg + db * db;
+                if (dist < nearestDist)
+                {
+                    nearestDist = dist;
+                    nearest = k;
+                }
+            }
+            lut[i] = (uint8)nearest;
+        }
+    });
+}
+
+bool GIFWriter::encodeFrame(const std::vector<QRgb>& aPixels, int aDelay,
+                            const Palette& aPalette, bool aIsLocal)
+{
+    const int width = mSize.width();
+    const int height = mSize.height();
+    const bool isFirst = mPrevious.empty();
+    if (isFirst) mPrevious.assign(aPixels.size(), 0);
+
+    // changed columns of each row, and the pixels which turned transparent
+    std::vector<int> changedMin(height, width), changedMax(height, -1);
+    std::vector<int> clearedMin(height, width), clearedMax(height, -1);
+    forEachBand(height, width, [&](int aBegin, int aEnd)
+    {
+        for (int y = aBegin; y < aEnd; ++y)
+        {
+            const QRgb* curr = aPixels.data() + y * width;
+            const QRgb* prev = mPrevious.data() + y * width;
+            for (int x = 0; x < width; ++x)
+            {
+                if (curr[x] == prev[x]) continue;
+                changedMin[y] = std::min(changedMin[y], x);
+                changedMax[y] = x;
+                if (curr[x] == 0)
+                {
+                    clearedMin[y] = std::min(clearedMin[y], x);
+                    clearedMax[y] = x;
+                }
+            }
+        }
+    });
+
+    QRect changed, cleared;
+    for (int y = 0; y < height; ++y)
+    {
+        if (changedMax[y] >= 0)
+        {
+            changed |= QRect(QPoint(changedMin[y], y), QPoint(changedMax[y], y));
+        }
+        if (clearedMax[y] >= 0)
+        {
+            cleared |= QRect(QPoint(clearedMin[y], y), QPoint(clearedMax[y], y));
+        }
+    }
+
+    if (changed.isEmpty())
+    {
+        if (isFirst)
+        {
+            // a gif frame has one pixel at least
+            changed = QRect(0, 0, 1, 1);
+        }
+        else
+        {
+            // an identical frame extends the display time of the previous one
+            XC_ASSERT(mPending);
+            mPending->delay = std::min(mPending->delay + aDelay, kMaxDelay);
+            return true;
+        }
+    }
+
+    // a gif frame can not make the previous pixels transparent, so the
+    // previous frame restores its rectangle to the background after its
+    // display, and this frame redraws the opaque pixels in the rectangle.
+    QRect redrawn;
+    if (!cleared.isEmpty() && mPending)
+    {
+        extendPendingRect(cleared);
+        mPending->disposal = kDisposal_Background;
+        redrawn = mPending->rect;
+
+        for (int y = redrawn.top(); y <= redrawn.bottom(); ++y)
+        {
+            const QRgb* curr = aPixels.data() + y * width;
+            int left = redrawn.left();
+            int right = redrawn.right();
+            while (left <= right && curr[left] == 0) ++left;
+            while (left <= right && curr[right] == 0) --right;
+            if (left <= right) changed |= QRect(QPoint(left, y), QPoint(right, y));
+        }
+    }
+
+    // indexing
+    QScopedPointer<Frame> frame(new Frame());
+    frame->rect = changed;
+    frame->indices.resize(changed.width() * changed.height());
+    frame->delay = aDelay;
+    frame->transparentIndex = aPalette.transparentIndex();
+    frame->tableBits = aPalette.tableBits();
+    if (aIsLocal) frame->localColors = aPalette.colors;
+
+    const uint8 transparent = (uint8)aPalette.transparentIndex();
+    const bool dithering = mDithering;
+    forEachBand(changed.height(), changed.width(), [&](int aBegin, int aEnd)
+    {
+        for (int row = aBegin; row < aEnd; ++row)
+        {
+            const int y = changed.top() + row;
+            const bool rowRedrawn = redrawn.top() <= y && y <= redrawn.bottom();
+            const QRgb* curr = aPixels.data() + y * width;
+            const QRgb* prev = mPrevious.data() + y * width;
+            uint8* dst = frame->indices.data() + row * changed.width();
+            const uint8* bayer = kBayer + (y & 7) * 8;
+
+            for (int x = changed.left(); x <= changed.right(); ++x, ++dst)
+            {
+                const QRgb pixel = curr[x];
+                const bool keeps = !(rowRedrawn && redrawn.left() <= x && x <= redrawn.right());
+
+                if (pixel == 0 || (keeps && !isFirst && pixel == prev[x]))
+                {
+                    *dst = transparent;
+                }
+                else if (dithering)
+                {
+                    const int offset = ((int)bayer[x & 7] - 32) * kDitherSpread / 64;
+                    *dst = aPalette.lut[binOf(clampByte(qRed(pixel) + offset),
+                                              clampByte(qGreen(pixel) + offset),
+                                              clampByte(qBlue(pixel) + offset))];
+                }
+                else
+                {
+                    *dst = aPalette.lut[binOf(pixel)];
+                }
+            }
+        }
+    });
+
+    mPrevious = aPixels;
+
+    // the previous frame is written after its disposal was decided
+    if (mPending && !writeFrame(*mPending)) return false;
+    mPending.reset(frame.take());
+    return true;
+}
+
+void GIFWriter::extendPendingRect(const QRect& aRect)
+{
+    XC_ASSERT(mPending);
+    Frame& frame = *mPending;
+    const QRect rect = frame.rect | aRect;
+    if (rect == frame.rect) return;
+
+    // the extended pixels keep the previous ones
+    std::vector<uint8> indices(rect.width() * rect.height(), (uint8)frame.transparentIndex);
+    for (int y = frame.rect.top(); y <= frame.rect.bottom(); ++y)
+    {
+        std::copy_n(frame.indices.data() + (y - frame.rect.top()) * frame.rect.width(),
+                    frame.rect.width(),
+                    indices.data() + (y - rect.top()) * rect.width() + (frame.rect.left() - rect.left()));
+    }
+    frame.rect = rect;
+    frame.indices.swap(indices);
+}
+
+bool GIFWriter::writeHeader(const Palette* aGlobal)
+{
+    if (mHeaderWritten) return true;
+    mHeaderWritten = true;
+
+    QByteArray bytes;
+    bytes.append("GIF89a", 6);
+
+    // logical screen descriptor
+    appendUInt16(bytes, mSize.width());
+    appendUInt16(bytes, mSize.height());
+    const int globalBits = aGlobal ? aGlobal->tableBits() : 0;
+    bytes.append((char)(aGlobal ? (0x80 | 0x70 | (globalBits - 1)) : 0x70));
+    bytes.append((char)0); // background color index
+    bytes.append((char)0); // pixel aspect ratio
+    if (aGlobal)
+    {
+        appendColorTable(bytes, aGlobal->colors, globalBits);
+    }
+
+    // infinite loop
+    bytes.append((char)0x21);
+    bytes.append((char)0xff);
+    bytes.append((char)11);
+    bytes.append("NETSCAPE2.0", 11);
+    bytes.append((char)3);
+    bytes.append((char)1);
+    appendUInt16(bytes, 0);
+    bytes.append((char)0);
+
+    return writeBytes(bytes);
+}
+
+bool GIFWriter::writeFrame(const Frame& aFrame)
+{
+    QByteArray bytes;
+
+    // graphic control extension
+    bytes.append((char)0x21);
+    bytes.append((char)0xf9);
+    bytes.append((char)4);
+    bytes.append((char)((aFrame.disposal << 2) | 0x01));
+    appendUInt16(bytes, aFrame.delay);
+    bytes.append((char)aFrame.transparentIndex);
+    bytes.append((char)0);
+
+    // image descriptor
+    const bool hasLocal = !aFrame.localColors.empty() || mPaletteMode == PaletteMode_Local;
+    bytes.append((char)0x2c);
+    appendUInt16(bytes, aFrame.rect.left());
+    appendUInt16(bytes, aFrame.rect.top());
+    appendUInt16(bytes, aFrame.rect.width());
+    appendUInt16(bytes, aFrame.rect.height());
+    bytes.append((char)(hasLocal ? (0x80 | (aFrame.tableBits - 1)) : 0));
+    if (hasLocal)
+    {
+        appendColorTable(bytes, aFrame.localColors, aFrame.tableBits);
+    }
+
+    // image data
+    LZWEncoder encoder(bytes, std::max(2, aFrame.tableBits));
+    encoder.encode(aFrame.indices.data(), (int)aFrame.indices.size());
+
+    return writeBytes(bytes);
+}
+
+bool GIFWriter::writeBytes(const QByteArray& aBytes)
+{
+    if (mOut.write(aBytes) != aBytes.size())
+    {
+        return setError("Failed to write a gif file. " + mOut.errorString());
+    }
+    return true;
+}
+
+bool GIFWriter::setError(const QString& aMessage)
+{
+    if (mErrorString.isEmpty()) mErrorString = aMessage;
+    return false;
+}
+
+} // namespace img
@@ -0,0 +1,99 @@
+#ifndef IMG_GIFWRITER_H
+#define IMG_GIFWRITER_H
+
+#include <vector>
+#include <QIODevice>
+#include <QImage>
+#include <QSize>
+#include <QRect>
+#include <QString>
+#include <QScopedPointer>
+#include <QTemporaryFile>
+#include "XC.h"
+
+namespace img
+{
+
+// Writes an animated gif frame by frame.
+// The palette is made by the median cut, either over all of the frames
+// (global) or for each frame (local). The global mode spools the frames
+// into a temporary file and encodes them in finish().
+// A frame is written as the rectangle which changed from the previous one,
+// and the unchanged pixels in it are written as the transparent index.
+// The pixels whose alpha is less than a half are transparent.
+class GIFWriter
+{
+public:
+    enum PaletteMode
+    {
+        PaletteMode_Global,
+        PaletteMode_Local
+    };
+
+    GIFWriter(QIODevice& aOut, const QSize& aSize,
+              PaletteMode aPaletteMode, bool aDithering);
+    ~GIFWriter();
+
+    // the image is converted into ARGB32 if necessary
+    // the delay is in 1/100 seconds
+    bool pushFrame(const QImage& aImage, int aDelay);
+    // repeats the last frame without encoding it again
+    bool pushDuplicate(int aDelay);
+    // writes the pending frames and the trailer
+    bool finish();
+
+    int frameCount() const { return mFrameCount; }
+    const QString& errorString() const { return mErrorString; }
+
+private:
+    struct Palette
+    {
+        Palette();
+        int transparentIndex() const { return (int)colors.size(); }
+        int tableBits() const;
+        std::vector<QRgb> colors;
+        // nearest color index of each 15bit rgb
+        std::vector<uint8> lut;
+    };
+
+    struct Frame
+    {
+        Frame();
+        QRect rect;
+        std::vector<uint8> indices;
+        int delay;
+        int disposal;
+        int transparentIndex;
+        int tableBits;
+        std::vector<QRgb> localColors;
+    };
+
+    struct Histogram;
+
+    void normalize(const QImage& aImage, std::vector<QRgb>& aPixels) const;
+    void makePalette(const Histogram& aHistogram, Palette& aPalette) const;
+    bool encodeFrame(const std::vector<QRgb>& aPixels, int aDelay,
+                     const Palette& aPalette, bool aIsLocal);
+    void extendPendingRect(const QRect& aRect);
+    bool writeHeader(const Palette* aGlobal);
+    bool writeFrame(const Frame& aFrame);
+    bool writeBytes(const QByteArray& aBytes);
+    bool setError(const QString& aMessage);
+
+    QIODevice& mOut;
+    QSize mSize;
+    PaletteMode mPaletteMode;
+    bool mDithering;
+    QScopedPointer<Histogram> mGlobalHistogram;
+    QScopedPointer<QTemporaryFile> mSpool;
+    std::vector<QRgb> mPrevious;
+    QScopedPointer<Frame> mPending;
+    bool mHeaderWritten;
+    bool mFinished;
+    int mFrameCount;
+    QString mErrorString;
+};
+
+} // namespace img
+
+#endif // IMG_GIFWRITER_H
@@ -1,9 +1,47 @@
+#include <algorithm>
+#include <array>
+#include <vector>
+#include <QAtomicInt>
 #include "util/MathUtil.h"
 #include "util/TriangleRasterizer.h"
+#include "thr/ParallelFor.h"
 #include "img/GridMeshCreator.h"
 #include "img/Util.h"
 #include "img/ColorRGBA.h"
 
+namespace
+{
+// tables smaller than this are processed on the calling thread
+static const int kBandMinElements = 64 * 1024;
+// minimum rows per band
+static const int kBandMinRows = 8;
+
+// adaptive meshing
+enum CoarseState
+{
+    CoarseState_Whole, // one triangle of the double size
+    CoarseState_Split, // two triangles, one edge has a middle vertex
+    CoarseState_Fine   // the original four triangles
+};
+
+struct CoarseCell
+{
+    int corner[3]; // indices of the vertex table, same winding as cells
+    int mid[3];    // mid[i] is on the edge between corner[i] and corner[i + 1]
+    int cell[4];   // indices of the cell table
+    CoarseState state;
+};
+
+// hexagonal directions on the axial coordinate (q = x - y / 2, r = y)
+// which correspond to the connection ids of the uniform mode
+static const int kAxialDirs[6][2] = {
+    { 1, 0 }, { 0, 1 }, { -1, 1 }, { -1, 0 }, { 0, -1 }, { 1, -1 }
+};
+
+// a corner vertex connects its 6 ring vertices and some split edges
+static const int kMaxAdjacency = 12;
+}
+
 namespace img
 {
 
@@ -154,7 +192,8 @@ GridMeshCreator::VertexTable::VertexTable(int aWidth, int aHeight)
     }
 }
 
-void GridMeshCreator::VertexTable::setReducingVectors(float aCellWidth)
+void GridMeshCreator::VertexTable::setReducingVectors(
+        float aCellWidth, int aRowBegin, int aRowEnd)
 {
     const float cellHeight = aCellWidth * mHalfSqrt3;
     const float pairTriangleHeight = cellHeight * mHalfSqrt3;
@@ -165,9 +204,10 @@ void GridMeshCreator::VertexTable::setReducingVectors(float aCellWidth)
         vecs[i] = util::MathUtil::getVectorFromPolarCoord(cellHeight, angle);
     }
 
-    const int count = mSize.width() * mSize.height();
+    const int begin = mSize.width() * aRowBegin;
+    const int end = mSize.width() * aRowEnd;
 
-    for (int i = 0; i < count; ++i)
+    for (int i = begin; i < end; ++i)
     {
         auto& vtx = mVertices[i];
         QVector2D vec;
@@ -214,12 +254,14 @@ void GridMeshCreator::VertexTable::setReducingVectors(float aCellWidth)
     }
 }
 
-void GridMeshCreator::VertexTable::shortenReducingVectorsOnePixel()
+void GridMeshCreator::VertexTable::shortenReducingVectorsOnePixel(
+        int aRowBegin, int aRowEnd)
 {
     static const float kShorten = 1.0f;
-    const int count = mSize.width() * mSize.height();
+    const int begin = mSize.width() * aRowBegin;
+    const int end = mSize.width() * aRowEnd;
 
-    for (int i = 0; i < count; ++i)
+    for (int i = begin; i < end; ++i)
     {
         auto& vtx = mVertices[i];
 
@@ -255,20 +297,24 @@ GridMeshCreator::CellTable::CellTable(int aCellWidth)
 {
 }
 
-int GridMeshCreator::CellTable::initCells(const Image &aImage)
+void GridMeshCreator::CellTable::allocCells(const QSize& aImageSize)
+{
+    auto tableSize = calculateCellTableSize(aImageSize, mCellSize);
+    mWidth = tableSize.width();
+    mHeight = tableSize.height();
+    mCells.reset(new Cell[mWidth * mHeight]);
+}
+
+int GridMeshCreator::CellTable::initCells(const Image &aImage, int aRowBegin, int aRowEnd)
 {
     int count = 0;
 
     const float cellWidth = mCellSize.width();
     const float cellHeight = mCellSize.height();
     const float halfCellWidth = cellWidth * 0.5f;
-    auto tableSize = calculateCellTableSize(aImage.size(), mCellSize);
-    mWidth = tableSize.width();
-    mHeight = tableSize.height();
-    mCells.reset(new Cell[mWidth * mHeight]);
 
     // initialize each cells
-    for (int y = 0; y < mHeight; ++y)
+    for (int y = aRowBegin; y < aRowEnd; ++y)
     {
         const bool zalign = (y % 2 == 0);
         const int line = y * mWidth;
@@ -390,14 +436,22 @@ int GridMeshCreator::getCellTableCount(const QSize& aImageSize, int aCellWidth)
 }
 
 //-------------------------------------------------------------------------------------------------
-GridMeshCreator::GridMeshCreator(const uint8* aPtr, const QSize& aSize, int aCellPx)
+GridMeshCreator::GridMeshCreator(
+        const uint8* aPtr, const QSize& aSize, int aCellPx,
+        bool aParallel, bool aAdaptive)
     : mCells()
     , mVertices()
     , mVertexCount()
     , mIndexCount()
     , mImageSize(aSize)
+    , mCellPx(aCellPx)
+    , mParallel(aParallel)
+    , mAdaptive(aAdaptive)
+    , mAdaptiveIndices()
+    , mAdaptiveConnections()
 {
     execute(aPtr, aSize, aCellPx);
+    if (mAdaptive) makeAdaptive();
 }
 
 QRect GridMeshCreator::vertexRect() const
@@ -438,6 +492,12 @@ void GridMeshCreator::writeVertices(GLfloat* aPosVec3, GLfloat* aTexVec2)
 
 void GridMeshCreator::writeIndices(GLuint* aIndices)
 {
+    if (mAdaptive)
+    {
+        std::copy(mAdaptiveIndices.begin(), mAdaptiveIndices.end(), aIndices);
+        return;
+    }
+
     GLuint index = 0;
 
     for (int y = 0; y < mCells->tableHeight(); ++y)
@@ -459,27 +519,53 @@ void GridMeshCreator::writeIndices(GLuint* aIndices)
 
 void GridMeshCreator::writeConnections(HexaConnection* aDest)
 {
+    if (mAdaptive)
+    {
+        std::copy(mAdaptiveConnections.begin(), mAdaptiveConnections.end(), aDest);
+        return;
+    }
+
     const int w = mVertices->width();
     const int h = mVertices->height();
 
-    for (int y = 0; y < h; ++y)
+    // each vertex writes to its own index only
+    forEachBand(h, w, [=](int aBegin, int aEnd)
     {
-        for (int x = 0; x < w; ++x)
+        for (int y = aBegin; y < aEnd; ++y)
         {
-            auto& vtx = mVertices->vertex(x, y);
-            if (vtx.isExist)
+            for (int x = 0; x < w; ++x)
             {
-                auto index = vtx.index;
-                auto& connection = aDest[index];
-                connection.clear();
-                for (int i = 0; i < 6; ++i)
+                auto& vtx = mVertices->vertex(x, y);
+                if (vtx.isExist)
                 {
-                    const Vertex* cvtx = findConnectVertex(x, y, i);
-                    if (cvtx) connection.id[i] = cvtx->index;
+                    auto index = vtx.index;
+                    auto& connection = aDest[index];
+                    connection.clear();
+                    for (int i = 0; i < 6; ++i)
+                    {
+                        const Vertex* cvtx = findConnectVertex(x, y, i);
+                        if (cvtx) connection.id[i] = cvtx->index;
+                    }
                 }
             }
         }
+    });
+}
+
+void GridMeshCreator::forEachBand(
+        int aRowCount, int aRowWidth, const BandFunc& aFunc) const
+{
+    if (aRowCount <= 0) return;
+
+    if (!mParallel || aRowCount * aRowWidth < kBandMinElements)
+    {
+        aFunc(0, aRowCount);
+        return;
     }
+
+    const int grain = std::max(
+                kBandMinRows, kBandMinElements / std::max(aRowWidth, 1));
+    thr::ParallelFor::run(aRowCount, grain, aFunc);
 }
 
 void GridMeshCreator::execute(const uint8* aPtr, const QSize& aSize, int aCellPx)
@@ -487,7 +573,16 @@ void GridMeshCreator::execute(const uint8* aPtr, const QSize& aSize, int aCellPx
     Image image(aPtr, aSize);
 
     mCells.reset(new CellTable(aCellPx));
-    mIndexCount = 3 * mCells->initCells(image);
+    mCells->allocCells(aSize);
+    {
+        QAtomicInt cellCount(0);
+        forEachBand(mCells->tableHeight(), mCells->tableWidth(),
+                    [&](int aBegin, int aEnd)
+        {
+            cellCount.fetchAndAddRelaxed(mCells->initCells(image, aBegin, aEnd));
+        });
+        mIndexCount = 3 * cellCount.load();
+    }
 
     mVertices.reset(new VertexTable(
                         (mCells->tableWidth() + 1) / 2 + 1,
@@ -501,6 +596,279 @@ void GridMeshCreator::execute(const uint8* aPtr, const QSize& aSize, int aCellPx
     reduceBurrs(*mVertices, image);
 }
 
+void GridMeshCreator::makeAdaptive()
+{
+    VertexTable& table = *mVertices;
+    const int vw = table.width();
+    const int vh = table.height();
+    const int cw = mCells->tableWidth();
+    const int ch = mCells->tableHeight();
+
+    // find cells by their top vertex (top-left one for inverted cells)
+    QVector<int> downCells(vw * vh, -1);
+    QVector<int> upCells(vw * vh, -1);
+    for (int y = 0; y < ch; ++y)
+    {
+        for (int x = 0; x < cw; ++x)
+        {
+            auto& cell = mCells->cell(x, y);
+            if (!cell.isExist) continue;
+            const int top = table.indexOf(cell.vtx[0]);
+            (cell.inverted ? downCells : upCells)[top] = x + y * cw;
+        }
+    }
+
+    auto toIndex = [=](int aQ, int aR) -> int
+    {
+        if (aR < 0 || vh <= aR) return -1;
+        const int x = aQ + aR / 2;
+        if (x < 0 || vw <= x) return -1;
+        return x + aR * vw;
+    };
+
+    // a vertex surrounded by 6 cells is not on any alpha contour
+    auto isInterior = [&](int aIndex) -> bool
+    {
+        if (aIndex < 0) return false;
+        const Vertex& vtx = table.at(aIndex);
+        if (!vtx.isExist) return false;
+        if (vtx.maxReduce > 0.0f && vtx.reduceRate > 0.0f) return false;
+        for (int i = 0; i < 6; ++i)
+        {
+            if (vtx.cell[i] == -1) return false;
+        }
+        return true;
+    };
+
+    // collect the double sized cells which have interior vertices only
+    std::vector<CoarseCell> coarses;
+    QVector<int> cellOwner(cw * ch, -1);
+
+    auto tryPushCoarse = [&](const int aCorners[3][2], const int aMids[3][2],
+                             int aCell0, int aCell1, int aCell2, int aCell3)
+    {
+        CoarseCell coarse;
+        for (int i = 0; i < 3; ++i)
+        {
+            coarse.corner[i] = toIndex(aCorners[i][0], aCorners[i][1]);
+            coarse.mid[i] = toIndex(aMids[i][0], aMids[i][1]);
+            if (!isInterior(coarse.corner[i]) || !isInterior(coarse.mid[i])) return;
+        }
+        coarse.cell[0] = aCell0;
+        coarse.cell[1] = aCell1;
+        coarse.cell[2] = aCell2;
+        coarse.cell[3] = aCell3;
+        for (int i = 0; i < 4; ++i)
+        {
+            if (coarse.cell[i] < 0 || cellOwner[coarse.cell[i]] >= 0) return;
+        }
+        coarse.state = CoarseState_Whole;
+
+        for (int i = 0; i < 4; ++i)
+        {
+            cellOwner[coarse.cell[i]] = (int)coarses.size();
+        }
+        coarses.push_back(coarse);
+    };
+
+    auto downCell = [&](int aQ, int aR) { auto i = toIndex(aQ, aR); return i < 0 ? -1 : downCells[i]; };
+    auto upCell = [&](int aQ, int aR) { auto i = toIndex(aQ, aR); return i < 0 ? -1 : upCells[i]; };
+
+    // the corners of double sized cells are the vertices which have even (q, r)
+    for (int r = 0; r < vh; r += 2)
+    {
+        for (int x = 0; x < vw; ++x)
+        {
+            const int q = x - r / 2;
+            if (q & 1) continue;
+
+            {
+                const int corners[3][2] = { { q, r }, { q + 2, r }, { q, r + 2 } };
+                const int mids[3][2] = { { q + 1, r }, { q + 1, r + 1 }, { q, r + 1 } };
+                tryPushCoarse(corners, mids,
+                              downCell(q, r), downCell(q + 1, r),
+                              downCell(q, r + 1), upCell(q + 1, r));
+            }
+            {
+                const int corners[3][2] = { { q, r }, { q, r + 2 }, { q - 2, r + 2 } };
+                const int mids[3][2] = { { q, r + 1 }, { q - 1, r + 2 }, { q - 1, r + 1 } };
+                tryPushCoarse(corners, mids,
+                              upCell(q, r), upCell(q, r + 1),
+                              upCell(q - 1, r + 1), downCell(q - 1, r + 1));
+            }
+        }
+    }
+
+    if (coarses.empty()) return;
+
+    // vertices used by the original cells are required
+    QVector<char> needed(vw * vh, 0);
+    for (int i = 0; i < cw * ch; ++i)
+    {
+        if (cellOwner[i] >= 0) continue;
+        const Cell& cell = mCells->cell(i % cw, i / cw);
+        if (!cell.isExist) continue;
+        for (int k = 0; k < 3; ++k)
+        {
+            needed[table.indexOf(cell.vtx[k])] = 1;
+        }
+    }
+
+    // resolve t-junctions. a double sized cell can be split by one middle vertex,
+    // otherwise it falls back to the original cells which require more vertices.
+    bool changed = true;
+    while (changed)
+    {
+        changed = false;
+        for (auto& coarse : coarses)
+        {
+            if (coarse.state == CoarseState_Fine) continue;
+
+            int count = 0;
+            for (int i = 0; i < 3; ++i)
+            {
+                if (needed[coarse.mid[i]]) ++count;
+            }
+
+            if (count >= 2)
+            {
+                coarse.state = CoarseState_Fine;
+                for (int i = 0; i < 3; ++i)
+                {
+                    needed[coarse.mid[i]] = 1;
+                }
+                changed = true;
+            }
+            else
+            {
+                coarse.state = (count == 1) ? CoarseState_Split : CoarseState_Whole;
+            }
+        }
+    }
+
+    // remove middle vertices which no triangle uses
+    for (auto& coarse : coarses)
+    {
+        if (coarse.state == CoarseState_Fine) continue;
+        for (int i = 0; i < 3; ++i)
+        {
+            if (!needed[coarse.mid[i]]) table.at(coarse.mid[i]).isExist = false;
+        }
+    }
+    setIndicesOfExistingVertices(table);
+
+    // write indices and gather adjacency
+    std::vector<std::array<int, kMaxAdjacency>> adjacency(mVertexCount);
+    std::vector<int> adjacencyCount(mVertexCount, 0);
+    QVector<char> emitted(coarses.size(), 0);
+
+    auto link = [&](GLuint aFrom, GLuint aTo)
+    {
+        auto& list = adjacency[aFrom];
+        auto& count = adjacencyCount[aFrom];
+        for (int i = 0; i < count; ++i)
+        {
+            if (list[i] == (int)aTo) return;
+        }
+        if (count < kMaxAdjacency) list[count++] = (int)aTo;
+    };
+
+    auto pushTriangle = [&](int aV0, int aV1, int aV2)
+    {
+        const GLuint ids[3] = { table.at(aV0).index, table.at(aV1).index, table.at(aV2).index };
+        for (int i = 0; i < 3; ++i)
+        {
+            mAdaptiveIndices.push_back(ids[i]);
+            link(ids[i], ids[(i + 1) % 3]);
+            link(ids[(i + 1) % 3], ids[i]);
+        }
+    };
+
+    mAdaptiveIndices.clear();
+    mAdaptiveIndices.reserve(mIndexCount);
+
+    for (int i = 0; i < cw * ch; ++i)
+    {
+        const Cell& cell = mCells->cell(i % cw, i / cw);
+        if (!cell.isExist) continue;
+
+        const int owner = cellOwner[i];
+        if (owner < 0 || coarses[owner].state == CoarseState_Fine)
+        {
+            pushTriangle(table.indexOf(cell.vtx[0]),
+                         table.indexOf(cell.vtx[1]),
+                         table.indexOf(cell.vtx[2]));
+            continue;
+        }
+
+        if (emitted[owner]) continue;
+        emitted[owner] = 1;
+
+        const CoarseCell& coarse = coarses[owner];
+        if (coarse.state == CoarseState_Whole)
+        {
+            pushTriangle(coarse.corner[0], coarse.corner[1], coarse.corner[2]);
+        }
+        else
+        {
+            for (int k = 0; k < 3; ++k)
+            {
+                if (!needed[coarse.mid[k]]) continue;
+                const int c0 = coarse.corner[k];
+                const int c1 = coarse.corner[(k + 1) % 3];
+                const int c2 = coarse.corner[(k + 2) % 3];
+                pushTriangle(c0, coarse.mid[k], c2);
+                pushTriangle(coarse.mid[k], c1, c2);
+                break;
+            }
+        }
+    }
+    mIndexCount = mAdaptiveIndices.size();
+
+    // connections keep the direction ids of the uniform mode. a link is put on
+    // the slot of its axial direction, the nearer vertex wins on a shared
+    // direction, and links off the six axes are not emitted.
+    QVector<int> tableIndices(mVertexCount);
+    for (int i = 0; i < vw * vh; ++i)
+    {
+        const Vertex& vtx = table.at(i);
+        if (vtx.isExist) tableIndices[vtx.index] = i;
+    }
+
+    mAdaptiveConnections.resize(mVertexCount);
+    for (int i = 0; i < mVertexCount; ++i)
+    {
+        auto& connection = mAdaptiveConnections[i];
+        connection.clear();
+
+        const int self = tableIndices[i];
+        const int sy = self / vw;
+        const int sq = self % vw - sy / 2;
+        int steps[6] = { 0, 0, 0, 0, 0, 0 };
+
+        for (int k = 0; k < adjacencyCount[i]; ++k)
+        {
+            const int other = adjacency[i][k];
+            const int oy = tableIndices[other] / vw;
+            const int dq = tableIndices[other] % vw - oy / 2 - sq;
+            const int dr = oy - sy;
+
+            for (int d = 0; d < 6; ++d)
+            {
+                for (int step = 1; step <= 2; ++step)
+                {
+                    if (dq != kAxialDirs[d][0] * step || dr != kAxialDirs[d][1] * step) continue;
+                    if (!connection.has(d) || step < steps[d])
+                    {
+                        connection.id[d] = other;
+                        steps[d] = step;
+                    }
+                }
+            }
+        }
+    }
+}
+
 void GridMeshCreator::initPositionsOfVertices(VertexTable& aTable)
 {
     const float cellWidth = mCells->cellWidth();
@@ -573,7 +941,10 @@ void GridMeshCreator::reduceBurrs(VertexTable& aTable, const Image& aImage)
     const int cellTableWidth = mCells->tableWidth();
     const int cellTableHeight = mCells->tableHeight();
 
-    aTable.setReducingVectors(reduce);
+    forEachBand(aTable.height(), aTable.width(), [&](int aBegin, int aEnd)
+    {
+        aTable.setReducingVectors(reduce, aBegin, aEnd);
+    });
 
     // avoid triangle flipping
     for (int y = 0; y < cellTableHeight; ++y)
@@ -619,32 +990,35 @@ void GridMeshCreator::reduceBurrs(VertexTable& aTable, const Image& aImage)
     }
 
     // shorten reducing vectors if they are riding on a opaque pixels.
-    for (int y = 0; y < aTable.height(); ++y)
+    forEachBand(aTable.height(), aTable.width(), [&](int aBegin, int aEnd)
     {
-        for (int x = 0; x < aTable.width(); ++x)
+        for (int y = aBegin; y < aEnd; ++y)
         {
-            auto& vtx = aTable.vertex(x, y);
-            if (vtx.isExist)
+            for (int x = 0; x < aTable.width(); ++x)
             {
-                if (vtx.maxReduce > 0.0f)
+                auto& vtx = aTable.vertex(x, y);
+                if (vtx.isExist)
                 {
-                    vtx.reduceRate = 0.95f;
-                    const float maxReduce = vtx.maxReduce;
-
-                    for (int div = 0; div < 9; ++div)
+                    if (vtx.maxReduce > 0.0f)
                     {
-                        auto pos = vtx.posReduced();
+                        vtx.reduceRate = 0.95f;
+                        const float maxReduce = vtx.maxReduce;
 
-                        if (!aImage.hasSomeAlphaIn3x3((int)pos.x(), (int)pos.y()))
+                        for (int div = 0; div < 9; ++div)
                         {
-                            break;
+                            auto pos = vtx.posReduced();
+
+                            if (!aImage.hasSomeAlphaIn3x3((int)pos.x(), (int)pos.y()))
+                            {
+                                break;
+                            }
+                            vtx.maxReduce = (1.0f - (div + 1) * 0.125f) * maxReduce;
                         }
-                        vtx.maxReduce = (1.0f - (div + 1) * 0.125f) * maxReduce;
                     }
                 }
             }
         }
-    }
+    });
 
 #if 1
     auto iw = aImage.size().width();
@@ -810,7 +1184,10 @@ void GridMeshCreator::reduceBurrs(VertexTable& aTable, const Image& aImage)
         }
     }
 
-    mVertices->shortenReducingVectorsOnePixel();
+    forEachBand(aTable.height(), aTable.width(), [&](int aBegin, int aEnd)
+    {
+        aTable.shortenReducingVectorsOnePixel(aBegin, aEnd);
+    });
 
 #endif
 }
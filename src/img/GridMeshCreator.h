@@ -1,6 +1,8 @@
 #ifndef IMG_GRIDMESHCREATOR_H
 #define IMG_GRIDMESHCREATOR_H
 
+#include <functional>
+#include <QVector>
 #include <QScopedArrayPointer>
 #include <QSize>
 #include <QRect>
@@ -23,8 +25,14 @@ public:
 
     static int getCellTableCount(const QSize& aImageSize, int aCellWidth);
 
-    GridMeshCreator(const uint8* aPtr, const QSize& aSize, int aCellPx);
+    // parallel mode splits the tables into row bands and processes them
+    // on the thread pool. the result is identical to the serial mode.
+    // adaptive mode merges each 4 cells in opaque interiors into one cell of
+    // the double size, and keeps the original density along alpha contours.
+    GridMeshCreator(const uint8* aPtr, const QSize& aSize, int aCellPx,
+                    bool aParallel = false, bool aAdaptive = false);
 
+    int cellPx() const { return mCellPx; }
     int vertexCount() const { return mVertexCount; }
     int indexCount() const { return mIndexCount; }
     QRect vertexRect() const;
@@ -111,6 +119,10 @@ private:
             return mVertices[aX + aY * mSize.width()];
         }
 
+        Vertex& at(int aIndex) { return mVertices[aIndex]; }
+        const Vertex& at(int aIndex) const { return mVertices[aIndex]; }
+        int indexOf(const Vertex* aVtx) const { return (int)(aVtx - mVertices.data()); }
+
         const Vertex* findVertex(int aX, int aY) const
         {
             if (aX < 0 || mSize.width() <= aX) return nullptr;
@@ -125,8 +137,8 @@ private:
             mVertices[aX + aY * mSize.width()].isExist = aValue;
         }
 
-        void setReducingVectors(float aCellWidth);
-        void shortenReducingVectorsOnePixel();
+        void setReducingVectors(float aCellWidth, int aRowBegin, int aRowEnd);
+        void shortenReducingVectorsOnePixel(int aRowBegin, int aRowEnd);
     };
 
     class CellTable
@@ -142,7 +154,8 @@ private:
                 const QSize& aImageSize, const QSizeF& aCellSize);
 
         CellTable(int aCellWidth);
-        int initCells(const Image& aImage);
+        void allocCells(const QSize& aImageSize);
+        int initCells(const Image& aImage, int aRowBegin, int aRowEnd);
         void connectCellsToVertices(VertexTable& aTable);
         Cell& cell(int aX, int aY);
         Cell* findExistingCell(int aX, int aY);
@@ -153,17 +166,26 @@ private:
         int tableHeight() const { return mHeight; }
     };
 
+    typedef std::function<void(int aBegin, int aEnd)> BandFunc;
+
+    void forEachBand(int aRowCount, int aRowWidth, const BandFunc& aFunc) const;
     void execute(const uint8* aPtr, const QSize& aSize, int aCellPx);
     void initPositionsOfVertices(VertexTable& aTable);
     const Vertex* findConnectVertex(int aX, int aY, int aConnectId) const;
     void setIndicesOfExistingVertices(VertexTable& aTable);
     void reduceBurrs(VertexTable& aTable, const Image& aImage);
+    void makeAdaptive();
 
     QScopedPointer<CellTable> mCells;
     QScopedPointer<VertexTable> mVertices;
     int mVertexCount;
     int mIndexCount;
     QSize mImageSize;
+    int mCellPx;
+    bool mParallel;
+    bool mAdaptive;
+    QVector<GLuint> mAdaptiveIndices;
+    QVector<HexaConnection> mAdaptiveConnections;
 };
 
 } // namespace img
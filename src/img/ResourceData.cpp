@@ -15,6 +15,7 @@ ResourceData::ResourceData(const QString& aIdentifier, const ResourceNode* aSeri
     , mBlendMode(BlendMode_Normal)
     , mImageLoader()
     , mSerialAddress(aSerialAddress)
+    , mContentHash(0)
 {
 }
 
@@ -59,6 +60,7 @@ void ResourceData::copyFrom(const ResourceData& aData)
     mIsLayer = aData.mIsLayer;
     mBlendMode = aData.mBlendMode;
     mImageLoader = aData.mImageLoader;
+    mContentHash = aData.mContentHash;
 }
 
 QRect ResourceData::rect() const
@@ -71,6 +73,14 @@ QVector2D ResourceData::center() const
     return util::MathUtil::getCenter(rect());
 }
 
+bool ResourceData::hasSameLayerSourceWith(const ResourceData& aData) const
+{
+    if (!isLayer() || !aData.isLayer()) return false;
+    if (blendMode() != aData.blendMode()) return false;
+    if (mContentHash == 0 || aData.mContentHash == 0) return false;
+    return mContentHash == aData.mContentHash;
+}
+
 bool ResourceData::hasSameLayerDataWith(const ResourceData& aData)
 {
     if (!isLayer() || !aData.isLayer()) return false;
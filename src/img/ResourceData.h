@@ -27,6 +27,8 @@ public:
     void setUserData(void* aData) { mUserData = aData; }
     void setIsLayer(bool aIsLayer) { mIsLayer = aIsLayer; }
     void setBlendMode(BlendMode aMode);
+    // hash of the source encoding of the image, zero means unknown.
+    void setContentHash(uint64 aHash) { mContentHash = aHash; }
     void copyFrom(const ResourceData& aData);
 
     bool isLayer() const { return mIsLayer; }
@@ -37,6 +39,7 @@ public:
     void* userData() const { return mUserData; }
     BlendMode blendMode() const { return mBlendMode; }
     const ResourceNode* serialAddress() const { return mSerialAddress; }
+    uint64 contentHash() const { return mContentHash; }
 
     void setImageLoader(const ImageLoader& aLoader) { mImageLoader = aLoader; }
     bool loadImage() { return (mImageLoader && mImageLoader(*this)); }
@@ -45,6 +48,8 @@ public:
     QVector2D center() const;
 
     bool hasSameLayerDataWith(const ResourceData& aData); // it's heavy
+    // true if both sources are known and equal, it works without any image.
+    bool hasSameLayerSourceWith(const ResourceData& aData) const;
 
 private:
     img::Buffer mBuffer;
@@ -55,6 +60,7 @@ private:
     BlendMode mBlendMode;
     ImageLoader mImageLoader;
     const ResourceNode* mSerialAddress;
+    uint64 mContentHash;
 };
 
 } // namespace img
@@ -1,5 +1,7 @@
 #include <string>
 #include "util/TextUtil.h"
+#include "util/HashUtil.h"
+#include "thr/ParallelFor.h"
 #include "img/Util.h"
 #include "img/ColorRGBA.h"
 #include "img/PSDUtil.h"
@@ -275,6 +277,48 @@ std::pair<XCMemBlock, QRect> Util::createTextureImage(const QImage& aImage)
     return std::pair<XCMemBlock, QRect>(image, rect);
 }
 
+uint64 Util::makeSourceHash(
+        const PSDFormat::Header& aHeader,
+        const PSDFormat::Layer& aLayer)
+{
+    using util::HashUtil;
+
+    const sint32 info[] = {
+        aHeader.depth, aHeader.mode,
+        aLayer.rect.left(), aLayer.rect.top(),
+        aLayer.rect.width(), aLayer.rect.height()
+    };
+    uint64 hash = HashUtil::hash64(info, sizeof(info));
+
+    for (auto& channel : aLayer.channels)
+    {
+        const sint32 channelInfo[] = {
+            channel->id, channel->compressionId, (sint32)channel->dataLength
+        };
+        hash = HashUtil::combine(hash, HashUtil::hash64(channelInfo, sizeof(channelInfo)));
+
+        if (channel->data)
+        {
+            hash = HashUtil::combine(
+                        hash, HashUtil::hash64(channel->data.get(), channel->dataLength));
+        }
+    }
+    return hash ? hash : 1;
+}
+
+uint64 Util::makeSourceHash(const QImage& aImage)
+{
+    using util::HashUtil;
+
+    const sint32 info[] = {
+        aImage.width(), aImage.height(), (sint32)aImage.format(), aImage.bytesPerLine()
+    };
+    uint64 hash = HashUtil::hash64(info, sizeof(info));
+    hash = HashUtil::combine(
+                hash, HashUtil::hash64(aImage.constBits(), (size_t)aImage.sizeInBytes()));
+    return hash ? hash : 1;
+}
+
 ResourceNode* Util::createResourceNodes(PSDFormat& aFormat, bool aLoadImage)
 {
     // build tree by a psd format
@@ -285,6 +329,9 @@ ResourceNode* Util::createResourceNodes(PSDFormat& aFormat, bool aLoadImage)
     std::vector<ResourceNode*> resStack;
     resStack.push_back(new ResourceNode("topnode"));
 
+    // layers to be hashed
+    std::vector<std::pair<ResourceData*, const PSDFormat::Layer*>> hashTargets;
+
     // each layer
     for (auto itr = layers.rbegin(); itr != layers.rend(); ++itr)
     {
@@ -304,6 +351,7 @@ ResourceNode* Util::createResourceNodes(PSDFormat& aFormat, bool aLoadImage)
             resNode->data().setUserData(&layer);
             resNode->data().setIsLayer(true);
             resNode->data().setBlendMode(getBlendModeFromPSD(layer.blendMode));
+            hashTargets.push_back(std::make_pair(&resNode->data(), &layer));
 
             if (aLoadImage)
             {
@@ -346,6 +394,19 @@ ResourceNode* Util::createResourceNodes(PSDFormat& aFormat, bool aLoadImage)
             resStack.push_back(resNode);
         }
     }
+
+    // hash each layer source
+    {
+        const PSDFormat::Header& header = aFormat.header();
+        thr::ParallelFor::run((int)hashTargets.size(), 1, [&](int aBegin, int aEnd)
+        {
+            for (int i = aBegin; i < aEnd; ++i)
+            {
+                hashTargets[i].first->setContentHash(
+                            makeSourceHash(header, *hashTargets[i].second));
+            }
+        });
+    }
     return resStack.front();
 }
 
@@ -356,6 +417,7 @@ ResourceNode* Util::createResourceNode(const QImage& aImage, const QString& aNam
     resNode->data().setPos(QPoint(0, 0));
     resNode->data().setIsLayer(true);
     resNode->data().setBlendMode(img::BlendMode_Normal);
+    resNode->data().setContentHash(makeSourceHash(aImage));
 
     if (aLoadImage)
     {
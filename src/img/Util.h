@@ -45,6 +45,12 @@ public:
             const PSDFormat::Layer& aLayer);
     static std::pair<XCMemBlock, QRect> createTextureImage(const QImage& aImage);
 
+    /// @note hash of the encoded source, never returns zero
+    static uint64 makeSourceHash(
+            const PSDFormat::Header& aHeader,
+            const PSDFormat::Layer& aLayer);
+    static uint64 makeSourceHash(const QImage& aImage);
+
     static ResourceNode* createResourceNodes(PSDFormat& aFormat, bool aLoadImage);
     static ResourceNode* createResourceNode(const QImage& aImage, const QString& aName, bool aLoadImage);
 };
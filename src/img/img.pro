@@ -11,14 +11,14 @@ OBJECTS_DIR = .obj
 MOC_DIR     = .moc
 RCC_DIR     = .rcc
 
-msvc:LIBS            += ../util/util.lib
-msvc:PRE_TARGETDEPS  += ../util/util.lib
+msvc:LIBS            += ../util/util.lib ../thr/thr.lib
+msvc:PRE_TARGETDEPS  += ../util/util.lib ../thr/thr.lib
 
-mingw:LIBS            += -L"$$OUT_PWD/../util/" -lutil
-mingw:PRE_TARGETDEPS  += ../util/libutil.a
+mingw:LIBS            += -L"$$OUT_PWD/../thr/" -lthr -L"$$OUT_PWD/../util/" -lutil
+mingw:PRE_TARGETDEPS  += ../thr/libthr.a ../util/libutil.a
 
-gcc:LIBS            += -L"$$OUT_PWD/../util/" -lutil
-gcc:PRE_TARGETDEPS  += ../util/libutil.a
+gcc:LIBS            += -L"$$OUT_PWD/../thr/" -lthr -L"$$OUT_PWD/../util/" -lutil
+gcc:PRE_TARGETDEPS  += ../thr/libthr.a ../util/libutil.a
 
 INCLUDEPATH += ..
 DEPENDPATH  += ..
@@ -34,7 +34,8 @@ SOURCES += \
     GridMeshCreator.cpp \
     ResourceData.cpp \
     ResourceHandle.cpp \
-    BlendModeName.cpp
+    BlendModeName.cpp \
+    GIFWriter.cpp
 
 HEADERS += \
     Buffer.h \
@@ -52,4 +53,5 @@ HEADERS += \
     BlendMode.h \
     GridMeshCreator.h \
     ResourceData.h \
-    BlendModeName.h
+    BlendModeName.h \
+    GIFWriter.h
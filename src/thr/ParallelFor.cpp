@@ -0,0 +1,111 @@
+#include <algorithm>
+#include <memory>
+#include <vector>
+#include <QAtomicInt>
+#include <QThread>
+#include "thr/Scheduler.h"
+#include "thr/ParallelFor.h"
+
+namespace
+{
+
+class Batch
+{
+public:
+    Batch(int aCount, int aChunkCount, const thr::ParallelFor::BodyType& aBody)
+        : mCount(aCount)
+        , mChunkCount(aChunkCount)
+        , mBody(aBody)
+        , mNext(0)
+    {
+    }
+
+    // a runner which starts after all chunks were taken does nothing
+    void work()
+    {
+        while (true)
+        {
+            const int chunk = mNext.fetchAndAddOrdered(1);
+            if (chunk >= mChunkCount) return;
+
+            const int begin = (int)((qint64)mCount * chunk / mChunkCount);
+            const int end = (int)((qint64)mCount * (chunk + 1) / mChunkCount);
+            mBody(begin, end);
+        }
+    }
+
+private:
+    const int mCount;
+    const int mChunkCount;
+    const thr::ParallelFor::BodyType& mBody;
+    QAtomicInt mNext;
+};
+
+class Runner : public thr::Task
+{
+public:
+    explicit Runner(Batch& aBatch)
+        : mBatch(aBatch)
+    {
+    }
+
+protected:
+    virtual void run()
+    {
+        mBatch.work();
+    }
+
+private:
+    Batch& mBatch;
+};
+
+// the batches run before the background tasks of the projects
+thr::TaskGroup& batchGroup()
+{
+    static thr::TaskGroup sGroup(thr::Scheduler::Priority_Interactive);
+    return sGroup;
+}
+
+}
+
+namespace thr
+{
+
+void ParallelFor::run(int aCount, int aMinGrain, const BodyType& aBody)
+{
+    if (aCount <= 0) return;
+
+    const int grain = std::max(1, aMinGrain);
+    const int threadCount = std::max(1, QThread::idealThreadCount());
+    const int chunkCount = std::min(threadCount * 4, (aCount + grain - 1) / grain);
+
+    if (chunkCount <= 1 || threadCount == 1)
+    {
+        aBody(0, aCount);
+        return;
+    }
+
+    TaskGroup& group = batchGroup();
+    Batch batch(aCount, chunkCount, aBody);
+
+    const int runnerCount = std::min(
+                Scheduler::instance().workerCount(),
+                std::min(threadCount, chunkCount) - 1);
+    std::vector<std::unique_ptr<Runner>> runners;
+    for (int i = 0; i < runnerCount; ++i)
+    {
+        runners.emplace_back(new Runner(batch));
+        group.push(*runners.back());
+    }
+
+    batch.work();
+
+    // every chunk was taken. the runners which are not started yet are
+    // removed, and the running ones finish their last chunks
+    for (auto& runner : runners)
+    {
+        group.cancel(*runner);
+    }
+}
+
+} // namespace thr
@@ -0,0 +1,23 @@
+#ifndef THR_PARALLELFOR_H
+#define THR_PARALLELFOR_H
+
+#include <functional>
+
+namespace thr
+{
+
+// Split the index range [0, aCount) into chunks and run them on the workers
+// of thr::Scheduler, in an interactive group. The caller thread takes part
+// in the work too, so nested calls can not dead-lock. Returns after every
+// chunk finished.
+class ParallelFor
+{
+public:
+    typedef std::function<void(int aBegin, int aEnd)> BodyType;
+
+    static void run(int aCount, int aMinGrain, const BodyType& aBody);
+};
+
+} // namespace thr
+
+#endif // THR_PARALLELFOR_H
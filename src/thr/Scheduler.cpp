@@ -0,0 +1,163 @@
+#include <algorithm>
+#include <QMutexLocker>
+#include "XC.h"
+#include "thr/Scheduler.h"
+
+namespace thr
+{
+
+//-------------------------------------------------------------------------------------------------
+Scheduler& Scheduler::instance()
+{
+    static Scheduler sInstance(std::max(2, QThread::idealThreadCount()));
+    return sInstance;
+}
+
+Scheduler::Scheduler(int aWorkerCount)
+    : mMutex()
+    , mTaskPushed()
+    , mTaskFinished()
+    , mGroups()
+    , mThreads()
+    , mQuit(false)
+{
+    for (int i = 0; i < aWorkerCount; ++i)
+    {
+        mThreads.emplace_back(std::unique_ptr<Thread>(new Thread(*this)));
+        mThreads.back()->start();
+    }
+}
+
+Scheduler::~Scheduler()
+{
+    {
+        QMutexLocker locker(&mMutex);
+        mQuit = true;
+        mTaskPushed.wakeAll();
+    }
+
+    for (auto& thread : mThreads)
+    {
+        thread->wait();
+    }
+}
+
+void Scheduler::run()
+{
+    QMutexLocker locker(&mMutex);
+
+    while (1)
+    {
+        TaskGroup* group = nullptr;
+        Task* task = pop(group);
+        if (!task)
+        {
+            if (mQuit) return;
+            mTaskPushed.wait(&mMutex);
+            continue;
+        }
+
+        // a running task is canceled through its state
+        group->mRunningTasks.push_back(task);
+        task->setRun();
+
+        locker.unlock();
+        task->run();
+        locker.relock();
+
+        task->setFinish();
+        group->mRunningTasks.removeOne(task);
+        mTaskFinished.wakeAll();
+    }
+}
+
+Task* Scheduler::pop(TaskGroup*& aGroup)
+{
+    for (int priority = 0; priority < Priority_TERM; ++priority)
+    {
+        for (auto itr = mGroups.begin(); itr != mGroups.end(); ++itr)
+        {
+            TaskGroup* group = *itr;
+            if (group->mPriority != priority || group->mTasks.empty()) continue;
+
+            // the group waits for the turn of the others
+            mGroups.erase(itr);
+            mGroups.push_back(group);
+
+            aGroup = group;
+            Task* task = group->mTasks.front();
+            group->mTasks.pop_front();
+            return task;
+        }
+    }
+    return nullptr;
+}
+
+//-------------------------------------------------------------------------------------------------
+TaskGroup::TaskGroup(Scheduler::Priority aPriority, Scheduler& aScheduler)
+    : mScheduler(aScheduler)
+    , mPriority(aPriority)
+    , mTasks()
+    , mRunningTasks()
+{
+    QMutexLocker locker(&mScheduler.mMutex);
+    mScheduler.mGroups.push_back(this);
+}
+
+TaskGroup::~TaskGroup()
+{
+    cancelAll();
+
+    QMutexLocker locker(&mScheduler.mMutex);
+    mScheduler.mGroups.remove(this);
+}
+
+void TaskGroup::setPriority(Scheduler::Priority aPriority)
+{
+    XC_ASSERT(0 <= aPriority && aPriority < Scheduler::Priority_TERM);
+    QMutexLocker locker(&mScheduler.mMutex);
+    mPriority = aPriority;
+}
+
+Scheduler::Priority TaskGroup::priority() const
+{
+    QMutexLocker locker(&mScheduler.mMutex);
+    return mPriority;
+}
+
+void TaskGroup::push(Task& aTask)
+{
+    QMutexLocker locker(&mScheduler.mMutex);
+    aTask.setIdle();
+    mTasks.push_back(&aTask);
+    mScheduler.mTaskPushed.wakeOne();
+}
+
+void TaskGroup::cancel(Task& aTask)
+{
+    QMutexLocker locker(&mScheduler.mMutex);
+    mTasks.erase(std::remove(mTasks.begin(), mTasks.end(), &aTask), mTasks.end());
+    aTask.setCancel();
+
+    while (mRunningTasks.contains(&aTask))
+    {
+        mScheduler.mTaskFinished.wait(&mScheduler.mMutex);
+    }
+}
+
+void TaskGroup::cancelAll()
+{
+    QMutexLocker locker(&mScheduler.mMutex);
+    mTasks.clear();
+
+    for (auto task : mRunningTasks)
+    {
+        task->setCancel();
+    }
+    while (!mRunningTasks.isEmpty())
+    {
+        mScheduler.mTaskFinished.wait(&mScheduler.mMutex);
+    }
+}
+
+} // namespace thr
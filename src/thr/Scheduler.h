@@ -0,0 +1,97 @@
+#ifndef THR_SCHEDULER_H
+#define THR_SCHEDULER_H
+
+#include <list>
+#include <deque>
+#include <memory>
+#include <QThread>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QList>
+#include "util/NonCopyable.h"
+#include "thr/Task.h"
+
+namespace thr
+{
+
+class TaskGroup;
+
+// A pool of worker threads which is shared by the whole application.
+// The tasks are pushed to task groups, a project has one. The workers take
+// the tasks of the interactive groups before the background ones, and the
+// groups of a priority take turns for each task, so that a group with many
+// tasks doesn't keep the others waiting.
+// thr::ParallelFor runs its batches on the same workers.
+class Scheduler : private util::NonCopyable
+{
+    friend class TaskGroup;
+public:
+    enum Priority
+    {
+        Priority_Interactive,
+        Priority_Background,
+        Priority_TERM
+    };
+
+    // the instance is created on the first call, with a worker per core
+    static Scheduler& instance();
+
+    explicit Scheduler(int aWorkerCount);
+    // runs the remaining tasks and stops the workers
+    ~Scheduler();
+
+    int workerCount() const { return (int)mThreads.size(); }
+
+private:
+    class Thread : public QThread
+    {
+    public:
+        Thread(Scheduler& aOwner) : mOwner(aOwner) {}
+    protected:
+        virtual void run() { mOwner.run(); }
+    private:
+        Scheduler& mOwner;
+    };
+
+    void run();
+    Task* pop(TaskGroup*& aGroup); // mMutex has to be locked
+
+    QMutex mMutex;
+    QWaitCondition mTaskPushed;
+    QWaitCondition mTaskFinished;
+    std::list<TaskGroup*> mGroups;
+    std::list<std::unique_ptr<Thread>> mThreads;
+    bool mQuit;
+};
+
+// The tasks of an owner, as a project. The ownership of the tasks still
+// belongs to the caller.
+class TaskGroup : private util::NonCopyable
+{
+    friend class Scheduler;
+public:
+    explicit TaskGroup(Scheduler::Priority aPriority = Scheduler::Priority_Background,
+                       Scheduler& aScheduler = Scheduler::instance());
+    // cancels the tasks of the group
+    ~TaskGroup();
+
+    void setPriority(Scheduler::Priority aPriority);
+    Scheduler::Priority priority() const;
+
+    void push(Task& aTask);
+    // removes the task if it is waiting, or requests the canceling and
+    // waits for it if it is running
+    void cancel(Task& aTask);
+    void cancelAll();
+
+private:
+    Scheduler& mScheduler;
+    // the members are guarded by the mutex of the scheduler
+    Scheduler::Priority mPriority;
+    std::deque<Task*> mTasks;
+    QList<Task*> mRunningTasks;
+};
+
+} // namespace thr
+
+#endif // THR_SCHEDULER_H
@@ -2,18 +2,16 @@
 #define THR_TASK
 
 #include <QReadWriteLock>
-namespace thr { class Paralleler; }
-namespace thr { class Worker; }
-namespace thr { class TaskQueue; }
+namespace thr { class Scheduler; }
+namespace thr { class TaskGroup; }
 
 namespace thr
 {
 
 class Task
 {
-    friend class Paralleler;
-    friend class Worker;
-    friend class TaskQueue;
+    friend class Scheduler;
+    friend class TaskGroup;
 public:
     Task();
     virtual ~Task();
@@ -24,13 +24,11 @@ INCLUDEPATH += ..
 DEPENDPATH  += ..
 
 SOURCES += \
-    Worker.cpp \
-    TaskQueue.cpp \
     Task.cpp \
-    Paralleler.cpp
+    Scheduler.cpp \
+    ParallelFor.cpp
 
 HEADERS += \
-    Worker.h \
-    TaskQueue.h \
     Task.h \
-    Paralleler.h
+    Scheduler.h \
+    ParallelFor.h
@@ -3,14 +3,16 @@
 
 #include <array>
 #include <vector>
-#include <list>
 #include <QRectF>
+#include "XC.h"
 #include "util/Triangle2D.h"
 #include "util/CollDetect.h"
 
 namespace util
 {
 
+// Nodes and per-node object indices are stored contiguously.
+// Push all triangles first, then call build() once before any query.
 template<typename tData>
 class BinarySpacePartition2D
 {
@@ -33,59 +35,149 @@ public:
         explicit Node(const QRectF& aBox)
             : box(aBox)
             , child()
-            , objects()
-        {}
+            , objBegin()
+            , objCount()
+        {
+            child.fill(-1);
+        }
 
-        bool hasChild() const { return child[0]; }
+        bool hasChild() const { return child[0] >= 0; }
 
         QRectF box;
-        std::array<Node*, 2> child;
-        std::list<Object*> objects;
+        std::array<int, 2> child;
+        int objBegin;
+        int objCount;
     };
 
     BinarySpacePartition2D(const QRectF& aSpace, int aMaxDepth = 10)
         : mSpace(aSpace)
         , mMaxDepth(aMaxDepth)
-        , mNodeHeap()
-        , mTopNode()
+        , mNodes()
+        , mObjects()
+        , mObjIndices()
+        , mIsBuilt(false)
+    {
+        mNodes.push_back(Node(mSpace));
+    }
+
+    void reserve(int aObjectCount)
     {
-        mNodeHeap.emplace_back(Node(mSpace));
-        mTopNode = &mNodeHeap.back();
+        mObjects.reserve(aObjectCount);
     }
 
     bool push(const tData& aData, const Triangle2D& aTri)
     {
+        XC_ASSERT(!mIsBuilt);
         auto rect = aTri.boundingRect();
 
-        if (!mTopNode->box.intersects(rect))
+        if (!mSpace.intersects(rect))
         {
             return false;
         }
 
-        mObjHeap.emplace_back(Object(aData, aTri, rect));
-        writeObject(*mTopNode, mObjHeap.back(), 1);
+        mObjects.push_back(Object(aData, aTri, rect));
         return true;
     }
 
-    Object* findOne(const QPointF& aPoint) const
+    // distribute all pushed objects to the nodes
+    void build()
+    {
+        XC_ASSERT(!mIsBuilt);
+        const int objCount = static_cast<int>(mObjects.size());
+
+        // count objects per node, which also creates the nodes
+        for (int i = 0; i < objCount; ++i)
+        {
+            writeObject(0, i, 1, false);
+        }
+
+        // assign ranges in the arena
+        int total = 0;
+        for (auto& node : mNodes)
+        {
+            node.objBegin = total;
+            total += node.objCount;
+            node.objCount = 0;
+        }
+        mObjIndices.resize(total);
+
+        // fill the arena in the order of pushing
+        for (int i = 0; i < objCount; ++i)
+        {
+            writeObject(0, i, 1, true);
+        }
+        mIsBuilt = true;
+    }
+
+    const Object* findOne(const QPointF& aPoint) const
     {
-        return findImpl(*mTopNode, aPoint);
+        XC_ASSERT(mIsBuilt);
+        const QVector2D vec(aPoint);
+
+        // depth first in the child order, same as the recursive search
+        int stack[64];
+        int stackSize = 0;
+        stack[stackSize++] = 0;
+
+        while (stackSize > 0)
+        {
+            const Node& node = mNodes[stack[--stackSize]];
+            if (!node.box.contains(aPoint)) continue;
+
+            const int* itr = mObjIndices.data() + node.objBegin;
+            const int* end = itr + node.objCount;
+            for (; itr != end; ++itr)
+            {
+                const Object& obj = mObjects[*itr];
+                if (obj.box.contains(aPoint) && CollDetect::isInside(obj.tri, vec))
+                {
+                    return &obj;
+                }
+            }
+
+            if (node.hasChild() && stackSize + 2 <= 64)
+            {
+                stack[stackSize++] = node.child[1];
+                stack[stackSize++] = node.child[0];
+            }
+        }
+        return nullptr;
     }
 
+    // batched query, a result is null when no object includes the point
+    void findEach(const QPointF* aPoints, int aCount, const Object** aResults) const
+    {
+        for (int i = 0; i < aCount; ++i)
+        {
+            aResults[i] = findOne(aPoints[i]);
+        }
+    }
+
+    int objectCount() const { return static_cast<int>(mObjects.size()); }
+
 private:
-    void writeObject(Node& aNode, Object& aObject, int aDepth)
+    void writeObject(int aNodeIndex, int aObjIndex, int aDepth, bool aFill)
     {
+        const QRectF box = mNodes[aNodeIndex].box;
+        const QRectF objBox = mObjects[aObjIndex].box;
+
         // push object if...
-        auto box = aNode.box;
-        if (aDepth >= mMaxDepth || aObject.box.contains(box))
+        if (aDepth >= mMaxDepth || objBox.contains(box))
         {
-            aNode.objects.push_back(&aObject);
+            Node& node = mNodes[aNodeIndex];
+            if (aFill)
+            {
+                mObjIndices[node.objBegin + node.objCount] = aObjIndex;
+            }
+            ++node.objCount;
             return;
         }
 
         // make child
-        if (!aNode.hasChild())
+        if (!mNodes[aNodeIndex].hasChild())
         {
+            XC_ASSERT(!aFill);
+
             // make child box
             bool horizontal = box.width() >= box.height();
             QRectF childBox[2];
@@ -105,58 +197,30 @@ private:
             }
             for (int i = 0; i < 2; ++i)
             {
-                mNodeHeap.emplace_back(Node(childBox[i]));
-                aNode.child[i] = &mNodeHeap.back();
+                // the node reference is invalidated by growing
+                mNodes.push_back(Node(childBox[i]));
+                mNodes[aNodeIndex].child[i] = static_cast<int>(mNodes.size()) - 1;
             }
         }
 
         for (int i = 0; i < 2; ++i)
         {
-            if (aObject.box.intersects(aNode.child[i]->box))
+            const int child = mNodes[aNodeIndex].child[i];
+            if (objBox.intersects(mNodes[child].box))
             {
-                writeObject(*aNode.child[i], aObject, aDepth + 1);
+                writeObject(child, aObjIndex, aDepth + 1, aFill);
             }
         }
     }
 
-    Object* findImpl(const Node& aNode, const QPointF& aPoint) const
-    {
-        if (!aNode.box.contains(aPoint))
-        {
-            return nullptr;
-        }
-
-        const QVector2D vec(aPoint);
-        for (auto obj : aNode.objects)
-        {
-            if (obj->box.contains(aPoint))
-            {
-                if (CollDetect::isInside(obj->tri, vec))
-                {
-                    return obj;
-                }
-            }
-        }
-
-        if (aNode.hasChild())
-        {
-            for (int i = 0; i < 2; ++i)
-            {
-                auto result = findImpl(*aNode.child[i], aPoint);
-                if (result) return result;
-            }
-        }
-        return nullptr;
-    }
-
     QRectF mSpace;
     int mMaxDepth;
-    std::list<Node> mNodeHeap;
-    std::list<Object> mObjHeap;
-    Node* mTopNode;
+    std::vector<Node> mNodes;
+    std::vector<Object> mObjects;
+    std::vector<int> mObjIndices;
+    bool mIsBuilt;
 };
 
 } // namespace util
 
 #endif // UTIL_BINARYSPACEPARTITION2D
-
@@ -0,0 +1,420 @@
+#include <algorithm>
+#include <cmath>
+#include "XC.h"
+#include "util/EasingTable.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define UTIL_EASINGTABLE_USE_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace
+{
+
+static const int kSampleCount = util::EasingTable::kSampleCount;
+// the samples, the value at 0 and the value at 1
+static const int kTableStride = kSampleCount + 3;
+static const util::Easing::Type kTableTypes[] =
+{
+    util::Easing::Type_Sine,
+    util::Easing::Type_Expo,
+    util::Easing::Type_Elastic
+};
+static const int kTableTypeCount = (int)(sizeof(kTableTypes) / sizeof(kTableTypes[0]));
+// expo and elastic return the exact values at the ends, which aren't
+// continuous with the curves. the ends of the tables are sampled inside.
+static const float kTableEdge = 1.0f / (kSampleCount * 1024.0f);
+
+static const float kBack = 1.70158f;
+static const float kBackInOut = 1.70158f * 1.525f;
+
+inline float clampRate(float aRate)
+{
+    return aRate < 0.0f ? 0.0f : (aRate > 1.0f ? 1.0f : aRate);
+}
+
+#if defined(UTIL_EASINGTABLE_USE_SSE2)
+inline __m128 select(__m128 aMask, __m128 aTrue, __m128 aFalse)
+{
+    return _mm_or_ps(_mm_and_ps(aMask, aTrue), _mm_andnot_ps(aMask, aFalse));
+}
+#endif
+
+//-------------------------------------------------------------------------------------------------
+// the in curves of the closed forms. the out and the in-out ranges are the
+// reflections of them, as the curves of util::Easing are.
+struct QuadCurve
+{
+    static float get(float u) { return u * u; }
+#if defined(UTIL_EASINGTABLE_USE_SSE2)
+    static __m128 get(__m128 u) { return _mm_mul_ps(u, u); }
+#endif
+};
+
+struct CubicCurve
+{
+    static float get(float u) { return u * u * u; }
+#if defined(UTIL_EASINGTABLE_USE_SSE2)
+    static __m128 get(__m128 u) { return _mm_mul_ps(_mm_mul_ps(u, u), u); }
+#endif
+};
+
+struct QuartCurve
+{
+    static float get(float u) { return u * u * u * u; }
+#if defined(UTIL_EASINGTABLE_USE_SSE2)
+    static __m128 get(__m128 u) { return _mm_mul_ps(_mm_mul_ps(_mm_mul_ps(u, u), u), u); }
+#endif
+};
+
+struct QuintCurve
+{
+    static float get(float u) { return u * u * u * u * u; }
+#if defined(UTIL_EASINGTABLE_USE_SSE2)
+    static __m128 get(__m128 u)
+    {
+        return _mm_mul_ps(_mm_mul_ps(_mm_mul_ps(_mm_mul_ps(u, u), u), u), u);
+    }
+#endif
+};
+
+struct CircCurve
+{
+    static float get(float u) { return 1.0f - std::sqrt(std::max(0.0f, 1.0f - u * u)); }
+#if defined(UTIL_EASINGTABLE_USE_SSE2)
+    static __m128 get(__m128 u)
+    {
+        const __m128 one = _mm_set1_ps(1.0f);
+        const __m128 r = _mm_max_ps(_mm_setzero_ps(), _mm_sub_ps(one, _mm_mul_ps(u, u)));
+        return _mm_sub_ps(one, _mm_sqrt_ps(r));
+    }
+#endif
+};
+
+template<bool tInOut>
+struct BackCurve
+{
+    static float s() { return tInOut ? kBackInOut : kBack; }
+    static float get(float u) { return u * u * ((s() + 1.0f) * u - s()); }
+#if defined(UTIL_EASINGTABLE_USE_SSE2)
+    static __m128 get(__m128 u)
+    {
+        const __m128 s0 = _mm_set1_ps(s());
+        const __m128 s1 = _mm_set1_ps(s() + 1.0f);
+        return _mm_mul_ps(_mm_mul_ps(u, u), _mm_sub_ps(_mm_mul_ps(s1, u), s0));
+    }
+#endif
+};
+
+// 1 - bounceOut(1 - u), each piece of bounceOut is 7.5625 (v - offset)^2 + base
+struct BounceCurve
+{
+    static float get(float u)
+    {
+        const float v = 1.0f - u;
+        float offset = 0.0f;
+        float base = 0.0f;
+        if (v >= (2.5f / 2.75f))      { offset = 2.625f / 2.75f; base = 0.984375f; }
+        else if (v >= (2.0f / 2.75f)) { offset = 2.25f / 2.75f;  base = 0.9375f; }
+        else if (v >= (1.0f / 2.75f)) { offset = 1.5f / 2.75f;   base = 0.75f; }
+        const float w = v - offset;
+        return 1.0f - (7.5625f * w * w + base);
+    }
+#if defined(UTIL_EASINGTABLE_USE_SSE2)
+    static __m128 get(__m128 u)
+    {
+        const __m128 one = _mm_set1_ps(1.0f);
+        const __m128 v = _mm_sub_ps(one, u);
+        const __m128 m1 = _mm_cmpge_ps(v, _mm_set1_ps(1.0f / 2.75f));
+        const __m128 m2 = _mm_cmpge_ps(v, _mm_set1_ps(2.0f / 2.75f));
+        const __m128 m3 = _mm_cmpge_ps(v, _mm_set1_ps(2.5f / 2.75f));
+        __m128 offset = _mm_and_ps(m1, _mm_set1_ps(1.5f / 2.75f));
+        __m128 base = _mm_and_ps(m1, _mm_set1_ps(0.75f));
+        offset = select(m2, _mm_set1_ps(2.25f / 2.75f), offset);
+        base = select(m2, _mm_set1_ps(0.9375f), base);
+        offset = select(m3, _mm_set1_ps(2.625f / 2.75f), offset);
+        base = select(m3, _mm_set1_ps(0.984375f), base);
+        const __m128 w = _mm_sub_ps(v, offset);
+        const __m128 bounce = _mm_add_ps(_mm_mul_ps(_mm_mul_ps(_mm_set1_ps(7.5625f), w), w), base);
+        return _mm_sub_ps(one, bounce);
+    }
+#endif
+};
+
+//-------------------------------------------------------------------------------------------------
+// the evaluators of the rates which are clamped to [0, 1]
+struct NoneEval
+{
+    float operator()(float) const { return 0.0f; }
+#if defined(UTIL_EASINGTABLE_USE_SSE2)
+    __m128 operator()(__m128) const { return _mm_setzero_ps(); }
+#endif
+};
+
+struct LinearEval
+{
+    float operator()(float x) const { return x; }
+#if defined(UTIL_EASINGTABLE_USE_SSE2)
+    __m128 operator()(__m128 x) const { return x; }
+#endif
+};
+
+template<class tCurve>
+struct ClosedEval
+{
+    explicit ClosedEval(util::Easing::Range aRange) : range(aRange) {}
+
+    float operator()(float x) const
+    {
+        switch (range)
+        {
+        case util::Easing::Range_In:
+            return tCurve::get(x);
+        case util::Easing::Range_Out:
+            return 1.0f - tCurve::get(1.0f - x);
+        default:
+            return (x < 0.5f) ?
+                        0.5f * tCurve::get(2.0f * x) :
+                        1.0f - 0.5f * tCurve::get(2.0f - 2.0f * x);
+        }
+    }
+
+#if defined(UTIL_EASINGTABLE_USE_SSE2)
+    __m128 operator()(__m128 x) const
+    {
+        const __m128 one = _mm_set1_ps(1.0f);
+        switch (range)
+        {
+        case util::Easing::Range_In:
+            return tCurve::get(x);
+        case util::Easing::Range_Out:
+            return _mm_sub_ps(one, tCurve::get(_mm_sub_ps(one, x)));
+        default:
+        {
+            const __m128 half = _mm_set1_ps(0.5f);
+            const __m128 two = _mm_set1_ps(2.0f);
+            const __m128 lower = _mm_cmplt_ps(x, half);
+            const __m128 twice = _mm_mul_ps(two, x);
+            const __m128 u = select(lower, twice, _mm_sub_ps(two, twice));
+            const __m128 g = _mm_mul_ps(half, tCurve::get(u));
+            return select(lower, g, _mm_sub_ps(one, g));
+        }
+        }
+    }
+#endif
+
+    util::Easing::Range range;
+};
+
+struct TableEval
+{
+    explicit TableEval(const float* aTable) : table(aTable) {}
+
+    float operator()(float x) const
+    {
+        if (x <= 0.0f) return table[kSampleCount + 1];
+        if (x >= 1.0f) return table[kSampleCount + 2];
+        const float pos = x * (float)kSampleCount;
+        const int index = std::min((int)pos, kSampleCount - 1);
+        const float frac = pos - (float)index;
+        return table[index] + (table[index + 1] - table[index]) * frac;
+    }
+
+#if defined(UTIL_EASINGTABLE_USE_SSE2)
+    __m128 operator()(__m128 x) const
+    {
+        const __m128 pos = _mm_mul_ps(x, _mm_set1_ps((float)kSampleCount));
+        int index[4];
+        _mm_storeu_si128((__m128i*)index, _mm_cvttps_epi32(pos));
+        for (int i = 0; i < 4; ++i)
+        {
+            index[i] = std::min(index[i], kSampleCount - 1);
+        }
+        const __m128 frac = _mm_sub_ps(pos, _mm_cvtepi32_ps(_mm_loadu_si128((const __m128i*)index)));
+        const __m128 v0 = _mm_setr_ps(table[index[0]], table[index[1]],
+                                      table[index[2]], table[index[3]]);
+        const __m128 v1 = _mm_setr_ps(table[index[0] + 1], table[index[1] + 1],
+                                      table[index[2] + 1], table[index[3] + 1]);
+        __m128 r = _mm_add_ps(v0, _mm_mul_ps(_mm_sub_ps(v1, v0), frac));
+        r = select(_mm_cmple_ps(x, _mm_setzero_ps()), _mm_set1_ps(table[kSampleCount + 1]), r);
+        r = select(_mm_cmpge_ps(x, _mm_set1_ps(1.0f)), _mm_set1_ps(table[kSampleCount + 2]), r);
+        return r;
+    }
+#endif
+
+    const float* table;
+};
+
+//-------------------------------------------------------------------------------------------------
+// the weight blends the curve with the linear one, as Easing::calculate does
+template<class tEval>
+void evaluate(const tEval& aEval, bool aWeighted, float aWeight,
+              const float* aRates, float* aDst, int aCount)
+{
+    const float rest = 1.0f - aWeight;
+    int i = 0;
+
+#if defined(UTIL_EASINGTABLE_USE_SSE2)
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 weight = _mm_set1_ps(aWeight);
+    const __m128 weightRest = _mm_set1_ps(rest);
+
+    for (; i + 4 <= aCount; i += 4)
+    {
+        const __m128 x = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(aRates + i), zero), one);
+        __m128 r = aEval(x);
+        if (aWeighted)
+        {
+            r = _mm_add_ps(_mm_mul_ps(r, weight), _mm_mul_ps(x, weightRest));
+        }
+        _mm_storeu_ps(aDst + i, r);
+    }
+#endif
+
+    for (; i < aCount; ++i)
+    {
+        const float x = clampRate(aRates[i]);
+        const float r = aEval(x);
+        aDst[i] = aWeighted ? r * aWeight + x * rest : r;
+    }
+}
+
+} // namespace
+
+namespace util
+{
+
+const float EasingTable::kMaxError = 1.0e-5f;
+
+//-------------------------------------------------------------------------------------------------
+const EasingTable& EasingTable::instance()
+{
+    static EasingTable sInstance;
+    return sInstance;
+}
+
+bool EasingTable::usesSimd()
+{
+#if defined(UTIL_EASINGTABLE_USE_SSE2)
+    return true;
+#else
+    return false;
+#endif
+}
+
+EasingTable::EasingTable()
+    : mSamples(kTableTypeCount * Easing::Range_TERM * kTableStride)
+{
+    for (int t = 0; t < kTableTypeCount; ++t)
+    {
+        for (int r = 0; r < Easing::Range_TERM; ++r)
+        {
+            const Easing::Type type = kTableTypes[t];
+            const Easing::Range range = (Easing::Range)r;
+            float* dst = mSamples.data() + (t * Easing::Range_TERM + r) * kTableStride;
+
+            for (int i = 0; i <= kSampleCount; ++i)
+            {
+                float x = (float)i / kSampleCount;
+                if (i == 0) x = kTableEdge;
+                if (i == kSampleCount) x = 1.0f - kTableEdge;
+                dst[i] = Easing::calculate(type, range, x, 0.0f, 1.0f, 1.0f);
+            }
+            dst[kSampleCount + 1] = Easing::calculate(type, range, 0.0f, 0.0f, 1.0f, 1.0f);
+            dst[kSampleCount + 2] = Easing::calculate(type, range, 1.0f, 0.0f, 1.0f, 1.0f);
+        }
+    }
+}
+
+int EasingTable::getTableIndex(Easing::Type aType)
+{
+    for (int i = 0; i < kTableTypeCount; ++i)
+    {
+        if (kTableTypes[i] == aType) return i;
+    }
+    return -1;
+}
+
+const float* EasingTable::table(int aTableIndex, Easing::Range aRange) const
+{
+    XC_ASSERT(0 <= aTableIndex && aTableIndex < kTableTypeCount);
+    // an unknown range is in-out, as Easing does
+    const int range = (0 <= aRange && aRange < Easing::Range_TERM) ? aRange : Easing::Range_InOut;
+    return mSamples.data() + (aTableIndex * Easing::Range_TERM + range) * kTableStride;
+}
+
+//-------------------------------------------------------------------------------------------------
+float EasingTable::rate(Easing::Param aParam, float aRate) const
+{
+    float result = 0.0f;
+    rates(aParam, &aRate, &result, 1);
+    return result;
+}
+
+void EasingTable::rates(Easing::Param aParam, const float* aRates, float* aDst, int aCount) const
+{
+    const bool weighted = aParam.type > Easing::Type_Linear;
+    const float weight = aParam.weight;
+    const Easing::Range range = aParam.range;
+
+    switch (aParam.type)
+    {
+    case Easing::Type_Linear:
+        evaluate(LinearEval(), weighted, weight, aRates, aDst, aCount);
+        break;
+    case Easing::Type_Sine:
+    case Easing::Type_Expo:
+    case Easing::Type_Elastic:
+        evaluate(TableEval(table(getTableIndex(aParam.type), range)),
+                 weighted, weight, aRates, aDst, aCount);
+        break;
+    case Easing::Type_Quad:
+        evaluate(ClosedEval<QuadCurve>(range), weighted, weight, aRates, aDst, aCount);
+        break;
+    case Easing::Type_Cubic:
+        evaluate(ClosedEval<CubicCurve>(range), weighted, weight, aRates, aDst, aCount);
+        break;
+    case Easing::Type_Quart:
+        evaluate(ClosedEval<QuartCurve>(range), weighted, weight, aRates, aDst, aCount);
+        break;
+    case Easing::Type_Quint:
+        evaluate(ClosedEval<QuintCurve>(range), weighted, weight, aRates, aDst, aCount);
+        break;
+    case Easing::Type_Circ:
+        evaluate(ClosedEval<CircCurve>(range), weighted, weight, aRates, aDst, aCount);
+        break;
+    case Easing::Type_Back:
+        if (range == Easing::Range_In || range == Easing::Range_Out)
+        {
+            evaluate(ClosedEval<BackCurve<false> >(range), weighted, weight, aRates, aDst, aCount);
+        }
+        else
+        {
+            evaluate(ClosedEval<BackCurve<true> >(range), weighted, weight, aRates, aDst, aCount);
+        }
+        break;
+    case Easing::Type_Bounce:
+        evaluate(ClosedEval<BounceCurve>(range), weighted, weight, aRates, aDst, aCount);
+        break;
+    default:
+        // none returns the start value
+        evaluate(NoneEval(), weighted, weight, aRates, aDst, aCount);
+        break;
+    }
+}
+
+void EasingTable::rates(const Easing::Param* aParams, const float* aRates,
+                        float* aDst, int aCount) const
+{
+    int begin = 0;
+    while (begin < aCount)
+    {
+        int end = begin + 1;
+        while (end < aCount && aParams[end] == aParams[begin]) ++end;
+        rates(aParams[begin], aRates + begin, aDst + begin, end - begin);
+        begin = end;
+    }
+}
+
+} // namespace util
@@ -0,0 +1,49 @@
+#ifndef UTIL_EASINGTABLE_H
+#define UTIL_EASINGTABLE_H
+
+#include <vector>
+#include "util/NonCopyable.h"
+#include "util/Easing.h"
+
+namespace util
+{
+
+// Evaluates the easing curves of util::Easing for the normalized time,
+// that is Easing::calculate(param, rate, 0, 1, 1). The sine, expo and
+// elastic curves are read from the tables which are sampled from Easing,
+// the others are evaluated in the closed forms. The error against Easing is
+// less than kMaxError. The batch evaluation uses sse2 where available.
+class EasingTable : private util::NonCopyable
+{
+public:
+    enum { kSampleCount = 4096 };
+    static const float kMaxError;
+
+    // the tables are built on the first call
+    static const EasingTable& instance();
+    static bool usesSimd();
+
+    EasingTable();
+
+    // aRate is clamped to [0, 1]
+    float rate(Easing::Param aParam, float aRate) const;
+    // the rates of one easing, aDst can be aRates
+    void rates(Easing::Param aParam, const float* aRates, float* aDst, int aCount) const;
+    // the rates of the channels which have each easing, the runs of the
+    // same easing are evaluated together
+    void rates(const Easing::Param* aParams, const float* aRates, float* aDst, int aCount) const;
+
+    size_t byteSize() const { return mSamples.size() * sizeof(float); }
+
+private:
+    static int getTableIndex(Easing::Type aType);
+    const float* table(int aTableIndex, Easing::Range aRange) const;
+
+    // the samples at kSampleCount + 1 points followed by the exact values
+    // at 0 and 1, for each range of each tabulated type
+    std::vector<float> mSamples;
+};
+
+} // namespace util
+
+#endif // UTIL_EASINGTABLE_H
@@ -0,0 +1,116 @@
+#include <string.h>
+#include "util/HashUtil.h"
+
+namespace
+{
+static const uint64 kPrime1 = 11400714785074694791ULL;
+static const uint64 kPrime2 = 14029467366897019727ULL;
+static const uint64 kPrime3 = 1609587929392839161ULL;
+static const uint64 kPrime4 = 9650029242287828579ULL;
+static const uint64 kPrime5 = 2870177450012600261ULL;
+
+inline uint64 rotl(uint64 aValue, int aBits)
+{
+    return (aValue << aBits) | (aValue >> (64 - aBits));
+}
+
+inline uint64 read64(const uint8* aPtr)
+{
+    uint64 value;
+    memcpy(&value, aPtr, sizeof(value));
+    return value;
+}
+
+inline uint32 read32(const uint8* aPtr)
+{
+    uint32 value;
+    memcpy(&value, aPtr, sizeof(value));
+    return value;
+}
+
+inline uint64 hashRound(uint64 aAcc, uint64 aInput)
+{
+    aAcc += aInput * kPrime2;
+    aAcc = rotl(aAcc, 31);
+    return aAcc * kPrime1;
+}
+
+inline uint64 mergeRound(uint64 aAcc, uint64 aValue)
+{
+    aAcc ^= hashRound(0, aValue);
+    return aAcc * kPrime1 + kPrime4;
+}
+}
+
+namespace util
+{
+
+uint64 HashUtil::hash64(const void* aData, size_t aSize, uint64 aSeed)
+{
+    const uint8* ptr = (const uint8*)aData;
+    const uint8* end = ptr + aSize;
+    uint64 hash = 0;
+
+    if (aSize >= 32)
+    {
+        uint64 v1 = aSeed + kPrime1 + kPrime2;
+        uint64 v2 = aSeed + kPrime2;
+        uint64 v3 = aSeed;
+        uint64 v4 = aSeed - kPrime1;
+
+        const uint8* limit = end - 32;
+        do
+        {
+            v1 = hashRound(v1, read64(ptr)); ptr += 8;
+            v2 = hashRound(v2, read64(ptr)); ptr += 8;
+            v3 = hashRound(v3, read64(ptr)); ptr += 8;
+            v4 = hashRound(v4, read64(ptr)); ptr += 8;
+        } while (ptr <= limit);
+
+        hash = rotl(v1, 1) + rotl(v2, 7) + rotl(v3, 12) + rotl(v4, 18);
+        hash = mergeRound(hash, v1);
+        hash = mergeRound(hash, v2);
+        hash = mergeRound(hash, v3);
+        hash = mergeRound(hash, v4);
+    }
+    else
+    {
+        hash = aSeed + kPrime5;
+    }
+
+    hash += (uint64)aSize;
+
+    while (ptr + 8 <= end)
+    {
+        hash ^= hashRound(0, read64(ptr));
+        hash = rotl(hash, 27) * kPrime1 + kPrime4;
+        ptr += 8;
+    }
+    if (ptr + 4 <= end)
+    {
+        hash ^= (uint64)read32(ptr) * kPrime1;
+        hash = rotl(hash, 23) * kPrime2 + kPrime3;
+        ptr += 4;
+    }
+    while (ptr < end)
+    {
+        hash ^= (uint64)(*ptr) * kPrime5;
+        hash = rotl(hash, 11) * kPrime1;
+        ++ptr;
+    }
+
+    // avalanche
+    hash ^= hash >> 33;
+    hash *= kPrime2;
+    hash ^= hash >> 29;
+    hash *= kPrime3;
+    hash ^= hash >> 32;
+    return hash;
+}
+
+uint64 HashUtil::combine(uint64 aHash, uint64 aValue)
+{
+    return mergeRound(aHash ^ kPrime5, aValue);
+}
+
+} // namespace util
@@ -0,0 +1,26 @@
+#ifndef UTIL_HASHUTIL_H
+#define UTIL_HASHUTIL_H
+
+#include <stddef.h>
+#include "XCType.h"
+
+namespace util
+{
+
+class HashUtil
+{
+public:
+    // xxHash64 of a memory block. the value depends on the byte order,
+    // so it is only for comparisons in a process.
+    static uint64 hash64(const void* aData, size_t aSize, uint64 aSeed = 0);
+
+    // order dependent combination of two hash values
+    static uint64 combine(uint64 aHash, uint64 aValue);
+
+private:
+    HashUtil() {}
+};
+
+} // namespace util
+
+#endif // UTIL_HASHUTIL_H
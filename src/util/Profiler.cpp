@@ -0,0 +1,214 @@
+#include <algorithm>
+#include <QAtomicInt>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QElapsedTimer>
+#include <QThread>
+#include <QHash>
+#include <QTextStream>
+#include "util/Profiler.h"
+
+namespace
+{
+// the oldest half is discarded when the events exceed this
+static const int kMaxEventCount = 1 << 18;
+// the gpu track of a thread in the trace
+static const int kGPUTrackOffset = 1000;
+static const int kMaxNodeSummaries = 8;
+
+struct Event
+{
+    const char* name;
+    QString detail;
+    qint64 begin;
+    qint64 end;
+    int thread;
+    bool isGPU;
+};
+
+QAtomicInt gIsEnabled(0);
+QMutex gMutex;
+QElapsedTimer gClock;
+QVector<Event> gEvents;
+QHash<Qt::HANDLE, int> gThreads;
+int gFrameBegin = 0;
+qint64 gFrameTime = -1;
+util::Profiler::Frame gLastFrame;
+
+int threadIndex()
+{
+    const Qt::HANDLE handle = QThread::currentThreadId();
+    auto itr = gThreads.find(handle);
+    if (itr != gThreads.end()) return itr.value();
+    const int index = gThreads.size() + 1;
+    gThreads.insert(handle, index);
+    return index;
+}
+
+void addSummary(QVector<util::Profiler::Summary>& aDest, const Event& aEvent, bool aUseDetail)
+{
+    const QString name = QString::fromLatin1(aEvent.name);
+    for (auto& summary : aDest)
+    {
+        if (summary.isGPU == aEvent.isGPU && summary.name == name &&
+                (!aUseDetail || summary.detail == aEvent.detail))
+        {
+            summary.msec += (aEvent.end - aEvent.begin) * 1e-6;
+            ++summary.count;
+            return;
+        }
+    }
+    util::Profiler::Summary summary;
+    summary.name = name;
+    summary.detail = aUseDetail ? aEvent.detail : QString();
+    summary.isGPU = aEvent.isGPU;
+    summary.msec = (aEvent.end - aEvent.begin) * 1e-6;
+    summary.count = 1;
+    aDest.push_back(summary);
+}
+
+QString escapeJson(const QString& aText)
+{
+    QString result;
+    result.reserve(aText.size());
+    for (auto c : aText)
+    {
+        if (c == '"' || c == '\\') { result += '\\'; result += c; }
+        else if (c.unicode() < 0x20) { result += QString("\\u%1").arg(c.unicode(), 4, 16, QChar('0')); }
+        else { result += c; }
+    }
+    return result;
+}
+}
+
+namespace util
+{
+
+//-------------------------------------------------------------------------------------------------
+bool Profiler::isEnabled()
+{
+    return gIsEnabled.load() != 0;
+}
+
+void Profiler::setEnabled(bool aIsEnabled)
+{
+    QMutexLocker locker(&gMutex);
+    if (!gClock.isValid()) gClock.start();
+    gIsEnabled.store(aIsEnabled ? 1 : 0);
+    gFrameTime = -1;
+}
+
+void Profiler::clear()
+{
+    QMutexLocker locker(&gMutex);
+    gEvents.clear();
+    gFrameBegin = 0;
+    gFrameTime = -1;
+    gLastFrame = Frame();
+}
+
+qint64 Profiler::now()
+{
+    return gClock.isValid() ? gClock.nsecsElapsed() : 0;
+}
+
+void Profiler::record(const char* aName, const QString& aDetail,
+                      qint64 aBegin, qint64 aEnd, bool aIsGPU)
+{
+    QMutexLocker locker(&gMutex);
+    if (gEvents.size() >= kMaxEventCount)
+    {
+        const int count = kMaxEventCount / 2;
+        gEvents.erase(gEvents.begin(), gEvents.begin() + count);
+        gFrameBegin = std::max(gFrameBegin - count, 0);
+    }
+    Event event = { aName, aDetail, aBegin, aEnd, threadIndex(), aIsGPU };
+    gEvents.push_back(event);
+}
+
+void Profiler::markFrame()
+{
+    if (!isEnabled()) return;
+
+    const qint64 time = now();
+    QMutexLocker locker(&gMutex);
+
+    Frame frame;
+    frame.msec = gFrameTime >= 0 ? (time - gFrameTime) * 1e-6 : 0.0;
+    for (int i = gFrameBegin; i < gEvents.size(); ++i)
+    {
+        const Event& event = gEvents[i];
+        addSummary(frame.zones, event, false);
+        if (!event.detail.isEmpty())
+        {
+            addSummary(frame.nodes, event, true);
+        }
+    }
+    std::sort(frame.nodes.begin(), frame.nodes.end(), [](const Summary& a, const Summary& b)
+    {
+        return a.msec > b.msec;
+    });
+    if (frame.nodes.size() > kMaxNodeSummaries)
+    {
+        frame.nodes.resize(kMaxNodeSummaries);
+    }
+
+    // the frame itself is a zone of the trace
+    if (gFrameTime >= 0)
+    {
+        Event event = { "frame", QString(), gFrameTime, time, threadIndex(), false };
+        gEvents.push_back(event);
+    }
+    gLastFrame = frame;
+    gFrameBegin = gEvents.size();
+    gFrameTime = time;
+}
+
+Profiler::Frame Profiler::lastFrame()
+{
+    QMutexLocker locker(&gMutex);
+    return gLastFrame;
+}
+
+bool Profiler::writeTrace(QIODevice& aDevice)
+{
+    QMutexLocker locker(&gMutex);
+    QTextStream out(&aDevice);
+    out.setCodec("UTF-8");
+
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    bool isFirst = true;
+
+    // track names
+    for (auto itr = gThreads.cbegin(); itr != gThreads.cend(); ++itr)
+    {
+        const int tid = itr.value();
+        out << (isFirst ? "" : ",\n")
+            << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << tid
+            << ",\"args\":{\"name\":\"cpu " << tid << "\"}},\n"
+            << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << (tid + kGPUTrackOffset)
+            << ",\"args\":{\"name\":\"gpu " << tid << "\"}}";
+        isFirst = false;
+    }
+
+    for (auto& event : gEvents)
+    {
+        const int tid = event.isGPU ? event.thread + kGPUTrackOffset : event.thread;
+        out << (isFirst ? "" : ",\n")
+            << "{\"name\":\"" << event.name << "\",\"cat\":\"" << (event.isGPU ? "gpu" : "cpu")
+            << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << tid
+            << ",\"ts\":" << QString::number(event.begin * 1e-3, 'f', 3)
+            << ",\"dur\":" << QString::number((event.end - event.begin) * 1e-3, 'f', 3);
+        if (!event.detail.isEmpty())
+        {
+            out << ",\"args\":{\"node\":\"" << escapeJson(event.detail) << "\"}";
+        }
+        out << "}";
+        isFirst = false;
+    }
+    out << "\n]}\n";
+    out.flush();
+    return out.status() == QTextStream::Ok;
+}
+
+} // namespace util
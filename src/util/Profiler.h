@@ -0,0 +1,93 @@
+#ifndef UTIL_PROFILER_H
+#define UTIL_PROFILER_H
+
+#include <QString>
+#include <QVector>
+#include <QIODevice>
+
+namespace util
+{
+
+// Records the timings of scoped zones while enabled.
+// The zones of each frame are summarized by markFrame(), and all the
+// recorded zones can be written in the chrome trace event format, which
+// is also read by perfetto. A disabled profiler costs a flag check per zone.
+class Profiler
+{
+public:
+    struct Summary
+    {
+        Summary() : name(), detail(), isGPU(), msec(), count() {}
+        QString name;
+        QString detail;
+        bool isGPU;
+        double msec;
+        int count;
+    };
+
+    struct Frame
+    {
+        Frame() : msec(), zones(), nodes() {}
+        double msec;
+        QVector<Summary> zones; // by name
+        QVector<Summary> nodes; // by name and detail, slowest first
+    };
+
+    static bool isEnabled();
+    static void setEnabled(bool aIsEnabled);
+    static void clear();
+
+    // nanoseconds on the clock of the profiler
+    static qint64 now();
+
+    // aName has to be a literal, which is not copied
+    static void record(const char* aName, const QString& aDetail,
+                       qint64 aBegin, qint64 aEnd, bool aIsGPU);
+
+    // closes the zones of the current frame
+    static void markFrame();
+    static Frame lastFrame();
+
+    static bool writeTrace(QIODevice& aDevice);
+
+private:
+    Profiler() {}
+};
+
+//-------------------------------------------------------------------------------------------------
+class ProfileZone
+{
+public:
+    explicit ProfileZone(const char* aName)
+        : mName(aName)
+        , mDetail()
+        , mBegin(Profiler::isEnabled() ? Profiler::now() : -1)
+    {
+    }
+
+    // aDetail has to live longer than this zone
+    ProfileZone(const char* aName, const QString& aDetail)
+        : mName(aName)
+        , mDetail(&aDetail)
+        , mBegin(Profiler::isEnabled() ? Profiler::now() : -1)
+    {
+    }
+
+    ~ProfileZone()
+    {
+        if (mBegin >= 0)
+        {
+            Profiler::record(mName, mDetail ? *mDetail : QString(),
+                             mBegin, Profiler::now(), false);
+        }
+    }
+
+private:
+    const char* mName;
+    const QString* mDetail;
+    qint64 mBegin;
+};
+
+} // namespace util
+
+#endif // UTIL_PROFILER_H
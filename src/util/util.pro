@@ -27,11 +27,15 @@ SOURCES += \
     Triangle2DPos.cpp \
     Dir4.cpp \
     Easing.cpp \
+    EasingTable.cpp \
     TriangleRasterizer.cpp \
     ByteBuffer.cpp \
-    EasingName.cpp
+    EasingName.cpp \
+    HashUtil.cpp \
+    Profiler.cpp
 
 HEADERS += \
+    HashUtil.h \
     NetworkUtil.h \
     Signaler.h \
     CollDetect.h \
@@ -48,6 +52,7 @@ HEADERS += \
     PlacePointer.h \
     NonCopyable.h \
     Easing.h \
+    EasingTable.h \
     FergusonCoonsSpline.h \
     SlotId.h \
     StreamReader.h \
@@ -73,4 +78,5 @@ HEADERS += \
     DealtList.h \
     ByteBuffer.h \
     ArrayBuffer.h \
-    EasingName.h
+    EasingName.h \
+    Profiler.h